@@ -371,6 +371,7 @@
 #define enableCanVss_offset 976
 #define enabledStep1Limiter_offset 744
 #define enableInnovateLC2_offset 976
+#define enableKnockControl_offset 976
 #define enableLaunchBoost_offset 976
 #define enableLaunchRetard_offset 976
 #define enableMapEstimationTableFallback_offset 76
@@ -1000,6 +1001,8 @@
 #define knockDetectionWindowStart_offset 1500
 #define knockNoise_offset 1820
 #define knockNoiseRpmBins_offset 1852
+#define knockRetardRecoveryRate_offset 2432
+#define knockRetardStep_offset 2428
 #define knockVThreshold_offset 1512
 #define lambdaLoadBins_offset 18848
 #define lambdaRpmBins_offset 18912
@@ -1038,7 +1041,7 @@
 #define LIS302DLCsPin_offset 2043
 #define LIS302DLCsPinMode_offset 2417
 #define LOAD_1_BYTE_PACKING_MULT 2
-#define log_format_e_auto_enum "LF_NATIVE", "LM_MLV"
+#define log_format_e_auto_enum "LF_NATIVE", "LM_MLV", "LF_MLG_COMPRESSED"
 #define logFormat_offset 496
 #define LOGIC_ANALYZER_CHANNEL_COUNT 4
 #define logicAnalyzerPins1_offset 748
@@ -1070,6 +1073,7 @@
 #define MAP_ACCEL_TAPER 8
 #define MAP_ANGLE_SIZE 8
 #define map_offset 108
+#define mapPredictionGain_offset 2424
 #define map_samplingAngle_offset 140
 #define map_samplingAngleBins_offset 108
 #define map_samplingWindow_offset 204
@@ -1212,6 +1216,7 @@
 #define PROTOCOL_WA_CHANNEL_2 "input2"
 #define PROTOCOL_WA_CHANNEL_3 "input3"
 #define PROTOCOL_WA_CHANNEL_4 "input4"
+#define rollingCutRpmWindow_offset 1708
 #define rollingLaunchEnabled_offset 76
 #define RPM_1_BYTE_PACKING_MULT 50
 #define rpmHardLimit_offset 416
@@ -1220,6 +1225,12 @@
 #define sdCardCsPinMode_offset 2226
 #define sdCardPeriodMs_offset 804
 #define sdCardSpiDevice_offset 2592
+#define sdLogEngineDivider_offset 2508
+#define sdLogFuelDivider_offset 2509
+#define sdLogIgnitionDivider_offset 2510
+#define sdLogSensorsDivider_offset 2512
+#define sdLogStatusDivider_offset 2513
+#define sdLogThrottleDivider_offset 2511
 #define secondSolenoidPin_offset 810
 #define sensor_chart_e_auto_enum "SC_OFF", "SC_TRIGGER", "SC_MAP", "SC_RPM_ACCEL", "SC_DETAILED_RPM", "SC_AUX_FAST1"
 #define sensor_chart_e_enum "none", "trigger", "MAP", "RPM ACCEL", "DETAILED RPM", "Fast Aux1", "INVALID", "INVALID"
@@ -1526,6 +1537,10 @@
 #define TS_ONLINE_PROTOCOL_char z
 #define TS_OUTPUT_COMMAND 'O'
 #define TS_OUTPUT_COMMAND_char O
+#define TS_OUTPUT_DELTA_COMMAND 'd'
+#define TS_OUTPUT_DELTA_COMMAND_char d
+#define TS_OUTPUT_STREAM_COMMAND 'u'
+#define TS_OUTPUT_STREAM_COMMAND_char u
 #define TS_OUTPUT_SIZE 340
 #define TS_PAGE_COMMAND 'P'
 #define TS_PAGE_COMMAND_char P
@@ -1541,6 +1556,7 @@
 #define TS_RESPONSE_CRC_FAILURE 0x82
 #define TS_RESPONSE_FRAMING_ERROR 0x8D
 #define TS_RESPONSE_OK 0
+#define TS_RESPONSE_OUTPUT_STREAM 8
 #define TS_RESPONSE_OUT_OF_RANGE 0x84
 #define TS_RESPONSE_UNDERRUN 0x80
 #define TS_RESPONSE_UNRECOGNIZED_COMMAND 0x83
@@ -1641,13 +1657,9 @@
 #define unused1476b3_offset 1476
 #define unused1476b8_offset 1476
 #define unused15136_offset 16032
-#define unused1708_offset 1708
+#define unused1710_offset 1710
 #define unused2260_offset 2260
 #define unused2419_offset 2419
-#define unused2432_offset 2432
-#define unused244_2_offset 2424
-#define unused244_3_offset 2428
-#define unused2508_offset 2508
 #define unused2536_offset 2536
 #define unused3328_offset 3340
 #define unused3942_offset 3992
@@ -1676,7 +1688,6 @@
 #define unusedAuxVoltage1_TODO_332_offset 2713
 #define unusedAuxVoltage2_TODO_332_offset 2714
 #define unusedBit4_1476_offset 1476
-#define unusedBit_251_29_offset 976
 #define unusedBit_289_30_offset 976
 #define unusedBit_289_31_offset 976
 #define unusedBit_34_31_offset 76
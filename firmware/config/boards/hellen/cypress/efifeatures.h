@@ -102,6 +102,9 @@
 
 #define EFI_INTERNAL_FLASH TRUE
 
+// journal regions are sized for stm32 sectors
+#define EFI_CONFIG_JOURNAL FALSE
+
 /**
  * Flex Non Volatile Memory is faster than flash
  * It also has smaller pages so it takes less time to erase
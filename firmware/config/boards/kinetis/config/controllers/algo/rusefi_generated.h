@@ -355,6 +355,7 @@
 #define enableCanVss_offset 976
 #define enabledStep1Limiter_offset 744
 #define enableInnovateLC2_offset 976
+#define enableKnockControl_offset 976
 #define enableLaunchBoost_offset 976
 #define enableLaunchRetard_offset 976
 #define enableMapEstimationTableFallback_offset 76
@@ -984,6 +985,8 @@
 #define knockDetectionWindowStart_offset 1500
 #define knockNoise_offset 1820
 #define knockNoiseRpmBins_offset 1852
+#define knockRetardRecoveryRate_offset 2424
+#define knockRetardStep_offset 2420
 #define knockVThreshold_offset 1512
 #define lambdaLoadBins_offset 18820
 #define lambdaRpmBins_offset 18884
@@ -1022,7 +1025,7 @@
 #define LIS302DLCsPin_offset 2043
 #define LIS302DLCsPinMode_offset 2409
 #define LOAD_1_BYTE_PACKING_MULT 2
-#define log_format_e_auto_enum "LF_NATIVE", "LM_MLV"
+#define log_format_e_auto_enum "LF_NATIVE", "LM_MLV", "LF_MLG_COMPRESSED"
 #define logFormat_offset 496
 #define LOGIC_ANALYZER_CHANNEL_COUNT 4
 #define logicAnalyzerPins1_offset 748
@@ -1054,6 +1057,7 @@
 #define MAP_ACCEL_TAPER 8
 #define MAP_ANGLE_SIZE 8
 #define map_offset 108
+#define mapPredictionGain_offset 2416
 #define map_samplingAngle_offset 140
 #define map_samplingAngleBins_offset 108
 #define map_samplingWindow_offset 204
@@ -1196,6 +1200,7 @@
 #define PROTOCOL_WA_CHANNEL_2 "input2"
 #define PROTOCOL_WA_CHANNEL_3 "input3"
 #define PROTOCOL_WA_CHANNEL_4 "input4"
+#define rollingCutRpmWindow_offset 1708
 #define rollingLaunchEnabled_offset 76
 #define RPM_1_BYTE_PACKING_MULT 50
 #define rpmHardLimit_offset 416
@@ -1510,6 +1515,10 @@
 #define TS_ONLINE_PROTOCOL_char z
 #define TS_OUTPUT_COMMAND 'O'
 #define TS_OUTPUT_COMMAND_char O
+#define TS_OUTPUT_DELTA_COMMAND 'd'
+#define TS_OUTPUT_DELTA_COMMAND_char d
+#define TS_OUTPUT_STREAM_COMMAND 'u'
+#define TS_OUTPUT_STREAM_COMMAND_char u
 #define TS_OUTPUT_SIZE 340
 #define TS_PAGE_COMMAND 'P'
 #define TS_PAGE_COMMAND_char P
@@ -1525,6 +1534,7 @@
 #define TS_RESPONSE_CRC_FAILURE 0x82
 #define TS_RESPONSE_FRAMING_ERROR 0x8D
 #define TS_RESPONSE_OK 0
+#define TS_RESPONSE_OUTPUT_STREAM 8
 #define TS_RESPONSE_OUT_OF_RANGE 0x84
 #define TS_RESPONSE_UNDERRUN 0x80
 #define TS_RESPONSE_UNRECOGNIZED_COMMAND 0x83
@@ -1625,12 +1635,9 @@
 #define unused1476b3_offset 1476
 #define unused1476b8_offset 1476
 #define unused15136_offset 16004
-#define unused1708_offset 1708
+#define unused1710_offset 1710
 #define unused2260_offset 2252
 #define unused2419_offset 2411
-#define unused2432_offset 2424
-#define unused244_2_offset 2416
-#define unused244_3_offset 2420
 #define unused2508_offset 2500
 #define unused2536_offset 2528
 #define unused3328_offset 3312
@@ -1660,7 +1667,6 @@
 #define unusedAuxVoltage1_TODO_332_offset 2685
 #define unusedAuxVoltage2_TODO_332_offset 2686
 #define unusedBit4_1476_offset 1476
-#define unusedBit_251_29_offset 976
 #define unusedBit_289_30_offset 976
 #define unusedBit_289_31_offset 976
 #define unusedBit_34_31_offset 76
@@ -101,6 +101,9 @@
 
 #define EFI_INTERNAL_FLASH TRUE
 
+// activeConfiguration lives in the first copy, it has to stay a plain copy
+#define EFI_CONFIG_JOURNAL FALSE
+
 /**
  * Usually you need shaft position input, but maybe you do not need it?
  */
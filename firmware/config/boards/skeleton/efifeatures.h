@@ -144,6 +144,13 @@
 #define EFI_INTERNAL_FLASH TRUE
 #endif
 
+/**
+ * Burns append the changed parts of the configuration to a journal instead of rewriting both copies
+ */
+#ifndef EFI_CONFIG_JOURNAL
+#define EFI_CONFIG_JOURNAL TRUE
+#endif
+
 /**
  * Usually you need shaft position input, but maybe you do not need it?
  */
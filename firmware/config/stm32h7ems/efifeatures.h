@@ -39,6 +39,9 @@
 #undef EFI_MAX_31855
 #define EFI_MAX_31855 FALSE
 
+// intFlashWrite programs whole 256 bit flash words, each of them once between erases
+#define CONFIG_JOURNAL_WRITE_ALIGN 32
+
 #undef BOARD_EXT_GPIOCHIPS
 #define BOARD_EXT_GPIOCHIPS			(BOARD_TLE6240_COUNT + BOARD_MC33972_COUNT + BOARD_TLE8888_COUNT + BOARD_DRV8860_COUNT + BOARD_MC33810_COUNT)
 
@@ -0,0 +1,82 @@
+/**
+ * @file	output_channel_registry.h
+ *
+ * Output channels are filled by small updaters, each owning a range of TunerStudioOutputChannels.
+ * A request refreshes just the updaters whose range it overlaps, slow changing ones no more
+ * often than OUTPUT_SLOW_REFRESH_MS.
+ *
+ * @date Oct 18, 2026
+ */
+
+#pragma once
+
+#include "global.h"
+#include "tunerstudio_outputs.h"
+
+#include <cstddef>
+
+// error counters, versions, fuel level: nobody needs these faster
+#define OUTPUT_SLOW_REFRESH_MS 500
+
+enum class OutputRefresh : uint8_t {
+	// every request covering the range
+	EveryRequest,
+	// at most every OUTPUT_SLOW_REFRESH_MS
+	Slow,
+};
+
+typedef void (*OutputChannelUpdater)(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX);
+
+struct OutputChannelEntry {
+	uint16_t offset;
+	uint16_t size;
+	OutputRefresh refresh;
+	OutputChannelUpdater update;
+};
+
+// offset and size covering fields first to last
+#define OUTPUT_RANGE(first, last) offsetof(TunerStudioOutputChannels, first), \
+	offsetof(TunerStudioOutputChannels, last) + sizeof(TunerStudioOutputChannels::last) - offsetof(TunerStudioOutputChannels, first)
+
+template <size_t TCount>
+class OutputChannelRegistry {
+public:
+	explicit OutputChannelRegistry(const OutputChannelEntry (&entries)[TCount])
+		: m_entries(entries)
+	{
+	}
+
+	/**
+	 * Runs the updaters overlapping offset..offset+count which are due.
+	 */
+	void refresh(TunerStudioOutputChannels *tsOutputChannels, uint16_t offset, uint16_t count, efitick_t nowNt DECLARE_ENGINE_PARAMETER_SUFFIX) {
+		for (size_t i = 0; i < TCount; i++) {
+			const OutputChannelEntry &entry = m_entries[i];
+
+			if (entry.offset >= offset + count || entry.offset + entry.size <= offset) {
+				continue;
+			}
+
+			if (entry.refresh == OutputRefresh::Slow && m_refreshed[i]
+					&& nowNt - m_refreshedNt[i] < MS2NT(OUTPUT_SLOW_REFRESH_MS)) {
+				continue;
+			}
+
+			entry.update(tsOutputChannels PASS_ENGINE_PARAMETER_SUFFIX);
+			m_refreshed[i] = true;
+			m_refreshedNt[i] = nowNt;
+			m_updateCount++;
+		}
+	}
+
+	// updaters run so far
+	uint32_t getUpdateCount() const {
+		return m_updateCount;
+	}
+
+private:
+	const OutputChannelEntry (&m_entries)[TCount];
+	bool m_refreshed[TCount] = {};
+	efitick_t m_refreshedNt[TCount] = {};
+	uint32_t m_updateCount = 0;
+};
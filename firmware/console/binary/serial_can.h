@@ -8,60 +8,77 @@
 
 #pragma once
 
-#include "fifo_buffer.h"
+#include "tunerstudio_io.h"
+#include "iso_tp.h"
 
 #define CAN_TX_ID 0x102
 
-enum IsoTpFrameType {
-	ISO_TP_FRAME_SINGLE = 0,
-	ISO_TP_FRAME_FIRST = 1,
-	ISO_TP_FRAME_CONSECUTIVE = 2,
-	ISO_TP_FRAME_FLOW_CONTROL = 3,
-};
+#ifndef TS_CAN_BLOCK_SIZE
+// Consecutive Frames the PC may send between our Flow Controls, 0 for no limit
+#define TS_CAN_BLOCK_SIZE 0
+#endif
 
-class IsoTpFrameHeader {
-public:
-	IsoTpFrameType frameType;
-
-	// used for 'single' or 'first' frames
-	int numBytes;
-	// used for 'consecutive' frames
-	int index;
-	// used for 'flow control' frames
-	int fcFlag;
-	int blockSize;
-	int separationTime;
-};
+#ifndef TS_CAN_SEPARATION_TIME
+// STmin asked from the PC, as carried in Flow Control: 0..127 ms or 0xF1..0xF9 for 100..900 us
+#define TS_CAN_SEPARATION_TIME 0
+#endif
 
-class CanStreamerState {
+/**
+ * TunerStudio byte stream over ISO-TP.
+ *
+ * Every write() which does not fit one frame goes out as its own ISO-TP message, straight out
+ * of the caller's buffer: a whole response built in the scratch buffer is one message and is
+ * never copied. Short writes like the header and CRC of large packets are gathered and sent
+ * on flush() or ahead of the next long write.
+ *
+ * Consecutive Frames go back to back as fast as the CAN mailboxes take them, paced only by the
+ * block size and STmin the PC asks for.
+ */
+class CanTsChannel : public TsChannelBase {
 public:
-	fifo_buffer<uint8_t, 64> rxFifoBuf;
-	fifo_buffer<uint8_t, 64> txFifoBuf;
+	/**
+	 * @param pollTimeout how long to wait for a frame while waiting for Flow Control or STmin,
+	 * in receiveFrame() units, about a millisecond
+	 */
+	explicit CanTsChannel(int pollTimeout);
 
-#if defined(TS_CAN_DEVICE_SHORT_PACKETS_IN_ONE_FRAME)
-	// used to restore the original packet with CRC
-    uint8_t tmpRxBuf[13];
-#endif
+	void write(const uint8_t* buffer, size_t size) override;
+	size_t readTimeout(uint8_t* buffer, size_t size, int timeout) override;
+	void flush() override;
+	bool isReady() override;
 
-	// used for multi-frame ISO-TP packets
-	int waitingForNumBytes = 0;
-	int waitingForFrameIndex = 0;
+	uint32_t getTxAbortCount() const {
+		return m_transmitter.getAbortCount();
+	}
 
-	event_listener_t el;
-	
-public:
-	int sendFrame(CANDriver *canp, const IsoTpFrameHeader & header, const uint8_t *data, int num);
-	int receiveFrame(CANDriver *canp, CANRxFrame *rxmsg, uint8_t *buf, int num);
-	int getDataFromFifo(uint8_t *rxbuf, size_t &numBytes);
-	// returns the number of bytes sent
-	int sendDataTimeout(CANDriver *canp, const uint8_t *txbuf, int numBytes, sysinterval_t timeout);
-};
+	uint32_t getRxErrorCount() const {
+		return m_receiver.getErrorCount();
+	}
 
-void canInit(CANDriver *canp);
+protected:
+	// puts one ISO_TP_FRAME_SIZE byte frame on the bus, false on failure
+	virtual bool transmitFrame(const uint8_t* frame) = 0;
+	// waits up to timeout for the next frame addressed to us
+	virtual bool receiveFrame(uint8_t* frame, int timeout) = 0;
 
-// we don't have canStreamSendTimeout() because we need to "bufferize" the stream and send it in fixed-length packets
-msg_t canAddToTxStreamTimeout(CANDriver *canp, size_t *np, const uint8_t *txbuf, sysinterval_t timeout);
-msg_t canFlushTxStream(CANDriver *canp, sysinterval_t timeout);
+private:
+	void sendMessage(const uint8_t* buffer, size_t size);
 
-msg_t canStreamReceiveTimeout(CANDriver *canp, size_t *np, uint8_t *rxbuf, sysinterval_t timeout);
+	const int m_pollTimeout;
+
+	IsoTpTransmitter m_transmitter;
+	IsoTpReceiver m_receiver;
+
+	// short writes waiting to go out in one Single Frame
+	uint8_t m_txPending[ISO_TP_FRAME_SIZE - 1];
+	size_t m_txPendingCount = 0;
+
+	// received bytes the reader did not ask for yet, one frame worth or a restored short packet
+	uint8_t m_rxPending[16];
+	size_t m_rxPendingOffset = 0;
+	size_t m_rxPendingCount = 0;
+};
 
+#ifdef TS_CAN_DEVICE
+CanTsChannel* getTsCanChannel();
+#endif /* TS_CAN_DEVICE */
@@ -0,0 +1,86 @@
+/**
+ * @file	ts_delta_encoder.cpp
+ *
+ * @date Oct 18, 2026
+ */
+
+#include "ts_delta_encoder.h"
+
+#include <cstring>
+
+bool tsParseDeltaRequest(const char *data, size_t size, TsDeltaRequest &request) {
+	if (size < TS_DELTA_REQUEST_SIZE) {
+		return false;
+	}
+
+	// same byte order as the other offset and count commands
+	memcpy(&request.offset, data, sizeof(request.offset));
+	memcpy(&request.count, data + 2, sizeof(request.count));
+	request.acknowledged = data[4];
+	return true;
+}
+
+size_t TsDeltaEncoder::encodeKeyframe(const uint8_t *current, uint16_t count, uint8_t *out) {
+	m_keyframeCount++;
+	m_sinceKeyframe = 0;
+
+	out[0] = TS_DELTA_KEYFRAME;
+	out[1] = m_sequence;
+	memcpy(out + TS_DELTA_HEADER_SIZE, current, count);
+
+	return TS_DELTA_HEADER_SIZE + count;
+}
+
+size_t TsDeltaEncoder::encode(const uint8_t *current, uint16_t offset, uint16_t count, uint8_t acknowledged, uint8_t *out) {
+	bool clientHasSnapshot = m_sequence != 0 && acknowledged == m_sequence
+			&& offset == m_offset && count == m_count;
+
+	// skip 0, it means "no snapshot"
+	m_sequence = m_sequence == 0xFF ? 1 : m_sequence + 1;
+
+	size_t size = 0;
+
+	if (clientHasSnapshot && ++m_sinceKeyframe < TS_DELTA_KEYFRAME_PERIOD) {
+		size_t words = (count + TS_DELTA_WORD_SIZE - 1) / TS_DELTA_WORD_SIZE;
+		size_t bitmapSize = (words + 7) / 8;
+
+		uint8_t *bitmap = out + TS_DELTA_HEADER_SIZE;
+		memset(bitmap, 0, bitmapSize);
+		size = TS_DELTA_HEADER_SIZE + bitmapSize;
+
+		for (size_t word = 0; word < words; word++) {
+			size_t position = word * TS_DELTA_WORD_SIZE;
+			// odd count: the last word is a single byte
+			size_t length = count - position < TS_DELTA_WORD_SIZE ? count - position : TS_DELTA_WORD_SIZE;
+
+			if (memcmp(current + position, m_snapshot + position, length) == 0) {
+				continue;
+			}
+
+			// a delta which does not beat the keyframe is not worth it
+			if (size + length > TS_DELTA_HEADER_SIZE + (size_t)count) {
+				size = 0;
+				break;
+			}
+
+			bitmap[word / 8] |= 1 << (word % 8);
+			memcpy(out + size, current + position, length);
+			size += length;
+		}
+
+		if (size != 0) {
+			out[0] = 0;
+			out[1] = m_sequence;
+		}
+	}
+
+	if (size == 0) {
+		size = encodeKeyframe(current, count, out);
+	}
+
+	memcpy(m_snapshot, current, count);
+	m_offset = offset;
+	m_count = count;
+
+	return size;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file	ts_delta_encoder.h
+ *
+ * Output channels sent as a difference against the previous response, for TS_OUTPUT_DELTA_COMMAND.
+ *
+ * Response layout:
+ *   flags (TS_DELTA_KEYFRAME), sequence number of this snapshot, then either
+ *   keyframe: all requested bytes
+ *   delta: one bit per 16 bit word of the requested range, least significant bit first, set
+ *          for words which changed, followed by just the changed words
+ *
+ * The client sends back the sequence number of the last response it applied. A delta is only
+ * ever sent against that exact snapshot, anything else (first poll, lost response, different
+ * range) gets a keyframe. Sequence number 0 is never used, a client without a snapshot sends 0.
+ *
+ * @date Oct 18, 2026
+ */
+
+#pragma once
+
+#include "tunerstudio_outputs.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#define TS_DELTA_KEYFRAME 1
+
+// flags and sequence number
+#define TS_DELTA_HEADER_SIZE 2
+
+// after the command byte: offset, count and the sequence number the client has
+#define TS_DELTA_REQUEST_SIZE 5
+
+// one bitmap bit per word
+#define TS_DELTA_WORD_SIZE 2
+
+// even a client which never misses a response gets a full snapshot this often
+#define TS_DELTA_KEYFRAME_PERIOD 64
+
+struct TsDeltaRequest {
+	uint16_t offset;
+	uint16_t count;
+	// sequence number the client has applied, 0 for none
+	uint8_t acknowledged;
+};
+
+/**
+ * @param data request after the command byte
+ * @return false if the request is too short
+ */
+bool tsParseDeltaRequest(const char *data, size_t size, TsDeltaRequest &request);
+
+class TsDeltaEncoder {
+public:
+	/**
+	 * @param current count bytes of output channels starting at offset
+	 * @param acknowledged sequence number the client has applied, 0 for none
+	 * @param out at least TS_DELTA_HEADER_SIZE + count bytes
+	 * @return response size
+	 */
+	size_t encode(const uint8_t *current, uint16_t offset, uint16_t count, uint8_t acknowledged, uint8_t *out);
+
+	uint32_t getKeyframeCount() const {
+		return m_keyframeCount;
+	}
+
+private:
+	size_t encodeKeyframe(const uint8_t *current, uint16_t count, uint8_t *out);
+
+	// what the client has if it acknowledges m_sequence
+	uint8_t m_snapshot[sizeof(TunerStudioOutputChannels)];
+	uint16_t m_offset = 0;
+	uint16_t m_count = 0;
+	uint8_t m_sequence = 0;
+	uint8_t m_sinceKeyframe = 0;
+
+	uint32_t m_keyframeCount = 0;
+};
@@ -0,0 +1,111 @@
+/**
+ * @file	ts_output_stream.cpp
+ *
+ * @date Oct 18, 2026
+ */
+
+#include "ts_output_stream.h"
+
+bool TsOutputStream::subscribe(TsChannelBase *tsChannel, const uint8_t *request, size_t size, efitick_t nowNt) {
+	if (size < sizeof(uint16_t) || (size - sizeof(uint16_t)) % (2 * sizeof(uint16_t)) != 0) {
+		return false;
+	}
+
+	// little endian like offset and count of the other commands
+	auto get16 = [request](size_t index) {
+		return (uint16_t)(request[2 * index] | request[2 * index + 1] << 8);
+	};
+
+	uint16_t periodMs = get16(0);
+	size_t rangeCount = (size - sizeof(uint16_t)) / (2 * sizeof(uint16_t));
+
+	if (periodMs == 0) {
+		stop();
+		return true;
+	}
+
+	if (rangeCount > TS_STREAM_MAX_RANGES) {
+		return false;
+	}
+
+	Range ranges[TS_STREAM_MAX_RANGES];
+	size_t total = 0;
+	for (size_t i = 0; i < rangeCount; i++) {
+		ranges[i].offset = get16(1 + 2 * i);
+		ranges[i].count = get16(2 + 2 * i);
+		total += ranges[i].count;
+
+		if (ranges[i].offset + ranges[i].count > sizeof(TunerStudioOutputChannels)
+				|| total > sizeof(TunerStudioOutputChannels)) {
+			return false;
+		}
+	}
+
+	if (rangeCount == 0) {
+		ranges[0] = { 0, sizeof(TunerStudioOutputChannels) };
+		rangeCount = 1;
+	}
+
+	memcpy(m_ranges, ranges, sizeof(m_ranges));
+	m_rangeCount = rangeCount;
+	m_channel = tsChannel;
+	m_period = MS2NT(periodMs);
+	// first frame right away
+	m_nextFrameNt = nowNt;
+	m_waitingForChannel = false;
+
+	return true;
+}
+
+void TsOutputStream::stop() {
+	m_period = 0;
+}
+
+efitick_t TsOutputStream::getTimeToNextFrame(efitick_t nowNt) const {
+	if (m_nextFrameNt > nowNt) {
+		return m_nextFrameNt - nowNt;
+	}
+
+	// do not spin while the link drains
+	return m_waitingForChannel ? MS2NT(TS_STREAM_RETRY_MS) : 0;
+}
+
+void TsOutputStream::update(TsChannelBase *tsChannel, const uint8_t *outputs, efitick_t nowNt,
+		void (*refresh)(uint16_t offset, uint16_t count)) {
+	if (!isActive(tsChannel) || nowNt < m_nextFrameNt) {
+		return;
+	}
+
+	// a whole period late: a page read or a burn kept us away, or the link could not take it
+	efitick_t late = nowNt - m_nextFrameNt;
+	if (late >= m_period) {
+		uint32_t missed = late / m_period;
+		m_droppedCount += missed;
+		m_frameNumber += missed;
+		m_nextFrameNt += missed * m_period;
+	}
+
+	if (tsChannel->wouldWriteBlock()) {
+		// hold the frame until the link drains or the next one is due, never queue behind it
+		m_waitingForChannel = true;
+		return;
+	}
+	m_waitingForChannel = false;
+
+	m_nextFrameNt += m_period;
+	uint16_t frameNumber = m_frameNumber++;
+
+	m_frame[0] = frameNumber & 0xFF;
+	m_frame[1] = frameNumber >> 8;
+	size_t size = TS_STREAM_HEADER_SIZE;
+	for (size_t i = 0; i < m_rangeCount; i++) {
+		if (refresh) {
+			refresh(m_ranges[i].offset, m_ranges[i].count);
+		}
+		memcpy(m_frame + size, outputs + m_ranges[i].offset, m_ranges[i].count);
+		size += m_ranges[i].count;
+	}
+
+	m_frameCount++;
+	tsChannel->writeCrcPacket(TS_RESPONSE_OUTPUT_STREAM, m_frame, size);
+}
@@ -0,0 +1,88 @@
+/**
+ * @file	ts_output_stream.h
+ *
+ * Output channels pushed to the client at a fixed rate, for TS_OUTPUT_STREAM_COMMAND.
+ *
+ * Request payload: period in milliseconds (uint16), then up to TS_STREAM_MAX_RANGES pairs of
+ * offset and count (uint16 each) into the output channels. No pairs means the whole block,
+ * period 0 stops the stream.
+ *
+ * Every period the TS thread sends a CRC packet with response code TS_RESPONSE_OUTPUT_STREAM:
+ * frame number (uint16), then the requested ranges back to back. While the channel has not
+ * drained the previous frame the next one waits; once it is a whole period late it is dropped
+ * rather than let frames pile up behind a slow link. The frame number counts dropped frames
+ * too so the client sees the gap.
+ *
+ * There is one stream, it goes to the channel which asked for it last.
+ *
+ * @date Oct 18, 2026
+ */
+
+#pragma once
+
+#include "global.h"
+#include "tunerstudio_io.h"
+#include "tunerstudio_outputs.h"
+
+#define TS_STREAM_MAX_RANGES 8
+
+// frame number
+#define TS_STREAM_HEADER_SIZE 2
+
+// how often to look again while the channel is busy with the previous frame
+#define TS_STREAM_RETRY_MS 1
+
+class TsOutputStream {
+public:
+	/**
+	 * @param request command payload after the command byte
+	 * @return false if the request is malformed or out of range, the stream is left as it was
+	 */
+	bool subscribe(TsChannelBase *tsChannel, const uint8_t *request, size_t size, efitick_t nowNt);
+	void stop();
+
+	bool isActive(const TsChannelBase *tsChannel) const {
+		return m_period != 0 && m_channel == tsChannel;
+	}
+
+	/**
+	 * @return how long the TS thread may wait for a command before the next frame is due
+	 */
+	efitick_t getTimeToNextFrame(efitick_t nowNt) const;
+
+	/**
+	 * Sends the frame if it is due and the channel subscribed and can take it.
+	 * @param outputs current output channels
+	 * @param refresh brings a range of outputs up to date, called only for frames which are sent
+	 */
+	void update(TsChannelBase *tsChannel, const uint8_t *outputs, efitick_t nowNt,
+			void (*refresh)(uint16_t offset, uint16_t count) = nullptr);
+
+	uint32_t getFrameCount() const {
+		return m_frameCount;
+	}
+
+	uint32_t getDroppedCount() const {
+		return m_droppedCount;
+	}
+
+private:
+	struct Range {
+		uint16_t offset;
+		uint16_t count;
+	};
+
+	TsChannelBase *m_channel = nullptr;
+	Range m_ranges[TS_STREAM_MAX_RANGES];
+	size_t m_rangeCount = 0;
+
+	efitick_t m_period = 0;
+	efitick_t m_nextFrameNt = 0;
+	uint16_t m_frameNumber = 0;
+	bool m_waitingForChannel = false;
+
+	uint32_t m_frameCount = 0;
+	uint32_t m_droppedCount = 0;
+
+	uint8_t m_frame[TS_STREAM_HEADER_SIZE + sizeof(TunerStudioOutputChannels)];
+};
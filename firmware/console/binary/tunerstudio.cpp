@@ -90,6 +90,9 @@
 #include "thread_priority.h"
 
 #include "signature.h"
+#include "serial_can.h"
+#include "ts_output_stream.h"
+#include "ts_delta_encoder.h"
 
 #if EFI_SIMULATOR
 #include "rusEfiFunctionalTest.h"
@@ -120,6 +123,8 @@ static efitimems_t previousWriteReportMs = 0;
 
 static ts_channel_s tsChannel;
 
+static TsOutputStream outputStream;
+
 // this thread wants a bit extra stack
 static THD_WORKING_AREA(tunerstudioThreadStack, CONNECTIVITY_THREAD_STACK);
 
@@ -133,6 +138,8 @@ static void printErrorCounters(void) {
 			tsState.outputChannelsCommandCounter, tsState.readPageCommandsCounter, tsState.burnCommandCounter);
 	scheduleMsg(&tsLogger, "TunerStudio W=%d / C=%d / P=%d", tsState.writeValueCommandCounter,
 			tsState.writeChunkCommandCounter, tsState.pageCommandCounter);
+	scheduleMsg(&tsLogger, "TunerStudio output stream frames=%d / dropped=%d", outputStream.getFrameCount(),
+			outputStream.getDroppedCount());
 }
 
 void printTsStats(void) {
@@ -448,6 +455,8 @@ static void handleBurnCommand(TsChannelBase* tsChannel, ts_response_format_e mod
 
 static bool isKnownCommand(char command) {
 	return command == TS_HELLO_COMMAND || command == TS_READ_COMMAND || command == TS_OUTPUT_COMMAND
+			|| command == TS_OUTPUT_DELTA_COMMAND
+			|| command == TS_OUTPUT_STREAM_COMMAND
 			|| command == TS_PAGE_COMMAND || command == TS_BURN_COMMAND || command == TS_SINGLE_WRITE_COMMAND
 			|| command == TS_CHUNK_WRITE_COMMAND || command == TS_EXECUTE
 			|| command == TS_IO_TEST_COMMAND
@@ -473,6 +482,10 @@ static void tsProcessOne(TsChannelBase* tsChannel) {
 	if (!tsChannel->isReady()) {
 		chThdSleepMilliseconds(10);
 		tsChannel->wasReady = false;
+		// whoever connects next did not ask for it
+		if (outputStream.isActive(tsChannel)) {
+			outputStream.stop();
+		}
 		return;
 	}
 
@@ -484,7 +497,19 @@ static void tsProcessOne(TsChannelBase* tsChannel) {
 	tsState.totalCounter++;
 
 	uint8_t firstByte;
-	int received = tsChannel->read(&firstByte, 1);
+	int received;
+	if (outputStream.isActive(tsChannel)) {
+		// wait for a command only until the next frame is due
+		efitick_t wait = outputStream.getTimeToNextFrame(getTimeNowNt());
+		received = tsChannel->readTimeout(&firstByte, 1, TIME_US2I(NT2US(wait)));
+		if (received != 1) {
+			outputStream.update(tsChannel, reinterpret_cast<const uint8_t*>(&tsOutputChannels), getTimeNowNt(),
+					prepareTunerStudioOutputs);
+			return;
+		}
+	} else {
+		received = tsChannel->read(&firstByte, 1);
+	}
 #if EFI_SIMULATOR
 		logMsg("received %d\r\n", received);
 #endif
@@ -584,7 +609,11 @@ static THD_FUNCTION(tsThreadEntryPoint, arg) {
 
 	startTsPort(&tsChannel);
 
+#ifdef TS_CAN_DEVICE
+	runBinaryProtocolLoop(getTsCanChannel());
+#else
 	runBinaryProtocolLoop(&tsChannel);
+#endif /* TS_CAN_DEVICE */
 }
 
 /**
@@ -650,6 +679,17 @@ static void handleGetVersion(TsChannelBase* tsChannel) {
 	tsChannel->sendResponse(TS_CRC, (const uint8_t *) versionBuffer, strlen(versionBuffer) + 1);
 }
 
+static void handleOutputStreamCommand(TsChannelBase* tsChannel, const char *data, int size) {
+	if (!outputStream.subscribe(tsChannel, reinterpret_cast<const uint8_t*>(data), size, getTimeNowNt())) {
+		scheduleMsg(&tsLogger, "TS: bad output stream request size=%d", size);
+		sendErrorCode(tsChannel, TS_RESPONSE_OUT_OF_RANGE);
+		return;
+	}
+
+	// frames follow right after this from tsProcessOne()
+	sendOkResponse(tsChannel, TS_CRC);
+}
+
 static void handleGetText(TsChannelBase* tsChannel) {
 	tsState.textCommandCounter++;
 
@@ -730,6 +770,20 @@ int TunerStudioBase::handleCrcCommand(TsChannelBase* tsChannel, char *data, int
 	case TS_OUTPUT_COMMAND:
 		cmdOutputChannels(tsChannel, offset, count);
 		break;
+	case TS_OUTPUT_STREAM_COMMAND:
+		handleOutputStreamCommand(tsChannel, data, incomingPacketSize - 1);
+		break;
+	case TS_OUTPUT_DELTA_COMMAND:
+		{
+			TsDeltaRequest request;
+			if (!tsParseDeltaRequest(data, incomingPacketSize - 1, request)) {
+				scheduleMsg(&tsLogger, "TS: bad delta request size=%d", incomingPacketSize - 1);
+				sendErrorCode(tsChannel, TS_RESPONSE_UNDERRUN);
+				break;
+			}
+			cmdOutputChannelsDelta(tsChannel, request.offset, request.count, request.acknowledged);
+		}
+		break;
 	case TS_HELLO_COMMAND:
 		tunerStudioDebug("got Query command");
 		handleQueryCommand(tsChannel, TS_CRC);
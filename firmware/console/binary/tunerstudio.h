@@ -48,6 +48,7 @@ void tunerStudioDebug(const char *msg);
 void tunerStudioError(const char *msg);
 
 void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX);
+void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels, uint16_t offset, uint16_t count DECLARE_ENGINE_PARAMETER_SUFFIX);
 void printTsStats(void);
 void requestBurn(void);
 
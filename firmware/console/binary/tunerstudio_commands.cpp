@@ -5,6 +5,7 @@
 #include "tunerstudio_io.h"
 
 #include "status_loop.h"
+#include "ts_delta_encoder.h"
 
 #if EFI_TUNER_STUDIO
 
@@ -21,9 +22,27 @@ void TunerStudio::cmdOutputChannels(TsChannelBase* tsChannel, uint16_t offset, u
 	}
 
 	tsState.outputChannelsCommandCounter++;
-	prepareTunerStudioOutputs();
+	prepareTunerStudioOutputs(offset, count);
 	// this method is invoked too often to print any debug information
 	tsChannel->sendResponse(TS_CRC, reinterpret_cast<const uint8_t*>(&tsOutputChannels) + offset, count);
 }
 
+/**
+ * @brief 'Output' command which sends just the words changed since the snapshot the client acknowledged
+ */
+void TunerStudio::cmdOutputChannelsDelta(TsChannelBase* tsChannel, uint16_t offset, uint16_t count, uint8_t acknowledged) {
+	if (offset + count > sizeof(TunerStudioOutputChannels)) {
+		scheduleMsg(tsLogger, "TS: Version Mismatch? Too much outputs requested %d/%d/%d", offset, count,
+				sizeof(TunerStudioOutputChannels));
+		sendErrorCode(tsChannel, TS_RESPONSE_OUT_OF_RANGE);
+		return;
+	}
+
+	tsState.outputChannelsCommandCounter++;
+	prepareTunerStudioOutputs(offset, count);
+	size_t size = tsChannel->deltaEncoder.encode(reinterpret_cast<const uint8_t*>(&tsOutputChannels) + offset, offset, count,
+			acknowledged, tsChannel->deltaResponse);
+	tsChannel->sendResponse(TS_CRC, tsChannel->deltaResponse, size);
+}
+
 #endif // EFI_TUNER_STUDIO
@@ -10,6 +10,7 @@ public:
 
 protected:
 	virtual void cmdOutputChannels(TsChannelBase* tsChannel, uint16_t offset, uint16_t count) = 0;
+	virtual void cmdOutputChannelsDelta(TsChannelBase* tsChannel, uint16_t offset, uint16_t count, uint8_t acknowledged) = 0;
 };
 
 class TunerStudio : public TunerStudioBase {
@@ -20,6 +21,7 @@ public:
 	}
 
 	void cmdOutputChannels(TsChannelBase* tsChannel, uint16_t offset, uint16_t count) override;
+	void cmdOutputChannelsDelta(TsChannelBase* tsChannel, uint16_t offset, uint16_t count, uint8_t acknowledged) override;
 
 private:
 	void sendErrorCode(TsChannelBase* tsChannel, uint8_t code);
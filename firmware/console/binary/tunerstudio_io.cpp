@@ -33,10 +33,6 @@ static_assert(SERIAL_USB_BUFFERS_SIZE >= BLOCKING_FACTOR + 10);
 extern SERIAL_USB_DRIVER TS_USB_DEVICE;
 #endif /* TS_USB_DEVICE */
 
-#ifdef TS_CAN_DEVICE
-#include "serial_can.h"
-#endif /* TS_CAN_DEVICE */
-
 
 #if TS_UART_DMA_MODE
 #elif TS_UART_MODE
@@ -117,9 +113,7 @@ void startTsPort(ts_channel_s *tsChannel) {
 				efiSetPadMode("ts can tx", GPIOG_14/*CONFIG(canTxPin)*/, PAL_MODE_ALTERNATE(TS_CAN_AF)); // CAN2_TX2_0
 
 				canStart(&TS_CAN_DEVICE, &tsCanConfig);
-				canInit(&TS_CAN_DEVICE);
-
-				//tsChannel->channel = (BaseChannel *) &TS_CAN_DEVICE;
+				// the TS thread talks to getTsCanChannel() from here on
 			}
 		#endif /* TS_CAN_DEVICE */
 	#elif EFI_SIMULATOR /* EFI_PROD_CODE */
@@ -183,8 +177,6 @@ void ts_channel_s::write(const uint8_t* buffer, size_t size) {
 		uartSendTimeout(uartp, &size, buffer, BINARY_IO_TIMEOUT);
 		return;
 	}
-#elif defined(TS_CAN_DEVICE)
-	canAddToTxStreamTimeout(&TS_CAN_DEVICE, &size, buffer, BINARY_IO_TIMEOUT);
 #endif
 	if (!channel) {
 		return;
@@ -225,9 +217,6 @@ size_t ts_channel_s::readTimeout(uint8_t* buffer, size_t size, int timeout) {
 #elif TS_UART_MODE
 	uartReceiveTimeout(TS_UART_DEVICE, &size, buffer, timeout);
 	return size;
-#elif defined(TS_CAN_DEVICE)
-	canStreamReceiveTimeout(&TS_CAN_DEVICE, &size, buffer, timeout);
-	return size;
 #else /* TS_UART_DMA_MODE */
 	if (channel == nullptr)
 		return 0;
@@ -349,7 +338,35 @@ bool ts_channel_s::isReady() {
 }
 
 void ts_channel_s::flush() {
-#if defined(TS_CAN_DEVICE)
-	canFlushTxStream(&TS_CAN_DEVICE);
-#endif /* TS_CAN_DEVICE */
 }
+
+#if EFI_PROD_CODE
+bool ts_channel_s::wouldWriteBlock() {
+#if (PRIMARY_UART_DMA_MODE || TS_UART_DMA_MODE || TS_UART_MODE)
+	if (uartp) {
+		// uartSendTimeout() returns once the transfer is done, nothing is left queued
+		return false;
+	}
+#endif
+	if (!channel) {
+		return false;
+	}
+
+	bool pending = false;
+	chSysLock();
+#if EFI_USB_SERIAL
+	if (isUsbSerial(channel)) {
+		pending = obqGetFullBuffersI(&((SerialUSBDriver *)channel)->obqueue) != 0;
+	} else
+#endif /* EFI_USB_SERIAL */
+	{
+#if HAL_USE_SERIAL
+		// BaseChannel over USART is a SerialDriver
+		pending = !oqIsEmptyI(&((SerialDriver *)channel)->oqueue);
+#endif /* HAL_USE_SERIAL */
+	}
+	chSysUnlock();
+
+	return pending;
+}
+#endif /* EFI_PROD_CODE */
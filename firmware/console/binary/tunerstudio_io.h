@@ -17,6 +17,8 @@
 #include "pin_repository.h"
 #endif
 
+#include "ts_delta_encoder.h"
+
 typedef enum {
 	TS_PLAIN = 0,
 	TS_CRC = 1
@@ -29,6 +31,13 @@ public:
 	virtual size_t readTimeout(uint8_t* buffer, size_t size, int timeout) = 0;
 	virtual void flush() = 0;
 	virtual bool isReady() = 0;
+	/**
+	 * @return true while bytes from earlier writes are still waiting for the wire, so that
+	 * a new write would have to wait for them
+	 */
+	virtual bool wouldWriteBlock() {
+		return false;
+	}
 
 	// Base functions that use the above virtual implementation
 	size_t read(uint8_t* buffer, size_t size);
@@ -41,6 +50,12 @@ public:
 	 */
 	char scratchBuffer[BLOCKING_FACTOR + 30];
 
+	/**
+	 * TS_OUTPUT_DELTA_COMMAND state, each client acknowledges its own snapshots
+	 */
+	TsDeltaEncoder deltaEncoder;
+	uint8_t deltaResponse[TS_DELTA_HEADER_SIZE + sizeof(TunerStudioOutputChannels)];
+
 	bool wasReady = false;
 
 private:
@@ -53,6 +68,9 @@ struct ts_channel_s : public TsChannelBase {
 	size_t readTimeout(uint8_t* buffer, size_t size, int timeout) override;
 	void flush() override;
 	bool isReady() override;
+#if EFI_PROD_CODE
+	bool wouldWriteBlock() override;
+#endif
 
 #if !EFI_UNIT_TEST
 	BaseChannel * channel = nullptr;
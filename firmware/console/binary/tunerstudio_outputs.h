@@ -270,7 +270,16 @@ typedef struct {
 	scaled_angle secondVvtPositionBank1; // 290
 	scaled_angle vvtPositionBank2; // 292
 	scaled_angle secondVvtPositionBank2; // 294
-	uint8_t unusedAtTheEnd[42]; // we have some unused bytes to allow compatible TS changes
+
+	// share of combustion events cut by limiters during the last engine cycle
+	uint8_t fuelCutRatio; // 296
+	uint8_t sparkCutRatio; // 297
+	scaled_pressure predictedMap; // 298
+	scaled_channel<int16_t, PACK_MULT_PRESSURE> mapPredictionError; // 300
+	// largest knock retard across cylinders
+	scaled_channel<uint8_t, 10> knockRetard; // 302
+
+	uint8_t unusedAtTheEnd[35]; // we have some unused bytes to allow compatible TS changes
 
 	// Temporary - will remove soon
 	TsDebugChannels* getDebugChannels() {
@@ -10,66 +10,192 @@
 #include "efitime.h"
 #include "crc.h"
 #include "buffered_writer.h"
+#include "log_delta_encoder.h"
 
 #define TIME_PRECISION 1000
 
 // floating number of seconds with millisecond precision
 static scaled_channel<uint32_t, TIME_PRECISION> packedTime;
 
-// todo: we are at the edge of sdLogBuffer size and at the moment we have no code to make sure buffer does not overflow
-// todo: make this logic smarter
-static const LogField fields[] = {
-	{tsOutputChannels.rpm, GAUGE_NAME_RPM, "rpm", 0},
-	{packedTime, GAUGE_NAME_TIME, "sec", 0},
-	{tsOutputChannels.totalTriggerErrorCounter, GAUGE_NAME_TRG_ERR, "err", 0},
-	{tsOutputChannels.vehicleSpeedKph, GAUGE_NAME_VVS, "kph", 0},
-	{tsOutputChannels.internalMcuTemperature, GAUGE_NAME_CPU_TEMP, "C", 0},
-	{tsOutputChannels.coolantTemperature, GAUGE_NAME_CLT, "C", 1},
-	{tsOutputChannels.intakeAirTemperature, GAUGE_NAME_IAT, "C", 1},
-	{tsOutputChannels.throttlePosition, GAUGE_NAME_TPS, "%", 2},
-	{tsOutputChannels.throttle2Position, GAUGE_NAME_TPS2, "%", 2},
-	{tsOutputChannels.pedalPosition, GAUGE_NAME_THROTTLE_PEDAL, "%", 2},
-	{tsOutputChannels.manifoldAirPressure, GAUGE_NAME_MAP, "kPa", 1},
-	{tsOutputChannels.airFuelRatio, GAUGE_NAME_AFR, "afr", 2},
-	{tsOutputChannels.airFuelRatio2, GAUGE_NAME_AFR2, "afr", 2},
-	{tsOutputChannels.lambda, GAUGE_NAME_LAMBDA, "", 3},
-	{tsOutputChannels.lambda2, GAUGE_NAME_LAMBDA2, "", 3},
-	{tsOutputChannels.vBatt, GAUGE_NAME_VBAT, "v", 2},
-	{tsOutputChannels.oilPressure, GAUGE_NAME_OIL_PRESSURE, GAUGE_NAME_FUEL_PRESSURE_HIGH_UNITS, 0},
-	{tsOutputChannels.lowFuelPressure, GAUGE_NAME_FUEL_PRESSURE_LOW, GAUGE_NAME_FUEL_PRESSURE_LOW_UNITS, 0},
-	{tsOutputChannels.highFuelPressure, GAUGE_NAME_FUEL_PRESSURE_HIGH, GAUGE_NAME_FUEL_PRESSURE_HIGH_UNITS, 0},
-	{tsOutputChannels.vvtPosition, GAUGE_NAME_VVT, "deg", 1},
-	{tsOutputChannels.chargeAirMass, GAUGE_NAME_AIR_MASS, "g", 3},
-	{tsOutputChannels.currentTargetAfr, GAUGE_NAME_TARGET_AFR, "afr", 2},
-	{tsOutputChannels.targetLambda, GAUGE_NAME_TARGET_LAMBDA, "", 3},
-	{tsOutputChannels.fuelBase, GAUGE_NAME_FUEL_BASE, "ms", 3},
-	{tsOutputChannels.fuelRunning, GAUGE_NAME_FUEL_RUNNING, "ms", 3},
-	{tsOutputChannels.actualLastInjection, GAUGE_NAME_FUEL_LAST_INJECTION, "ms", 3},
-	{tsOutputChannels.injectorDutyCycle, GAUGE_NAME_FUEL_INJ_DUTY, "%", 0},
-	{tsOutputChannels.veValue, GAUGE_NAME_FUEL_VE, "%", 1},
-	{tsOutputChannels.tCharge, "tCharge", "C", 1},
-	{tsOutputChannels.injectorLagMs, GAUGE_NAME_INJECTOR_LAG, "ms", 3},
-	{tsOutputChannels.shortTermFuelTrim, GAUGE_NAME_FUEL_PID_CORR, "%", 3},
-	{tsOutputChannels.wallFuelCorrection, GAUGE_NAME_FUEL_WALL_CORRECTION, "ms", 3},
-	{tsOutputChannels.tpsAccelFuel, GAUGE_NAME_FUEL_TPS_EXTRA, "ms", 3},
-	{tsOutputChannels.ignitionAdvance, GAUGE_NAME_TIMING_ADVANCE, "deg", 1},
-	{tsOutputChannels.sparkDwell, GAUGE_COIL_DWELL_TIME, "ms", 1},
-	{tsOutputChannels.coilDutyCycle, GAUGE_NAME_DWELL_DUTY, "%", 0},
-	{tsOutputChannels.idlePosition, GAUGE_NAME_IAC, "%", 1},
-	{tsOutputChannels.etbTarget, "ETB Target", "%", 2},
-	{tsOutputChannels.etb1DutyCycle, "ETB Duty", "%", 1},
-	{tsOutputChannels.etb1Error, "ETB Error", "%", 3},
-	{tsOutputChannels.fuelTankLevel, "fuel level", "%", 0},
-	{tsOutputChannels.fuelingLoad, GAUGE_NAME_FUEL_LOAD, "%", 1},
-	{tsOutputChannels.ignitionLoad, GAUGE_NAME_IGNITION_LOAD, "%", 1},
-	{tsOutputChannels.massAirFlow, GAUGE_NAME_AIR_FLOW, "kg/h", 1},
-	{tsOutputChannels.flexPercent, GAUGE_NAME_FLEX, "%", 1},
+static scaled_channel<uint16_t> sdDroppedRecords;
+static scaled_channel<uint16_t> sdMaxWriteMs;
+
+static const LogField timeField(packedTime, GAUGE_NAME_TIME, "sec", 0);
+
+struct GroupedLogField {
+	LogGroup group;
+	LogField field;
 };
 
-void writeHeader(Writer& outBuffer) {
+/**
+ * Everything which can go into the log, by group. Time is always logged.
+ */
+static const GroupedLogField fields[] = {
+	{LogGroup::Engine, {tsOutputChannels.rpm, GAUGE_NAME_RPM, "rpm", 0}},
+	{LogGroup::Engine, {tsOutputChannels.manifoldAirPressure, GAUGE_NAME_MAP, "kPa", 1}},
+	{LogGroup::Engine, {tsOutputChannels.throttlePosition, GAUGE_NAME_TPS, "%", 2}},
+	{LogGroup::Engine, {tsOutputChannels.airFuelRatio, GAUGE_NAME_AFR, "afr", 2}},
+	{LogGroup::Engine, {tsOutputChannels.airFuelRatio2, GAUGE_NAME_AFR2, "afr", 2}},
+	{LogGroup::Engine, {tsOutputChannels.lambda, GAUGE_NAME_LAMBDA, "", 3}},
+	{LogGroup::Engine, {tsOutputChannels.lambda2, GAUGE_NAME_LAMBDA2, "", 3}},
+	{LogGroup::Engine, {tsOutputChannels.ignitionAdvance, GAUGE_NAME_TIMING_ADVANCE, "deg", 1}},
+	{LogGroup::Engine, {tsOutputChannels.knockRetard, "Knock retard", "deg", 1}},
+	{LogGroup::Engine, {tsOutputChannels.vvtPosition, GAUGE_NAME_VVT, "deg", 1}},
+	{LogGroup::Fuel, {tsOutputChannels.currentTargetAfr, GAUGE_NAME_TARGET_AFR, "afr", 2}},
+	{LogGroup::Fuel, {tsOutputChannels.targetLambda, GAUGE_NAME_TARGET_LAMBDA, "", 3}},
+	{LogGroup::Fuel, {tsOutputChannels.fuelBase, GAUGE_NAME_FUEL_BASE, "ms", 3}},
+	{LogGroup::Fuel, {tsOutputChannels.fuelRunning, GAUGE_NAME_FUEL_RUNNING, "ms", 3}},
+	{LogGroup::Fuel, {tsOutputChannels.actualLastInjection, GAUGE_NAME_FUEL_LAST_INJECTION, "ms", 3}},
+	{LogGroup::Fuel, {tsOutputChannels.injectorDutyCycle, GAUGE_NAME_FUEL_INJ_DUTY, "%", 0}},
+	{LogGroup::Fuel, {tsOutputChannels.veValue, GAUGE_NAME_FUEL_VE, "%", 1}},
+	{LogGroup::Fuel, {tsOutputChannels.tCharge, "tCharge", "C", 1}},
+	{LogGroup::Fuel, {tsOutputChannels.injectorLagMs, GAUGE_NAME_INJECTOR_LAG, "ms", 3}},
+	{LogGroup::Fuel, {tsOutputChannels.shortTermFuelTrim, GAUGE_NAME_FUEL_PID_CORR, "%", 3}},
+	{LogGroup::Fuel, {tsOutputChannels.wallFuelCorrection, GAUGE_NAME_FUEL_WALL_CORRECTION, "ms", 3}},
+	{LogGroup::Fuel, {tsOutputChannels.tpsAccelFuel, GAUGE_NAME_FUEL_TPS_EXTRA, "ms", 3}},
+	{LogGroup::Fuel, {tsOutputChannels.fuelingLoad, GAUGE_NAME_FUEL_LOAD, "%", 1}},
+	{LogGroup::Fuel, {tsOutputChannels.chargeAirMass, GAUGE_NAME_AIR_MASS, "g", 3}},
+	{LogGroup::Fuel, {tsOutputChannels.massAirFlow, GAUGE_NAME_AIR_FLOW, "kg/h", 1}},
+	{LogGroup::Fuel, {tsOutputChannels.flexPercent, GAUGE_NAME_FLEX, "%", 1}},
+	{LogGroup::Ignition, {tsOutputChannels.sparkDwell, GAUGE_COIL_DWELL_TIME, "ms", 1}},
+	{LogGroup::Ignition, {tsOutputChannels.coilDutyCycle, GAUGE_NAME_DWELL_DUTY, "%", 0}},
+	{LogGroup::Ignition, {tsOutputChannels.ignitionLoad, GAUGE_NAME_IGNITION_LOAD, "%", 1}},
+	{LogGroup::Throttle, {tsOutputChannels.throttle2Position, GAUGE_NAME_TPS2, "%", 2}},
+	{LogGroup::Throttle, {tsOutputChannels.pedalPosition, GAUGE_NAME_THROTTLE_PEDAL, "%", 2}},
+	{LogGroup::Throttle, {tsOutputChannels.idlePosition, GAUGE_NAME_IAC, "%", 1}},
+	{LogGroup::Throttle, {tsOutputChannels.etbTarget, "ETB Target", "%", 2}},
+	{LogGroup::Throttle, {tsOutputChannels.etb1DutyCycle, "ETB Duty", "%", 1}},
+	{LogGroup::Throttle, {tsOutputChannels.etb1Error, "ETB Error", "%", 3}},
+	{LogGroup::Sensors, {tsOutputChannels.coolantTemperature, GAUGE_NAME_CLT, "C", 1}},
+	{LogGroup::Sensors, {tsOutputChannels.intakeAirTemperature, GAUGE_NAME_IAT, "C", 1}},
+	{LogGroup::Sensors, {tsOutputChannels.vBatt, GAUGE_NAME_VBAT, "v", 2}},
+	{LogGroup::Sensors, {tsOutputChannels.oilPressure, GAUGE_NAME_OIL_PRESSURE, GAUGE_NAME_FUEL_PRESSURE_HIGH_UNITS, 0}},
+	{LogGroup::Sensors, {tsOutputChannels.lowFuelPressure, GAUGE_NAME_FUEL_PRESSURE_LOW, GAUGE_NAME_FUEL_PRESSURE_LOW_UNITS, 0}},
+	{LogGroup::Sensors, {tsOutputChannels.highFuelPressure, GAUGE_NAME_FUEL_PRESSURE_HIGH, GAUGE_NAME_FUEL_PRESSURE_HIGH_UNITS, 0}},
+	{LogGroup::Sensors, {tsOutputChannels.fuelTankLevel, "fuel level", "%", 0}},
+	{LogGroup::Sensors, {tsOutputChannels.vehicleSpeedKph, GAUGE_NAME_VVS, "kph", 0}},
+	{LogGroup::Sensors, {tsOutputChannels.internalMcuTemperature, GAUGE_NAME_CPU_TEMP, "C", 0}},
+	{LogGroup::Status, {tsOutputChannels.totalTriggerErrorCounter, GAUGE_NAME_TRG_ERR, "err", 0}},
+	{LogGroup::Status, {sdDroppedRecords, "SD dropped", "", 0}},
+	{LogGroup::Status, {sdMaxWriteMs, "SD write max", "ms", 0}},
+};
+
+// the time field and everything else which is selected, in file order
+static const LogField* selectedFields[1 + efi::size(fields)];
+static size_t selectedCount = 0;
+
+static_assert(efi::size(selectedFields) <= LOG_DELTA_MAX_FIELDS, "compressed log can not take all the fields");
+
+static uint8_t groupDividers[LOG_GROUP_COUNT];
+
+struct LogRange {
+	uint16_t offset;
+	uint16_t size;
+};
+
+/**
+ * Parts of tsOutputChannels which have to be refreshed, group after group. Within a group in
+ * offset order, fields next to each other share one range.
+ */
+static LogRange refreshRanges[efi::size(fields)];
+// ranges of group g are groupRanges[g]..groupRanges[g + 1]
+static uint8_t groupRanges[LOG_GROUP_COUNT + 1];
+
+static_assert(static_cast<size_t>(LogGroup::Status) + 1 == LOG_GROUP_COUNT, "log groups");
+static_assert(efi::size(fields) <= UINT8_MAX, "log range index");
+
+static uint32_t recordIndex = 0;
+
+void selectLogFields(const uint8_t (&dividers)[LOG_GROUP_COUNT]) {
+	bool isAnySelected = false;
+	for (size_t g = 0; g < LOG_GROUP_COUNT; g++) {
+		isAnySelected |= dividers[g] != 0;
+	}
+
+	for (size_t g = 0; g < LOG_GROUP_COUNT; g++) {
+		// nothing selected means everything, every record: what the log was before groups
+		groupDividers[g] = isAnySelected ? dividers[g] : 1;
+	}
+
+	selectedCount = 0;
+	selectedFields[selectedCount++] = &timeField;
+
+	const char* outputs = reinterpret_cast<const char*>(&tsOutputChannels);
+	for (size_t i = 0; i < efi::size(fields); i++) {
+		size_t g = static_cast<size_t>(fields[i].group);
+		if (groupDividers[g] == 0) {
+			continue;
+		}
+
+		selectedFields[selectedCount++] = &fields[i].field;
+	}
+
+	size_t rangeCount = 0;
+	for (size_t g = 0; g < LOG_GROUP_COUNT; g++) {
+		size_t first = rangeCount;
+		groupRanges[g] = first;
+		if (groupDividers[g] == 0) {
+			continue;
+		}
+
+		for (size_t i = 0; i < efi::size(fields); i++) {
+			const LogField& field = fields[i].field;
+			ptrdiff_t offset = field.getAddress() - outputs;
+			// SD logger health lives outside of the output channels
+			if (static_cast<size_t>(fields[i].group) != g
+					|| offset < 0 || offset + field.getSize() > sizeof(TunerStudioOutputChannels)) {
+				continue;
+			}
+
+			size_t at = rangeCount++;
+			while (at > first && refreshRanges[at - 1].offset > offset) {
+				refreshRanges[at] = refreshRanges[at - 1];
+				at--;
+			}
+			refreshRanges[at] = { (uint16_t)offset, (uint16_t)field.getSize() };
+		}
+
+		if (rangeCount == first) {
+			continue;
+		}
+
+		// a range which reaches the next one takes it over
+		size_t last = first;
+		for (size_t r = first + 1; r < rangeCount; r++) {
+			LogRange& range = refreshRanges[last];
+			if (refreshRanges[r].offset <= range.offset + range.size) {
+				range.size = maxI(range.size, refreshRanges[r].offset + refreshRanges[r].size - range.offset);
+			} else {
+				refreshRanges[++last] = refreshRanges[r];
+			}
+		}
+		rangeCount = last + 1;
+	}
+	groupRanges[LOG_GROUP_COUNT] = rangeCount;
+
+	recordIndex = 0;
+}
+
+static void selectAllIfNothingSelected() {
+	if (selectedCount == 0) {
+		static const uint8_t everything[LOG_GROUP_COUNT] = {};
+		selectLogFields(everything);
+	}
+}
+
+void setSdLogCounters(uint32_t droppedRecords, uint32_t maxWriteMs) {
+	sdDroppedRecords = minI(droppedRecords, UINT16_MAX);
+	sdMaxWriteMs = minI(maxWriteMs, UINT16_MAX);
+}
+
+static LogDeltaEncoder encoder;
+
+void writeHeader(Writer& outBuffer, bool isCompressed) {
+	selectAllIfNothingSelected();
+
 	char buffer[MLQ_HEADER_SIZE];
-	// File format: MLVLG\0
-	strncpy(buffer, "MLVLG", 6);
+	// File format: MLVLG\0, MLVLZ\0 for delta blocks
+	strncpy(buffer, isCompressed ? "MLVLZ" : "MLVLG", 6);
 
 	// Format version = 01
 	buffer[6] = 0;
@@ -85,7 +211,7 @@ void writeHeader(Writer& outBuffer) {
 	buffer[12] = 0;
 	buffer[13] = 0;
 
-	size_t headerSize = MLQ_HEADER_SIZE + efi::size(fields) * 55;
+	size_t headerSize = MLQ_HEADER_SIZE + selectedCount * 55;
 
 	// Data begin index: begins immediately after the header
 	buffer[14] = 0;
@@ -95,8 +221,8 @@ void writeHeader(Writer& outBuffer) {
 
 	// Record length - length of a single data record: sum size of all fields
 	uint16_t recLength = 0;
-	for (size_t i = 0; i < efi::size(fields); i++) {
-		recLength += fields[i].getSize();
+	for (size_t i = 0; i < selectedCount; i++) {
+		recLength += selectedFields[i]->getSize();
 	}
 
 	buffer[18] = recLength >> 8;
@@ -104,19 +230,40 @@ void writeHeader(Writer& outBuffer) {
 
 	// Number of logger fields
 	buffer[20] = 0;
-	buffer[21] = efi::size(fields);
+	buffer[21] = selectedCount;
 
 	outBuffer.write(buffer, MLQ_HEADER_SIZE);
 
 	// Write the actual logger fields, offset 22
-	for (size_t i = 0; i < efi::size(fields); i++) {
-		fields[i].writeHeader(outBuffer);
+	for (size_t i = 0; i < selectedCount; i++) {
+		selectedFields[i]->writeHeader(outBuffer);
 	}
+
+	uint8_t sizes[efi::size(selectedFields)];
+	for (size_t i = 0; i < selectedCount; i++) {
+		sizes[i] = selectedFields[i]->getSize();
+	}
+	encoder.setFields(sizes, selectedCount);
 }
 
 static uint8_t blockRollCounter = 0;
 
-size_t writeBlock(char* buffer) {
+size_t writeBlock(char* buffer, LogRefresh refresh) {
+	selectAllIfNothingSelected();
+
+	if (refresh) {
+		// slow groups are only refreshed every so often, in between the record holds the last value
+		for (size_t g = 0; g < LOG_GROUP_COUNT; g++) {
+			if (groupDividers[g] == 0 || recordIndex % groupDividers[g] != 0) {
+				continue;
+			}
+			for (size_t r = groupRanges[g]; r < groupRanges[g + 1]; r++) {
+				refresh(refreshRanges[r].offset, refreshRanges[r].size);
+			}
+		}
+	}
+	recordIndex++;
+
 	// Offset 0 = Block type, standard data block in this case
 	buffer[0] = 0;
 
@@ -133,8 +280,8 @@ size_t writeBlock(char* buffer) {
 	// Offset 4 = field data
 	const char* dataBlockStart = buffer + 4;
 	char* dataBlock = buffer + 4;
-	for (size_t i = 0; i < efi::size(fields); i++) {
-		size_t entrySize = fields[i].writeData(dataBlock);
+	for (size_t i = 0; i < selectedCount; i++) {
+		size_t entrySize = selectedFields[i]->writeData(dataBlock);
 
 		// Increment pointer to next entry
 		dataBlock += entrySize;
@@ -152,3 +299,14 @@ size_t writeBlock(char* buffer) {
 	// Total size has 4 byte header + 1 byte checksum
 	return dataBlockSize + 5;
 }
+
+size_t writeCompressedBlock(char* buffer, LogRefresh refresh) {
+	// block header, fields of at most four bytes, checksum
+	char record[4 + 4 * efi::size(selectedFields) + 1];
+	size_t size = writeBlock(record, refresh);
+	return encoder.encode(record, size, buffer);
+}
+
+void requestLogKeyframe() {
+	encoder.requestKeyframe();
+}
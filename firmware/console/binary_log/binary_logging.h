@@ -1,5 +1,50 @@
 #include <cstddef>
+#include <cstdint>
 
 struct Writer;
-void writeHeader(Writer& buffer);
-size_t writeBlock(char* buffer);
+
+/**
+ * SD log fields come in groups, each group is logged at its own rate.
+ */
+enum class LogGroup : uint8_t {
+	Engine,
+	Fuel,
+	Ignition,
+	Throttle,
+	Sensors,
+	Status,
+};
+
+#define LOG_GROUP_COUNT 6
+
+/**
+ * Picks what goes into the next log file, takes effect with the next writeHeader.
+ * @param dividers per group: refreshed every this many records, 0 to leave the group out.
+ * All zeros logs everything in every record.
+ */
+void selectLogFields(const uint8_t (&dividers)[LOG_GROUP_COUNT]);
+
+typedef void (*LogRefresh)(uint16_t offset, uint16_t count);
+
+/**
+ * @param isCompressed data blocks are going to come from writeCompressedBlock
+ */
+void writeHeader(Writer& buffer, bool isCompressed = false);
+/**
+ * @param refresh called for the part of the output channels which is due in this record
+ */
+size_t writeBlock(char* buffer, LogRefresh refresh = nullptr);
+/**
+ * Same record as a delta against the previous one, see log_delta_encoder.h
+ * @return never more than writeBlock would have written
+ */
+size_t writeCompressedBlock(char* buffer, LogRefresh refresh = nullptr);
+// the previous record did not make it into the file
+void requestLogKeyframe();
+
+/**
+ * SD logger health, goes into the following records
+ * @param droppedRecords records the card could not keep up with so far
+ * @param maxWriteMs slowest card write since the previous record
+ */
+void setSdLogCounters(uint32_t droppedRecords, uint32_t maxWriteMs);
@@ -0,0 +1,215 @@
+/**
+ * @file	log_delta_encoder.cpp
+ *
+ * @date Oct 18, 2026
+ */
+
+#include "log_delta_encoder.h"
+
+#include <cstring>
+
+// block type, rolling counter, two bytes of timestamp
+#define BLOCK_HEADER_SIZE 4
+
+// fields are big endian in MLG
+static uint32_t readField(const char* at, size_t size) {
+	uint32_t value = 0;
+	for (size_t i = 0; i < size; i++) {
+		value = value << 8 | static_cast<uint8_t>(at[i]);
+	}
+	return value;
+}
+
+static void writeField(char* at, uint32_t value, size_t size) {
+	for (size_t i = size; i > 0; i--) {
+		at[i - 1] = value & 0xFF;
+		value >>= 8;
+	}
+}
+
+static uint32_t fieldMask(size_t size) {
+	return size >= 4 ? 0xFFFFFFFF : (1u << (8 * size)) - 1;
+}
+
+// difference in the width of the field, so that a small step across zero or a wrap stays small
+static int32_t signExtend(uint32_t value, size_t size) {
+	int shift = 32 - 8 * size;
+	return static_cast<int32_t>(value << shift) >> shift;
+}
+
+static uint8_t checksum(const char* data, size_t size) {
+	uint8_t sum = 0;
+	for (size_t i = 0; i < size; i++) {
+		sum += data[i];
+	}
+	return sum;
+}
+
+void LogDeltaEncoder::setFields(const uint8_t* sizes, size_t count) {
+	m_count = count;
+	memcpy(m_sizes, sizes, m_count);
+	m_recordsToKeyframe = 0;
+}
+
+size_t LogDeltaEncoder::encode(const char* record, size_t size, char* out) {
+	bool isKeyframe = m_recordsToKeyframe == 0;
+
+	// one bit per field after the block header, the varints of the fields which changed follow
+	size_t mapSize = (m_count + 7) / 8;
+	char* map = out + BLOCK_HEADER_SIZE;
+	size_t at = BLOCK_HEADER_SIZE + mapSize;
+	if (at + 1 >= size) {
+		isKeyframe = true;
+	} else {
+		memset(map, 0, mapSize);
+	}
+
+	const char* field = record + BLOCK_HEADER_SIZE;
+	for (size_t i = 0; i < m_count; i++) {
+		uint32_t value = readField(field, m_sizes[i]);
+		field += m_sizes[i];
+
+		int32_t delta = signExtend(value - m_previous[i], m_sizes[i]);
+		m_previous[i] = value;
+
+		if (isKeyframe || delta == 0) {
+			continue;
+		}
+		map[i / 8] |= 1 << (i % 8);
+
+		// zigzag: small steps either way take few bits
+		uint32_t zigzag = static_cast<uint32_t>(delta) << 1 ^ static_cast<uint32_t>(delta >> 31);
+		do {
+			// room for this byte and the checksum, and still shorter than the plain block
+			if (at + 2 >= size) {
+				isKeyframe = true;
+				break;
+			}
+
+			uint8_t byte = zigzag & 0x7F;
+			zigzag >>= 7;
+			if (zigzag != 0) {
+				byte |= 0x80;
+			}
+			out[at++] = byte;
+		} while (zigzag != 0);
+	}
+
+	if (isKeyframe) {
+		memcpy(out, record, size);
+		m_recordsToKeyframe = LOG_DELTA_KEYFRAME_INTERVAL - 1;
+		m_keyframeCount++;
+		return size;
+	}
+
+	out[0] = MLG_BLOCK_DELTA;
+	out[1] = record[1];
+	out[2] = record[2];
+	out[3] = record[3];
+	out[at] = checksum(out + BLOCK_HEADER_SIZE, at - BLOCK_HEADER_SIZE);
+	at++;
+
+	m_recordsToKeyframe--;
+	return at;
+}
+
+void LogDeltaDecoder::setFields(const uint8_t* sizes, size_t count) {
+	m_count = count < LOG_DELTA_MAX_FIELDS ? count : LOG_DELTA_MAX_FIELDS;
+	memcpy(m_sizes, sizes, m_count);
+
+	m_recordSize = BLOCK_HEADER_SIZE + 1;
+	for (size_t i = 0; i < m_count; i++) {
+		m_recordSize += m_sizes[i];
+	}
+	m_hasPrevious = false;
+}
+
+size_t LogDeltaDecoder::decode(const char* in, size_t available, char* record, bool& isRecord) {
+	isRecord = false;
+	if (available < BLOCK_HEADER_SIZE) {
+		return 0;
+	}
+
+	uint8_t counter = in[1];
+
+	if (in[0] == MLG_BLOCK_DATA) {
+		if (available < m_recordSize
+				|| static_cast<uint8_t>(in[m_recordSize - 1]) != checksum(in + BLOCK_HEADER_SIZE, m_recordSize - BLOCK_HEADER_SIZE - 1)) {
+			return 0;
+		}
+
+		const char* field = in + BLOCK_HEADER_SIZE;
+		for (size_t i = 0; i < m_count; i++) {
+			m_previous[i] = readField(field, m_sizes[i]);
+			field += m_sizes[i];
+		}
+
+		memcpy(record, in, m_recordSize);
+		m_hasPrevious = true;
+		m_counter = counter;
+		isRecord = true;
+		return m_recordSize;
+	}
+
+	if (in[0] != MLG_BLOCK_DELTA) {
+		return 0;
+	}
+
+	size_t mapSize = (m_count + 7) / 8;
+	const char* map = in + BLOCK_HEADER_SIZE;
+	size_t at = BLOCK_HEADER_SIZE + mapSize;
+	if (at > available) {
+		return 0;
+	}
+
+	uint32_t values[LOG_DELTA_MAX_FIELDS];
+	for (size_t i = 0; i < m_count; i++) {
+		if ((map[i / 8] & (1 << (i % 8))) == 0) {
+			values[i] = m_previous[i];
+			continue;
+		}
+
+		uint32_t zigzag = 0;
+		for (int shift = 0;; shift += 7) {
+			if (at >= available || shift > 28) {
+				return 0;
+			}
+			uint8_t byte = in[at++];
+			zigzag |= static_cast<uint32_t>(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0) {
+				break;
+			}
+		}
+
+		uint32_t delta = zigzag >> 1 ^ -(zigzag & 1);
+		values[i] = (m_previous[i] + delta) & fieldMask(m_sizes[i]);
+	}
+
+	if (at >= available || static_cast<uint8_t>(in[at]) != checksum(in + BLOCK_HEADER_SIZE, at - BLOCK_HEADER_SIZE)) {
+		return 0;
+	}
+	at++;
+
+	// a lost block in between, nothing to add this one to until the next keyframe
+	bool isInSequence = m_hasPrevious && counter == static_cast<uint8_t>(m_counter + 1);
+	m_counter = counter;
+	if (!isInSequence) {
+		m_hasPrevious = false;
+		return at;
+	}
+
+	record[0] = MLG_BLOCK_DATA;
+	record[1] = in[1];
+	record[2] = in[2];
+	record[3] = in[3];
+	char* field = record + BLOCK_HEADER_SIZE;
+	for (size_t i = 0; i < m_count; i++) {
+		writeField(field, values[i], m_sizes[i]);
+		field += m_sizes[i];
+		m_previous[i] = values[i];
+	}
+	*field = checksum(record + BLOCK_HEADER_SIZE, m_recordSize - BLOCK_HEADER_SIZE - 1);
+
+	isRecord = true;
+	return at;
+}
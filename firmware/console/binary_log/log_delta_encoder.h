@@ -0,0 +1,90 @@
+/**
+ * @file	log_delta_encoder.h
+ *
+ * Compressed MLG: most fields barely move from one record to the next, so instead of the full
+ * record each data block holds just how much every field changed.
+ *
+ * The file header is the usual MLG header with "MLVLZ" instead of "MLVLG". Data blocks are either
+ * - a keyframe: a plain MLG data block, block type 0
+ * - a delta block: block type 2, rolling counter and timestamp like a plain block, a bitmap with
+ *   one bit per field which changed, for each of those the difference to the previous record as
+ *   a zigzag varint, then the sum of the bitmap and varint bytes.
+ *
+ * Differences are taken on the raw field value in the width of the field, floats by their bit
+ * pattern, so decoding gives back exactly the plain record. A keyframe goes out every so many
+ * records, whenever a delta block would not be smaller, and after a record was lost, so a reader
+ * can start at any keyframe.
+ *
+ * @date Oct 18, 2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define MLG_BLOCK_DATA 0
+#define MLG_BLOCK_DELTA 2
+
+#define LOG_DELTA_MAX_FIELDS 64
+#define LOG_DELTA_KEYFRAME_INTERVAL 64
+
+class LogDeltaEncoder {
+public:
+	/**
+	 * @param sizes of the fields in a record, in bytes, in record order
+	 * @param count no more than LOG_DELTA_MAX_FIELDS, the caller checks at compile time
+	 */
+	void setFields(const uint8_t* sizes, size_t count);
+
+	// next record goes out in full
+	void requestKeyframe() {
+		m_recordsToKeyframe = 0;
+	}
+
+	/**
+	 * @param record plain MLG data block
+	 * @param out room for size bytes, the result is never longer than the plain block
+	 * @return bytes in out
+	 */
+	size_t encode(const char* record, size_t size, char* out);
+
+	uint32_t getKeyframeCount() const {
+		return m_keyframeCount;
+	}
+
+private:
+	uint8_t m_sizes[LOG_DELTA_MAX_FIELDS];
+	size_t m_count = 0;
+	uint32_t m_previous[LOG_DELTA_MAX_FIELDS];
+	uint32_t m_recordsToKeyframe = 0;
+	uint32_t m_keyframeCount = 0;
+};
+
+/**
+ * Turns compressed blocks back into plain MLG data blocks.
+ */
+class LogDeltaDecoder {
+public:
+	void setFields(const uint8_t* sizes, size_t count);
+
+	/**
+	 * @param record room for a plain data block, filled when isRecord comes back true. Delta blocks
+	 * after a lost record cannot be decoded until the next keyframe.
+	 * @return bytes of in the block took, 0 if it is cut short or corrupt
+	 */
+	size_t decode(const char* in, size_t available, char* record, bool& isRecord);
+
+	// size of a plain data block
+	size_t getRecordSize() const {
+		return m_recordSize;
+	}
+
+private:
+	uint8_t m_sizes[LOG_DELTA_MAX_FIELDS];
+	size_t m_count = 0;
+	size_t m_recordSize = 0;
+	uint32_t m_previous[LOG_DELTA_MAX_FIELDS];
+	bool m_hasPrevious = false;
+	uint8_t m_counter = 0;
+};
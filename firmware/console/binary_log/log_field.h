@@ -34,6 +34,10 @@ public:
 		return m_size;
 	}
 
+	const char* getAddress() const {
+		return m_addr;
+	}
+
 	// Write the header data describing this field.
 	void writeHeader(Writer& outBuffer) const;
 
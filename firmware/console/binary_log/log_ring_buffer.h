@@ -0,0 +1,105 @@
+/**
+ * @file	log_ring_buffer.h
+ *
+ * Between the thread sampling log records at a fixed rate and the thread writing them to the card.
+ *
+ * One producer, one consumer, no locks: each side only ever moves its own counter. Records go in
+ * whole or not at all, if the card falls too far behind the record is dropped and counted rather
+ * than the sampler waiting for it. The consumer takes whole blocks, so every write to the card is
+ * a multiple of the sector size.
+ *
+ * @date Oct 18, 2026
+ */
+
+#pragma once
+
+#include "buffered_writer.h"
+
+#include <atomic>
+#include <cstdint>
+
+template <size_t TSize, size_t TBlockSize = 512>
+class LogRingBuffer : public Writer {
+	static_assert(TSize % TBlockSize == 0, "ring has to be whole blocks");
+	// so that positions stay right when the counters wrap
+	static_assert((TSize & (TSize - 1)) == 0, "ring size has to be a power of two");
+
+public:
+	/**
+	 * Producer side.
+	 * @return false if the record did not fit and was dropped
+	 */
+	bool push(const char* record, size_t size) {
+		uint32_t head = m_head;
+		if (size > TSize - (head - m_tail)) {
+			m_droppedCount++;
+			return false;
+		}
+
+		size_t at = head % TSize;
+		size_t first = size < TSize - at ? size : TSize - at;
+		memcpy(m_buffer + at, record, first);
+		memcpy(m_buffer, record + first, size - first);
+
+		// the data has to be in place before the consumer sees the new head
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+		m_head = head + size;
+		return true;
+	}
+
+	size_t write(const char* buffer, size_t count) override {
+		return push(buffer, count) ? count : 0;
+	}
+
+	size_t flush() override {
+		// the consumer decides when to write
+		return 0;
+	}
+
+	/**
+	 * Consumer side: full blocks which can be written in one go, they do not wrap.
+	 */
+	size_t getReadableBlocks() const {
+		uint32_t tail = m_tail;
+		size_t full = (m_head - tail) / TBlockSize;
+		size_t untilEnd = (TSize - tail % TSize) / TBlockSize;
+		return full < untilEnd ? full : untilEnd;
+	}
+
+	const char* getReadPointer() const {
+		return m_buffer + m_tail % TSize;
+	}
+
+	void release(size_t blockCount) {
+		// done reading before the producer may overwrite
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+		m_tail = m_tail + blockCount * TBlockSize;
+	}
+
+	/**
+	 * Consumer side, once the full blocks are out: the block still being filled. It starts at
+	 * getReadPointer() and does not wrap, it stays in the ring until the block is full.
+	 */
+	size_t getPartialSize() const {
+		size_t used = m_head - m_tail;
+		return used < TBlockSize ? used : 0;
+	}
+
+	// bytes waiting for the card, including the partial block
+	size_t getUsed() const {
+		return m_head - m_tail;
+	}
+
+	uint32_t getDroppedCount() const {
+		return m_droppedCount;
+	}
+
+private:
+	char m_buffer[TSize];
+
+	// total bytes in and out, they wrap together
+	volatile uint32_t m_head = 0;
+	volatile uint32_t m_tail = 0;
+
+	uint32_t m_droppedCount = 0;
+};
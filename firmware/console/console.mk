@@ -8,6 +8,7 @@ CONSOLE_SRC_CPP = $(PROJECT_DIR)/console/status_loop.cpp \
 	$(PROJECT_DIR)/console/binary/tooth_logger.cpp \
 	$(PROJECT_DIR)/console/binary_log/log_field.cpp \
 	$(PROJECT_DIR)/console/binary_log/binary_logging.cpp \
+	$(PROJECT_DIR)/console/binary_log/log_delta_encoder.cpp \
 
 
 CONSOLE_INC=\
@@ -194,6 +194,7 @@ void print(const char *format, ...) {
 void initializeConsole(Logging *sharedLogger) {
 	initConsoleLogic(sharedLogger);
 
+	startDeferredLogging();
 	startConsole(sharedLogger, &handleConsoleLine);
 
 	sayHello();
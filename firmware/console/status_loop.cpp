@@ -63,6 +63,7 @@
 #include "binary_logging.h"
 #include "buffered_writer.h"
 #include "dynoview.h"
+#include "output_channel_registry.h"
 
 extern bool main_loop_started;
 
@@ -133,9 +134,11 @@ static void setWarningEnabled(int value) {
 }
 
 #if EFI_FILE_LOGGING
-// this one needs to be in main ram so that SD card SPI DMA works fine
-static NO_CACHE char sdLogBuffer[100];
+// one record, copied into the SD log ring from here
+static char sdLogBuffer[128];
 static uint64_t binaryLogCount = 0;
+// latched with the header, a file is one or the other
+static bool isSdLogCompressed = false;
 
 #endif /* EFI_FILE_LOGGING */
 
@@ -161,12 +164,27 @@ void writeLogLine(Writer& buffer) {
 		return;
 
 	if (binaryLogCount == 0) {
-		writeHeader(buffer);
+		const uint8_t dividers[LOG_GROUP_COUNT] = {
+			CONFIG(sdLogEngineDivider),
+			CONFIG(sdLogFuelDivider),
+			CONFIG(sdLogIgnitionDivider),
+			CONFIG(sdLogThrottleDivider),
+			CONFIG(sdLogSensorsDivider),
+			CONFIG(sdLogStatusDivider),
+		};
+		selectLogFields(dividers);
+		isSdLogCompressed = CONFIG(logFormat) == LF_MLG_COMPRESSED;
+		writeHeader(buffer, isSdLogCompressed);
 	} else {
-		updateTunerStudioState(&tsOutputChannels);
-		size_t length = writeBlock(sdLogBuffer);
+		// only what is due in this record
+		size_t length = isSdLogCompressed
+				? writeCompressedBlock(sdLogBuffer, prepareTunerStudioOutputs)
+				: writeBlock(sdLogBuffer, prepareTunerStudioOutputs);
 		efiAssertVoid(OBD_PCM_Processor_Fault, length <= efi::size(sdLogBuffer), "SD log buffer overflow");
-		buffer.write(sdLogBuffer, length);
+		if (buffer.write(sdLogBuffer, length) == 0) {
+			// the next delta would be against a record the file does not have
+			requestLogKeyframe();
+		}
 	}
 
 	binaryLogCount++;
@@ -464,176 +482,22 @@ extern HIP9011 instance;
 
 #if EFI_TUNER_STUDIO
 
-void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+static int getRpmGauge(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 #if EFI_SHAFT_POSITION_INPUT
-	int rpm = Sensor::get(SensorType::Rpm).Value;
+	return Sensor::get(SensorType::Rpm).Value;
 #else /* EFI_SHAFT_POSITION_INPUT */
-	int rpm = 0;
+	return 0;
 #endif /* EFI_SHAFT_POSITION_INPUT */
+}
 
-#if EFI_PROD_CODE
-	executorStatistics();
-#endif /* EFI_PROD_CODE */
-
-#if EFI_SIMULATOR
-	tsOutputChannels->sd_status = 1 + 4;
-#endif
-
-	// header
-	tsOutputChannels->tsConfigVersion = TS_FILE_VERSION;
-
-	// offset 0
-	tsOutputChannels->rpm = rpm;
-
-	SensorResult clt = Sensor::get(SensorType::Clt);
-	tsOutputChannels->coolantTemperature = clt.Value;
-	tsOutputChannels->isCltError = !clt.Valid;
-
-	SensorResult iat = Sensor::get(SensorType::Iat);
-	tsOutputChannels->intakeAirTemperature = iat.Value;
-	tsOutputChannels->isIatError = !iat.Valid;
-
-	SensorResult auxTemp1 = Sensor::get(SensorType::AuxTemp1);
-	tsOutputChannels->auxTemp1 = auxTemp1.Value;
-
-	SensorResult auxTemp2 = Sensor::get(SensorType::AuxTemp2);
-	tsOutputChannels->auxTemp2 = auxTemp2.Value;
-
-	SensorResult tps1 = Sensor::get(SensorType::Tps1);
-	tsOutputChannels->throttlePosition = tps1.Value;
-	tsOutputChannels->isTpsError = !tps1.Valid;
-	tsOutputChannels->tpsADC = convertVoltageTo10bitADC(Sensor::getRaw(SensorType::Tps1Primary));
-
-	SensorResult tps2 = Sensor::get(SensorType::Tps2);
-	tsOutputChannels->throttle2Position = tps2.Value;
+static void updateStatusBits(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	tsOutputChannels->isCltError = !Sensor::get(SensorType::Clt).Valid;
+	tsOutputChannels->isIatError = !Sensor::get(SensorType::Iat).Valid;
+	tsOutputChannels->isTpsError = !Sensor::get(SensorType::Tps1).Valid;
 	// If we don't have a TPS2 at all, don't turn on the failure light
-	tsOutputChannels->isTps2Error = !tps2.Valid && Sensor::hasSensor(SensorType::Tps2Primary);
-
-	SensorResult pedal = Sensor::get(SensorType::AcceleratorPedal);
-	tsOutputChannels->pedalPosition = pedal.Value;
+	tsOutputChannels->isTps2Error = !Sensor::get(SensorType::Tps2).Valid && Sensor::hasSensor(SensorType::Tps2Primary);
 	// Only report fail if you have one (many people don't)
-	tsOutputChannels->isPedalError = !pedal.Valid && Sensor::hasSensor(SensorType::AcceleratorPedalPrimary);
-
-	// Set raw sensors
-	tsOutputChannels->rawTps1Primary = Sensor::getRaw(SensorType::Tps1Primary);
-	tsOutputChannels->rawPpsPrimary = Sensor::getRaw(SensorType::AcceleratorPedalPrimary);
-	tsOutputChannels->rawPpsSecondary = Sensor::getRaw(SensorType::AcceleratorPedalSecondary);
-	tsOutputChannels->rawClt = Sensor::getRaw(SensorType::Clt);
-	tsOutputChannels->rawIat = Sensor::getRaw(SensorType::Iat);
-	tsOutputChannels->rawOilPressure = Sensor::getRaw(SensorType::OilPressure);
-	tsOutputChannels->rawLowFuelPressure = Sensor::getRaw(SensorType::FuelPressureLow);
-	tsOutputChannels->rawHighFuelPressure = Sensor::getRaw(SensorType::FuelPressureHigh);
-
-	// offset 16
-	tsOutputChannels->massAirFlowVoltage = hasMafSensor() ? getMafVoltage(PASS_ENGINE_PARAMETER_SIGNATURE) : 0;
-
-	float lambdaValue = Sensor::get(SensorType::Lambda1).value_or(0);
-	tsOutputChannels->lambda = lambdaValue;
-	tsOutputChannels->airFuelRatio = lambdaValue * ENGINE(engineState.stoichiometricRatio);
-
-	float lambda2Value = Sensor::get(SensorType::Lambda2).value_or(0);
-	tsOutputChannels->lambda2 = lambda2Value;
-	tsOutputChannels->airFuelRatio2 = lambda2Value * ENGINE(engineState.stoichiometricRatio);
-
-	// offset 24
-	tsOutputChannels->engineLoad = getEngineLoadT(PASS_ENGINE_PARAMETER_SIGNATURE);
-
-	tsOutputChannels->fuelingLoad = getFuelingLoad(PASS_ENGINE_PARAMETER_SIGNATURE);
-	tsOutputChannels->ignitionLoad = getIgnitionLoad(PASS_ENGINE_PARAMETER_SIGNATURE);
-	tsOutputChannels->veTableYAxis = ENGINE(engineState.currentVeLoad);
-	tsOutputChannels->afrTableYAxis = ENGINE(engineState.currentAfrLoad);
-
-	// offset 28
-	tsOutputChannels->vBatt = Sensor::get(SensorType::BatteryVoltage).value_or(0);
-
-	// offset 36
-	tsOutputChannels->baroPressure = Sensor::get(SensorType::BarometricPressure).value_or(0);
-
-	// 48
-	tsOutputChannels->fuelBase = engine->engineState.baseFuel * 1000;	// Convert grams to mg
-	// 64
-	tsOutputChannels->actualLastInjection = ENGINE(actualLastInjection);
-
-
-	// 104
-	tsOutputChannels->rpmAcceleration = engine->rpmCalculator.getRpmAcceleration();
-	// offset 108
-	// For air-interpolated tCharge mode, we calculate a decent massAirFlow approximation, so we can show it to users even without MAF sensor!
-	tsOutputChannels->massAirFlow = getAirFlowGauge(PASS_ENGINE_PARAMETER_SIGNATURE);
-	// offset 116
-	// TPS acceleration
-	tsOutputChannels->deltaTps = engine->tpsAccelEnrichment.getMaxDelta();
-	// 128
-	tsOutputChannels->totalTriggerErrorCounter = engine->triggerCentral.triggerState.totalTriggerErrorCounter;
-	// 132
-	tsOutputChannels->orderingErrorCounter = engine->triggerCentral.triggerState.orderingErrorCounter;
-	// 68
-	tsOutputChannels->baroCorrection = engine->engineState.baroCorrection;
-	// 140
-#if EFI_ENGINE_CONTROL
-	tsOutputChannels->injectorDutyCycle = getInjectorDutyCycle(rpm PASS_ENGINE_PARAMETER_SUFFIX);
-#endif
-	// 148
-	tsOutputChannels->fuelTankLevel = engine->sensors.fuelTankLevel;
-	// 160
-	const auto& wallFuel = ENGINE(injectionEvents.elements[0].wallFuel);
-	tsOutputChannels->wallFuelAmount = wallFuel.getWallFuel();
-	// 168
-	tsOutputChannels->wallFuelCorrection = wallFuel.wallFuelCorrection;
-
-	// 164
-	tsOutputChannels->iatCorrection = ENGINE(engineState.running.intakeTemperatureCoefficient);
-	// 184
-	tsOutputChannels->cltCorrection = ENGINE(engineState.running.coolantTemperatureCoefficient);
-	// 188
-	tsOutputChannels->fuelRunning = ENGINE(engineState.running.fuel);
-	// 196
-	tsOutputChannels->injectorLagMs = ENGINE(engineState.running.injectorLag);
-	// 224
-	efitimesec_t timeSeconds = getTimeNowSeconds();
-	tsOutputChannels->timeSeconds = timeSeconds;
-
-#if EFI_SHAFT_POSITION_INPUT
-	// 248
-	tsOutputChannels->vvtPosition = engine->triggerCentral.getVVTPosition();
-#endif
-
-	// 252
-	tsOutputChannels->engineMode = packEngineMode(PASS_ENGINE_PARAMETER_SIGNATURE);
-	// 120
-	tsOutputChannels->firmwareVersion = getRusEfiVersion();
-	// 268
-	tsOutputChannels->shortTermFuelTrim = 100.0f * (ENGINE(engineState.running.pidCorrection) - 1.0f);
-	// 276
-	tsOutputChannels->accelerationX = engine->sensors.accelerometer.x;
-	// 278
-	tsOutputChannels->accelerationY = engine->sensors.accelerometer.y;
-	// 280
-	tsOutputChannels->oilPressure = Sensor::get(SensorType::OilPressure).Value;
-
-	// Low pressure is directly in kpa
-	tsOutputChannels->lowFuelPressure = Sensor::get(SensorType::FuelPressureLow).Value;
-	// High pressure is in bar, aka 100 kpa
-	tsOutputChannels->highFuelPressure = KPA2BAR(Sensor::get(SensorType::FuelPressureHigh).Value);
-
-	tsOutputChannels->flexPercent = Sensor::get(SensorType::FuelEthanolPercent).Value;
-
-	// 288
-	tsOutputChannels->injectionOffset = engine->engineState.injectionOffset;
-
-	// offset 112
-	tsOutputChannels->veValue = engine->engineState.currentVe;
-	tsOutputChannels->currentTargetAfr = ENGINE(engineState.targetAFR);
-	tsOutputChannels->targetLambda = ENGINE(engineState.targetLambda);
-
-	tsOutputChannels->manifoldAirPressure = Sensor::get(SensorType::Map).value_or(0);
-
-#if EFI_DYNO_VIEW
-	tsOutputChannels->VssAcceleration = getDynoviewAcceleration(PASS_ENGINE_PARAMETER_SIGNATURE);
-#endif
-
-	//tsOutputChannels->knockCount = engine->knockCount;
-	//tsOutputChannels->knockLevel = engine->knockVolts;
+	tsOutputChannels->isPedalError = !Sensor::get(SensorType::AcceleratorPedal).Valid && Sensor::hasSensor(SensorType::AcceleratorPedalPrimary);
 
 #if HW_CHECK_MODE
 	tsOutputChannels->hasCriticalError = 1;
@@ -641,7 +505,7 @@ void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_
 	tsOutputChannels->hasCriticalError = hasFirmwareError();
 #endif // HW_CHECK_MODE
 
-	tsOutputChannels->isWarnNow = engine->engineState.warnings.isWarningNow(timeSeconds, true);
+	tsOutputChannels->isWarnNow = engine->engineState.warnings.isWarningNow(getTimeNowSeconds(), true);
 #if EFI_HIP_9011
 	tsOutputChannels->isKnockChipOk = (instance.invalidHip9011ResponsesCount == 0);
 #endif /* EFI_HIP_9011 */
@@ -650,34 +514,8 @@ void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_
 	tsOutputChannels->launchTriggered = engine->isLaunchCondition;
 #endif
 
-	tsOutputChannels->tpsAccelFuel = engine->engineState.tpsAccelEnrich;
-	// engine load acceleration
-	if (hasMapSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
-		tsOutputChannels->engineLoadAccelExtra = engine->engineLoadAccelEnrichment.getEngineLoadEnrichment(PASS_ENGINE_PARAMETER_SIGNATURE) * 100 / Sensor::get(SensorType::Map).value_or(0);
-	}
-	tsOutputChannels->engineLoadDelta = engine->engineLoadAccelEnrichment.getMaxDelta();
-
 	tsOutputChannels->checkEngine = hasErrorCodes();
 
-#if	HAL_USE_ADC
-	tsOutputChannels->internalMcuTemperature = getMCUInternalTemperature();
-#endif /* HAL_USE_ADC */
-
-#if EFI_MAX_31855
-	for (int i = 0; i < EGT_CHANNEL_COUNT; i++)
-		tsOutputChannels->egtValues.values[i] = getEgtValue(i);
-#endif /* EFI_MAX_31855 */
-
-#if EFI_IDLE_CONTROL
-	tsOutputChannels->idlePosition = getIdlePosition();
-#endif
-
-	tsOutputChannels->idlePositionSensor = Sensor::get(SensorType::IdlePosition).value_or(0);
-	tsOutputChannels->rawIdlePositionSensor = Sensor::getRaw(SensorType::IdlePosition);
-
-	tsOutputChannels->wastegatePosition = Sensor::get(SensorType::WastegatePosition).value_or(0);
-	tsOutputChannels->rawWastegatePositionSensor = Sensor::getRaw(SensorType::WastegatePosition);
-
 #if EFI_PROD_CODE
 	tsOutputChannels->isTriggerError = isTriggerErrorNow();
 
@@ -696,23 +534,8 @@ void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_
 	tsOutputChannels->isInjectionEnabledIndicator = ENGINE(limpManager).allowInjection();
 	tsOutputChannels->isCylinderCleanupEnabled = engineConfiguration->isCylinderCleanupEnabled;
 	tsOutputChannels->isCylinderCleanupActivated = engine->isCylinderCleanupMode;
-
-#if EFI_VEHICLE_SPEED
-	float vehicleSpeed = getVehicleSpeed();
-	tsOutputChannels->vehicleSpeedKph = vehicleSpeed;
-	tsOutputChannels->speedToRpmRatio = vehicleSpeed / rpm;
-
-#endif /* EFI_VEHICLE_SPEED */
 #endif /* EFI_PROD_CODE */
 
-	tsOutputChannels->fuelConsumptionPerHour = engine->engineState.fuelConsumption.perSecondConsumption;
-
-	tsOutputChannels->warningCounter = engine->engineState.warnings.warningCounter;
-	tsOutputChannels->lastErrorCode = engine->engineState.warnings.lastErrorCode;
-	for (int i = 0; i < 8;i++) {
-		tsOutputChannels->recentErrorCodes[i] = engine->engineState.warnings.recentWarnings.get(i);
-	}
-
 	tsOutputChannels->knockNowIndicator = engine->knockCount > 0;
 	tsOutputChannels->knockEverIndicator = engine->knockEver;
 
@@ -720,20 +543,173 @@ void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_
 	tsOutputChannels->clutchDownState = engine->clutchDownState;
 	tsOutputChannels->brakePedalState = engine->brakePedalState;
 	tsOutputChannels->acSwitchState = engine->acSwitchState;
+}
+
+static void updateSpeedGauges(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	int rpm = getRpmGauge(PASS_ENGINE_PARAMETER_SIGNATURE);
+
+	// offset 4
+	tsOutputChannels->rpm = rpm;
+	tsOutputChannels->rpmAcceleration = engine->rpmCalculator.getRpmAcceleration();
 
+#if EFI_PROD_CODE && EFI_VEHICLE_SPEED
+	float vehicleSpeed = getVehicleSpeed();
+	tsOutputChannels->vehicleSpeedKph = vehicleSpeed;
+	tsOutputChannels->speedToRpmRatio = vehicleSpeed / rpm;
+#else
+	(void)rpm;
+#endif /* EFI_PROD_CODE && EFI_VEHICLE_SPEED */
+}
+
+static void updateMcuTemperature(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+#if	HAL_USE_ADC
+	tsOutputChannels->internalMcuTemperature = getMCUInternalTemperature();
+#else
+	(void)tsOutputChannels;
+#endif /* HAL_USE_ADC */
+}
+
+static void updateSensorGauges(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 12
+	tsOutputChannels->coolantTemperature = Sensor::get(SensorType::Clt).Value;
+	tsOutputChannels->intakeAirTemperature = Sensor::get(SensorType::Iat).Value;
+	tsOutputChannels->auxTemp1 = Sensor::get(SensorType::AuxTemp1).Value;
+	tsOutputChannels->auxTemp2 = Sensor::get(SensorType::AuxTemp2).Value;
+
+	// offset 20
+	tsOutputChannels->throttlePosition = Sensor::get(SensorType::Tps1).Value;
+	tsOutputChannels->pedalPosition = Sensor::get(SensorType::AcceleratorPedal).Value;
+	tsOutputChannels->tpsADC = convertVoltageTo10bitADC(Sensor::getRaw(SensorType::Tps1Primary));
+
+	// offset 26
+	tsOutputChannels->massAirFlowVoltage = hasMafSensor() ? getMafVoltage(PASS_ENGINE_PARAMETER_SIGNATURE) : 0;
+	// For air-interpolated tCharge mode, we calculate a decent massAirFlow approximation, so we can show it to users even without MAF sensor!
+	tsOutputChannels->massAirFlow = getAirFlowGauge(PASS_ENGINE_PARAMETER_SIGNATURE);
+	tsOutputChannels->manifoldAirPressure = Sensor::get(SensorType::Map).value_or(0);
+	tsOutputChannels->baroPressure = Sensor::get(SensorType::BarometricPressure).value_or(0);
+
+	// offset 34
+	tsOutputChannels->lambda = Sensor::get(SensorType::Lambda1).value_or(0);
+	tsOutputChannels->engineLoad = getEngineLoadT(PASS_ENGINE_PARAMETER_SIGNATURE);
+	tsOutputChannels->vBatt = Sensor::get(SensorType::BatteryVoltage).value_or(0);
+	tsOutputChannels->oilPressure = Sensor::get(SensorType::OilPressure).Value;
+
+#if EFI_SHAFT_POSITION_INPUT
+	// offset 42
+	tsOutputChannels->vvtPosition = engine->triggerCentral.getVVTPosition();
+#endif
+}
+
+static void updateFuelGauges(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+#if EFI_ENGINE_CONTROL
+	// offset 44
+	tsOutputChannels->chargeAirMass = engine->engineState.sd.airMassInOneCylinder;
+	tsOutputChannels->crankingFuelMass = ENGINE(engineState.cranking.fuel);
+#endif // EFI_ENGINE_CONTROL
+	tsOutputChannels->currentTargetAfr = ENGINE(engineState.targetAFR);
+	tsOutputChannels->fuelBase = engine->engineState.baseFuel * 1000;	// Convert grams to mg
+	tsOutputChannels->fuelRunning = ENGINE(engineState.running.fuel);
+	tsOutputChannels->actualLastInjection = ENGINE(actualLastInjection);
+#if EFI_ENGINE_CONTROL
+	// offset 56
+	tsOutputChannels->injectorDutyCycle = getInjectorDutyCycle(getRpmGauge(PASS_ENGINE_PARAMETER_SIGNATURE) PASS_ENGINE_PARAMETER_SUFFIX);
+#endif
+	tsOutputChannels->veValue = engine->engineState.currentVe;
+	tsOutputChannels->injectionOffset = engine->engineState.injectionOffset;
 #if EFI_ENGINE_CONTROL
 	// tCharge depends on the previous state, so we should use the stored value.
 	tsOutputChannels->tCharge = ENGINE(engineState.sd.tCharge);
+#endif // EFI_ENGINE_CONTROL
+
+	// offset 62
+	tsOutputChannels->injectorLagMs = ENGINE(engineState.running.injectorLag);
+	tsOutputChannels->iatCorrection = ENGINE(engineState.running.intakeTemperatureCoefficient);
+	tsOutputChannels->cltCorrection = ENGINE(engineState.running.coolantTemperatureCoefficient);
+	tsOutputChannels->baroCorrection = engine->engineState.baroCorrection;
+	tsOutputChannels->shortTermFuelTrim = 100.0f * (ENGINE(engineState.running.pidCorrection) - 1.0f);
+
+	// offset 72
+	const auto& wallFuel = ENGINE(injectionEvents.elements[0].wallFuel);
+	tsOutputChannels->wallFuelAmount = wallFuel.getWallFuel();
+	tsOutputChannels->wallFuelCorrection = wallFuel.wallFuelCorrection;
+
+	// offset 76
+	// engine load acceleration
+	tsOutputChannels->engineLoadDelta = engine->engineLoadAccelEnrichment.getMaxDelta();
+	// TPS acceleration
+	tsOutputChannels->deltaTps = engine->tpsAccelEnrichment.getMaxDelta();
+	if (hasMapSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
+		tsOutputChannels->engineLoadAccelExtra = engine->engineLoadAccelEnrichment.getEngineLoadEnrichment(PASS_ENGINE_PARAMETER_SIGNATURE) * 100 / Sensor::get(SensorType::Map).value_or(0);
+	}
+	tsOutputChannels->tpsAccelFuel = engine->engineState.tpsAccelEnrich;
+}
+
+static void updateIgnitionGauges(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+#if EFI_ENGINE_CONTROL
+	// offset 84
 	float timing = engine->engineState.timingAdvance;
 	tsOutputChannels->ignitionAdvance = timing > 360 ? timing - 720 : timing;
-	// 60
 	tsOutputChannels->sparkDwell = ENGINE(engineState.sparkDwell);
-	tsOutputChannels->crankingFuelMass = ENGINE(engineState.cranking.fuel);
-	tsOutputChannels->chargeAirMass = engine->engineState.sd.airMassInOneCylinder;
-
-	tsOutputChannels->coilDutyCycle = getCoilDutyCycle(rpm PASS_ENGINE_PARAMETER_SUFFIX);
+	tsOutputChannels->coilDutyCycle = getCoilDutyCycle(getRpmGauge(PASS_ENGINE_PARAMETER_SIGNATURE) PASS_ENGINE_PARAMETER_SUFFIX);
+#else
+	(void)tsOutputChannels;
 #endif // EFI_ENGINE_CONTROL
+}
+
+static void updateIdleGauges(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+#if EFI_IDLE_CONTROL
+	tsOutputChannels->idlePosition = getIdlePosition();
+#else
+	(void)tsOutputChannels;
+#endif
+}
+
+static void updateFuelConsumption(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 98
+	tsOutputChannels->fuelTankLevel = engine->sensors.fuelTankLevel;
+	tsOutputChannels->fuelConsumptionPerHour = engine->engineState.fuelConsumption.perSecondConsumption;
+}
+
+static void updateTableAxes(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 104
+	tsOutputChannels->veTableYAxis = ENGINE(engineState.currentVeLoad);
+	tsOutputChannels->afrTableYAxis = ENGINE(engineState.currentAfrLoad);
+}
+
+static void updateTableLoads(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 134
+	tsOutputChannels->fuelingLoad = getFuelingLoad(PASS_ENGINE_PARAMETER_SIGNATURE);
+	tsOutputChannels->ignitionLoad = getIgnitionLoad(PASS_ENGINE_PARAMETER_SIGNATURE);
+}
+
+static void updateTime(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 112
+	tsOutputChannels->timeSeconds = getTimeNowSeconds();
+}
+
+static void updateVersions(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 116
+	tsOutputChannels->engineMode = packEngineMode(PASS_ENGINE_PARAMETER_SIGNATURE);
+	tsOutputChannels->firmwareVersion = getRusEfiVersion();
+	tsOutputChannels->tsConfigVersion = TS_FILE_VERSION;
+}
+
+static void updateTriggerErrors(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 140
+	tsOutputChannels->totalTriggerErrorCounter = engine->triggerCentral.triggerState.totalTriggerErrorCounter;
+	tsOutputChannels->orderingErrorCounter = engine->triggerCentral.triggerState.orderingErrorCounter;
+}
+
+static void updateWarnings(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 148
+	tsOutputChannels->warningCounter = engine->engineState.warnings.warningCounter;
+	tsOutputChannels->lastErrorCode = engine->engineState.warnings.lastErrorCode;
+	for (int i = 0; i < 8;i++) {
+		tsOutputChannels->recentErrorCodes[i] = engine->engineState.warnings.recentWarnings.get(i);
+	}
+}
 
+static void updateDebugFields(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	switch (engineConfiguration->debugMode)	{
 	case DBG_START_STOP:
 		tsOutputChannels->debugIntField1 = engine->startStopStateToggleCounter;
@@ -741,7 +717,7 @@ void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_
 		tsOutputChannels->debugIntField3 = enginePins.starterRelayDisable.getLogicValue();
 		break;
 	case DBG_STATUS:
-		tsOutputChannels->debugFloatField1 = timeSeconds;
+		tsOutputChannels->debugFloatField1 = getTimeNowSeconds();
 		tsOutputChannels->debugIntField1 = atoi(VCS_VERSION);
 		break;
 	case DBG_METRICS:
@@ -887,9 +863,154 @@ void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_
 	}
 }
 
-void prepareTunerStudioOutputs(void) {
+static void updateAccelerometer(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 212
+	tsOutputChannels->accelerationX = engine->sensors.accelerometer.x;
+	tsOutputChannels->accelerationY = engine->sensors.accelerometer.y;
+}
+
+static void updateEgt(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+#if EFI_MAX_31855
+	for (int i = 0; i < EGT_CHANNEL_COUNT; i++)
+		tsOutputChannels->egtValues.values[i] = getEgtValue(i);
+#else
+	(void)tsOutputChannels;
+#endif /* EFI_MAX_31855 */
+}
+
+static void updateRawSensors(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 232
+	tsOutputChannels->throttle2Position = Sensor::get(SensorType::Tps2).Value;
+
+	tsOutputChannels->rawTps1Primary = Sensor::getRaw(SensorType::Tps1Primary);
+	tsOutputChannels->rawPpsPrimary = Sensor::getRaw(SensorType::AcceleratorPedalPrimary);
+	tsOutputChannels->rawClt = Sensor::getRaw(SensorType::Clt);
+	tsOutputChannels->rawIat = Sensor::getRaw(SensorType::Iat);
+	tsOutputChannels->rawOilPressure = Sensor::getRaw(SensorType::OilPressure);
+}
+
+static void updateSdStatus(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+#if EFI_SIMULATOR
+	tsOutputChannels->sd_status = 1 + 4;
+#else
+	(void)tsOutputChannels;
+#endif
+}
+
+static void updateRawPedalSecondary(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 248
+	tsOutputChannels->rawPpsSecondary = Sensor::getRaw(SensorType::AcceleratorPedalSecondary);
+}
+
+static void updateFlex(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 263
+	tsOutputChannels->flexPercent = Sensor::get(SensorType::FuelEthanolPercent).Value;
+}
+
+static void updatePositionSensors(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 264
+	tsOutputChannels->rawIdlePositionSensor = Sensor::getRaw(SensorType::IdlePosition);
+	tsOutputChannels->rawWastegatePositionSensor = Sensor::getRaw(SensorType::WastegatePosition);
+	tsOutputChannels->wastegatePosition = Sensor::get(SensorType::WastegatePosition).value_or(0);
+	tsOutputChannels->idlePositionSensor = Sensor::get(SensorType::IdlePosition).value_or(0);
+}
+
+static void updateFuelPressure(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 272
+	tsOutputChannels->rawLowFuelPressure = Sensor::getRaw(SensorType::FuelPressureLow);
+	tsOutputChannels->rawHighFuelPressure = Sensor::getRaw(SensorType::FuelPressureHigh);
+	// Low pressure is directly in kpa
+	tsOutputChannels->lowFuelPressure = Sensor::get(SensorType::FuelPressureLow).Value;
+	// High pressure is in bar, aka 100 kpa
+	tsOutputChannels->highFuelPressure = KPA2BAR(Sensor::get(SensorType::FuelPressureHigh).Value);
+}
+
+static void updateAirFuelRatio(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 280
+	tsOutputChannels->targetLambda = ENGINE(engineState.targetLambda);
+	tsOutputChannels->airFuelRatio = Sensor::get(SensorType::Lambda1).value_or(0) * ENGINE(engineState.stoichiometricRatio);
+}
+
+static void updateDynoView(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+#if EFI_DYNO_VIEW
+	// offset 284
+	tsOutputChannels->VssAcceleration = getDynoviewAcceleration(PASS_ENGINE_PARAMETER_SIGNATURE);
+#else
+	(void)tsOutputChannels;
+#endif
+}
+
+static void updateSecondLambda(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 286
+	float lambda2Value = Sensor::get(SensorType::Lambda2).value_or(0);
+	tsOutputChannels->lambda2 = lambda2Value;
+	tsOutputChannels->airFuelRatio2 = lambda2Value * ENGINE(engineState.stoichiometricRatio);
+}
+
+static void updateLimitsAndPrediction(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// offset 296
+	tsOutputChannels->fuelCutRatio = ENGINE(limpManager).getFuelCutRatio();
+	tsOutputChannels->sparkCutRatio = ENGINE(limpManager).getSparkCutRatio();
+	tsOutputChannels->predictedMap = ENGINE(loadPredictor).getPredictedMap(Sensor::get(SensorType::Map).value_or(0));
+	tsOutputChannels->mapPredictionError = ENGINE(loadPredictor).getPredictionError();
+	tsOutputChannels->knockRetard = ENGINE(knockController).getMaxRetard();
+}
+
+/**
+ * Every field written here belongs to exactly one entry, fields filled elsewhere (ETB, knock,
+ * calibration, CRCs) are not listed.
+ */
+static const OutputChannelEntry outputChannelEntries[] = {
+	{ 0, 4, OutputRefresh::EveryRequest, updateStatusBits },
+	{ OUTPUT_RANGE(rpm, vehicleSpeedKph), OutputRefresh::EveryRequest, updateSpeedGauges },
+	{ OUTPUT_RANGE(internalMcuTemperature, internalMcuTemperature), OutputRefresh::Slow, updateMcuTemperature },
+	{ OUTPUT_RANGE(coolantTemperature, vvtPosition), OutputRefresh::EveryRequest, updateSensorGauges },
+	{ OUTPUT_RANGE(chargeAirMass, tpsAccelFuel), OutputRefresh::EveryRequest, updateFuelGauges },
+	{ OUTPUT_RANGE(ignitionAdvance, coilDutyCycle), OutputRefresh::EveryRequest, updateIgnitionGauges },
+	{ OUTPUT_RANGE(idlePosition, idlePosition), OutputRefresh::EveryRequest, updateIdleGauges },
+	{ OUTPUT_RANGE(fuelTankLevel, fuelConsumptionPerHour), OutputRefresh::Slow, updateFuelConsumption },
+	{ OUTPUT_RANGE(veTableYAxis, afrTableYAxis), OutputRefresh::EveryRequest, updateTableAxes },
+	{ OUTPUT_RANGE(timeSeconds, timeSeconds), OutputRefresh::EveryRequest, updateTime },
+	{ OUTPUT_RANGE(engineMode, tsConfigVersion), OutputRefresh::Slow, updateVersions },
+	{ OUTPUT_RANGE(fuelingLoad, ignitionLoad), OutputRefresh::EveryRequest, updateTableLoads },
+	{ OUTPUT_RANGE(totalTriggerErrorCounter, orderingErrorCounter), OutputRefresh::EveryRequest, updateTriggerErrors },
+	{ OUTPUT_RANGE(warningCounter, recentErrorCodes), OutputRefresh::Slow, updateWarnings },
+	{ OUTPUT_RANGE(debugFloatField1, debugIntField5), OutputRefresh::EveryRequest, updateDebugFields },
+	{ OUTPUT_RANGE(accelerationX, accelerationY), OutputRefresh::EveryRequest, updateAccelerometer },
+	{ OUTPUT_RANGE(egtValues, egtValues), OutputRefresh::Slow, updateEgt },
+	{ OUTPUT_RANGE(throttle2Position, rawOilPressure), OutputRefresh::EveryRequest, updateRawSensors },
+	{ OUTPUT_RANGE(sd_status, sd_status), OutputRefresh::Slow, updateSdStatus },
+	{ OUTPUT_RANGE(rawPpsSecondary, rawPpsSecondary), OutputRefresh::EveryRequest, updateRawPedalSecondary },
+	{ OUTPUT_RANGE(flexPercent, flexPercent), OutputRefresh::Slow, updateFlex },
+	{ OUTPUT_RANGE(rawIdlePositionSensor, idlePositionSensor), OutputRefresh::EveryRequest, updatePositionSensors },
+	{ OUTPUT_RANGE(rawLowFuelPressure, highFuelPressure), OutputRefresh::EveryRequest, updateFuelPressure },
+	{ OUTPUT_RANGE(targetLambda, airFuelRatio), OutputRefresh::EveryRequest, updateAirFuelRatio },
+	{ OUTPUT_RANGE(VssAcceleration, VssAcceleration), OutputRefresh::EveryRequest, updateDynoView },
+	{ OUTPUT_RANGE(lambda2, airFuelRatio2), OutputRefresh::EveryRequest, updateSecondLambda },
+	{ OUTPUT_RANGE(fuelCutRatio, knockRetard), OutputRefresh::EveryRequest, updateLimitsAndPrediction },
+};
+
+static OutputChannelRegistry<efi::size(outputChannelEntries)> outputChannelRegistry(outputChannelEntries);
+
+void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels, uint16_t offset, uint16_t count DECLARE_ENGINE_PARAMETER_SUFFIX) {
+#if EFI_PROD_CODE
+	executorStatistics();
+#endif /* EFI_PROD_CODE */
+
+	outputChannelRegistry.refresh(tsOutputChannels, offset, count, getTimeNowNt() PASS_ENGINE_PARAMETER_SUFFIX);
+}
+
+void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	updateTunerStudioState(tsOutputChannels, 0, sizeof(TunerStudioOutputChannels) PASS_ENGINE_PARAMETER_SUFFIX);
+}
+
+void prepareTunerStudioOutputs(uint16_t offset, uint16_t count) {
 	// sensor state for EFI Analytics Tuner Studio
-	updateTunerStudioState(&tsOutputChannels PASS_ENGINE_PARAMETER_SUFFIX);
+	updateTunerStudioState(&tsOutputChannels, offset, count PASS_ENGINE_PARAMETER_SUFFIX);
+}
+
+void prepareTunerStudioOutputs(void) {
+	prepareTunerStudioOutputs(0, sizeof(TunerStudioOutputChannels));
 }
 
 #endif /* EFI_TUNER_STUDIO */
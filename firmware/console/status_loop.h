@@ -11,6 +11,8 @@
 
 void updateDevConsoleState(void);
 void prepareTunerStudioOutputs(void);
+// refreshes just the output channels overlapping offset..offset+count
+void prepareTunerStudioOutputs(uint16_t offset, uint16_t count);
 void startStatusThreads(void);
 void initStatusLoop(void);
 
@@ -85,7 +85,7 @@ static angle_t getRunningAdvance(int rpm, float engineLoad DECLARE_ENGINE_PARAME
 	if (CONFIG(useSeparateAdvanceForIdle) && isIdling()) {
 		float idleAdvance = interpolate2d(rpm, config->idleAdvanceBins, config->idleAdvance);
 
-		auto [valid, tps] = Sensor::get(SensorType::DriverThrottleIntent);
+		auto [valid, tps] = ENGINE(fastFrame).get(SensorType::DriverThrottleIntent);
 		if (valid) {
 			// interpolate between idle table and normal (running) table using TPS threshold
 			advanceAngle = interpolateClamped(0.0f, idleAdvance, CONFIG(idlePidDeactivationTpsThreshold), advanceAngle, tps);
@@ -112,7 +112,7 @@ static angle_t getRunningAdvance(int rpm, float engineLoad DECLARE_ENGINE_PARAME
 angle_t getAdvanceCorrections(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	float iatCorrection;
 
-	const auto [iatValid, iat] = Sensor::get(SensorType::Iat);
+	const auto [iatValid, iat] = ENGINE(fastFrame).get(SensorType::Iat);
 
 	if (!iatValid) {
 		iatCorrection = 0;
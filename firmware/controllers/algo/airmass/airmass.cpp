@@ -9,8 +9,8 @@ AirmassModelBase::AirmassModelBase(const ValueProvider3D& veTable) : m_veTable(&
 float AirmassModelBase::getVeLoadAxis(float passedLoad) const {
 	switch(CONFIG(veOverrideMode)) {
 		case VE_None: return passedLoad;
-		case VE_MAP: return Sensor::get(SensorType::Map).value_or(0);
-		case VE_TPS: return Sensor::get(SensorType::Tps1).value_or(0);
+		case VE_MAP: return ENGINE(fastFrame).get(SensorType::Map).value_or(0);
+		case VE_TPS: return ENGINE(fastFrame).get(SensorType::Tps1).value_or(0);
 		default: return 0;
 	}
 }
@@ -23,7 +23,7 @@ float AirmassModelBase::getVe(int rpm, float load) const {
 
 	float ve = m_veTable->getValue(rpm, load);
 
-	auto tps = Sensor::get(SensorType::Tps1);
+	auto tps = ENGINE(fastFrame).get(SensorType::Tps1);
 	// get VE from the separate table for Idle if idling
 	if (isIdling() && tps && CONFIG(useSeparateVeForIdle)) {
 		float idleVe = interpolate2d(rpm, config->idleVeBins, config->idleVe);
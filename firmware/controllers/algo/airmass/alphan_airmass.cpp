@@ -1,8 +1,12 @@
+#include "global.h"
+#include "engine.h"
 #include "alphan_airmass.h"
 #include "sensor.h"
 
+EXTERN_ENGINE;
+
 AirmassResult AlphaNAirmass::getAirmass(int rpm) {
-	auto tps = Sensor::get(SensorType::Tps1);
+	auto tps = ENGINE(fastFrame).get(SensorType::Tps1);
 
 	if (!tps.Valid) {
 		// We are fully reliant on TPS - if the TPS fails, stop the engine.
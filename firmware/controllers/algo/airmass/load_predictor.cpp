@@ -0,0 +1,61 @@
+#include "global.h"
+#include "load_predictor.h"
+#include "efilib.h"
+
+// smoothing of the per-callback rate estimate, 1 = no smoothing
+#define RATE_FILTER_ALPHA 0.3f
+
+void LoadPredictor::reset() {
+	m_hasHistory = false;
+	m_mapRate = 0;
+	m_tpsRate = 0;
+	m_predictedDelta = 0;
+	m_hasPending = false;
+}
+
+void LoadPredictor::update(efitick_t nowNt, float map, float tps, float horizonUs, float gain) {
+	if (m_hasPending && nowNt >= m_pendingNt) {
+		m_predictionError = map - m_pendingMap;
+		m_hasPending = false;
+	}
+
+	if (m_hasHistory && nowNt > m_lastNt) {
+		float dtSec = NT2US(nowNt - m_lastNt) / 1e6f;
+
+		float mapRate = (map - m_lastMap) / dtSec;
+		float tpsRate = (tps - m_lastTps) / dtSec;
+
+		m_mapRate += RATE_FILTER_ALPHA * (mapRate - m_mapRate);
+		m_tpsRate += RATE_FILTER_ALPHA * (tpsRate - m_tpsRate);
+	}
+
+	m_hasHistory = true;
+	m_lastNt = nowNt;
+	m_lastMap = map;
+	m_lastTps = tps;
+
+	if (gain <= 0 || cisnan(horizonUs) || horizonUs <= 0) {
+		m_predictedDelta = 0;
+		m_hasPending = false;
+		return;
+	}
+
+	bool throttleReversed = m_tpsRate * m_mapRate < 0 && absF(m_tpsRate) > TPS_REVERSAL_RATE;
+
+	if (throttleReversed) {
+		m_predictedDelta = 0;
+	} else {
+		float delta = gain * m_mapRate * horizonUs / 1e6f;
+		m_predictedDelta = clampF(-MAX_PREDICTED_MAP_DELTA, delta, MAX_PREDICTED_MAP_DELTA);
+	}
+
+	if (!m_hasPending) {
+		m_hasPending = true;
+		m_pendingNt = nowNt + US2NT(horizonUs);
+		m_pendingMap = map + m_predictedDelta;
+	}
+}
+
+float LoadPredictor::getPredictedMap(float measuredMap) const {
+	return maxF(0, measuredMap + m_predictedDelta);
+}
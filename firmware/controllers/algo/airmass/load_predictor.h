@@ -0,0 +1,58 @@
+/**
+ * @file	load_predictor.h
+ *
+ * Fuel computed on the fast callback only takes effect once the intake valve of the next
+ * cylinder closes. During transients MAP keeps moving in the meantime, so the measured value
+ * is stale by the time it matters. This extrapolates MAP over that horizon from its own rate
+ * of change, using TPS rate to stop extrapolating once the throttle has reversed.
+ */
+
+#pragma once
+
+#include "rusefi_types.h"
+
+// Never extrapolate further than this from the measured value, kPa
+#define MAX_PREDICTED_MAP_DELTA 50
+// TPS moving this fast against the MAP trend means the trend is about to reverse, %/s
+#define TPS_REVERSAL_RATE 50
+
+class LoadPredictor {
+public:
+	/**
+	 * Called from the fast callback with the latest readings.
+	 * @param horizonUs time from now until the intake valve closes on the next cylinder event
+	 * @param gain 0 disables prediction, 1 extrapolates the full current rate
+	 */
+	void update(efitick_t nowNt, float map, float tps, float horizonUs, float gain);
+	// Forget rate history, for example when MAP is not valid
+	void reset();
+
+	// Measured MAP moved by the predicted change until the next intake valve closing
+	float getPredictedMap(float measuredMap) const;
+	float getPredictedDelta() const {
+		return m_predictedDelta;
+	}
+
+	// Measured MAP minus what we predicted for that moment, kPa
+	float getPredictionError() const {
+		return m_predictionError;
+	}
+
+private:
+	bool m_hasHistory = false;
+	efitick_t m_lastNt = 0;
+	float m_lastMap = 0;
+	float m_lastTps = 0;
+
+	// filtered rates of change, per second
+	float m_mapRate = 0;
+	float m_tpsRate = 0;
+
+	float m_predictedDelta = 0;
+
+	// one outstanding prediction at a time is checked against the measurement once its moment arrives
+	bool m_hasPending = false;
+	efitick_t m_pendingNt = 0;
+	float m_pendingMap = 0;
+	float m_predictionError = 0;
+};
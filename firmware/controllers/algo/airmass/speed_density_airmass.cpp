@@ -17,7 +17,8 @@ AirmassResult SpeedDensityAirmass::getAirmass(int rpm) {
 		return {};
 	}
 
-	auto map = getMap(rpm);
+	// use the MAP expected at intake valve closing, not the one measured right now
+	auto map = ENGINE(loadPredictor).getPredictedMap(getMap(rpm));
 
 	engine->engineState.sd.manifoldAirPressureAccelerationAdjustment = engine->engineLoadAccelEnrichment.getEngineLoadEnrichment(PASS_ENGINE_PARAMETER_SIGNATURE);
 
@@ -46,7 +47,7 @@ float SpeedDensityAirmass::getMap(int rpm) const {
 	float fallbackMap;
 	if (CONFIG(enableMapEstimationTableFallback)) {
 		// if the map estimation table is enabled, estimate map based on the TPS and RPM
-		fallbackMap = m_mapEstimationTable->getValue(rpm, TPS_2_BYTE_PACKING_MULT * Sensor::get(SensorType::Tps1).value_or(0));
+		fallbackMap = m_mapEstimationTable->getValue(rpm, TPS_2_BYTE_PACKING_MULT * ENGINE(fastFrame).get(SensorType::Tps1).value_or(0));
 	} else {
 		fallbackMap = CONFIG(failedMapFallback);
 	}
@@ -57,5 +58,5 @@ float SpeedDensityAirmass::getMap(int rpm) const {
 	}
 #endif // EFI_TUNER_STUDIO
 
-	return Sensor::get(SensorType::Map).value_or(fallbackMap);
+	return ENGINE(fastFrame).get(SensorType::Map).value_or(fallbackMap);
 }
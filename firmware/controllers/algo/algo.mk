@@ -15,6 +15,8 @@ CONTROLLERS_ALGO_SRC_CPP = $(PROJECT_DIR)/controllers/algo/advance_map.cpp \
 	$(PROJECT_DIR)/controllers/algo/event_registry.cpp \
 	$(PROJECT_DIR)/controllers/algo/airmass/airmass.cpp \
 	$(PROJECT_DIR)/controllers/algo/airmass/alphan_airmass.cpp \
+	$(PROJECT_DIR)/controllers/algo/airmass/load_predictor.cpp \
+	$(PROJECT_DIR)/controllers/algo/knock_controller.cpp \
 	$(PROJECT_DIR)/controllers/algo/airmass/maf_airmass.cpp \
 	$(PROJECT_DIR)/controllers/algo/airmass/speed_density_airmass.cpp \
 	$(PROJECT_DIR)/controllers/algo/airmass/speed_density_base.cpp \
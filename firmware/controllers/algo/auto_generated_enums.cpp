@@ -1136,6 +1136,8 @@ const char *getLog_format_e(log_format_e value){
 switch(value) {
 case Force_4_bytes_size_log_format:
   return "Force_4_bytes_size_log_format";
+case LF_MLG_COMPRESSED:
+  return "LF_MLG_COMPRESSED";
 case LF_NATIVE:
   return "LF_NATIVE";
 case LM_MLV:
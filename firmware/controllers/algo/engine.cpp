@@ -34,6 +34,7 @@
 #include "tachometer.h"
 #include "dynoview.h"
 #include "boost_control.h"
+#include "obd2.h"
 #if EFI_MC33816
  #include "mc33816.h"
 #endif // EFI_MC33816
@@ -216,6 +217,12 @@ void Engine::periodicSlowCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 
 	standardAirCharge = getStandardAirCharge(PASS_ENGINE_PARAMETER_SIGNATURE);
 
+#if EFI_CAN_SUPPORT
+	if (CONFIG(canReadEnabled)) {
+		obdRefreshPidCache(PASS_ENGINE_PARAMETER_SIGNATURE);
+	}
+#endif /* EFI_CAN_SUPPORT */
+
 #if (BOARD_TLE8888_COUNT > 0)
 	static efitick_t tle8888CrankingResetTime = 0;
 
@@ -461,6 +468,7 @@ void Engine::injectEngineReferences() {
 		INJECT_ENGINE_REFERENCE(&vvtTriggerConfiguration[camIndex]);
 	}
 	INJECT_ENGINE_REFERENCE(&limpManager);
+	INJECT_ENGINE_REFERENCE(&knockController);
 
 	primaryTriggerConfiguration.update();
 	for (int camIndex = 0;camIndex < CAMS_PER_BANK;camIndex++) {
@@ -506,6 +514,9 @@ void Engine::knockLogic(float knockVolts DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	} else {
         knockCount = 0;
     }
+
+    // these sources don't know which cylinder knocked
+    knockController.onKnockSenseAllCylinders(knockNow);
 }
 
 void Engine::watchdog() {
@@ -662,6 +673,10 @@ int Engine::getRpmHardLimit(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 void Engine::periodicFastCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	ScopePerf pc(PE::EnginePeriodicFastCallback);
 
+	// one consistent set of sensor readings for everything computed during this tick
+	sensorFrames.publish(getTimeNowNt());
+	sensorFrames.read(fastFrame);
+
 #if EFI_MAP_AVERAGING
 	refreshMapAveragingPreCalc(PASS_ENGINE_PARAMETER_SIGNATURE);
 #endif
@@ -669,6 +684,8 @@ void Engine::periodicFastCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	engineState.periodicFastCallback(PASS_ENGINE_PARAMETER_SIGNATURE);
 
 	tachSignalCallback(PASS_ENGINE_PARAMETER_SIGNATURE);
+
+	fastFrame.release();
 }
 
 void doScheduleStopEngine(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
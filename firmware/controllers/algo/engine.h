@@ -19,6 +19,9 @@
 #include "buttonshift.h"
 #include "gear_controller.h"
 #include "limp_manager.h"
+#include "load_predictor.h"
+#include "knock_controller.h"
+#include "sensor_frame.h"
 
 #if EFI_SIGNAL_EXECUTOR_ONE_TIMER
 // PROD real firmware uses this implementation
@@ -371,6 +374,13 @@ public:
 	AirmassModelBase* mockAirmassModel = nullptr;
 
 	LimpManager limpManager;
+	LoadPredictor loadPredictor;
+	KnockController knockController;
+
+	// Published at the start of every fast callback for readers in any context
+	SensorFramePublisher sensorFrames;
+	// What the fast callback itself works from during its tick, reads through to the registry outside of the tick
+	SensorFrame fastFrame;
 
 private:
 	/**
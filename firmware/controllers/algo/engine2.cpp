@@ -169,9 +169,20 @@ void EngineState::periodicFastCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 
 	baroCorrection = getBaroCorrection(PASS_ENGINE_PARAMETER_SIGNATURE);
 
-	auto tps = Sensor::get(SensorType::Tps1);
+	auto tps = ENGINE(fastFrame).get(SensorType::Tps1);
 	updateTChargeK(rpm, tps.value_or(0) PASS_ENGINE_PARAMETER_SUFFIX);
 
+	auto map = ENGINE(fastFrame).get(SensorType::Map);
+	if (map && rpm > 0) {
+		// fuel computed now is injected for the next cylinder event, so it has to match the air trapped
+		// one firing interval from now, plus on average half a callback period
+		float horizonUs = getOneDegreeTimeUs(rpm) * ENGINE(engineCycle) / CONFIG(specs.cylindersCount)
+				+ FAST_CALLBACK_PERIOD_MS * 1000 / 2;
+		ENGINE(loadPredictor).update(nowNt, map.Value, tps.value_or(0), horizonUs, CONFIG(mapPredictionGain));
+	} else {
+		ENGINE(loadPredictor).reset();
+	}
+
 	float injectionMass = getInjectionMass(rpm PASS_ENGINE_PARAMETER_SUFFIX);
 	ENGINE(injectionMass) = injectionMass;
 	// Store the pre-wall wetting injection duration for scheduling purposes only, not the actual injection duration
@@ -190,6 +201,8 @@ void EngineState::periodicFastCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 
 	engine->limpManager.updateState(rpm);
 
+	ENGINE(knockController).update(nowNt);
+
 #endif // EFI_ENGINE_CONTROL
 }
 
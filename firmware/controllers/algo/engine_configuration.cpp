@@ -140,6 +140,9 @@ static fuel_table_t alphaNfuel = {
  * todo: place this field next to 'engineConfiguration'?
  */
 #if EFI_ACTIVE_CONFIGURATION_IN_FLASH
+#if EFI_CONFIG_JOURNAL
+#error "EFI_ACTIVE_CONFIGURATION_IN_FLASH needs a plain copy of the configuration in flash, disable EFI_CONFIG_JOURNAL"
+#endif
 #include "flash_int.h"
 engine_configuration_s & activeConfiguration = reinterpret_cast<persistent_config_container_s*>(getFlashAddrFirstCopy())->persistentConfiguration.engineConfiguration;
 // we cannot use this activeConfiguration until we call rememberCurrentConfiguration()
@@ -975,6 +978,9 @@ static void setDefaultEngineConfiguration(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 
 	engineConfiguration->cylinderBore = 87.5;
 	engineConfiguration->knockBandCustom = BAND(engineConfiguration->cylinderBore);
+	// knock control stays inactive until enableKnockControl is set
+	engineConfiguration->knockRetardStep = 2;
+	engineConfiguration->knockRetardRecoveryRate = 1;
 
 	setEgoSensor(ES_14Point7_Free PASS_CONFIG_PARAMETER_SUFFIX);
 
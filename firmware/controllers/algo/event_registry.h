@@ -92,6 +92,26 @@ public:
 
 #define MAX_OUTPUTS_FOR_IGNITION 2
 
+// see multisparkMaxExtraSparkCount limits in rusefi_config.txt
+#define MAX_MULTISPARK_EXTRA_SPARKS 5
+
+/**
+ * All extra sparks of one cylinder event, computed once when the main spark is scheduled.
+ * Even edges start dwell, odd edges fire. Offsets are relative to the main spark so that
+ * interrupt latency of one edge does not push the following ones.
+ */
+class MultisparkBurst {
+public:
+	uint32_t edgeOffsetNt[2 * MAX_MULTISPARK_EXTRA_SPARKS];
+	uint8_t edgeCount = 0;
+	uint8_t nextEdge = 0;
+	efitick_t startNt = 0;
+	/**
+	 * The whole burst walks through the executor using this one record
+	 */
+	scheduling_s timer;
+};
+
 class IgnitionEvent {
 public:
 	IgnitionEvent();
@@ -99,9 +119,9 @@ public:
 	scheduling_s dwellStartTimer;
 	AngleBasedEvent sparkEvent;
 
-	// How many additional sparks should we fire after the first one?
-	// For single sparks, this should be zero.
-	uint8_t sparksRemaining = 0;
+	// Additional sparks to fire after the first one.
+	// For single sparks, edgeCount is zero.
+	MultisparkBurst multispark;
 
 	/**
 	 * Desired timing advance
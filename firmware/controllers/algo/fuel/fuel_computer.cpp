@@ -43,7 +43,7 @@ float FuelComputer::getStoichiometricRatio() const {
 		secondary = 9.0f;
 	}
 
-	auto flex = Sensor::get(SensorType::FuelEthanolPercent);
+	auto flex = ENGINE(fastFrame).get(SensorType::FuelEthanolPercent);
 
 	// TODO: what do do if flex sensor fails?
 
@@ -65,9 +65,9 @@ float getLoadOverride(float defaultLoad, afr_override_e overrideMode DECLARE_ENG
 	switch(overrideMode) {
 		case AFR_None: return defaultLoad;
 		// MAP default to 200kpa - failed MAP goes rich
-		case AFR_MAP: return Sensor::get(SensorType::Map).value_or(200);
+		case AFR_MAP: return ENGINE(fastFrame).get(SensorType::Map).value_or(200);
 		// TPS/pedal default to 100% - failed TPS goes rich
-		case AFR_Tps: return Sensor::get(SensorType::Tps1).value_or(100);
+		case AFR_Tps: return ENGINE(fastFrame).get(SensorType::Tps1).value_or(100);
 		case AFR_AccPedal: return Sensor::get(SensorType::AcceleratorPedal).value_or(100);
 		case AFR_CylFilling: return 100 * ENGINE(engineState.sd.airMassInOneCylinder) / ENGINE(standardAirCharge);
 		default: return 0;
@@ -43,7 +43,7 @@ float InjectorModel::getInjectorFlowRatio() const {
 		return 1.0f;
 	}
 
-	auto map = Sensor::get(SensorType::Map);
+	auto map = ENGINE(fastFrame).get(SensorType::Map);
 
 	// Map has failed, assume nominal pressure
 	if (!map) {
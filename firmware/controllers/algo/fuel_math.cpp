@@ -79,14 +79,14 @@ DISPLAY(DISPLAY_IF(isCrankingState)) float getCrankingFuel3(
 	 * Cranking fuel is different depending on engine coolant temperature
 	 * If the sensor is failed, use 20 deg C
 	 */
-	auto clt = Sensor::get(SensorType::Clt);
+	auto clt = ENGINE(fastFrame).get(SensorType::Clt);
 	DISPLAY_TEXT(Coolant_coef);
 	engine->engineState.DISPLAY_PREFIX(cranking).DISPLAY_FIELD(coolantTemperatureCoefficient) =
 		interpolate2d(clt.value_or(20), config->crankingFuelBins, config->crankingFuelCoef);
 	DISPLAY_SENSOR(CLT);
 	DISPLAY_TEXT(eol);
 
-	auto tps = Sensor::get(SensorType::DriverThrottleIntent);
+	auto tps = ENGINE(fastFrame).get(SensorType::DriverThrottleIntent);
 
 	DISPLAY_TEXT(TPS_coef);
 	engine->engineState.DISPLAY_PREFIX(cranking).DISPLAY_FIELD(tpsCoefficient) = tps.Valid ? 1 : interpolate2d(tps.Value, engineConfiguration->crankingTpsBins,
@@ -365,7 +365,7 @@ void initFuelMap(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
  * @brief Engine warm-up fuel correction.
  */
 float getCltFuelCorrection(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
-	const auto [valid, clt] = Sensor::get(SensorType::Clt);
+	const auto [valid, clt] = ENGINE(fastFrame).get(SensorType::Clt);
 	
 	if (!valid)
 		return 1; // this error should be already reported somewhere else, let's just handle it
@@ -374,7 +374,7 @@ float getCltFuelCorrection(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 }
 
 angle_t getCltTimingCorrection(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
-	const auto [valid, clt] = Sensor::get(SensorType::Clt);
+	const auto [valid, clt] = ENGINE(fastFrame).get(SensorType::Clt);
 
 	if (!valid)
 		return 0; // this error should be already reported somewhere else, let's just handle it
@@ -383,7 +383,7 @@ angle_t getCltTimingCorrection(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 }
 
 float getIatFuelCorrection(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
-	const auto [valid, iat] = Sensor::get(SensorType::Iat);
+	const auto [valid, iat] = ENGINE(fastFrame).get(SensorType::Iat);
 
 	if (!valid)
 		return 1; // this error should be already reported somewhere else, let's just handle it
@@ -402,17 +402,17 @@ float getFuelCutOffCorrection(efitick_t nowNt, int rpm DECLARE_ENGINE_PARAMETER_
 
 	// coasting fuel cut-off correction
 	if (CONFIG(coastingFuelCutEnabled)) {
-		auto [tpsValid, tpsPos] = Sensor::get(SensorType::Tps1);
+		auto [tpsValid, tpsPos] = ENGINE(fastFrame).get(SensorType::Tps1);
 		if (!tpsValid) {
 			return 1.0f;
 		}
 
-		const auto [cltValid, clt] = Sensor::get(SensorType::Clt);
+		const auto [cltValid, clt] = ENGINE(fastFrame).get(SensorType::Clt);
 		if (!cltValid) {
 			return 1.0f;
 		}
 
-		const auto [mapValid, map] = Sensor::get(SensorType::Map);
+		const auto [mapValid, map] = ENGINE(fastFrame).get(SensorType::Map);
 		if (!mapValid) {
 			return 1.0f;
 		}
@@ -445,7 +445,7 @@ float getFuelCutOffCorrection(efitick_t nowNt, int rpm DECLARE_ENGINE_PARAMETER_
 float getBaroCorrection(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	if (Sensor::hasSensor(SensorType::BarometricPressure)) {
 		// Default to 1atm if failed
-		float pressure = Sensor::get(SensorType::BarometricPressure).value_or(101.325f);
+		float pressure = ENGINE(fastFrame).get(SensorType::BarometricPressure).value_or(101.325f);
 
 		float correction = baroCorrMap.getValue(GET_RPM(), pressure);
 		if (cisnan(correction) || correction < 0.01) {
@@ -0,0 +1,70 @@
+#include "global.h"
+#include "knock_controller.h"
+#include "engine.h"
+#include "efilib.h"
+
+EXTERN_ENGINE;
+
+// don't add back more than this much time worth of recovery after a stall of the fast callback
+#define MAX_RECOVERY_STEP_SEC 0.1f
+
+void KnockController::onKnockSense(size_t cylinderIndex, bool isKnock) {
+	if (!CONFIG(enableKnockControl) || !isKnock || cylinderIndex >= efi::size(m_retard)) {
+		return;
+	}
+
+	m_retard[cylinderIndex] = minF(m_retard[cylinderIndex] + CONFIG(knockRetardStep), CONFIG(maxKnockSubDeg));
+}
+
+void KnockController::onKnockSenseAllCylinders(bool isKnock) {
+	if (!isKnock) {
+		return;
+	}
+
+	for (size_t i = 0; i < efi::size(m_retard); i++) {
+		onKnockSense(i, true);
+	}
+}
+
+void KnockController::update(efitick_t nowNt) {
+	float dtSec = m_hasLastUpdate ? NT2US(nowNt - m_lastUpdateNt) / 1e6f : 0;
+	m_hasLastUpdate = true;
+	m_lastUpdateNt = nowNt;
+
+	float recovery = CONFIG(knockRetardRecoveryRate) * clampF(0, dtSec, MAX_RECOVERY_STEP_SEC);
+	float maxRetard = CONFIG(maxKnockSubDeg);
+
+	for (size_t i = 0; i < efi::size(m_retard); i++) {
+		// limit might have been lowered since the retard was applied
+		m_retard[i] = clampF(0, m_retard[i] - recovery, maxRetard);
+	}
+}
+
+void KnockController::reset() {
+	for (size_t i = 0; i < efi::size(m_retard); i++) {
+		m_retard[i] = 0;
+	}
+
+	m_hasLastUpdate = false;
+}
+
+angle_t KnockController::getRetard(size_t cylinderIndex) const {
+	if (!CONFIG(enableKnockControl) || cylinderIndex >= efi::size(m_retard)) {
+		return 0;
+	}
+
+	return m_retard[cylinderIndex];
+}
+
+angle_t KnockController::getMaxRetard() const {
+	float result = 0;
+	if (!CONFIG(enableKnockControl)) {
+		return result;
+	}
+
+	for (size_t i = 0; i < efi::size(m_retard); i++) {
+		result = maxF(result, m_retard[i]);
+	}
+
+	return result;
+}
@@ -0,0 +1,41 @@
+/**
+ * @file knock_controller.h
+ *
+ * Turns knock sensed on a cylinder into timing retard for that cylinder: every knocking event
+ * removes a fixed step, and the removed timing is added back at a constant rate while the
+ * cylinder stays quiet. Total retard is limited to maxKnockSubDeg. Nothing is retarded unless
+ * enableKnockControl is set.
+ */
+
+#pragma once
+
+#include "engine_ptr.h"
+#include "rusefi_types.h"
+
+class KnockController {
+public:
+	DECLARE_ENGINE_PTR;
+
+	// Result of one cylinder's knock window, software knock
+	void onKnockSense(size_t cylinderIndex, bool isKnock);
+	// Knock sensed without knowing which cylinder, HIP9011, CDM or external knock input
+	void onKnockSenseAllCylinders(bool isKnock);
+
+	// Called from the fast callback to add removed timing back
+	void update(efitick_t nowNt);
+	void reset();
+
+	// Degrees to retard this cylinder's spark by
+	angle_t getRetard(size_t cylinderIndex) const;
+	// Largest retard across cylinders
+	angle_t getMaxRetard() const;
+
+private:
+	// indexed by coil, which is the physical cylinder
+	// Knock is reported from interrupts and the knock thread while recovery runs on the fast callback.
+	// A lost update between the two is one step worth of timing and the loop corrects it.
+	float m_retard[IGNITION_PIN_COUNT] = {};
+
+	bool m_hasLastUpdate = false;
+	efitick_t m_lastUpdateNt = 0;
+};
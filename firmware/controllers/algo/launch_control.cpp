@@ -22,7 +22,7 @@
 #include "efi_gpio.h"
 #include "advance_map.h"
 #include "engine_state.h"
-#include "advance_map.h"
+#include "cut_pattern.h"
 
 static bool isInit = false;
 static Logging *logger;
@@ -144,7 +144,7 @@ void LaunchControlBase::update() {
 	bool combinedConditions = isLaunchConditionMet(rpm);
 	float timeDelay = CONFIG(launchActivateDelay);
 
-	//recalculate in periodic task, this way we save time in applyLaunchControlLimiting
+	//recalculate in periodic task, this way we save time in getLaunchCutPercent
 	//and still recalculat in case user changed the values
 	retardThresholdRpm = CONFIG(launchRpm) + (CONFIG(enableLaunchRetard) ? 
 	                     CONFIG(launchAdvanceRpmRange) : 0) + CONFIG(hardCutRpmRange);
@@ -198,11 +198,15 @@ void setDefaultLaunchParameters(DECLARE_CONFIG_PARAMETER_SIGNATURE) {
 
 }
 
-void applyLaunchControlLimiting(bool *limitedSpark, bool *limitedFuel DECLARE_ENGINE_PARAMETER_SUFFIX) {
-	if (( engine->isLaunchCondition ) && ( retardThresholdRpm < GET_RPM() )) {
-		*limitedSpark = engineConfiguration->launchSparkCutEnable;
-		*limitedFuel = engineConfiguration->launchFuelCutEnable;
-	} 
+/**
+ * Full cut above the hard cut threshold, partial cut inside of rollingCutRpmWindow below it
+ */
+percent_t getLaunchCutPercent(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (!engine->isLaunchCondition) {
+		return 0;
+	}
+
+	return getRollingCutPercent(rpm, retardThresholdRpm, CONFIG(rollingCutRpmWindow));
 }
 
 void initLaunchControl(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
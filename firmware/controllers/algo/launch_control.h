@@ -9,11 +9,12 @@
 
 #include "engine_ptr.h"
 #include "timer.h"
+#include "rusefi_types.h"
 
 class Logging;
 void initLaunchControl(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX);
 void setDefaultLaunchParameters(DECLARE_CONFIG_PARAMETER_SIGNATURE);
-void applyLaunchControlLimiting(bool *limitedSpark, bool *limitedFuel DECLARE_ENGINE_PARAMETER_SUFFIX);
+percent_t getLaunchCutPercent(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX);
 void updateLaunchConditions(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 
 class LaunchControlBase {
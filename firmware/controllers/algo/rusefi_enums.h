@@ -506,6 +506,10 @@ typedef enum {
 	 * log example: http://svn.code.sf.net/p/rusefi/code/trunk/misc/ms_logs/
 	 */
 	LM_MLV = 1,
+	/**
+	 * MLG with field deltas instead of full records, see log_delta_encoder.h
+	 */
+	LF_MLG_COMPRESSED = 2,
 
 	Force_4_bytes_size_log_format = ENUM_32_BITS,
 } log_format_e;
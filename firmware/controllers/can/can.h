@@ -10,6 +10,7 @@
 #include "hal.h"
 
 #include "periodic_thread_controller.h"
+#include "can_tx_schedule.h"
 
 #define CAN_PEDAL_TPS_OFFSET 2
 #define CAN_SENSOR_1_OFFSET 3
@@ -20,6 +21,17 @@ class Logging;
 class CanSensorBase;
 
 #if EFI_CAN_SUPPORT
+// Upper bound of CAN RX consumers: CAN sensors, OBD, CAN VSS and friends
+#define CAN_RX_HANDLER_COUNT 32
+
+typedef void (*CanRxHandler)(void* owner, const CANRxFrame& frame, efitick_t nowNt);
+
+/**
+ * Frames with this ID go to the handler, 11 bit standard or 29 bit extended frames only
+ * depending on isExtended. Meant to be called during init.
+ */
+void registerCanRxHandler(uint32_t id, bool isExtended, CanRxHandler handler, void* owner, const char* name);
+void initCanRx();
 void processCanRxMessage(const CANRxFrame& msg, Logging* logger, efitick_t nowNt);
 #endif // EFI_CAN_SUPPORT
 
@@ -30,8 +42,19 @@ void handleWidebandBootloaderAck();
 // Update the firmware on any connected wideband controller
 void updateWidebandFirmware(Logging*);
 
+/**
+ * Periodic message, the callback builds and sends the frame when its slot comes up.
+ * Meant to be called during init, before the TX thread starts.
+ */
+void registerCanTxMessage(void (*callback)(), int periodMs, int phaseMs, const char* name);
+void initCanVerbose();
+
+/**
+ * Ticks once per CAN_TX_SLOT_MS and sends the messages due in that slot
+ */
 class CanWrite final : public PeriodicController<512> {
 public:
 	CanWrite();
+	void start();
 	void PeriodicTask(efitime_t nowNt) override;
 };
@@ -0,0 +1,119 @@
+/**
+ * @file	can_codec.h
+ *
+ * Packing and unpacking of scaled signals at arbitrary bit positions of a CAN frame, with the
+ * same conventions as a DBC file: start bit, length, Intel (little endian) or Motorola
+ * (big endian) byte order, signedness, factor and offset.
+ *
+ * Message definitions using this live in can_codec_generated.h, see gen_can_codec.sh
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum class CanByteOrder : uint8_t {
+	// DBC @1, start bit is the least significant bit of the value
+	Intel,
+	// DBC @0, start bit is the most significant bit of the value
+	Motorola,
+};
+
+struct CanSignal {
+	uint8_t startBit;
+	// 1..32 bits
+	uint8_t length;
+	CanByteOrder order;
+	bool isSigned;
+	float factor;
+	float offset;
+
+	constexpr uint32_t getRaw(const uint8_t *data) const {
+		uint32_t raw = 0;
+
+		if (order == CanByteOrder::Intel) {
+			for (int i = length - 1; i >= 0; i--) {
+				raw = (raw << 1) | getBit(data, startBit + i);
+			}
+		} else {
+			size_t position = startBit;
+			for (int i = 0; i < length; i++) {
+				raw = (raw << 1) | getBit(data, position);
+				position = nextMotorolaBit(position);
+			}
+		}
+
+		return raw;
+	}
+
+	constexpr void setRaw(uint8_t *data, uint32_t raw) const {
+		if (order == CanByteOrder::Intel) {
+			for (int i = 0; i < length; i++) {
+				setBit(data, startBit + i, (raw >> i) & 1);
+			}
+		} else {
+			size_t position = startBit;
+			for (int i = length - 1; i >= 0; i--) {
+				setBit(data, position, (raw >> i) & 1);
+				position = nextMotorolaBit(position);
+			}
+		}
+	}
+
+	constexpr float decode(const uint8_t *data) const {
+		uint32_t raw = getRaw(data);
+
+		if (isSigned && length < 32 && (raw >> (length - 1)) & 1) {
+			// sign extend
+			raw |= ~0u << length;
+		}
+
+		float value = isSigned ? (float)(int32_t)raw : (float)raw;
+		return value * factor + offset;
+	}
+
+	/**
+	 * Rounded to the nearest step, values outside of what the signal can carry are saturated
+	 */
+	constexpr void encode(uint8_t *data, float value) const {
+		float scaled = (value - offset) / factor;
+
+		int64_t raw = 0;
+		if (scaled != scaled) {
+			// NaN goes out as raw zero
+		} else if (scaled <= rawMin()) {
+			raw = rawMin();
+		} else if (scaled >= rawMax()) {
+			raw = rawMax();
+		} else {
+			raw = (int64_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+			raw = raw > rawMax() ? rawMax() : raw;
+		}
+
+		setRaw(data, (uint32_t)raw);
+	}
+
+private:
+	constexpr int64_t rawMin() const {
+		return isSigned ? -(1ll << (length - 1)) : 0;
+	}
+
+	constexpr int64_t rawMax() const {
+		return isSigned ? (1ll << (length - 1)) - 1 : (1ll << length) - 1;
+	}
+
+	static constexpr uint32_t getBit(const uint8_t *data, size_t position) {
+		return (data[position / 8] >> (position % 8)) & 1;
+	}
+
+	static constexpr void setBit(uint8_t *data, size_t position, uint32_t bit) {
+		uint8_t mask = 1 << (position % 8);
+		data[position / 8] = bit ? (data[position / 8] | mask) : (data[position / 8] & ~mask);
+	}
+
+	// Motorola signals continue from bit 0 of a byte to bit 7 of the following byte
+	static constexpr size_t nextMotorolaBit(size_t position) {
+		return position % 8 == 0 ? position + 15 : position - 1;
+	}
+};
@@ -13,6 +13,7 @@
 #include "engine.h"
 #include "can_dash.h"
 #include "can_msg_tx.h"
+#include "can_codec_generated.h"
 
 #include "sensor.h"
 #include "allsensors.h"
@@ -22,6 +23,7 @@
 EXTERN_ENGINE;
 
 // CAN Bus ID for broadcast
+// Frames carrying signals are described in integration/can/dashboards.dbc, see gen_can_codec.sh
 /**
  * e46 data is from http://forums.bimmerforums.com/forum/showthread.php?1887229
  *
@@ -30,24 +32,12 @@ EXTERN_ENGINE;
  * All the below packets are using 500kb/s
  *
  */
-#define CAN_BMW_E46_SPEED 0x153
-#define CAN_BMW_E46_RPM 0x316
-#define CAN_BMW_E46_DME2 0x329
 #define CAN_BMW_E46_CLUSTER_STATUS 0x613
 #define CAN_BMW_E46_CLUSTER_STATUS_2 0x615
-#define CAN_FIAT_MOTOR_INFO 0x561
-#define CAN_MAZDA_RX_RPM_SPEED 0x201
 #define CAN_MAZDA_RX_STEERING_WARNING 0x300
 #define CAN_MAZDA_RX_STATUS_1 0x212
-#define CAN_MAZDA_RX_STATUS_2 0x420
-// https://wiki.openstreetmap.org/wiki/VW-CAN
-#define CAN_VAG_RPM 0x280
-#define CAN_VAG_CLT 0x288
-#define CAN_VAG_CLT_V2 0x420
-#define CAN_VAG_IMMO 0x3D0
+// VAG: https://wiki.openstreetmap.org/wiki/VW-CAN
 //w202 DASH
-#define W202_STAT_1	0x308
-#define W202_STAT_2 0x608
 #define W202_ALIVE	0x210
 #define W202_STAT_3 0x310
 
@@ -84,18 +74,21 @@ constexpr uint8_t e90_temp_offset = 49;
 void canDashboardBMW(void) {
 	//BMW Dashboard
 	{
-		CanTxMessage msg(CAN_BMW_E46_SPEED);
-		msg.setShortValue(10 * 8, 1);
+		BmwE46Speed msg;
+		msg.speed = 10;
+		transmitMessage(msg);
 	}
 
 	{
-		CanTxMessage msg(CAN_BMW_E46_RPM);
-		msg.setShortValue((int) (GET_RPM() * 6.4), 2);
+		BmwE46Rpm msg;
+		msg.rpm = GET_RPM();
+		transmitMessage(msg);
 	}
 
 	{
-		CanTxMessage msg(CAN_BMW_E46_DME2);
-		msg.setShortValue((int) ((Sensor::get(SensorType::Clt).value_or(0) + 48.373) / 0.75), 1);
+		BmwE46Dme2 msg;
+		msg.clt = Sensor::get(SensorType::Clt).value_or(0);
+		transmitMessage(msg);
 	}
 }
 
@@ -106,14 +99,11 @@ void canMazdaRX8(void) {
 	}
 
 	{
-		CanTxMessage msg(CAN_MAZDA_RX_RPM_SPEED);
-
-		float kph = getVehicleSpeed();
-
-		msg.setShortValue(SWAP_UINT16(GET_RPM() * 4), 0);
-		msg.setShortValue(0xFFFF, 2);
-		msg.setShortValue(SWAP_UINT16((int )(100 * kph + 10000)), 4);
-		msg.setShortValue(0, 6);
+		MazdaRx8RpmSpeed msg;
+		msg.rpm = GET_RPM();
+		msg.unknown = 0xFFFF;
+		msg.speed = getVehicleSpeed();
+		transmitMessage(msg);
 	}
 
 	{
@@ -129,69 +119,67 @@ void canMazdaRX8(void) {
 	}
 
 	{
-		CanTxMessage msg(CAN_MAZDA_RX_STATUS_2);
+		MazdaRx8Status2 msg;
 		auto clt = Sensor::get(SensorType::Clt);
-		msg[0] = (uint8_t)(clt.value_or(0) + 69); //temp gauge //~170 is red, ~165 last bar, 152 centre, 90 first bar, 92 second bar
-		msg[1] = ((int16_t)(engine->engineState.vssEventCounter*(engineConfiguration->vehicleSpeedCoef*0.277*2.58))) & 0xff;
-		msg[2] = 0x00; // unknown
-		msg[3] = 0x00; //unknown
-		msg[4] = 0x01; //Oil Pressure (not really a gauge)
-		msg[5] = 0x00; //check engine light
-		msg[6] = 0x00; //Coolant, oil and battery
-		if ((GET_RPM()>0) && (engine->sensors.vBatt<13)) {
-			msg.setBit(6, 6); // battery light
-		}
-		if (!clt.Valid || clt.Value > 105) {
-			// coolant light, 101 - red zone, light means its get too hot
-			// Also turn on the light in case of sensor failure
-			msg.setBit(6, 1);
-		}
+		msg.clt = clt.value_or(0); //temp gauge //~170 is red, ~165 last bar, 152 centre, 90 first bar, 92 second bar
+		msg.odometer = ((int16_t)(engine->engineState.vssEventCounter*(engineConfiguration->vehicleSpeedCoef*0.277*2.58))) & 0xff;
+		msg.oilPressure = 1; //Oil Pressure (not really a gauge)
+		msg.batteryLight = (GET_RPM() > 0) && (engine->sensors.vBatt < 13);
+		// coolant light, 101 - red zone, light means its get too hot
+		// Also turn on the light in case of sensor failure
+		msg.coolantLight = !clt.Valid || clt.Value > 105;
 		//oil pressure warning lamp bit is 7
-		msg[7] = 0x00; //unused
+		transmitMessage(msg);
 	}
 }
 
 void canDashboardFiat(void) {
 	{
 		//Fiat Dashboard
-		CanTxMessage msg(CAN_FIAT_MOTOR_INFO);
-		msg.setShortValue((int) (Sensor::get(SensorType::Clt).value_or(0) - 40), 3); //Coolant Temp
-		msg.setShortValue(GET_RPM() / 32, 6); //RPM
+		FiatMotorInfo msg;
+		msg.clt = Sensor::get(SensorType::Clt).value_or(0);
+		msg.rpm = GET_RPM();
+		transmitMessage(msg);
 	}
 }
 
 void canDashboardVAG(void) {
 	{
 		//VAG Dashboard
-		CanTxMessage msg(CAN_VAG_RPM);
-		msg.setShortValue(GET_RPM() * 4, 2); //RPM
+		VagRpm msg;
+		msg.rpm = GET_RPM();
+		transmitMessage(msg);
 	}
 
 	float clt = Sensor::get(SensorType::Clt).value_or(0);
 
 	{
-		CanTxMessage msg(CAN_VAG_CLT);
-		msg.setShortValue((int) ((clt + 48.373) / 0.75), 1); //Coolant Temp
+		VagClt msg;
+		msg.clt = clt;
+		transmitMessage(msg);
 	}
 
 	{
-		CanTxMessage msg(CAN_VAG_CLT_V2);
-		msg.setShortValue((int) ((clt + 48.373) / 0.75), 4); //Coolant Temp
+		VagCltV2 msg;
+		msg.clt = clt;
+		transmitMessage(msg);
 	}
 
 	{
-		CanTxMessage msg(CAN_VAG_IMMO);
-		msg.setShortValue(0x80, 1);
+		VagImmo msg;
+		msg.immo = 0x80;
+		transmitMessage(msg);
 	}
 }
 
 void canDashboardW202(void) {
 	{
-		CanTxMessage msg(W202_STAT_1);
-		uint16_t tmp = GET_RPM();
+		W202Stat1 stat1;
+		stat1.rpm = GET_RPM();
+
+		CanTxMessage msg(W202Stat1::id);
+		stat1.pack(&msg[0]);
 		msg[0] = 0x08; // Unknown
-		msg[1] = (tmp >> 8); //RPM
-		msg[2] = (tmp & 0xff); //RPM
 		msg[3] = 0x00; // 0x01 - tank blink, 0x02 - EPC
 		msg[4] = 0x00; // Unknown
 		msg[5] = 0x00; // Unknown
@@ -200,8 +188,11 @@ void canDashboardW202(void) {
 	}
 
 	{
-		CanTxMessage msg(W202_STAT_2); //dlc 7
-		msg[0] = (int)(Sensor::get(SensorType::Clt).value_or(0) + 40); // CLT -40 offset
+		W202Stat2 stat2;
+		stat2.clt = Sensor::get(SensorType::Clt).value_or(0);
+
+		CanTxMessage msg(W202Stat2::id); //dlc 7
+		stat2.pack(&msg[0]);
 		msg[1] = 0x3D; // TBD
 		msg[2] = 0x63; // Const
 		msg[3] = 0x41; // Const
@@ -59,6 +59,10 @@ bool acceptCanRx(int sid DECLARE_ENGINE_PARAMETER_SUFFIX) {
 #include "engine.h"
 #include "can_sensor.h"
 #include "can_vss.h"
+#include "can_rx_dispatch.h"
+#include "can_codec_generated.h"
+
+extern LoggingWithStorage sharedLogger;
 
 /**
  * this build-in CAN sniffer is very basic but that's our CAN sniffer
@@ -82,47 +86,73 @@ volatile float canMap = 0;
 
 CanSensorBase *cansensors_head = nullptr;
 
-void serviceCanSubscribers(const CANRxFrame &frame, efitick_t nowNt) {
-	CanSensorBase *current = cansensors_head;
+static CanRxDispatchTable<CANRxFrame, CAN_RX_HANDLER_COUNT> canRxHandlers;
+
+void registerCanRxHandler(uint32_t id, bool isExtended, CanRxHandler handler, void *owner, const char *name) {
+	// sensors are registered after the RX thread is started, at worst one frame arriving during
+	// boot is missed or seen twice
+	bool added;
+	{
+		chibios_rt::CriticalSectionLocker csl;
+		added = canRxHandlers.add(id, isExtended, handler, owner, name);
+	}
 
-	while (current) {
-		current = current->processFrame(frame, nowNt);
+	if (!added) {
+		firmwareError(CUSTOM_ERR_CAN_CONFIGURATION, "Too many CAN RX handlers, %s not registered", name);
 	}
 }
 
 void registerCanSensor(CanSensorBase &sensor) {
+	// the list is still walked for OBD requests
 	sensor.setNext(cansensors_head);
 	cansensors_head = &sensor;
 	sensor.Register();
+
+	registerCanRxHandler(sensor.getEid(), sensor.isExtended(), [](void *owner, const CANRxFrame &frame, efitick_t nowNt) {
+		static_cast<CanSensorBase*>(owner)->processFrame(frame, nowNt);
+	}, &sensor, sensor.getSensorName());
 }
 
-void processCanRxMessage(const CANRxFrame &frame, Logging *logger,
-		efitick_t nowNt) {
-	if (CONFIG(debugMode) == DBG_CAN) {
-		printPacket(frame, logger);
+static void canRxInfo() {
+	for (size_t i = 0; i < canRxHandlers.getCount(); i++) {
+		auto &e = canRxHandlers.get(i);
+		scheduleMsg(&sharedLogger, "CAN RX %x%s %s: %d frames", e.id, e.isExtended ? " ext" : "", e.name, e.hits);
 	}
 
-	serviceCanSubscribers(frame, nowNt);
+	scheduleMsg(&sharedLogger, "CAN RX unknown ID frames dropped: %d", canRxHandlers.getUnknownCount());
+}
+
+void initCanRx() {
+	addConsoleAction("canrxinfo", canRxInfo);
 
-	//Vss is configurable, should we handle it here:
-	processCanRxVss(frame, nowNt);
+	registerCanRxHandler(OBD_TEST_REQUEST, false, [](void *, const CANRxFrame &frame, efitick_t nowNt) {
+		obdOnCanPacketRx(frame, nowNt);
+	}, nullptr, "OBD");
+	registerCanRxHandler(OBD_PHYSICAL_REQUEST, false, [](void *, const CANRxFrame &frame, efitick_t nowNt) {
+		obdOnCanPacketRx(frame, nowNt);
+	}, nullptr, "OBD physical");
 
 #if EFI_CANBUS_SLAVE
-	if (frame.EID == CONFIG(verboseCanBaseAddress) + CAN_SENSOR_1_OFFSET) {
-		int16_t mapScaled = *reinterpret_cast<const int16_t*>(&frame.data8[0]);
-		canMap = mapScaled / (1.0 * PACK_MULT_PRESSURE);
-	} else
+	registerCanRxHandler(CONFIG(verboseCanBaseAddress) + CAN_SENSOR_1_OFFSET, false, [](void *, const CANRxFrame &frame, efitick_t) {
+		canMap = VerboseSensors1::mapSignal.decode(frame.data8);
+	}, nullptr, "MAP");
 #endif
-	{
-		obdOnCanPacketRx(frame);
-	}
 
 #if EFI_WIDEBAND_FIRMWARE_UPDATE
 	// Bootloader acks with address 0x727573 aka ascii "rus"
-	if (frame.EID == 0x727573) {
+	registerCanRxHandler(0x727573, true, [](void *, const CANRxFrame &, efitick_t) {
 		handleWidebandBootloaderAck();
-	}
+	}, nullptr, "wideband bootloader");
 #endif
 }
 
+void processCanRxMessage(const CANRxFrame &frame, Logging *logger,
+		efitick_t nowNt) {
+	if (CONFIG(debugMode) == DBG_CAN) {
+		printPacket(frame, logger);
+	}
+
+	canRxHandlers.dispatch(frame, nowNt);
+}
+
 #endif // EFI_CAN_SUPPORT
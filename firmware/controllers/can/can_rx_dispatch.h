@@ -0,0 +1,146 @@
+/**
+ * @file	can_rx_dispatch.h
+ *
+ * Routing of received CAN frames to the subsystems which consume them, keyed by frame ID.
+ * Standard and extended IDs are separate keys, 0x100 standard and 0x100 extended are different
+ * frames.
+ *
+ * Handlers are registered at init into a table sorted by ID. A 256 bit filter over the
+ * registered IDs rejects most frames nobody listens to in constant time, so a busy vehicle bus
+ * costs one bit test per unrelated frame instead of a walk over every consumer.
+ */
+
+#pragma once
+
+#include "rusefi_types.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// bit 31 is never part of a 29 bit ID, it keeps extended keys apart from standard ones
+#define CAN_RX_EXTENDED_KEY 0x80000000u
+
+template <typename TFrame, size_t TSize>
+class CanRxDispatchTable {
+public:
+	using Handler = void (*)(void *owner, const TFrame &frame, efitick_t nowNt);
+
+	struct Entry {
+		uint32_t id;
+		bool isExtended;
+		Handler handler;
+		void *owner;
+		const char *name;
+		// frames delivered to this handler
+		uint32_t hits;
+	};
+
+	/**
+	 * Handlers sharing an ID are called in the order they were added.
+	 * @return false if the table is full
+	 */
+	bool add(uint32_t id, bool isExtended, Handler handler, void *owner, const char *name) {
+		if (m_count >= TSize) {
+			return false;
+		}
+
+		uint32_t key = makeKey(id, isExtended);
+
+		// insert after every entry with the same or lower key, table stays sorted
+		size_t position = m_count;
+		while (position > 0 && keyOf(m_entries[position - 1]) > key) {
+			m_entries[position] = m_entries[position - 1];
+			position--;
+		}
+
+		m_entries[position] = { id, isExtended, handler, owner, name, 0 };
+		m_count++;
+
+		m_filter[bucket(key) / 32] |= 1u << (bucket(key) % 32);
+
+		return true;
+	}
+
+	/**
+	 * @return number of handlers the frame was delivered to
+	 */
+	size_t dispatch(const TFrame &frame, efitick_t nowNt) {
+		// SID and EID share storage and a standard frame only writes the low 11 bits, the rest
+		// of EID is whatever the previous extended frame in the same buffer left there
+		uint32_t key = frame.IDE ? makeKey(frame.EID, true) : makeKey(frame.SID, false);
+
+		if (!(m_filter[bucket(key) / 32] & (1u << (bucket(key) % 32)))) {
+			m_unknownCount++;
+			return 0;
+		}
+
+		// lower bound of the key
+		size_t low = 0;
+		size_t high = m_count;
+		while (low < high) {
+			size_t middle = (low + high) / 2;
+			if (keyOf(m_entries[middle]) < key) {
+				low = middle + 1;
+			} else {
+				high = middle;
+			}
+		}
+
+		size_t delivered = 0;
+		for (size_t i = low; i < m_count && keyOf(m_entries[i]) == key; i++) {
+			Entry &e = m_entries[i];
+			e.hits++;
+			e.handler(e.owner, frame, nowNt);
+			delivered++;
+		}
+
+		if (delivered == 0) {
+			// filter collision with a registered ID
+			m_unknownCount++;
+		}
+
+		return delivered;
+	}
+
+	void clear() {
+		m_count = 0;
+		m_unknownCount = 0;
+
+		for (auto &word : m_filter) {
+			word = 0;
+		}
+	}
+
+	size_t getCount() const {
+		return m_count;
+	}
+
+	const Entry& get(size_t index) const {
+		return m_entries[index];
+	}
+
+	// frames dropped because no handler is registered for their ID
+	uint32_t getUnknownCount() const {
+		return m_unknownCount;
+	}
+
+private:
+	static uint32_t makeKey(uint32_t id, bool isExtended) {
+		return isExtended ? (id | CAN_RX_EXTENDED_KEY) : (id & 0x7FF);
+	}
+
+	static uint32_t keyOf(const Entry &e) {
+		return makeKey(e.id, e.isExtended);
+	}
+
+	static uint8_t bucket(uint32_t key) {
+		// fold all 29 bits, both standard and extended IDs spread over the filter
+		return key ^ (key >> 8) ^ (key >> 16) ^ (key >> 24);
+	}
+
+	Entry m_entries[TSize];
+	size_t m_count = 0;
+
+	uint32_t m_filter[256 / 32] = {};
+	uint32_t m_unknownCount = 0;
+};
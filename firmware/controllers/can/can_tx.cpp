@@ -22,25 +22,28 @@ EXTERN_ENGINE;
 
 extern CanSensorBase* cansensors_head;
 
-CanWrite::CanWrite()
-	: PeriodicController("CAN TX", PRIO_CAN_TX, 50)
-{
-}
+// Upper bound of periodic CAN TX messages
+#define CAN_TX_MESSAGE_COUNT 16
 
-void CanWrite::PeriodicTask(efitime_t nowNt) {
-	UNUSED(nowNt);
+static CanTxSchedule<CAN_TX_MESSAGE_COUNT> canTxSchedule;
+
+extern LoggingWithStorage sharedLogger;
 
-	if (CONFIG(enableVerboseCanTx)) {
-		void sendCanVerbose();
-		sendCanVerbose();
+void registerCanTxMessage(void (*callback)(), int periodMs, int phaseMs, const char* name) {
+	if (!canTxSchedule.add(callback, periodMs, phaseMs, name)) {
+		firmwareError(CUSTOM_ERR_CAN_CONFIGURATION, "Too many CAN TX messages, %s not registered", name);
 	}
+}
 
+static void requestCanSensors() {
 	CanSensorBase* current = cansensors_head;
 
 	while (current) {
 		current = current->request();
 	}
+}
 
+static void sendDashboard() {
 	// Transmit dash data, if enabled
 	switch (CONFIG(canNbcType)) {
 	case CAN_BUS_NBC_BMW:
@@ -66,4 +69,39 @@ void CanWrite::PeriodicTask(efitime_t nowNt) {
 	}
 }
 
+static void canTxInfo() {
+	for (size_t i = 0; i < canTxSchedule.getCount(); i++) {
+		auto &e = canTxSchedule.get(i);
+		scheduleMsg(&sharedLogger, "CAN TX %s: every %d ms at +%d ms, sent %d times", e.name,
+				e.period * CAN_TX_SLOT_MS, e.phase * CAN_TX_SLOT_MS, e.runs);
+	}
+}
+
+CanWrite::CanWrite()
+	: PeriodicController("CAN TX", PRIO_CAN_TX, 1000 / CAN_TX_SLOT_MS)
+{
+}
+
+void CanWrite::start() {
+	addConsoleAction("cantxinfo", canTxInfo);
+
+	initCanVerbose();
+
+	// OBD requests wait for the response right in this thread, keep them out of the way of
+	// everything else
+	registerCanTxMessage(requestCanSensors, CONFIG(canSleepPeriodMs), CAN_TX_AUTO_PHASE, "CAN sensor requests");
+	// dashboard protocols count messages, they keep the period they were tuned at
+	registerCanTxMessage(sendDashboard, CONFIG(canSleepPeriodMs), CAN_TX_AUTO_PHASE, "dashboard");
+	// Consecutive Frames of multi frame OBD responses which wait for the STmin of the scan tool
+	registerCanTxMessage(obdTransmitPending, CAN_TX_SLOT_MS, 0, "OBD multi frame");
+
+	Start();
+}
+
+void CanWrite::PeriodicTask(efitime_t nowNt) {
+	UNUSED(nowNt);
+
+	canTxSchedule.onSlot();
+}
+
 #endif // EFI_CAN_SUPPORT
@@ -0,0 +1,143 @@
+/**
+ * @file	can_tx_schedule.h
+ *
+ * Time slotted schedule of periodic CAN transmissions. The TX thread ticks once per slot and
+ * each message is built and sent only in the slots that belong to it, at its own period.
+ *
+ * Messages registered without a phase are placed in the slot which collides least with what
+ * is already scheduled, so frames sharing a period are spread out instead of all going out in
+ * the same slot.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Length of one TX slot, also the shortest period a message can have
+#define CAN_TX_SLOT_MS 10
+
+// Pass as phase to let the schedule pick the least loaded slot
+#define CAN_TX_AUTO_PHASE -1
+
+template <size_t TSize>
+class CanTxSchedule {
+public:
+	using Callback = void (*)();
+
+	struct Entry {
+		Callback callback;
+		const char *name;
+		// in slots
+		uint16_t period;
+		uint16_t phase;
+		// number of times the message was due
+		uint32_t runs;
+	};
+
+	/**
+	 * @param periodMs rounded down to whole slots, at least one
+	 * @param phaseMs offset of the first transmission, or CAN_TX_AUTO_PHASE
+	 * @return false if the schedule is full
+	 */
+	bool add(Callback callback, int periodMs, int phaseMs, const char *name) {
+		if (m_count >= TSize) {
+			return false;
+		}
+
+		uint16_t period = periodMs < CAN_TX_SLOT_MS ? 1 : periodMs / CAN_TX_SLOT_MS;
+		uint16_t phase = phaseMs == CAN_TX_AUTO_PHASE ? findQuietPhase(period) : (phaseMs / CAN_TX_SLOT_MS) % period;
+
+		m_entries[m_count++] = { callback, name, period, phase, 0 };
+		return true;
+	}
+
+	/**
+	 * Sends everything due in the current slot and moves on to the next one
+	 * @return number of messages sent in this slot
+	 */
+	size_t onSlot() {
+		size_t sent = 0;
+
+		for (size_t i = 0; i < m_count; i++) {
+			Entry &e = m_entries[i];
+
+			if (m_slot % e.period == e.phase) {
+				e.runs++;
+				e.callback();
+				sent++;
+			}
+		}
+
+		m_slot++;
+		return sent;
+	}
+
+	/**
+	 * Number of messages which would be sent in the given slot
+	 */
+	size_t getLoad(uint32_t slot) const {
+		size_t load = 0;
+
+		for (size_t i = 0; i < m_count; i++) {
+			if (slot % m_entries[i].period == m_entries[i].phase) {
+				load++;
+			}
+		}
+
+		return load;
+	}
+
+	size_t getCount() const {
+		return m_count;
+	}
+
+	const Entry& get(size_t index) const {
+		return m_entries[index];
+	}
+
+private:
+	static uint16_t gcd(uint16_t a, uint16_t b) {
+		while (b) {
+			uint16_t t = a % b;
+			a = b;
+			b = t;
+		}
+		return a;
+	}
+
+	/**
+	 * Two periodic messages ever share a slot only if their phases are equal modulo the gcd of
+	 * their periods, and then they meet once every lcm of the periods. Pick the phase with the
+	 * lowest rate of such meetings.
+	 */
+	uint16_t findQuietPhase(uint16_t period) const {
+		uint16_t best = 0;
+		float bestCost = 0;
+
+		for (uint16_t phase = 0; phase < period; phase++) {
+			float cost = 0;
+
+			for (size_t i = 0; i < m_count; i++) {
+				const Entry &e = m_entries[i];
+				uint16_t g = gcd(period, e.period);
+
+				if (phase % g == e.phase % g) {
+					// meetings per slot: 1 / lcm
+					cost += (float)g / ((uint32_t)period * e.period);
+				}
+			}
+
+			if (phase == 0 || cost < bestCost) {
+				best = phase;
+				bestCost = cost;
+			}
+		}
+
+		return best;
+	}
+
+	Entry m_entries[TSize];
+	size_t m_count = 0;
+	uint32_t m_slot = 0;
+};
@@ -3,6 +3,8 @@
  *
  * TODO: change 'verbose' into 'broadcast'?
  *
+ * Frame layout is in integration/can/rusefi_verbose.dbc
+ *
  * @author Matthew Kennedy, (c) 2020
  */
 
@@ -11,8 +13,8 @@
 
 #include "engine.h"
 
-#include "scaled_channel.h"
 #include "can_msg_tx.h"
+#include "can_codec_generated.h"
 #include "sensor.h"
 #include "can.h"
 #include "allsensors.h"
@@ -22,24 +24,11 @@
 
 EXTERN_ENGINE;
 
-struct Status {
-    uint16_t warningCounter;
-    uint16_t lastErrorCode;
-
-    uint8_t revLimit : 1;
-    uint8_t mainRelay : 1;
-    uint8_t fuelPump : 1;
-    uint8_t checkEngine : 1;
-    uint8_t o2Heater : 1;
-
-    uint8_t pad6 : 1;
-    uint8_t pad7 : 1;
-    uint8_t pad8 : 1;
+// IDs in the DBC are for the default base address
+static_assert(VerbosePedalAndTps::id == CAN_DEFAULT_BASE + CAN_PEDAL_TPS_OFFSET);
+static_assert(VerboseSensors1::id == CAN_DEFAULT_BASE + CAN_SENSOR_1_OFFSET);
 
-    uint8_t pad[3];
-};
-
-static void populateFrame(Status& msg) {
+static void populateFrame(VerboseStatus& msg) {
     msg.warningCounter = engine->engineState.warnings.warningCounter;
     msg.lastErrorCode = engine->engineState.warnings.lastErrorCode;
 
@@ -50,16 +39,7 @@ static void populateFrame(Status& msg) {
     msg.o2Heater = enginePins.o2heater.getLogicValue();
 }
 
-struct Speeds {
-    uint16_t rpm;
-    scaled_angle timing;
-    scaled_channel<uint8_t, 2> injDuty;
-    scaled_channel<uint8_t, 2> coilDuty;
-    scaled_channel<uint8_t> vssKph;
-    uint8_t pad[1];
-};
-
-static void populateFrame(Speeds& msg) {
+static void populateFrame(VerboseSpeeds& msg) {
     auto rpm = GET_RPM();
     msg.rpm = rpm;
 
@@ -72,83 +52,62 @@ static void populateFrame(Speeds& msg) {
     msg.vssKph = getVehicleSpeed();
 }
 
-struct PedalAndTps {
-    scaled_percent pedal;
-    scaled_percent tps1;
-    scaled_percent tps2;
-    uint8_t pad[2];
-};
-
-static void populateFrame(PedalAndTps& msg)
+static void populateFrame(VerbosePedalAndTps& msg)
 {
     msg.pedal = Sensor::get(SensorType::AcceleratorPedal).value_or(-1);
     msg.tps1 = Sensor::get(SensorType::Tps1).value_or(-1);
     msg.tps2 = Sensor::get(SensorType::Tps2).value_or(-1);
 }
 
-struct Sensors1 {
-    scaled_pressure map;
-    scaled_channel<uint8_t> clt;
-    scaled_channel<uint8_t> iat;
-    scaled_channel<uint8_t> aux1;
-    scaled_channel<uint8_t> aux2;
-    scaled_channel<uint8_t> mcuTemp;
-    scaled_channel<uint8_t, 2> fuelLevel;
-};
-
-static void populateFrame(Sensors1& msg) {
+static void populateFrame(VerboseSensors1& msg) {
     msg.map = Sensor::get(SensorType::Map).value_or(0);
 
-    msg.clt = Sensor::get(SensorType::Clt).value_or(0) + PACK_ADD_TEMPERATURE;
-    msg.iat = Sensor::get(SensorType::Iat).value_or(0) + PACK_ADD_TEMPERATURE;
+    msg.clt = Sensor::get(SensorType::Clt).value_or(0);
+    msg.iat = Sensor::get(SensorType::Iat).value_or(0);
 
-    // todo: does aux temp even work?
-    msg.aux1 = 0 + PACK_ADD_TEMPERATURE;
-    msg.aux2 = 0 + PACK_ADD_TEMPERATURE;
+    msg.aux1 = 0;
+    msg.aux2 = 0;
 
     msg.mcuTemp = getMCUInternalTemperature();
     msg.fuelLevel = engine->sensors.fuelTankLevel;
 }
 
-struct Sensors2 {
-    scaled_afr afr;
-    scaled_pressure oilPressure;
-    scaled_angle vvtPos;
-    scaled_voltage vbatt;
-};
-
-static void populateFrame(Sensors2& msg) {
+static void populateFrame(VerboseSensors2& msg) {
     msg.afr = Sensor::get(SensorType::Lambda1).value_or(0) * 14.7f;
     msg.oilPressure = Sensor::get(SensorType::OilPressure).value_or(-1);
     msg.vvtPos = engine->triggerCentral.getVVTPosition();
     msg.vbatt = Sensor::get(SensorType::BatteryVoltage).value_or(0);
 }
 
-struct Fueling {
-    scaled_channel<uint16_t, 1000> cylAirmass;
-    scaled_channel<uint16_t, 100> estAirflow;
-    scaled_ms fuel_pulse;
-    scaled_percent stft;
-};
-
-static void populateFrame(Fueling& msg) {
+static void populateFrame(VerboseFueling& msg) {
     msg.cylAirmass = engine->engineState.sd.airMassInOneCylinder;
     msg.estAirflow = engine->engineState.airFlow;
-    msg.fuel_pulse = engine->actualLastInjection;
+    msg.fuelPulse = engine->actualLastInjection;
 
-    // todo
     msg.stft = 0;
 }
 
-void sendCanVerbose() {
-    auto base = CONFIG(verboseCanBaseAddress);
+template <typename TMessage>
+static void sendCanVerbose() {
+    if (!CONFIG(enableVerboseCanTx)) {
+        return;
+    }
+
+    TMessage msg;
+    populateFrame(msg);
+    transmitMessage(msg, CONFIG(verboseCanBaseAddress) + TMessage::id - CAN_DEFAULT_BASE);
+}
+
+void initCanVerbose() {
+    // what a dash or logger reacts to quickly goes out every slot, slow moving values less often
+    auto period = CONFIG(canSleepPeriodMs);
 
-    transmitStruct<Status>      (base + 0);
-    transmitStruct<Speeds>      (base + 1);
-    transmitStruct<PedalAndTps> (base + CAN_PEDAL_TPS_OFFSET);
-    transmitStruct<Sensors1>    (base + CAN_SENSOR_1_OFFSET);
-    transmitStruct<Sensors2>    (base + 4);
-    transmitStruct<Fueling>     (base + 5);
+    registerCanTxMessage(sendCanVerbose<VerboseStatus>, 1000, CAN_TX_AUTO_PHASE, "verbose status");
+    registerCanTxMessage(sendCanVerbose<VerboseSpeeds>, CAN_TX_SLOT_MS, CAN_TX_AUTO_PHASE, "verbose speeds");
+    registerCanTxMessage(sendCanVerbose<VerbosePedalAndTps>, CAN_TX_SLOT_MS, CAN_TX_AUTO_PHASE, "verbose pedal");
+    registerCanTxMessage(sendCanVerbose<VerboseSensors1>, period, CAN_TX_AUTO_PHASE, "verbose sensors 1");
+    registerCanTxMessage(sendCanVerbose<VerboseSensors2>, period, CAN_TX_AUTO_PHASE, "verbose sensors 2");
+    registerCanTxMessage(sendCanVerbose<VerboseFueling>, period, CAN_TX_AUTO_PHASE, "verbose fueling");
 }
 
 #endif // EFI_CAN_SUPPORT
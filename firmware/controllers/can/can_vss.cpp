@@ -14,6 +14,7 @@
 #include "engine.h"
 #include "vehicle_speed.h"
 #include "dynoview.h"
+#include "can_codec_generated.h"
 
 EXTERN_ENGINE;
 
@@ -29,10 +30,10 @@ uint16_t look_up_can_id(can_vss_nbc_e type) {
     uint16_t retCanID;
     switch (type) {
         case BMW_e46:
-            retCanID = 0x01F0; /* BMW e46 ABS Message */
+            retCanID = BmwE46Abs::id; /* BMW e46 ABS Message */
             break;
         case W202:
-            retCanID = 0x0200; /* W202 C180 ABS signal */
+            retCanID = W202Abs::id; /* W202 C180 ABS signal */
             break;
         default:
             firmwareError(OBD_Vehicle_Speed_SensorB, "Wrong Can DBC selected: %d", type);
@@ -46,25 +47,12 @@ uint16_t look_up_can_id(can_vss_nbc_e type) {
 /* Module specitifc processing functions */
 /* source: http://z4evconversion.blogspot.com/2016/07/completely-forgot-but-it-does-live-on.html */
 void processBMW_e46(const CANRxFrame& frame) {
-    
-    uint16_t tmp;
-    
     /* left front wheel speed is used here */
-    tmp = ((frame.data8[1] & 0x0f) << 8 );
-    tmp |= frame.data8[0];
-
-    vssSpeed = tmp / 16;
-
-
+    vssSpeed = BmwE46Abs::unpack(frame.data8).leftFrontSpeed;
 }
 
 void processW202(const CANRxFrame& frame) {
-
-    uint16_t tmp;
-    
-    tmp = (frame.data8[2] << 8);
-    tmp |= frame.data8[3];
-    vssSpeed = ((float)tmp) * 0.0625;
+    vssSpeed = W202Abs::unpack(frame.data8).speed;
 }
 
 /* End of specific processing functions */
@@ -127,6 +115,10 @@ void initCanVssSupport(Logging *logger_ptr) {
 
         if (filterCanID == 0xffff) {
             isInit = false;
+        } else {
+            registerCanRxHandler(filterCanID, false, [](void *, const CANRxFrame& frame, efitick_t nowNt) {
+                processCanRxVss(frame, nowNt);
+            }, nullptr, "VSS");
         }
     }
     
@@ -0,0 +1,207 @@
+/**
+ * @file	iso_tp.cpp
+ *
+ * @date Oct 18, 2026
+ */
+
+#include "global.h"
+#include "iso_tp.h"
+
+#include <cstring>
+
+efitick_t isoTpDecodeSeparationTime(uint8_t stMin) {
+	if (stMin <= 0x7F) {
+		return MS2NT(stMin);
+	}
+
+	if (stMin >= 0xF1 && stMin <= 0xF9) {
+		return US2NT(100 * (stMin - 0xF0));
+	}
+
+	return MS2NT(0x7F);
+}
+
+bool IsoTpTransmitter::start(const uint8_t *payload, size_t length, efitick_t nowNt) {
+	UNUSED(nowNt);
+
+	if (isBusy() || length == 0 || length > ISO_TP_MAX_PAYLOAD) {
+		return false;
+	}
+
+	m_payload = payload;
+	m_length = length;
+	m_offset = 0;
+	m_state = length <= ISO_TP_FRAME_SIZE - 1 ? State::SingleFrame : State::FirstFrame;
+
+	return true;
+}
+
+void IsoTpTransmitter::abort() {
+	if (isBusy()) {
+		m_abortCount++;
+	}
+
+	m_state = State::Idle;
+	m_payload = nullptr;
+}
+
+void IsoTpTransmitter::onFlowControl(const uint8_t *data, size_t length, efitick_t nowNt) {
+	if (m_state != State::WaitFlowControl || length < 3) {
+		return;
+	}
+
+	if ((IsoTpFrameType)(data[0] >> 4) != IsoTpFrameType::FlowControl) {
+		return;
+	}
+
+	switch ((IsoTpFlowStatus)(data[0] & 0xF)) {
+	case IsoTpFlowStatus::ContinueToSend:
+		m_blockSize = data[1];
+		m_blockRemaining = data[1];
+		m_separationNt = isoTpDecodeSeparationTime(data[2]);
+		m_state = State::Consecutive;
+		// first frame of the block goes out right away
+		m_deadlineNt = nowNt;
+		break;
+	case IsoTpFlowStatus::Wait:
+		m_deadlineNt = nowNt + MS2NT(ISO_TP_FLOW_CONTROL_TIMEOUT_MS);
+		break;
+	default:
+		// overflow, or something we do not know
+		abort();
+		break;
+	}
+}
+
+bool IsoTpTransmitter::getNextFrame(uint8_t *frame, efitick_t nowNt) {
+	memset(frame, 0, ISO_TP_FRAME_SIZE);
+
+	switch (m_state) {
+	case State::SingleFrame:
+		frame[0] = m_length;
+		memcpy(frame + 1, m_payload, m_length);
+
+		m_state = State::Idle;
+		m_frameCount++;
+		return true;
+	case State::FirstFrame:
+		frame[0] = ((int)IsoTpFrameType::First << 4) | (m_length >> 8);
+		frame[1] = m_length & 0xFF;
+		memcpy(frame + 2, m_payload, ISO_TP_FRAME_SIZE - 2);
+
+		m_offset = ISO_TP_FRAME_SIZE - 2;
+		m_sequence = 1;
+		m_state = State::WaitFlowControl;
+		m_deadlineNt = nowNt + MS2NT(ISO_TP_FLOW_CONTROL_TIMEOUT_MS);
+		m_frameCount++;
+		return true;
+	case State::WaitFlowControl:
+		if (nowNt >= m_deadlineNt) {
+			abort();
+		}
+		return false;
+	case State::Consecutive: {
+		if (nowNt < m_deadlineNt) {
+			return false;
+		}
+
+		size_t chunk = m_length - m_offset;
+		if (chunk > ISO_TP_FRAME_SIZE - 1) {
+			chunk = ISO_TP_FRAME_SIZE - 1;
+		}
+
+		frame[0] = ((int)IsoTpFrameType::Consecutive << 4) | m_sequence;
+		memcpy(frame + 1, m_payload + m_offset, chunk);
+
+		m_offset += chunk;
+		m_sequence = (m_sequence + 1) & 0xF;
+		m_frameCount++;
+
+		if (m_offset >= m_length) {
+			m_state = State::Idle;
+			m_payload = nullptr;
+		} else if (m_blockSize != 0 && --m_blockRemaining == 0) {
+			m_state = State::WaitFlowControl;
+			m_deadlineNt = nowNt + MS2NT(ISO_TP_FLOW_CONTROL_TIMEOUT_MS);
+		} else {
+			m_deadlineNt = nowNt + m_separationNt;
+		}
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+size_t IsoTpReceiver::onFrame(const uint8_t *frame, size_t length, uint8_t *payload) {
+	if (length < 1) {
+		return 0;
+	}
+
+	size_t count;
+	const uint8_t *data;
+
+	switch ((IsoTpFrameType)(frame[0] >> 4)) {
+	case IsoTpFrameType::Single:
+		count = frame[0] & 0xF;
+		data = frame + 1;
+		m_remaining = 0;
+		m_lastType = IsoTpFrameType::Single;
+		break;
+	case IsoTpFrameType::First:
+		m_remaining = ((frame[0] & 0xF) << 8) | frame[1];
+		count = m_remaining < ISO_TP_FRAME_SIZE - 2 ? m_remaining : ISO_TP_FRAME_SIZE - 2;
+		data = frame + 2;
+		m_sequence = 1;
+		m_blockRemaining = m_blockSize;
+		m_flowControlDue = true;
+		m_lastType = IsoTpFrameType::First;
+		break;
+	case IsoTpFrameType::Consecutive:
+		if (m_remaining == 0 || (frame[0] & 0xF) != m_sequence) {
+			// lost a frame, nothing good can come out of the rest of this transfer
+			m_errorCount++;
+			m_remaining = 0;
+			return 0;
+		}
+
+		count = m_remaining < ISO_TP_FRAME_SIZE - 1 ? m_remaining : ISO_TP_FRAME_SIZE - 1;
+		data = frame + 1;
+		m_sequence = (m_sequence + 1) & 0xF;
+		m_lastType = IsoTpFrameType::Consecutive;
+
+		if (m_blockSize != 0 && --m_blockRemaining == 0) {
+			m_blockRemaining = m_blockSize;
+			m_flowControlDue = m_remaining > count;
+		}
+		break;
+	default:
+		// Flow Control is the business of the transmitter
+		return 0;
+	}
+
+	// short frame, or a Single Frame claiming more than fits
+	size_t available = length > (size_t)(data - frame) ? length - (data - frame) : 0;
+	if (count > available) {
+		count = available;
+	}
+
+	memcpy(payload, data, count);
+	m_remaining -= m_remaining < count ? m_remaining : count;
+
+	return count;
+}
+
+bool IsoTpReceiver::getFlowControl(uint8_t *frame) {
+	if (!m_flowControlDue) {
+		return false;
+	}
+
+	memset(frame, 0, ISO_TP_FRAME_SIZE);
+	frame[0] = ((int)IsoTpFrameType::FlowControl << 4) | (int)IsoTpFlowStatus::ContinueToSend;
+	frame[1] = m_blockSize;
+	frame[2] = m_separationTime;
+
+	m_flowControlDue = false;
+	return true;
+}
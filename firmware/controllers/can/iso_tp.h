@@ -0,0 +1,161 @@
+/**
+ * @file	iso_tp.h
+ *
+ * ISO 15765-2 (ISO-TP) segmentation of payloads longer than one CAN frame.
+ *
+ * Short payloads go out as a Single Frame. Longer ones go out as a First Frame, then
+ * Consecutive Frames paced by the Flow Control frames of the receiver: Block Size frames per
+ * Flow Control, at least STmin apart.
+ *
+ * Nothing here touches CAN hardware. The owner feeds in received frames and asks for the next
+ * frame which is due, so the same code is used with the real bus and in unit tests.
+ */
+
+#pragma once
+
+#include "rusefi_types.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#define ISO_TP_FRAME_SIZE 8
+
+// 12 bit First Frame length
+#define ISO_TP_MAX_PAYLOAD 4095
+
+// N_Bs, how long we wait for the receiver to send a Flow Control
+#define ISO_TP_FLOW_CONTROL_TIMEOUT_MS 1000
+
+enum class IsoTpFrameType : uint8_t {
+	Single = 0,
+	First = 1,
+	Consecutive = 2,
+	FlowControl = 3,
+};
+
+enum class IsoTpFlowStatus : uint8_t {
+	ContinueToSend = 0,
+	Wait = 1,
+	Overflow = 2,
+};
+
+/**
+ * Decodes STmin as carried in a Flow Control frame: 0..127 ms, or 100..900 us
+ * Reserved values mean the longest time, as the standard asks.
+ */
+efitick_t isoTpDecodeSeparationTime(uint8_t stMin);
+
+class IsoTpTransmitter {
+public:
+	/**
+	 * Queues a payload. Nothing is copied, the payload has to stay as it is until
+	 * isBusy() returns false.
+	 * @return false if a transfer is already in progress or the payload is too long
+	 */
+	bool start(const uint8_t *payload, size_t length, efitick_t nowNt);
+
+	/**
+	 * Feed a Flow Control frame received from the other side. Anything else is ignored.
+	 */
+	void onFlowControl(const uint8_t *data, size_t length, efitick_t nowNt);
+
+	/**
+	 * Fills frame (ISO_TP_FRAME_SIZE bytes, zero padded) with the next frame to send.
+	 * @return false if nothing is due right now
+	 */
+	bool getNextFrame(uint8_t *frame, efitick_t nowNt);
+
+	bool isBusy() const {
+		return m_state != State::Idle;
+	}
+
+	void abort();
+
+	// transfers given up on: Flow Control timeout or receiver overflow
+	uint32_t getAbortCount() const {
+		return m_abortCount;
+	}
+
+	uint32_t getFrameCount() const {
+		return m_frameCount;
+	}
+
+private:
+	enum class State : uint8_t {
+		Idle,
+		SingleFrame,
+		FirstFrame,
+		WaitFlowControl,
+		Consecutive,
+	};
+
+	State m_state = State::Idle;
+
+	const uint8_t *m_payload = nullptr;
+	size_t m_length = 0;
+	size_t m_offset = 0;
+
+	uint8_t m_sequence = 0;
+	// 0 means no limit
+	uint8_t m_blockSize = 0;
+	uint8_t m_blockRemaining = 0;
+	efitick_t m_separationNt = 0;
+
+	// next Consecutive Frame, or Flow Control timeout while waiting
+	efitick_t m_deadlineNt = 0;
+
+	uint32_t m_abortCount = 0;
+	uint32_t m_frameCount = 0;
+};
+
+class IsoTpReceiver {
+public:
+	/**
+	 * @param blockSize Consecutive Frames the sender may send per Flow Control, 0 for no limit
+	 * @param separationTime STmin we ask the sender for, as carried in Flow Control
+	 */
+	IsoTpReceiver(uint8_t blockSize, uint8_t separationTime)
+		: m_blockSize(blockSize)
+		, m_separationTime(separationTime)
+	{
+	}
+
+	/**
+	 * Takes one received frame and copies its data bytes out, at most ISO_TP_FRAME_SIZE - 1.
+	 * A new Single or First Frame drops whatever transfer was in progress.
+	 * @return number of data bytes, 0 for frames which carry nothing for us
+	 */
+	size_t onFrame(const uint8_t *frame, size_t length, uint8_t *payload);
+
+	/**
+	 * Fills frame (ISO_TP_FRAME_SIZE bytes) with a Flow Control if the sender waits for one
+	 */
+	bool getFlowControl(uint8_t *frame);
+
+	// type of the last frame which carried data
+	IsoTpFrameType getLastFrameType() const {
+		return m_lastType;
+	}
+
+	// payload bytes still expected from the current transfer
+	size_t getRemaining() const {
+		return m_remaining;
+	}
+
+	// Consecutive Frames out of sequence or without a First Frame
+	uint32_t getErrorCount() const {
+		return m_errorCount;
+	}
+
+private:
+	const uint8_t m_blockSize;
+	const uint8_t m_separationTime;
+
+	IsoTpFrameType m_lastType = IsoTpFrameType::Single;
+	size_t m_remaining = 0;
+	uint8_t m_sequence = 0;
+	uint8_t m_blockRemaining = 0;
+	bool m_flowControlDue = false;
+
+	uint32_t m_errorCount = 0;
+};
@@ -22,12 +22,9 @@
  */
 
 #include "global.h"
-
-#if EFI_CAN_SUPPORT
 #include "os_access.h"
 #include "engine.h"
 #include "obd2.h"
-#include "can_msg_tx.h"
 #include "vehicle_speed.h"
 #include "map.h"
 #include "maf.h"
@@ -64,121 +61,191 @@ static const int16_t supportedPids4160[] = {
 	-1
 };
 
-static void obdSendPacket(int mode, int PID, int numBytes, uint32_t iValue) {
-	CanTxMessage resp(OBD_TEST_RESPONSE);
-
-	// write number of bytes
-	resp[0] = (uint8_t)(2 + numBytes);
-	// write 2 bytes of header
-	resp[1] = (uint8_t)(0x40 + mode);
-	resp[2] = (uint8_t)PID;
-	// write N data bytes
-	for (int i = 8 * (numBytes - 1), j = 3; i >= 0; i -= 8, j++) {
-		resp[j] = (uint8_t)((iValue >> i) & 0xff);
-	}
-}
+struct ObdPidValue {
+	// 0 for PIDs we do not answer
+	uint8_t length;
+	// already encoded, most significant byte goes out first
+	uint32_t value;
+};
 
-#define _1_MODE 1
+/**
+ * Written by the slow callback, read by the CAN RX thread. Value and length go together, both
+ * sides only touch an entry under lock.
+ */
+static ObdPidValue pidCache[OBD_PID_CACHE_SIZE];
+
+static void setPidRaw(int pid, int numBytes, uint32_t value) {
+	chibios_rt::CriticalSectionLocker csl;
+	pidCache[pid].value = value;
+	pidCache[pid].length = numBytes;
+}
 
-static void obdSendValue(int mode, int PID, int numBytes, float value) {
-	efiAssertVoid(CUSTOM_ERR_6662, numBytes <= 2, "invalid numBytes");
+static void setPidValue(int pid, int numBytes, float value) {
 	int iValue = (int)efiRound(value, 1.0f);
 	// clamp to uint8_t (0..255) or uint16_t (0..65535)
 	iValue = maxI(minI(iValue, (numBytes == 1) ? 255 : 65535), 0);
-	obdSendPacket(mode, PID, numBytes, iValue);
+	setPidRaw(pid, numBytes, iValue);
 }
 
-
 //#define MOCK_SUPPORTED_PIDS 0xffffffff
 
-static void obdWriteSupportedPids(int PID, int bitOffset, const int16_t *supportedPids) {
-	uint32_t value = 0;
+/**
+ * Bit 31 is the PID right after rangePid, bit 0 is the next range request PID which says
+ * whether the scan tool should bother asking for the next range.
+ */
+static uint32_t getSupportedPids(int rangePid, const int16_t *supportedPids, bool hasNextRange) {
+	uint32_t value = hasNextRange ? 1 : 0;
 	// gather all 32 bit fields
 	for (int i = 0; i < 32 && supportedPids[i] > 0; i++)
-		value |= 1 << (31 + bitOffset - supportedPids[i]);
+		value |= 1 << (31 + rangePid + 1 - supportedPids[i]);
 
 #ifdef MOCK_SUPPORTED_PIDS
 	// for OBD debug
 	value = MOCK_SUPPORTED_PIDS;
 #endif
 
-	obdSendPacket(1, PID, 4, value);
+	return value;
 }
 
-static void handleGetDataRequest(const CANRxFrame& rx) {
-	int pid = rx.data8[2];
-	switch (pid) {
-	case PID_SUPPORTED_PIDS_REQUEST_01_20:
-		obdWriteSupportedPids(pid, 1, supportedPids0120);
-		break;
-	case PID_SUPPORTED_PIDS_REQUEST_21_40:
-		obdWriteSupportedPids(pid, 21, supportedPids2140);
-		break;
-	case PID_SUPPORTED_PIDS_REQUEST_41_60:
-		obdWriteSupportedPids(pid, 41, supportedPids4160);
-		break;
-	case PID_MONITOR_STATUS:
-		obdSendPacket(1, pid, 4, 0);	// todo: add statuses
-		break;
-	case PID_FUEL_SYSTEM_STATUS:
-		// todo: add statuses
-		obdSendValue(_1_MODE, pid, 2, (2<<8)|(0));	// 2 = "Closed loop, using oxygen sensor feedback to determine fuel mix"
-		break;
-	case PID_ENGINE_LOAD:
-		obdSendValue(_1_MODE, pid, 1, getFuelingLoad(PASS_ENGINE_PARAMETER_SIGNATURE) * ODB_TPS_BYTE_PERCENT);
-		break;
-	case PID_COOLANT_TEMP:
-		obdSendValue(_1_MODE, pid, 1, Sensor::get(SensorType::Clt).value_or(0) + ODB_TEMP_EXTRA);
-		break;
-	case PID_STFT_BANK1:
-		obdSendValue(_1_MODE, pid, 1, 128 * ENGINE(engineState.running.pidCorrection));
-		break;
-	case PID_STFT_BANK2:
-		// TODO: use second fueling bank
-		obdSendValue(_1_MODE, pid, 1, 128 * ENGINE(engineState.running.pidCorrection));
-		break;
-	case PID_INTAKE_MAP:
-		obdSendValue(_1_MODE, pid, 1, Sensor::get(SensorType::Map).value_or(0));
-		break;
-	case PID_RPM:
-		obdSendValue(_1_MODE, pid, 2, GET_RPM() * ODB_RPM_MULT);	//	rotation/min.	(A*256+B)/4
-		break;
-	case PID_SPEED:
-		obdSendValue(_1_MODE, pid, 1, getVehicleSpeed());
-		break;
-	case PID_TIMING_ADVANCE: {
-		float timing = engine->engineState.timingAdvance;
-		timing = (timing > 360.0f) ? (timing - 720.0f) : timing;
-		obdSendValue(_1_MODE, pid, 1, (timing + 64.0f) * 2.0f);		// angle before TDC.	(A/2)-64
-		break;
+void obdRefreshPidCache(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	setPidRaw(PID_SUPPORTED_PIDS_REQUEST_01_20, 4, getSupportedPids(PID_SUPPORTED_PIDS_REQUEST_01_20, supportedPids0120, true));
+	setPidRaw(PID_SUPPORTED_PIDS_REQUEST_21_40, 4, getSupportedPids(PID_SUPPORTED_PIDS_REQUEST_21_40, supportedPids2140, true));
+	setPidRaw(PID_SUPPORTED_PIDS_REQUEST_41_60, 4, getSupportedPids(PID_SUPPORTED_PIDS_REQUEST_41_60, supportedPids4160, false));
+
+	setPidRaw(PID_MONITOR_STATUS, 4, 0);	// todo: add statuses
+	// todo: add statuses
+	setPidValue(PID_FUEL_SYSTEM_STATUS, 2, (2<<8)|(0));	// 2 = "Closed loop, using oxygen sensor feedback to determine fuel mix"
+	setPidValue(PID_ENGINE_LOAD, 1, getFuelingLoad(PASS_ENGINE_PARAMETER_SIGNATURE) * ODB_TPS_BYTE_PERCENT);
+	setPidValue(PID_COOLANT_TEMP, 1, Sensor::get(SensorType::Clt).value_or(0) + ODB_TEMP_EXTRA);
+	setPidValue(PID_STFT_BANK1, 1, 128 * ENGINE(engineState.running.pidCorrection));
+	// TODO: use second fueling bank
+	setPidValue(PID_STFT_BANK2, 1, 128 * ENGINE(engineState.running.pidCorrection));
+	setPidValue(PID_INTAKE_MAP, 1, Sensor::get(SensorType::Map).value_or(0));
+	setPidValue(PID_RPM, 2, GET_RPM() * ODB_RPM_MULT);	//	rotation/min.	(A*256+B)/4
+	setPidValue(PID_SPEED, 1, getVehicleSpeed());
+
+	float timing = engine->engineState.timingAdvance;
+	timing = (timing > 360.0f) ? (timing - 720.0f) : timing;
+	setPidValue(PID_TIMING_ADVANCE, 1, (timing + 64.0f) * 2.0f);		// angle before TDC.	(A/2)-64
+
+	setPidValue(PID_INTAKE_TEMP, 1, Sensor::get(SensorType::Iat).value_or(0) + ODB_TEMP_EXTRA);
+	setPidValue(PID_INTAKE_MAF, 2, getRealMaf(PASS_ENGINE_PARAMETER_SIGNATURE) * 100.0f);	// grams/sec	(A*256+B)/100
+	setPidValue(PID_THROTTLE, 1, Sensor::get(SensorType::Tps1).value_or(0) * ODB_TPS_BYTE_PERCENT);	// (A*100/255)
+
+	float lambda = Sensor::get(SensorType::Lambda1).value_or(0);
+	// phi = 1 / lambda
+	float phi = clampF(0, 1 / lambda, 1.99f);
+	uint16_t scaled = phi * 32768;
+	setPidRaw(PID_FUEL_AIR_RATIO_1, 4, scaled << 16);
+
+	setPidValue(PID_FUEL_RATE, 2, engine->engineState.fuelConsumption.perSecondConsumption * 20.0f);	//	L/h.	(A*256+B)/20
+}
+
+size_t obdBuildCurrentDataResponse(const uint8_t *pids, size_t pidCount, uint8_t *out, size_t outSize) {
+	if (outSize < 1) {
+		return 0;
+	}
+
+	size_t length = 0;
+	out[length++] = 0x40 + OBD_CURRENT_DATA;
+
+	for (size_t i = 0; i < pidCount; i++) {
+		int pid = pids[i];
+		if (pid >= OBD_PID_CACHE_SIZE) {
+			// ignore unhandled PIDs
+			continue;
 		}
-	case PID_INTAKE_TEMP:
-		obdSendValue(_1_MODE, pid, 1, Sensor::get(SensorType::Iat).value_or(0) + ODB_TEMP_EXTRA);
-		break;
-	case PID_INTAKE_MAF:
-		obdSendValue(_1_MODE, pid, 2, getRealMaf(PASS_ENGINE_PARAMETER_SIGNATURE) * 100.0f);	// grams/sec	(A*256+B)/100
-		break;
-	case PID_THROTTLE:
-		obdSendValue(_1_MODE, pid, 1, Sensor::get(SensorType::Tps1).value_or(0) * ODB_TPS_BYTE_PERCENT);	// (A*100/255)
-		break;
-	case PID_FUEL_AIR_RATIO_1: {
-		float lambda = Sensor::get(SensorType::Lambda1).value_or(0);
-		// phi = 1 / lambda
-		float phi = clampF(0, 1 / lambda, 1.99f);
 
-		uint16_t scaled = phi * 32768;
+		ObdPidValue entry;
+		{
+			chibios_rt::CriticalSectionLocker csl;
+			entry = pidCache[pid];
+		}
+		if (entry.length == 0 || length + 1 + entry.length > outSize) {
+			continue;
+		}
 
-		obdSendPacket(1, pid, 4, scaled << 16);
-		break;
-	} case PID_FUEL_RATE:
-		obdSendValue(_1_MODE, pid, 2, engine->engineState.fuelConsumption.perSecondConsumption * 20.0f);	//	L/h.	(A*256+B)/20
-		break;
-	default:
-		// ignore unhandled PIDs
-		break;
+		out[length++] = pid;
+		for (int shift = 8 * (entry.length - 1); shift >= 0; shift -= 8) {
+			out[length++] = (entry.value >> shift) & 0xff;
+		}
+	}
+
+	// nothing we know about, stay quiet so that other ECUs can answer
+	return length == 1 ? 0 : length;
+}
+
+#if EFI_CAN_SUPPORT && HAL_USE_CAN
+#include "can_msg_tx.h"
+#include "iso_tp.h"
+
+static IsoTpTransmitter obdTransmitter;
+// the transmitter sends straight out of this buffer, it is only rewritten once it is idle
+static uint8_t obdResponse[OBD_MAX_RESPONSE_SIZE];
+// set while one of the CAN threads is sending response frames, only touched under lock
+static volatile bool obdTransmitting = false;
+
+/**
+ * Called by the RX thread right after a request or a Flow Control, and by the TX thread once
+ * per slot for Consecutive Frames which have to wait for STmin. Whoever comes first sends, so
+ * that frames never overtake each other.
+ */
+void obdTransmitPending() {
+	{
+		chibios_rt::CriticalSectionLocker csl;
+		if (obdTransmitting) {
+			return;
+		}
+		obdTransmitting = true;
+	}
+
+	while (true) {
+		uint8_t frame[ISO_TP_FRAME_SIZE];
+		efitick_t nowNt = getTimeNowNt();
+		{
+			chibios_rt::CriticalSectionLocker csl;
+			if (!obdTransmitter.getNextFrame(frame, nowNt)) {
+				// cleared in the section which found nothing due, the next caller sends whatever comes due later
+				obdTransmitting = false;
+				return;
+			}
+		}
+
+		CanTxMessage resp(OBD_TEST_RESPONSE);
+		for (size_t i = 0; i < ISO_TP_FRAME_SIZE; i++) {
+			resp[i] = frame[i];
+		}
 	}
 }
 
+static void handleGetDataRequest(const CANRxFrame& rx, efitick_t nowNt) {
+	// Single Frame length counts the mode byte
+	int pidCount = rx.data8[0] - 1;
+	if (pidCount < 1 || pidCount > OBD_MAX_PIDS_PER_REQUEST) {
+		return;
+	}
+
+	{
+		chibios_rt::CriticalSectionLocker csl;
+		if (obdTransmitter.isBusy()) {
+			// still sending the previous response, the scan tool will ask again
+			return;
+		}
+	}
+
+	size_t length = obdBuildCurrentDataResponse(&rx.data8[2], pidCount, obdResponse, sizeof(obdResponse));
+	if (length == 0) {
+		return;
+	}
+
+	{
+		chibios_rt::CriticalSectionLocker csl;
+		obdTransmitter.start(obdResponse, length, nowNt);
+	}
+
+	obdTransmitPending();
+}
+
 static void handleDtcRequest(int numCodes, int *dtcCode) {
 	// TODO: this appears to be unfinished?
 	UNUSED(numCodes);
@@ -193,22 +260,26 @@ static void handleDtcRequest(int numCodes, int *dtcCode) {
 	// }
 }
 
-#if HAL_USE_CAN
-void obdOnCanPacketRx(const CANRxFrame& rx) {
-	if (rx.SID != OBD_TEST_REQUEST) {
-		return;
-	}
+void obdOnCanPacketRx(const CANRxFrame& rx, efitick_t nowNt) {
+	switch (obdGetRequest(rx)) {
+	case ObdRequest::FlowControl:
+		{
+			chibios_rt::CriticalSectionLocker csl;
+			obdTransmitter.onFlowControl(rx.data8, rx.DLC, nowNt);
+		}
 
-	if (rx.data8[0] == _OBD_2 && rx.data8[1] == OBD_CURRENT_DATA) {
-		handleGetDataRequest(rx);
-	} else if (rx.data8[0] == 1 && rx.data8[1] == OBD_STORED_DIAGNOSTIC_TROUBLE_CODES) {
-		// todo: implement stored/pending difference?
-		handleDtcRequest(1, &engine->engineState.warnings.lastErrorCode);
-	} else if (rx.data8[0] == 1 && rx.data8[1] == OBD_PENDING_DIAGNOSTIC_TROUBLE_CODES) {
+		obdTransmitPending();
+		break;
+	case ObdRequest::CurrentData:
+		handleGetDataRequest(rx, nowNt);
+		break;
+	case ObdRequest::StoredTroubleCodes:
+	case ObdRequest::PendingTroubleCodes:
 		// todo: implement stored/pending difference?
 		handleDtcRequest(1, &engine->engineState.warnings.lastErrorCode);
+		break;
+	case ObdRequest::None:
+		break;
 	}
 }
-#endif /* HAL_USE_CAN */
-
-#endif /* EFI_CAN_SUPPORT */
+#endif /* EFI_CAN_SUPPORT && HAL_USE_CAN */
@@ -8,8 +8,12 @@
 #pragma once
 
 #include "global.h"
+#include "iso_tp.h"
 
+// functional (broadcast) request
 #define OBD_TEST_REQUEST 0x7DF
+// physical request to the ECU, also carries Flow Control of multi frame responses
+#define OBD_PHYSICAL_REQUEST 0x7E0
 
 #define OBD_TEST_RESPONSE 0x7E8
 
@@ -40,8 +44,62 @@
 #define PID_SUPPORTED_PIDS_REQUEST_41_60 0x40
 #define PID_FUEL_RATE 0x5E
 
+// mode 01 takes up to six PIDs in one request
+#define OBD_MAX_PIDS_PER_REQUEST 6
+// PIDs the value cache knows about
+#define OBD_PID_CACHE_SIZE 0x60
+// 0x41 followed by six PIDs with up to four bytes each
+#define OBD_MAX_RESPONSE_SIZE (1 + OBD_MAX_PIDS_PER_REQUEST * 5)
+
+/**
+ * Encodes every supported PID into the response cache, meant to run once per slow tick so
+ * that requests are answered with a copy instead of computing on the CAN thread.
+ */
+void obdRefreshPidCache(DECLARE_ENGINE_PARAMETER_SIGNATURE);
+
+/**
+ * Mode 01 response for the given PIDs: 0x41, then PID and data bytes for each supported one.
+ * @return response length, zero if none of the PIDs is supported
+ */
+size_t obdBuildCurrentDataResponse(const uint8_t *pids, size_t pidCount, uint8_t *out, size_t outSize);
+
+enum class ObdRequest : uint8_t {
+	None,
+	FlowControl,
+	CurrentData,
+	StoredTroubleCodes,
+	PendingTroubleCodes,
+};
+
+/**
+ * What a received frame asks of us. Only standard frames to the functional or the physical
+ * request ID count, the ID is taken from SID: a standard frame received into a reused buffer
+ * still has EID bits from the last extended frame.
+ */
+template <typename TFrame>
+ObdRequest obdGetRequest(const TFrame &rx) {
+	if (rx.IDE || (rx.SID != OBD_TEST_REQUEST && rx.SID != OBD_PHYSICAL_REQUEST)) {
+		return ObdRequest::None;
+	}
+
+	IsoTpFrameType type = (IsoTpFrameType)(rx.data8[0] >> 4);
+	if (type == IsoTpFrameType::FlowControl) {
+		return ObdRequest::FlowControl;
+	} else if (type == IsoTpFrameType::Single && rx.data8[1] == OBD_CURRENT_DATA) {
+		return ObdRequest::CurrentData;
+	} else if (rx.data8[0] == 1 && rx.data8[1] == OBD_STORED_DIAGNOSTIC_TROUBLE_CODES) {
+		return ObdRequest::StoredTroubleCodes;
+	} else if (rx.data8[0] == 1 && rx.data8[1] == OBD_PENDING_DIAGNOSTIC_TROUBLE_CODES) {
+		return ObdRequest::PendingTroubleCodes;
+	}
+
+	return ObdRequest::None;
+}
+
 #if HAL_USE_CAN
-void obdOnCanPacketRx(const CANRxFrame& rx);
+void obdOnCanPacketRx(const CANRxFrame& rx, efitick_t nowNt);
+// sends queued multi frame response frames once they are due
+void obdTransmitPending();
 #endif /* HAL_USE_CAN */
 
 #define ODB_RPM_MULT 4
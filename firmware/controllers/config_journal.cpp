@@ -0,0 +1,369 @@
+/**
+ * @file	config_journal.cpp
+ *
+ * @date Oct 18, 2026
+ */
+
+#include "config_journal.h"
+#include "crc.h"
+
+#include <cstddef>
+
+#define CONFIG_JOURNAL_MAGIC 0x4E524A43
+#define CONFIG_JOURNAL_RECORD_MARKER 0x44434552
+
+// last record of a burn, the burn is applied at boot only once this one made it
+#define RECORD_FLAG_COMMIT 1
+
+struct JournalRegionHeader {
+	uint32_t magic;
+	uint32_t generation;
+	int32_t version;
+	// of the fields above
+	uint32_t crc;
+};
+
+struct JournalRecordHeader {
+	uint32_t marker;
+	// same for all records of one burn
+	uint32_t sequence;
+	uint16_t offset;
+	uint16_t size;
+	uint32_t flags;
+	// of the fields above and the data
+	uint32_t crc;
+};
+
+static_assert(CONFIG_JOURNAL_CHUNK_SIZE % CONFIG_JOURNAL_WRITE_ALIGN == 0, "journal chunk alignment");
+static_assert(sizeof(persistent_config_s) % CONFIG_JOURNAL_WRITE_ALIGN == 0, "snapshot alignment");
+static_assert(sizeof(persistent_config_s) <= 0xFFFF, "snapshot does not fit a record");
+
+static constexpr size_t alignUp(size_t size) {
+	return (size + CONFIG_JOURNAL_WRITE_ALIGN - 1) / CONFIG_JOURNAL_WRITE_ALIGN * CONFIG_JOURNAL_WRITE_ALIGN;
+}
+
+// headers are padded to whole flash words, data after them never shares a word with them
+#define REGION_HEADER_SIZE alignUp(sizeof(JournalRegionHeader))
+#define RECORD_HEADER_SIZE alignUp(sizeof(JournalRecordHeader))
+
+static size_t recordSize(size_t dataSize) {
+	return RECORD_HEADER_SIZE + alignUp(dataSize);
+}
+
+template <typename THeader>
+static bool writeHeader(FlashRegion &region, size_t at, const THeader &header) {
+	// the padding is left erased
+	uint8_t words[alignUp(sizeof(THeader))];
+	memset(words, 0xFF, sizeof(words));
+	memcpy(words, &header, sizeof(header));
+	return region.write(at, words, sizeof(words));
+}
+
+static uint32_t headerCrc(const JournalRegionHeader &header) {
+	return crc32(&header, offsetof(JournalRegionHeader, crc));
+}
+
+static uint32_t recordCrc(const JournalRecordHeader &header, const uint8_t *data) {
+	return crc32inc(data, crc32(&header, offsetof(JournalRecordHeader, crc)), header.size);
+}
+
+static bool isErased(const JournalRecordHeader &header) {
+	const uint8_t *bytes = reinterpret_cast<const uint8_t*>(&header);
+	for (size_t i = 0; i < sizeof(header); i++) {
+		if (bytes[i] != 0xFF) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Checks the record CRC without touching the image, a torn record must not end up in RAM.
+ */
+static bool isValidRecord(FlashRegion &region, size_t at, const JournalRecordHeader &header) {
+	uint32_t crc = crc32(&header, offsetof(JournalRecordHeader, crc));
+
+	uint8_t buffer[64];
+	size_t done = 0;
+	while (done < header.size) {
+		size_t size = minI(sizeof(buffer), header.size - done);
+		if (!region.read(at + RECORD_HEADER_SIZE + done, buffer, size)) {
+			return false;
+		}
+		crc = crc32inc(buffer, crc, size);
+		done += size;
+	}
+
+	return crc == header.crc;
+}
+
+/**
+ * @return bytes written, 0 on failure
+ */
+static size_t writeRecord(FlashRegion &region, size_t at, uint32_t sequence, uint32_t flags, const uint8_t *image, size_t offset, size_t size) {
+	if (at + recordSize(size) > region.getSize()) {
+		return 0;
+	}
+
+	JournalRecordHeader header;
+	header.marker = CONFIG_JOURNAL_RECORD_MARKER;
+	header.sequence = sequence;
+	header.offset = offset;
+	header.size = size;
+	header.flags = flags;
+	header.crc = recordCrc(header, image + offset);
+
+	if (!writeHeader(region, at, header)
+			|| !region.write(at + RECORD_HEADER_SIZE, image + offset, alignUp(size))) {
+		return 0;
+	}
+
+	return recordSize(size);
+}
+
+ConfigJournal::ConfigJournal(FlashRegion &first, FlashRegion &second)
+	: m_regions{ &first, &second }
+{
+	memset(m_chunkCrc, 0, sizeof(m_chunkCrc));
+}
+
+persisted_configuration_state_e ConfigJournal::replay(uint8_t *image, size_t size, int version) {
+	JournalRegionHeader headers[2];
+	bool isValid[2];
+	for (int i = 0; i < 2; i++) {
+		isValid[i] = m_regions[i]->read(0, &headers[i], sizeof(headers[i]))
+				&& headers[i].magic == CONFIG_JOURNAL_MAGIC && headers[i].crc == headerCrc(headers[i]);
+	}
+
+	// newest first
+	int order[2] = { 0, 1 };
+	if (isValid[0] && isValid[1] && headers[1].generation > headers[0].generation) {
+		order[0] = 1;
+		order[1] = 0;
+	}
+
+	for (int index : order) {
+		if (!isValid[index]) {
+			continue;
+		}
+
+		if (headers[index].version != version) {
+			// like the old copies: read it anyway so engine type survives, next burn writes a fresh snapshot
+			replayRegion(index, image, size);
+			m_activeRegion = index;
+			m_generation = headers[index].generation;
+			m_needsCompaction = true;
+			return INCOMPATIBLE_VERSION;
+		}
+
+		if (replayRegion(index, image, size)) {
+			m_generation = headers[index].generation;
+			rememberChunks(image, size);
+			return PC_OK;
+		}
+	}
+
+	return CRC_FAILED;
+}
+
+bool ConfigJournal::replayRegion(int index, uint8_t *image, size_t size) {
+	FlashRegion &region = *m_regions[index];
+	size_t at = REGION_HEADER_SIZE;
+	bool isTorn = false;
+	bool isBurnOpen = false;
+	uint32_t recordCount = 0;
+	uint32_t sequence = 0;
+
+	// where the last complete burn ends
+	size_t committedAt = 0;
+	uint32_t committedRecordCount = 0;
+	uint32_t committedSequence = 0;
+
+	// first pass only checks, a burn which did not make it to its commit record must not end up in RAM
+	while (at + RECORD_HEADER_SIZE <= region.getSize()) {
+		JournalRecordHeader header;
+		if (!region.read(at, &header, sizeof(header))) {
+			return false;
+		}
+
+		if (isErased(header)) {
+			// records are written header first, nothing after this one
+			break;
+		}
+
+		bool isSnapshot = recordCount == 0;
+		bool isSane = header.marker == CONFIG_JOURNAL_RECORD_MARKER
+				&& header.size != 0
+				&& header.offset + header.size <= size
+				&& (isSnapshot
+						? header.offset == 0 && header.size == size && (header.flags & RECORD_FLAG_COMMIT)
+						: header.sequence == (isBurnOpen ? sequence : sequence + 1));
+
+		if (!isSane || !isValidRecord(region, at, header)) {
+			if (isSnapshot) {
+				// power went away while compacting into this region
+				return false;
+			}
+			// a burn was interrupted, everything before it is good
+			isTorn = true;
+			break;
+		}
+
+		sequence = header.sequence;
+		recordCount++;
+		at += recordSize(header.size);
+
+		isBurnOpen = !(header.flags & RECORD_FLAG_COMMIT);
+		if (!isBurnOpen) {
+			committedAt = at;
+			committedRecordCount = recordCount;
+			committedSequence = sequence;
+		}
+	}
+
+	if (committedRecordCount == 0) {
+		return false;
+	}
+
+	for (size_t offset = REGION_HEADER_SIZE; offset < committedAt;) {
+		JournalRecordHeader header;
+		if (!region.read(offset, &header, sizeof(header))
+				|| !region.read(offset + RECORD_HEADER_SIZE, image + header.offset, header.size)) {
+			return false;
+		}
+		offset += recordSize(header.size);
+	}
+
+	m_activeRegion = index;
+	m_writeOffset = committedAt;
+	m_sequence = committedSequence;
+	m_recordCount = committedRecordCount;
+	// the records of an uncommitted burn stay in flash, no more appends into this region
+	m_needsCompaction = isTorn || isBurnOpen;
+	return true;
+}
+
+void ConfigJournal::rememberChunks(const uint8_t *image, size_t size) {
+	for (size_t i = 0; i * CONFIG_JOURNAL_CHUNK_SIZE < size; i++) {
+		size_t offset = i * CONFIG_JOURNAL_CHUNK_SIZE;
+		m_chunkCrc[i] = crc32(image + offset, minI(CONFIG_JOURNAL_CHUNK_SIZE, size - offset));
+	}
+}
+
+bool ConfigJournal::burn(const uint8_t *image, size_t size, int version) {
+	if (size > sizeof(persistent_config_s)) {
+		return false;
+	}
+
+	if (m_activeRegion < 0 || m_needsCompaction) {
+		return compact(image, size, version);
+	}
+
+	uint32_t chunkCrc[CONFIG_JOURNAL_MAX_CHUNKS];
+	size_t chunkCount = (size + CONFIG_JOURNAL_CHUNK_SIZE - 1) / CONFIG_JOURNAL_CHUNK_SIZE;
+	size_t needed = 0;
+	bool inRun = false;
+	size_t runStart = 0;
+
+	for (size_t i = 0; i <= chunkCount; i++) {
+		bool isChanged = false;
+		if (i < chunkCount) {
+			size_t offset = i * CONFIG_JOURNAL_CHUNK_SIZE;
+			chunkCrc[i] = crc32(image + offset, minI(CONFIG_JOURNAL_CHUNK_SIZE, size - offset));
+			isChanged = chunkCrc[i] != m_chunkCrc[i];
+		}
+
+		if (isChanged && !inRun) {
+			runStart = i;
+		} else if (!isChanged && inRun) {
+			needed += recordSize(minI((i - runStart) * CONFIG_JOURNAL_CHUNK_SIZE, size - runStart * CONFIG_JOURNAL_CHUNK_SIZE));
+		}
+		inRun = isChanged;
+	}
+
+	if (needed == 0) {
+		return true;
+	}
+
+	if (m_writeOffset + needed > m_regions[m_activeRegion]->getSize()) {
+		return compact(image, size, version);
+	}
+
+	// second pass, runs of changed chunks each become one record. All of them carry the same
+	// sequence and the last one commits the burn, so it is applied at boot as a whole or not at all
+	uint32_t sequence = m_sequence + 1;
+	size_t pendingOffset = 0;
+	size_t pendingSize = 0;
+	inRun = false;
+	for (size_t i = 0; i <= chunkCount; i++) {
+		bool isChanged = i < chunkCount && chunkCrc[i] != m_chunkCrc[i];
+
+		if (isChanged && !inRun) {
+			runStart = i;
+		} else if (!isChanged && inRun) {
+			size_t offset = runStart * CONFIG_JOURNAL_CHUNK_SIZE;
+			size_t runSize = minI((i - runStart) * CONFIG_JOURNAL_CHUNK_SIZE, size - offset);
+			// we only know a run was the last one once the next one shows up
+			if (pendingSize != 0 && !append(image, sequence, 0, pendingOffset, pendingSize)) {
+				// whatever made it has no commit
+				m_needsCompaction = true;
+				return compact(image, size, version);
+			}
+			pendingOffset = offset;
+			pendingSize = runSize;
+		}
+		inRun = isChanged;
+	}
+
+	if (!append(image, sequence, RECORD_FLAG_COMMIT, pendingOffset, pendingSize)) {
+		m_needsCompaction = true;
+		return compact(image, size, version);
+	}
+
+	m_sequence = sequence;
+	memcpy(m_chunkCrc, chunkCrc, chunkCount * sizeof(chunkCrc[0]));
+	return true;
+}
+
+bool ConfigJournal::append(const uint8_t *image, uint32_t sequence, uint32_t flags, size_t offset, size_t size) {
+	size_t written = writeRecord(*m_regions[m_activeRegion], m_writeOffset, sequence, flags, image, offset, size);
+	if (written == 0) {
+		return false;
+	}
+
+	m_writeOffset += written;
+	m_recordCount++;
+	return true;
+}
+
+bool ConfigJournal::compact(const uint8_t *image, size_t size, int version) {
+	// the active region stays intact until the snapshot in the other one is complete
+	int target = m_activeRegion < 0 ? 0 : 1 - m_activeRegion;
+	FlashRegion &region = *m_regions[target];
+
+	JournalRegionHeader header;
+	header.magic = CONFIG_JOURNAL_MAGIC;
+	header.generation = m_generation + 1;
+	header.version = version;
+	header.crc = headerCrc(header);
+
+	m_compactionCount++;
+
+	if (!region.erase() || !writeHeader(region, 0, header)) {
+		return false;
+	}
+
+	size_t written = writeRecord(region, REGION_HEADER_SIZE, m_sequence + 1, RECORD_FLAG_COMMIT, image, 0, size);
+	if (written == 0) {
+		return false;
+	}
+
+	m_activeRegion = target;
+	m_generation = header.generation;
+	m_sequence++;
+	m_writeOffset = REGION_HEADER_SIZE + written;
+	m_recordCount = 1;
+	m_needsCompaction = false;
+	rememberChunks(image, size);
+	return true;
+}
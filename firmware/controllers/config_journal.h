@@ -0,0 +1,107 @@
+/**
+ * @file	config_journal.h
+ *
+ * Log structured configuration storage.
+ *
+ * Two flash regions, one of them active. The active region starts with a header and a snapshot
+ * of the whole configuration, every burn after that appends just the chunks which changed as
+ * records with a sequence number and a CRC. All records of one burn share the sequence number and
+ * the last of them is flagged as the commit. At boot the snapshot and the committed burns are
+ * replayed into RAM, a burn without its commit is dropped as a whole. Once the active region is
+ * full the current configuration is written as a fresh snapshot into the other region, so a
+ * region is only erased when it fills up and there is always one complete copy in flash, even if
+ * power goes away in the middle of a burn.
+ *
+ * @date Oct 18, 2026
+ */
+
+#pragma once
+
+#include "global.h"
+#include "flash_main.h"
+
+// configuration is compared and journaled in chunks of this size
+#define CONFIG_JOURNAL_CHUNK_SIZE 256
+
+#ifndef CONFIG_JOURNAL_REGION_SIZE
+// one 128K sector on stm32
+#define CONFIG_JOURNAL_REGION_SIZE (128 * 1024)
+#endif
+
+#ifndef CONFIG_JOURNAL_WRITE_ALIGN
+// flash is programmed in words of this many bytes, a word is programmed once between erases
+#define CONFIG_JOURNAL_WRITE_ALIGN 4
+#endif
+
+#define CONFIG_JOURNAL_MAX_CHUNKS ((sizeof(persistent_config_s) + CONFIG_JOURNAL_CHUNK_SIZE - 1) / CONFIG_JOURNAL_CHUNK_SIZE)
+
+/**
+ * A piece of flash which is erased as a whole, offsets are relative to its start.
+ */
+class FlashRegion {
+public:
+	virtual size_t getSize() const = 0;
+	virtual bool read(size_t offset, void *buffer, size_t size) = 0;
+	// the range has to be erased
+	virtual bool write(size_t offset, const void *buffer, size_t size) = 0;
+	virtual bool erase() = 0;
+};
+
+class ConfigJournal {
+public:
+	ConfigJournal(FlashRegion &first, FlashRegion &second);
+
+	/**
+	 * Finds the newest complete region and applies its records to image.
+	 * @return CRC_FAILED if there is no journal in either region
+	 */
+	persisted_configuration_state_e replay(uint8_t *image, size_t size, int version);
+
+	/**
+	 * Appends the chunks of image which differ from what the journal holds, or writes a fresh
+	 * snapshot into the other region if they do not fit.
+	 */
+	bool burn(const uint8_t *image, size_t size, int version);
+
+	// region records go to, -1 before the first replay or burn
+	int getActiveRegion() const {
+		return m_activeRegion;
+	}
+
+	size_t getUsedBytes() const {
+		return m_writeOffset;
+	}
+
+	uint32_t getGeneration() const {
+		return m_generation;
+	}
+
+	uint32_t getRecordCount() const {
+		return m_recordCount;
+	}
+
+	uint32_t getCompactionCount() const {
+		return m_compactionCount;
+	}
+
+private:
+	bool compact(const uint8_t *image, size_t size, int version);
+	bool append(const uint8_t *image, uint32_t sequence, uint32_t flags, size_t offset, size_t size);
+	bool replayRegion(int index, uint8_t *image, size_t size);
+	void rememberChunks(const uint8_t *image, size_t size);
+
+	FlashRegion *m_regions[2];
+
+	int m_activeRegion = -1;
+	size_t m_writeOffset = 0;
+	uint32_t m_generation = 0;
+	uint32_t m_sequence = 0;
+	// a torn record at the end, no more appends into this region
+	bool m_needsCompaction = false;
+
+	uint32_t m_recordCount = 0;
+	uint32_t m_compactionCount = 0;
+
+	// what the journal holds, to find the chunks a burn has to write
+	uint32_t m_chunkCrc[CONFIG_JOURNAL_MAX_CHUNKS];
+};
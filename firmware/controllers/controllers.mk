@@ -38,8 +38,10 @@ CONTROLLERS_SRC_CPP = \
 	$(CONTROLLERS_DIR)/engine_cycle/aux_valves.cpp \
 	$(CONTROLLERS_DIR)/engine_cycle/fuel_schedule.cpp \
 	$(CONTROLLERS_DIR)/flash_main.cpp \
+	$(CONTROLLERS_DIR)/config_journal.cpp \
 	$(CONTROLLERS_DIR)/bench_test.cpp \
 	$(CONTROLLERS_DIR)/can/obd2.cpp \
+	$(CONTROLLERS_DIR)/can/iso_tp.cpp \
 	$(CONTROLLERS_DIR)/can/can_verbose.cpp \
 	$(CONTROLLERS_DIR)/can/can_rx.cpp \
 	$(CONTORLLERS_DIR)/can/wideband_bootloader.cpp \
@@ -57,6 +59,7 @@ CONTROLLERS_SRC_CPP = \
 	$(CONTROLLERS_DIR)/start_stop.cpp \
 	$(CONTROLLERS_DIR)/simple_tcu.cpp \
 	$(CONTROLLERS_DIR)/limp_manager.cpp \
+	$(CONTROLLERS_DIR)/cut_pattern.cpp \
 
 CONTROLLERS_INC=\
 	$(CONTROLLERS_DIR) \
@@ -0,0 +1,57 @@
+#include "cut_pattern.h"
+#include "efilib.h"
+
+percent_t getRollingCutPercent(int rpm, int limit, int window) {
+	if (rpm > limit) {
+		return 100;
+	}
+
+	if (window <= 0 || rpm <= limit - window) {
+		return 0;
+	}
+
+	return 100.0f * (rpm - (limit - window)) / window;
+}
+
+void CutPattern::setTargetPercent(percent_t target) {
+	m_target = clampPercentValue(target);
+}
+
+void CutPattern::onEngineCycle(int cylinderCount) {
+	uint32_t mask = 0;
+	uint8_t cutCount = 0;
+
+	if (m_rotation >= cylinderCount) {
+		m_rotation = 0;
+	}
+
+	for (int i = 0; i < cylinderCount; i++) {
+		m_error += m_target;
+
+		if (m_error >= 100) {
+			m_error -= 100;
+
+			int eventIndex = i + m_rotation;
+			if (eventIndex >= cylinderCount) {
+				eventIndex -= cylinderCount;
+			}
+
+			mask |= 1 << eventIndex;
+			cutCount++;
+		}
+	}
+
+	m_rotation++;
+
+	m_mask = mask;
+	m_lastCutCount = cutCount;
+	m_lastCylinderCount = cylinderCount;
+}
+
+percent_t CutPattern::getActualPercent() const {
+	if (m_lastCylinderCount == 0) {
+		return 0;
+	}
+
+	return 100.0f * m_lastCutCount / m_lastCylinderCount;
+}
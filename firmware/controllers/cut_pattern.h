@@ -0,0 +1,43 @@
+#pragma once
+
+#include "rusefi_types.h"
+
+#include <cstdint>
+
+// Returns how much of the combustion events to cut: 0% up to limit - window, ramping up to 100% at the limit
+percent_t getRollingCutPercent(int rpm, int limit, int window);
+
+/**
+ * Decides which cylinders skip fuel or spark this engine cycle so that on average the
+ * requested share of combustion events is cut.
+ *
+ * Cuts are spread with a Bresenham style error accumulator carried across cycles, and the
+ * first cylinder considered rotates every cycle so that a fixed ratio does not keep landing
+ * on the same cylinder.
+ */
+class CutPattern {
+public:
+	void setTargetPercent(percent_t target);
+
+	// Called once per engine cycle, O(cylinders)
+	void onEngineCycle(int cylinderCount);
+
+	// Constant time so that the trigger callback can ask about every event
+	bool isCut(int eventIndex) const {
+		return m_mask & (1 << eventIndex);
+	}
+
+	// Share of events actually cut during the last engine cycle
+	percent_t getActualPercent() const;
+
+private:
+	// all in percent, 0-100
+	uint8_t m_target = 0;
+	uint8_t m_error = 0;
+
+	uint8_t m_rotation = 0;
+	uint8_t m_lastCutCount = 0;
+	uint8_t m_lastCylinderCount = 0;
+
+	uint32_t m_mask = 0;
+};
@@ -152,6 +152,11 @@ void FuelSchedule::onTriggerTooth(size_t toothIndex, int rpm, efitick_t nowNt DE
 	}
 
 	for (int i = 0; i < CONFIG(specs.cylindersCount); i++) {
+		if (!ENGINE(limpManager).allowInjection(i)) {
+			// rolling fuel cut skips this cylinder for the current engine cycle
+			continue;
+		}
+
 		elements[i].onTriggerTooth(toothIndex, rpm, nowNt);
 	}
 }
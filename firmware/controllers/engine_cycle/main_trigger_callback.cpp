@@ -53,9 +53,6 @@
 #include "perf_trace.h"
 #include "sensor.h"
 #include "injector_model.h"
-#if EFI_LAUNCH_CONTROL
-#include "launch_control.h"
-#endif
 
 #include "backup_ram.h"
 
@@ -319,7 +316,7 @@ static void handleFuel(const bool limitedFuel, uint32_t trgEventIndex, int rpm,
 	efiAssertVoid(CUSTOM_STACK_6627, getCurrentRemainingStack() > 128, "lowstck#3");
 	efiAssertVoid(CUSTOM_ERR_6628, trgEventIndex < engine->engineCycleEventCount, "handleFuel/event index");
 
-	ENGINE(tpsAccelEnrichment.onNewValue(Sensor::get(SensorType::Tps1).value_or(0) PASS_ENGINE_PARAMETER_SUFFIX));
+	ENGINE(tpsAccelEnrichment.onNewValue(ENGINE(sensorFrames).get(SensorType::Tps1).value_or(0) PASS_ENGINE_PARAMETER_SUFFIX));
 	if (trgEventIndex == 0) {
 		ENGINE(tpsAccelEnrichment.onEngineCycleTps(PASS_ENGINE_PARAMETER_SIGNATURE));
 		ENGINE(engineLoadAccelEnrichment.onEngineCycle(PASS_ENGINE_PARAMETER_SIGNATURE));
@@ -426,12 +423,10 @@ void mainTriggerCallback(uint32_t trgEventIndex, efitick_t edgeTimestamp DECLARE
 	bool limitedSpark = !ENGINE(limpManager).allowIgnition();
 	bool limitedFuel = !ENGINE(limpManager).allowInjection();
 
-#if EFI_LAUNCH_CONTROL
-	if (engine->isLaunchCondition && !limitedSpark && !limitedFuel) {
-		/* in case we are not already on a limited conditions, check launch as well */
-		applyLaunchControlLimiting(&limitedSpark, &limitedFuel PASS_ENGINE_PARAMETER_SUFFIX);
-	}
-#endif
+	// pick cylinders for rolling fuel/spark cut once per engine cycle, also with a crank-only
+	// trigger which goes around twice; per cylinder checks below are constant time
+	ENGINE(limpManager).updateEngineCycle(getEngineCycleCounter(PASS_ENGINE_PARAMETER_SIGNATURE), CONFIG(specs.cylindersCount));
+
 	if (trgEventIndex == 0) {
 		if (HAVE_CAM_INPUT()) {
 			engine->triggerCentral.validateCamVvtCounters();
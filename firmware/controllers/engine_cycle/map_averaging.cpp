@@ -38,6 +38,8 @@
 #include "engine_math.h"
 #include "perf_trace.h"
 
+#include <atomic>
+
 #if EFI_SENSOR_CHART
 #include "sensor_chart.h"
 #endif /* EFI_SENSOR_CHART */
@@ -60,21 +62,30 @@ static volatile int measurementsPerRevolutionCounter = 0;
 static volatile int measurementsPerRevolution = 0;
 
 /**
- * In this lock-free implementation 'readIndex' is always pointing
- * to the consistent copy of accumulator and counter pair
+ * One MAP sampling window: ADC samples of one cylinder within one engine cycle
  */
-static int readIndex = 0;
-static float accumulators[2];
-static int counters[2];
+struct MapAveragingWindow {
+	scheduling_s startTimer;
+	scheduling_s endTimer;
+
+	uint8_t cylinderIndex;
+	bool isOpen = false;
+	// mapSampler position of the first sample
+	uint32_t start;
+};
 
 /**
- * Running MAP accumulator - sum of all measurements within averaging window
+ * Ring of sampling windows indexed by engine cycle parity and cylinder - a window of the
+ * previous cycle could still be pending while we schedule the current one
  */
-static volatile float mapAdcAccumulator = 0;
+static MapAveragingWindow windows[2][INJECTION_PIN_COUNT];
+
+static MapSampler mapSampler;
+
 /**
- * Running counter of measurements to consider for averaging
+ * Number of samples in most recently processed window
  */
-static volatile int mapMeasurementsCounter = 0;
+static int mapMeasurementsCounter = 0;
 
 /**
  * v_ for Voltage
@@ -93,38 +104,73 @@ static int averagedMapBufIdx = 0;
 // this is 'minimal averaged' MAP within avegaging window
 static float currentPressure = NO_VALUE_YET;
 
-EXTERN_ENGINE;
-
 /**
- * here we have averaging start and averaging end points for each cylinder
+ * Per-cylinder results of the latest processed window, in kPa
  */
-static scheduling_s startTimer[INJECTION_PIN_COUNT][2];
-static scheduling_s endTimer[INJECTION_PIN_COUNT][2];
+static float cylinderMapAverage[INJECTION_PIN_COUNT];
+static float cylinderMapMin[INJECTION_PIN_COUNT];
 
-/**
- * that's a performance optimization: let's not bother averaging
- * if we are outside of of the window
- */
-static bool isAveraging = false;
+EXTERN_ENGINE;
+
+static_assert((MAP_SAMPLE_RING_SIZE & (MAP_SAMPLE_RING_SIZE - 1)) == 0, "MAP sample ring size has to be a power of two");
+
+uint32_t MapSampler::open() {
+	// count first: from here on the ADC callback stores samples, the window starts after them
+	m_openCount++;
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+	return m_writeIndex;
+}
 
-static void endAveraging(void *arg);
+void MapSampler::add(uint16_t adcValue) {
+	uint32_t index = m_writeIndex;
+	m_samples[index % MAP_SAMPLE_RING_SIZE] = adcValue;
+	// the sample has to be in place before the index says so
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+	m_writeIndex = index + 1;
+}
+
+void MapSampler::close(uint32_t start, MapSamples &result) {
+	uint32_t end = m_writeIndex;
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+	m_openCount--;
+
+	// keep clear of the slots the ADC callback may be writing while we read
+	uint32_t count = end - start;
+	if (count > MAP_SAMPLE_RING_SIZE / 2) {
+		start = end - MAP_SAMPLE_RING_SIZE / 2;
+		count = MAP_SAMPLE_RING_SIZE / 2;
+		m_overflowCount++;
+	}
+
+	result = { 0, (uint16_t)count, 0 };
+	for (uint32_t index = start; index != end; index++) {
+		uint16_t value = m_samples[index % MAP_SAMPLE_RING_SIZE];
+		result.adcSum += value;
+		if (index == start || value < result.adcMin) {
+			result.adcMin = value;
+		}
+	}
+}
+
+static void endAveraging(MapAveragingWindow *window);
 
-static void startAveraging(scheduling_s *endAveragingScheduling) {
+static void startAveraging(MapAveragingWindow *window) {
 	efiAssertVoid(CUSTOM_ERR_6649, getCurrentRemainingStack() > 128, "lowstck#9");
 
-	{
-		// with locking we will have a consistent state
-		chibios_rt::CriticalSectionLocker csl;
-		mapAdcAccumulator = 0;
-		mapMeasurementsCounter = 0;
-		isAveraging = true;
+	if (window->isOpen) {
+		// its end was never processed, it does not count as open any more
+		MapSamples discarded;
+		mapSampler.close(window->start, discarded);
 	}
 
+	window->start = mapSampler.open();
+	window->isOpen = true;
+
 	mapAveragingPin.setHigh();
 
 #if ! EFI_UNIT_TEST
-	scheduleByAngle(endAveragingScheduling, getTimeNowNt(), ENGINE(engineState.mapAveragingDuration),
-		endAveraging PASS_ENGINE_PARAMETER_SUFFIX);
+	scheduleByAngle(&window->endTimer, getTimeNowNt(), ENGINE(engineState.mapAveragingDuration),
+		{ endAveraging, window } PASS_ENGINE_PARAMETER_SUFFIX);
 #endif
 }
 
@@ -132,10 +178,12 @@ static void startAveraging(scheduling_s *endAveragingScheduling) {
 /**
  * This method is invoked from ADC callback.
  * @note This method is invoked OFTEN, this method is a potential bottle-next - the implementation should be
- * as fast as possible
+ * as fast as possible. We only store the sample here, all the math happens once the window is
+ * closed.
  */
 void mapAveragingAdcCallback(adcsample_t adcValue) {
-	if (!isAveraging && ENGINE(sensorChartMode) != SC_MAP) {
+	bool isSampling = mapSampler.isSampling();
+	if (!isSampling && ENGINE(sensorChartMode) != SC_MAP) {
 		return;
 	}
 
@@ -156,53 +204,56 @@ void mapAveragingAdcCallback(adcsample_t adcValue) {
 	}
 #endif /* EFI_SENSOR_CHART */
 
-	/**
-	 * Local copy is now safe, but it's an overkill: we only
-	 * have one writing thread anyway
-	 */
-	int readIndexLocal = readIndex;
-	int writeIndex = readIndexLocal ^ 1;
-	accumulators[writeIndex] = accumulators[readIndexLocal] + adcValue;
-	counters[writeIndex] = counters[readIndexLocal] + 1;
-	// this would commit the new pair of values
-	readIndex = writeIndex;
-
-	// todo: migrate to the lock-free implementation
-	{
-		// with locking we will have a consistent state
-		chibios_rt::CriticalSectionLocker csl;
-		mapAdcAccumulator += adcValue;
-		mapMeasurementsCounter++;
+	if (isSampling) {
+		mapSampler.add(adcValue);
 	}
 }
-#endif
 
-static void endAveraging(void *arg) {
-	(void) arg;
-#if ! EFI_UNIT_TEST
-	chibios_rt::CriticalSectionLocker csl;
-#endif
-	isAveraging = false;
-	// with locking we would have a consistent state
-#if HAL_USE_ADC
-	if (mapMeasurementsCounter > 0) {
-		v_averagedMapValue = adcToVoltsDivided(mapAdcAccumulator / mapMeasurementsCounter);
-		// todo: move out of locked context?
-		averagedMapRunningBuffer[averagedMapBufIdx] = getMapByVoltage(v_averagedMapValue);
-		// increment circular running buffer index
-		averagedMapBufIdx = (averagedMapBufIdx + 1) % mapMinBufferLength;
-		// find min. value (only works for pressure values, not raw voltages!)
-		float minPressure = averagedMapRunningBuffer[0];
-		for (int i = 1; i < mapMinBufferLength; i++) {
-			if (averagedMapRunningBuffer[i] < minPressure)
-				minPressure = averagedMapRunningBuffer[i];
-		}
-		currentPressure = minPressure;
-	} else {
+/**
+ * Converts a closed window into pressure, this is not invoked from the ADC callback
+ */
+static void processMapWindow(int cylinderIndex, const MapSamples &samples) {
+	mapMeasurementsCounter = samples.count;
+	if (samples.count == 0) {
 		warning(CUSTOM_UNEXPECTED_MAP_VALUE, "No MAP values");
+		return;
 	}
+
+	v_averagedMapValue = adcToVoltsDivided((float)samples.adcSum / samples.count);
+	float averagePressure = getMapByVoltage(v_averagedMapValue);
+
+	cylinderMapAverage[cylinderIndex] = averagePressure;
+	cylinderMapMin[cylinderIndex] = getMapByVoltage(adcToVoltsDivided(samples.adcMin));
+
+	averagedMapRunningBuffer[averagedMapBufIdx] = averagePressure;
+	// increment circular running buffer index
+	averagedMapBufIdx = (averagedMapBufIdx + 1) % mapMinBufferLength;
+	// find min. value (only works for pressure values, not raw voltages!)
+	float minPressure = averagedMapRunningBuffer[0];
+	for (int i = 1; i < mapMinBufferLength; i++) {
+		if (averagedMapRunningBuffer[i] < minPressure)
+			minPressure = averagedMapRunningBuffer[i];
+	}
+	currentPressure = minPressure;
+}
 #endif
-	mapAveragingPin.setLow();
+
+static void endAveraging(MapAveragingWindow *window) {
+	if (!window->isOpen) {
+		return;
+	}
+
+	// the window of the next cylinder might be open already, it keeps sampling
+	MapSamples samples;
+	mapSampler.close(window->start, samples);
+	window->isOpen = false;
+
+#if HAL_USE_ADC
+	processMapWindow(window->cylinderIndex, samples);
+#endif
+	if (!mapSampler.isSampling()) {
+		mapAveragingPin.setLow();
+	}
 }
 
 static void applyMapMinBufferLength(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
@@ -308,15 +359,25 @@ void mapAveragingTriggerCallback(
 		// at the moment we schedule based on time prediction based on current RPM and angle
 		// we are loosing precision in case of changing RPM - the further away is the event the worse is precision
 		// todo: schedule this based on closest trigger event, same as ignition works
-		scheduleByAngle(&startTimer[i][structIndex], edgeTimestamp, samplingStart,
-				{ startAveraging, &endTimer[i][structIndex] } PASS_ENGINE_PARAMETER_SUFFIX);
+		MapAveragingWindow *window = &windows[structIndex][i];
+		window->cylinderIndex = i;
+		scheduleByAngle(&window->startTimer, edgeTimestamp, samplingStart,
+				{ startAveraging, window } PASS_ENGINE_PARAMETER_SUFFIX);
 	}
 #endif
 }
 
+#if ! EFI_UNIT_TEST
 static void showMapStats(void) {
 	scheduleMsg(logger, "per revolution %d", measurementsPerRevolution);
+	scheduleMsg(logger, "windows longer than %d samples %d", MAP_SAMPLE_RING_SIZE / 2, mapSampler.getOverflowCount());
+
+	for (int i = 0; i < engineConfiguration->specs.cylindersCount; i++) {
+		scheduleMsg(logger, "cylinder %d MAP average %.2f min %.2f", i + 1,
+				cylinderMapAverage[i], cylinderMapMin[i]);
+	}
 }
+#endif /* EFI_UNIT_TEST */
 
 #if EFI_PROD_CODE
 
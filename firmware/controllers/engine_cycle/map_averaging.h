@@ -18,6 +18,55 @@ void mapAveragingAdcCallback(adcsample_t newValue);
 void initMapAveraging(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX);
 void refreshMapAveragingPreCalc(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 
+#ifndef MAP_SAMPLE_RING_SIZE
+// has to be a power of two; a window longer than this keeps its latest samples
+#define MAP_SAMPLE_RING_SIZE 1024
+#endif
+
+/**
+ * Raw ADC values collected within one sampling window
+ */
+struct MapSamples {
+	uint32_t adcSum;
+	uint16_t count;
+	uint16_t adcMin;
+};
+
+/**
+ * Raw MAP samples in the order the ADC took them.
+ *
+ * The ADC callback is the only writer: it stores a sample and then publishes it by moving the
+ * write index, no lock and no per window work. A window is just the range of write indexes between
+ * open() and close(), so windows of neighbouring cylinders overlap freely. Sum, minimum and count
+ * are worked out in close(), from the timer callback.
+ */
+class MapSampler {
+public:
+	/**
+	 * @return position the window starts at
+	 */
+	uint32_t open();
+	// ADC callback
+	void add(uint16_t adcValue);
+	void close(uint32_t start, MapSamples &result);
+
+	bool isSampling() const {
+		return m_openCount != 0;
+	}
+
+	// windows which were longer than the ring and lost their first samples
+	uint32_t getOverflowCount() const {
+		return m_overflowCount;
+	}
+
+private:
+	uint16_t m_samples[MAP_SAMPLE_RING_SIZE];
+	volatile uint32_t m_writeIndex = 0;
+	// only changed by open() and close()
+	volatile uint8_t m_openCount = 0;
+	uint32_t m_overflowCount = 0;
+};
+
 void mapAveragingTriggerCallback(
 		uint32_t index, efitick_t edgeTimestamp DECLARE_ENGINE_PARAMETER_SUFFIX);
 
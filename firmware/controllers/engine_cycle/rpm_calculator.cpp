@@ -315,7 +315,6 @@ void rpmShaftPositionCallback(trigger_event_e ckpSignalType,
 
 static scheduling_s tdcScheduler[2];
 
-static char rpmBuffer[_MAX_FILLER];
 
 /**
  * This callback has nothing to do with actual engine control, it just sends a Top Dead Center mark to the rusEfi console
@@ -328,11 +327,10 @@ static void onTdcCallback(Engine *engine) {
 	}
 #endif /* EFI_UNIT_TEST */
 	EXPAND_Engine;
-	itoa10(rpmBuffer, GET_RPM());
 #if EFI_ENGINE_SNIFFER
 	waveChart.startDataCollection();
 #endif
-	addEngineSnifferEvent(TOP_DEAD_CENTER_MESSAGE, (char* ) rpmBuffer);
+	addEngineSnifferValue(TOP_DEAD_CENTER_MESSAGE, "", GET_RPM());
 #if EFI_TOOTH_LOGGER
 	LogTriggerTopDeadCenter(getTimeNowNt() PASS_ENGINE_PARAMETER_SUFFIX);
 #endif /* EFI_TOOTH_LOGGER */
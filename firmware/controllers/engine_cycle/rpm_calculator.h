@@ -176,8 +176,10 @@ float getCrankshaftAngleNt(efitick_t timeNt DECLARE_ENGINE_PARAMETER_SUFFIX);
 
 #if EFI_ENGINE_SNIFFER
 #define addEngineSnifferEvent(name, msg) if (ENGINE(isEngineChartEnabled)) { waveChart.addEvent3((name), (msg)); }
+#define addEngineSnifferValue(name, msg, value) if (ENGINE(isEngineChartEnabled)) { waveChart.addEvent3((name), (msg), (value)); }
  #else
 #define addEngineSnifferEvent(n, msg) {}
+#define addEngineSnifferValue(n, msg, value) {}
 #endif /* EFI_ENGINE_SNIFFER */
 
 efitick_t scheduleByAngle(scheduling_s *timer, efitick_t edgeTimestamp, angle_t angle, action_s action DECLARE_ENGINE_PARAMETER_SUFFIX);
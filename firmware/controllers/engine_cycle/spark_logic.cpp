@@ -84,14 +84,17 @@ static void prepareCylinderIgnitionSchedule(angle_t dwellAngleDuration, floatms_
 	// change of sign here from 'before TDC' to 'after TDC'
 	angle_t ignitionPositionWithinEngineCycle = ENGINE(ignitionPositionWithinEngineCycle[event->cylinderIndex]);
 	assertAngleRange(ignitionPositionWithinEngineCycle, "aPWEC", CUSTOM_ERR_6566);
+	const int index = ENGINE(ignitionPin[event->cylinderIndex]);
+	const int coilIndex = ID2INDEX(getCylinderId(index PASS_ENGINE_PARAMETER_SUFFIX));
+
 	// this correction is usually zero (not used)
 	cfg_float_t_1f perCylinderCorrection = CONFIG(timing_offset_cylinder[event->cylinderIndex]);
-	const angle_t sparkAngle = -ENGINE(engineState.timingAdvance) + ignitionPositionWithinEngineCycle + perCylinderCorrection;
+	// knock is tracked by physical cylinder, same as knock sensing below
+	angle_t knockRetard = ENGINE(knockController).getRetard(coilIndex);
+	const angle_t sparkAngle = -ENGINE(engineState.timingAdvance) + ignitionPositionWithinEngineCycle + perCylinderCorrection + knockRetard;
 	efiAssertVoid(CUSTOM_SPARK_ANGLE_9, !cisnan(sparkAngle), "findAngle#9");
 
 	efiAssertVoid(CUSTOM_SPARK_ANGLE_1, !cisnan(sparkAngle), "sparkAngle#1");
-	const int index = ENGINE(ignitionPin[event->cylinderIndex]);
-	const int coilIndex = ID2INDEX(getCylinderId(index PASS_ENGINE_PARAMETER_SUFFIX));
 	IgnitionOutputPin *output = &enginePins.coils[coilIndex];
 
 	IgnitionOutputPin *secondOutput;
@@ -126,7 +129,7 @@ static void prepareCylinderIgnitionSchedule(angle_t dwellAngleDuration, floatms_
 #endif /* FUEL_MATH_EXTREME_LOGGING */
 }
 
-void fireSparkAndPrepareNextSchedule(IgnitionEvent *event) {
+static void fireSparkOutputs(IgnitionEvent *event) {
 	for (int i = 0; i< MAX_OUTPUTS_FOR_IGNITION;i++) {
 		IgnitionOutputPin *output = event->outputs[i];
 
@@ -134,6 +137,76 @@ void fireSparkAndPrepareNextSchedule(IgnitionEvent *event) {
 			fireSparkBySettingPinLow(event, output);
 		}
 	}
+}
+
+/**
+ * Lay out dwell/fire edges of all extra sparks relative to the main spark
+ */
+void prepareMultisparkBurst(IgnitionEvent *event, int sparkCount DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	MultisparkBurst *burst = &event->multispark;
+	sparkCount = minI(sparkCount, MAX_MULTISPARK_EXTRA_SPARKS);
+
+	// dwell times are below 10 seconds here so we use 32 bit type for performance reasons
+	uint32_t delayNt = ENGINE(engineState.multispark.delay);
+	uint32_t dwellNt = ENGINE(engineState.multispark.dwell);
+
+	uint32_t offsetNt = 0;
+	for (int i = 0; i < sparkCount; i++) {
+		offsetNt += delayNt;
+		burst->edgeOffsetNt[2 * i] = offsetNt;
+		offsetNt += dwellNt;
+		burst->edgeOffsetNt[2 * i + 1] = offsetNt;
+	}
+
+	burst->edgeCount = 2 * sparkCount;
+	burst->nextEdge = 0;
+}
+
+static void prepareNextCylinderSchedule(IgnitionEvent *event DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	angle_t dwellAngleDuration = ENGINE(engineState.dwellAngle);
+	floatms_t sparkDwell = ENGINE(engineState.sparkDwell);
+	if (cisnan(dwellAngleDuration) || cisnan(sparkDwell)) {
+		// we are here if engine has just stopped
+		return;
+	}
+
+	prepareCylinderIgnitionSchedule(dwellAngleDuration, sparkDwell, event PASS_ENGINE_PARAMETER_SUFFIX);
+}
+
+/**
+ * One edge of a multispark burst. Each edge queues the following one at its precomputed
+ * moment, the last one prepares the schedule for the next engine cycle.
+ */
+static void onMultisparkEdge(IgnitionEvent *event) {
+#if EFI_UNIT_TEST
+	Engine *engine = event->engine;
+	EXPAND_Engine;
+#endif // EFI_UNIT_TEST
+
+	MultisparkBurst *burst = &event->multispark;
+	bool isDwellStart = burst->nextEdge % 2 == 0;
+	burst->nextEdge++;
+
+	if (isDwellStart) {
+		turnSparkPinHigh(event);
+	} else {
+		fireSparkOutputs(event);
+#if EFI_TOOTH_LOGGER
+		LogTriggerCoilState(getTimeNowNt(), false PASS_ENGINE_PARAMETER_SUFFIX);
+#endif // EFI_TOOTH_LOGGER
+	}
+
+	if (burst->nextEdge < burst->edgeCount) {
+		efitick_t nextEdgeNt = burst->startNt + burst->edgeOffsetNt[burst->nextEdge];
+		engine->executor.scheduleByTimestampNt(&burst->timer, nextEdgeNt, { onMultisparkEdge, event });
+	} else {
+		// If all sparks have been fired, prepare for next time.
+		prepareNextCylinderSchedule(event PASS_ENGINE_PARAMETER_SUFFIX);
+	}
+}
+
+void fireSparkAndPrepareNextSchedule(IgnitionEvent *event) {
+	fireSparkOutputs(event);
 
 	efitick_t nowNt = getTimeNowNt();
 
@@ -176,29 +249,20 @@ if (engineConfiguration->debugMode == DBG_DWELL_METRIC) {
 #endif /* EFI_UNIT_TEST */
 	// now that we've just fired a coil let's prepare the new schedule for the next engine revolution
 
-	angle_t dwellAngleDuration = ENGINE(engineState.dwellAngle);
-	floatms_t sparkDwell = ENGINE(engineState.sparkDwell);
-	if (cisnan(dwellAngleDuration) || cisnan(sparkDwell)) {
+	if (cisnan(ENGINE(engineState.dwellAngle)) || cisnan(ENGINE(engineState.sparkDwell))) {
 		// we are here if engine has just stopped
 		return;
 	}
 
-	// If there are more sparks to fire, schedule them
-	if (event->sparksRemaining > 0)
-	{
-		event->sparksRemaining--;
-
-		efitick_t nextDwellStart = nowNt + engine->engineState.multispark.delay;
-		efitick_t nextFiring = nextDwellStart + engine->engineState.multispark.dwell;
-
-		// We can schedule both of these right away, since we're going for "asap" not "particular angle"
-		engine->executor.scheduleByTimestampNt(&event->dwellStartTimer, nextDwellStart, { &turnSparkPinHigh, event });
-		engine->executor.scheduleByTimestampNt(&event->sparkEvent.scheduling, nextFiring, { fireSparkAndPrepareNextSchedule, event });
-	}
-	else
-	{
-		// If all events have been scheduled, prepare for next time.
-		prepareCylinderIgnitionSchedule(dwellAngleDuration, sparkDwell, event PASS_ENGINE_PARAMETER_SUFFIX);
+	MultisparkBurst *burst = &event->multispark;
+	if (burst->edgeCount > 0) {
+		// Extra sparks were laid out when this event was scheduled, only the first edge goes
+		// into the queue now. The schedule for next time is prepared by the last edge.
+		burst->startNt = nowNt;
+		burst->nextEdge = 0;
+		engine->executor.scheduleByTimestampNt(&burst->timer, nowNt + burst->edgeOffsetNt[0], { onMultisparkEdge, event });
+	} else {
+		prepareNextCylinderSchedule(event PASS_ENGINE_PARAMETER_SUFFIX);
 	}
 
 #if EFI_SOFTWARE_KNOCK
@@ -362,10 +426,10 @@ static void handleSparkEvent(bool limitedSpark, uint32_t trgEventIndex, Ignition
 		 */
 		scheduleByAngle(&event->dwellStartTimer, edgeTimestamp, angleOffset, { &turnSparkPinHigh, event } PASS_ENGINE_PARAMETER_SUFFIX);
 
-		event->sparksRemaining = ENGINE(engineState.multispark.count);
+		prepareMultisparkBurst(event, ENGINE(engineState.multispark.count) PASS_ENGINE_PARAMETER_SUFFIX);
 	} else {
 		// don't fire multispark if spark is cut completely!
-		event->sparksRemaining = 0;
+		prepareMultisparkBurst(event, 0 PASS_ENGINE_PARAMETER_SUFFIX);
 	}
 
 	/**
@@ -504,7 +568,8 @@ void onTriggerEventSparkLogic(bool limitedSpark, uint32_t trgEventIndex, int rpm
 			IgnitionEvent *event = &ENGINE(ignitionEvents.elements[i]);
 			if (event->dwellPosition.triggerEventIndex != trgEventIndex)
 				continue;
-			handleSparkEvent(limitedSpark, trgEventIndex, event, rpm, edgeTimestamp PASS_ENGINE_PARAMETER_SUFFIX);
+			bool limitedCylinderSpark = limitedSpark || !ENGINE(limpManager).allowIgnition(i);
+			handleSparkEvent(limitedCylinderSpark, trgEventIndex, event, rpm, edgeTimestamp PASS_ENGINE_PARAMETER_SUFFIX);
 		}
 	}
 }
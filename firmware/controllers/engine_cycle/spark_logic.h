@@ -13,6 +13,7 @@ void onTriggerEventSparkLogic(bool limitedSpark, uint32_t trgEventIndex, int rpm
 void initSparkLogic(Logging *sharedLogger);
 void turnSparkPinHigh(IgnitionEvent *event);
 void fireSparkAndPrepareNextSchedule(IgnitionEvent *event);
+void prepareMultisparkBurst(IgnitionEvent *event, int sparkCount DECLARE_ENGINE_PARAMETER_SUFFIX);
 int getNumberOfSparks(ignition_mode_e mode DECLARE_ENGINE_PARAMETER_SUFFIX);
 percent_t getCoilDutyCycle(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX);
 void initializeIgnitionActions(DECLARE_ENGINE_PARAMETER_SIGNATURE);
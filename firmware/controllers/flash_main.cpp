@@ -16,6 +16,10 @@
 #include "flash_int.h"
 #include "engine_math.h"
 
+#if EFI_CONFIG_JOURNAL
+#include "config_journal.h"
+#endif
+
 #if EFI_TUNER_STUDIO
 #include "tunerstudio.h"
 #endif
@@ -71,6 +75,48 @@ int eraseAndFlashCopy(flashaddr_t storageAddress, const TStorage& data)
 	return intFlashWrite(storageAddress, reinterpret_cast<const char*>(&data), sizeof(TStorage));
 }
 
+#if EFI_CONFIG_JOURNAL
+class IntFlashRegion final : public FlashRegion {
+public:
+	explicit IntFlashRegion(flashaddr_t address)
+		: m_address(address)
+	{
+	}
+
+	size_t getSize() const override {
+		return CONFIG_JOURNAL_REGION_SIZE;
+	}
+
+	bool read(size_t offset, void *buffer, size_t size) override {
+		return intFlashRead(m_address + offset, reinterpret_cast<char*>(buffer), size) == FLASH_RETURN_SUCCESS;
+	}
+
+	bool write(size_t offset, const void *buffer, size_t size) override {
+		return intFlashWrite(m_address + offset, reinterpret_cast<const char*>(buffer), size) == FLASH_RETURN_SUCCESS;
+	}
+
+	bool erase() override {
+		return intFlashErase(m_address, CONFIG_JOURNAL_REGION_SIZE) == FLASH_RETURN_SUCCESS;
+	}
+
+private:
+	const flashaddr_t m_address;
+};
+
+/**
+ * The sectors which used to hold the two copies now take turns holding the journal
+ */
+static IntFlashRegion firstRegion(getFlashAddrFirstCopy());
+static IntFlashRegion secondRegion(getFlashAddrSecondCopy());
+static ConfigJournal configJournal(firstRegion, secondRegion);
+
+static void showJournalInfo() {
+	scheduleMsg(logger, "config journal: region %d generation %d, %d of %d bytes in %d records, %d compactions",
+			configJournal.getActiveRegion(), configJournal.getGeneration(), configJournal.getUsedBytes(),
+			CONFIG_JOURNAL_REGION_SIZE, configJournal.getRecordCount(), configJournal.getCompactionCount());
+}
+#endif /* EFI_CONFIG_JOURNAL */
+
 void writeToFlashNow(void) {
 	scheduleMsg(logger, " !!!!!!!!!!!!!!!!!!!! BE SURE NOT WRITE WITH IGNITION ON !!!!!!!!!!!!!!!!!!!!");
 
@@ -79,12 +125,18 @@ void writeToFlashNow(void) {
 	persistentState.version = FLASH_DATA_VERSION;
 	persistentState.value = flashStateCrc(&persistentState);
 
+#if EFI_CONFIG_JOURNAL
+	// just the chunks which changed, a sector is erased only once the journal is full
+	bool isSuccess = configJournal.burn(reinterpret_cast<const uint8_t*>(&persistentState.persistentConfiguration),
+			sizeof(persistent_config_s), FLASH_DATA_VERSION);
+#else
 	// Flash two copies
 	int result1 = eraseAndFlashCopy(getFlashAddrFirstCopy(), persistentState);
 	int result2 = eraseAndFlashCopy(getFlashAddrSecondCopy(), persistentState);
 
 	// handle success/failure
 	bool isSuccess = (result1 == FLASH_RETURN_SUCCESS) && (result2 == FLASH_RETURN_SUCCESS);
+#endif /* EFI_CONFIG_JOURNAL */
 
 	if (isSuccess) {
 		scheduleMsg(logger, "FLASH_SUCCESS");
@@ -121,17 +173,32 @@ static persisted_configuration_state_e doReadConfiguration(flashaddr_t address,
 	}
 }
 
+static persisted_configuration_state_e readBothCopies(Logging * logger) {
+	persisted_configuration_state_e result = doReadConfiguration(getFlashAddrFirstCopy(), logger);
+	if (result != PC_OK) {
+		printMsg(logger, "Reading second configuration copy");
+		result = doReadConfiguration(getFlashAddrSecondCopy(), logger);
+	}
+	return result;
+}
+
 /**
  * this method could and should be executed before we have any
  * connectivity so no console output here
  */
 persisted_configuration_state_e readConfiguration(Logging * logger) {
 	efiAssert(CUSTOM_ERR_ASSERT, getCurrentRemainingStack() > EXPECTED_REMAINING_STACK, "read f", PC_ERROR);
-	persisted_configuration_state_e result = doReadConfiguration(getFlashAddrFirstCopy(), logger);
-	if (result != PC_OK) {
-		printMsg(logger, "Reading second configuration copy");
-		result = doReadConfiguration(getFlashAddrSecondCopy(), logger);
+#if EFI_CONFIG_JOURNAL
+	persisted_configuration_state_e result = configJournal.replay(reinterpret_cast<uint8_t*>(&persistentState.persistentConfiguration),
+			sizeof(persistent_config_s), FLASH_DATA_VERSION);
+	if (result == CRC_FAILED) {
+		// no journal yet, the next burn turns the old copy into one
+		printMsg(logger, "No configuration journal");
+		result = readBothCopies(logger);
 	}
+#else
+	persisted_configuration_state_e result = readBothCopies(logger);
+#endif /* EFI_CONFIG_JOURNAL */
 
 	if (result == CRC_FAILED) {
 	    // we are here on first boot on brand new chip
@@ -195,6 +262,9 @@ void initFlash(Logging *sharedLogger) {
 #endif
 	addConsoleAction("resetconfig", doResetConfiguration);
 	addConsoleAction("rewriteconfig", rewriteConfig);
+#if EFI_CONFIG_JOURNAL
+	addConsoleAction("journalinfo", showJournalInfo);
+#endif
 }
 
 #endif /* EFI_INTERNAL_FLASH */
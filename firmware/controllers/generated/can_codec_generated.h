@@ -0,0 +1,649 @@
+//
+// was generated automatically by gen_can_codec.py based on gen_can_codec.sh integration/can/dashboards.dbc integration/can/rusefi_verbose.dbc integration/can/vehicle_speed.dbc
+// do not edit, change the DBC files and generate again
+//
+
+#pragma once
+
+#include "can_codec.h"
+
+// integration/can/dashboards.dbc
+
+/**
+ * 0x153 BmwE46Speed, sent by rusEFI
+ */
+struct BmwE46Speed {
+	static constexpr uint32_t id = 0x153;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal speedSignal = { 8, 16, CanByteOrder::Intel, false, 0.125f, 0.0f };
+
+	// kph, 0 to 8191.875
+	float speed = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		speedSignal.encode(data, speed);
+	}
+
+	static constexpr BmwE46Speed unpack(const uint8_t *data) {
+		BmwE46Speed m;
+		m.speed = speedSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x316 BmwE46Rpm, sent by rusEFI
+ */
+struct BmwE46Rpm {
+	static constexpr uint32_t id = 0x316;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal rpmSignal = { 16, 16, CanByteOrder::Intel, false, 0.15625f, 0.0f };
+
+	// rpm, 0 to 10239.84375
+	float rpm = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		rpmSignal.encode(data, rpm);
+	}
+
+	static constexpr BmwE46Rpm unpack(const uint8_t *data) {
+		BmwE46Rpm m;
+		m.rpm = rpmSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x329 BmwE46Dme2, sent by rusEFI
+ */
+struct BmwE46Dme2 {
+	static constexpr uint32_t id = 0x329;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal cltSignal = { 8, 8, CanByteOrder::Intel, false, 0.75f, -48.373f };
+
+	// degC, -48.373 to 142.877
+	float clt = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		cltSignal.encode(data, clt);
+	}
+
+	static constexpr BmwE46Dme2 unpack(const uint8_t *data) {
+		BmwE46Dme2 m;
+		m.clt = cltSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x561 FiatMotorInfo, sent by rusEFI
+ */
+struct FiatMotorInfo {
+	static constexpr uint32_t id = 0x561;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal cltSignal = { 24, 16, CanByteOrder::Intel, true, 1.0f, 40.0f };
+	static constexpr CanSignal rpmSignal = { 48, 16, CanByteOrder::Intel, false, 32.0f, 0.0f };
+
+	// degC, -32728 to 32807
+	float clt = 0;
+	// rpm, 0 to 2097120
+	float rpm = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		cltSignal.encode(data, clt);
+		rpmSignal.encode(data, rpm);
+	}
+
+	static constexpr FiatMotorInfo unpack(const uint8_t *data) {
+		FiatMotorInfo m;
+		m.clt = cltSignal.decode(data);
+		m.rpm = rpmSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x280 VagRpm, sent by rusEFI
+ */
+struct VagRpm {
+	static constexpr uint32_t id = 0x280;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal rpmSignal = { 16, 16, CanByteOrder::Intel, false, 0.25f, 0.0f };
+
+	// rpm, 0 to 16383.75
+	float rpm = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		rpmSignal.encode(data, rpm);
+	}
+
+	static constexpr VagRpm unpack(const uint8_t *data) {
+		VagRpm m;
+		m.rpm = rpmSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x288 VagClt, sent by rusEFI
+ */
+struct VagClt {
+	static constexpr uint32_t id = 0x288;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal cltSignal = { 8, 8, CanByteOrder::Intel, false, 0.75f, -48.373f };
+
+	// degC, -48.373 to 142.877
+	float clt = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		cltSignal.encode(data, clt);
+	}
+
+	static constexpr VagClt unpack(const uint8_t *data) {
+		VagClt m;
+		m.clt = cltSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x420 VagCltV2, sent by rusEFI
+ */
+struct VagCltV2 {
+	static constexpr uint32_t id = 0x420;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal cltSignal = { 32, 8, CanByteOrder::Intel, false, 0.75f, -48.373f };
+
+	// degC, -48.373 to 142.877
+	float clt = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		cltSignal.encode(data, clt);
+	}
+
+	static constexpr VagCltV2 unpack(const uint8_t *data) {
+		VagCltV2 m;
+		m.clt = cltSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x3D0 VagImmo, sent by rusEFI
+ */
+struct VagImmo {
+	static constexpr uint32_t id = 0x3D0;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal immoSignal = { 8, 16, CanByteOrder::Intel, false, 1.0f, 0.0f };
+
+	// 0 to 65535
+	float immo = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		immoSignal.encode(data, immo);
+	}
+
+	static constexpr VagImmo unpack(const uint8_t *data) {
+		VagImmo m;
+		m.immo = immoSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x201 MazdaRx8RpmSpeed, sent by rusEFI
+ */
+struct MazdaRx8RpmSpeed {
+	static constexpr uint32_t id = 0x201;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal rpmSignal = { 7, 16, CanByteOrder::Motorola, false, 0.25f, 0.0f };
+	static constexpr CanSignal unknownSignal = { 23, 16, CanByteOrder::Motorola, false, 1.0f, 0.0f };
+	static constexpr CanSignal speedSignal = { 39, 16, CanByteOrder::Motorola, false, 0.01f, -100.0f };
+
+	// rpm, 0 to 16383.75
+	float rpm = 0;
+	// 0 to 65535
+	float unknown = 0;
+	// kph, -100 to 555.35
+	float speed = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		rpmSignal.encode(data, rpm);
+		unknownSignal.encode(data, unknown);
+		speedSignal.encode(data, speed);
+	}
+
+	static constexpr MazdaRx8RpmSpeed unpack(const uint8_t *data) {
+		MazdaRx8RpmSpeed m;
+		m.rpm = rpmSignal.decode(data);
+		m.unknown = unknownSignal.decode(data);
+		m.speed = speedSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x420 MazdaRx8Status2, sent by rusEFI
+ */
+struct MazdaRx8Status2 {
+	static constexpr uint32_t id = 0x420;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal cltSignal = { 0, 8, CanByteOrder::Intel, false, 1.0f, -69.0f };
+	static constexpr CanSignal odometerSignal = { 8, 8, CanByteOrder::Intel, false, 1.0f, 0.0f };
+	static constexpr CanSignal oilPressureSignal = { 32, 8, CanByteOrder::Intel, false, 1.0f, 0.0f };
+	static constexpr CanSignal batteryLightSignal = { 54, 1, CanByteOrder::Intel, false, 1.0f, 0.0f };
+	static constexpr CanSignal coolantLightSignal = { 49, 1, CanByteOrder::Intel, false, 1.0f, 0.0f };
+
+	// degC, -69 to 186
+	float clt = 0;
+	// 0 to 255
+	float odometer = 0;
+	// 0 to 255
+	float oilPressure = 0;
+	// 0 to 1
+	float batteryLight = 0;
+	// 0 to 1
+	float coolantLight = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		cltSignal.encode(data, clt);
+		odometerSignal.encode(data, odometer);
+		oilPressureSignal.encode(data, oilPressure);
+		batteryLightSignal.encode(data, batteryLight);
+		coolantLightSignal.encode(data, coolantLight);
+	}
+
+	static constexpr MazdaRx8Status2 unpack(const uint8_t *data) {
+		MazdaRx8Status2 m;
+		m.clt = cltSignal.decode(data);
+		m.odometer = odometerSignal.decode(data);
+		m.oilPressure = oilPressureSignal.decode(data);
+		m.batteryLight = batteryLightSignal.decode(data);
+		m.coolantLight = coolantLightSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x308 W202Stat1, sent by rusEFI
+ */
+struct W202Stat1 {
+	static constexpr uint32_t id = 0x308;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal rpmSignal = { 15, 16, CanByteOrder::Motorola, false, 1.0f, 0.0f };
+
+	// rpm, 0 to 65535
+	float rpm = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		rpmSignal.encode(data, rpm);
+	}
+
+	static constexpr W202Stat1 unpack(const uint8_t *data) {
+		W202Stat1 m;
+		m.rpm = rpmSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x608 W202Stat2, sent by rusEFI
+ */
+struct W202Stat2 {
+	static constexpr uint32_t id = 0x608;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal cltSignal = { 0, 8, CanByteOrder::Intel, false, 1.0f, -40.0f };
+
+	// degC, -40 to 215
+	float clt = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		cltSignal.encode(data, clt);
+	}
+
+	static constexpr W202Stat2 unpack(const uint8_t *data) {
+		W202Stat2 m;
+		m.clt = cltSignal.decode(data);
+		return m;
+	}
+};
+
+// integration/can/rusefi_verbose.dbc
+
+/**
+ * 0x200 VerboseStatus, sent by rusEFI
+ */
+struct VerboseStatus {
+	static constexpr uint32_t id = 0x200;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal warningCounterSignal = { 0, 16, CanByteOrder::Intel, false, 1.0f, 0.0f };
+	static constexpr CanSignal lastErrorCodeSignal = { 16, 16, CanByteOrder::Intel, false, 1.0f, 0.0f };
+	static constexpr CanSignal revLimitSignal = { 32, 1, CanByteOrder::Intel, false, 1.0f, 0.0f };
+	static constexpr CanSignal mainRelaySignal = { 33, 1, CanByteOrder::Intel, false, 1.0f, 0.0f };
+	static constexpr CanSignal fuelPumpSignal = { 34, 1, CanByteOrder::Intel, false, 1.0f, 0.0f };
+	static constexpr CanSignal checkEngineSignal = { 35, 1, CanByteOrder::Intel, false, 1.0f, 0.0f };
+	static constexpr CanSignal o2HeaterSignal = { 36, 1, CanByteOrder::Intel, false, 1.0f, 0.0f };
+
+	// 0 to 65535
+	float warningCounter = 0;
+	// 0 to 65535
+	float lastErrorCode = 0;
+	// 0 to 1
+	float revLimit = 0;
+	// 0 to 1
+	float mainRelay = 0;
+	// 0 to 1
+	float fuelPump = 0;
+	// 0 to 1
+	float checkEngine = 0;
+	// 0 to 1
+	float o2Heater = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		warningCounterSignal.encode(data, warningCounter);
+		lastErrorCodeSignal.encode(data, lastErrorCode);
+		revLimitSignal.encode(data, revLimit);
+		mainRelaySignal.encode(data, mainRelay);
+		fuelPumpSignal.encode(data, fuelPump);
+		checkEngineSignal.encode(data, checkEngine);
+		o2HeaterSignal.encode(data, o2Heater);
+	}
+
+	static constexpr VerboseStatus unpack(const uint8_t *data) {
+		VerboseStatus m;
+		m.warningCounter = warningCounterSignal.decode(data);
+		m.lastErrorCode = lastErrorCodeSignal.decode(data);
+		m.revLimit = revLimitSignal.decode(data);
+		m.mainRelay = mainRelaySignal.decode(data);
+		m.fuelPump = fuelPumpSignal.decode(data);
+		m.checkEngine = checkEngineSignal.decode(data);
+		m.o2Heater = o2HeaterSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x201 VerboseSpeeds, sent by rusEFI
+ */
+struct VerboseSpeeds {
+	static constexpr uint32_t id = 0x201;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal rpmSignal = { 0, 16, CanByteOrder::Intel, false, 1.0f, 0.0f };
+	static constexpr CanSignal timingSignal = { 16, 16, CanByteOrder::Intel, true, 0.02f, 0.0f };
+	static constexpr CanSignal injDutySignal = { 32, 8, CanByteOrder::Intel, false, 0.5f, 0.0f };
+	static constexpr CanSignal coilDutySignal = { 40, 8, CanByteOrder::Intel, false, 0.5f, 0.0f };
+	static constexpr CanSignal vssKphSignal = { 48, 8, CanByteOrder::Intel, false, 1.0f, 0.0f };
+
+	// rpm, 0 to 65535
+	float rpm = 0;
+	// deg, -655.36 to 655.34
+	float timing = 0;
+	// %, 0 to 127.5
+	float injDuty = 0;
+	// %, 0 to 127.5
+	float coilDuty = 0;
+	// kph, 0 to 255
+	float vssKph = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		rpmSignal.encode(data, rpm);
+		timingSignal.encode(data, timing);
+		injDutySignal.encode(data, injDuty);
+		coilDutySignal.encode(data, coilDuty);
+		vssKphSignal.encode(data, vssKph);
+	}
+
+	static constexpr VerboseSpeeds unpack(const uint8_t *data) {
+		VerboseSpeeds m;
+		m.rpm = rpmSignal.decode(data);
+		m.timing = timingSignal.decode(data);
+		m.injDuty = injDutySignal.decode(data);
+		m.coilDuty = coilDutySignal.decode(data);
+		m.vssKph = vssKphSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x202 VerbosePedalAndTps, sent by rusEFI
+ */
+struct VerbosePedalAndTps {
+	static constexpr uint32_t id = 0x202;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal pedalSignal = { 0, 16, CanByteOrder::Intel, true, 0.01f, 0.0f };
+	static constexpr CanSignal tps1Signal = { 16, 16, CanByteOrder::Intel, true, 0.01f, 0.0f };
+	static constexpr CanSignal tps2Signal = { 32, 16, CanByteOrder::Intel, true, 0.01f, 0.0f };
+
+	// %, -327.68 to 327.67
+	float pedal = 0;
+	// %, -327.68 to 327.67
+	float tps1 = 0;
+	// %, -327.68 to 327.67
+	float tps2 = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		pedalSignal.encode(data, pedal);
+		tps1Signal.encode(data, tps1);
+		tps2Signal.encode(data, tps2);
+	}
+
+	static constexpr VerbosePedalAndTps unpack(const uint8_t *data) {
+		VerbosePedalAndTps m;
+		m.pedal = pedalSignal.decode(data);
+		m.tps1 = tps1Signal.decode(data);
+		m.tps2 = tps2Signal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x203 VerboseSensors1, sent by rusEFI
+ */
+struct VerboseSensors1 {
+	static constexpr uint32_t id = 0x203;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal mapSignal = { 0, 16, CanByteOrder::Intel, false, 0.0333333333f, 0.0f };
+	static constexpr CanSignal cltSignal = { 16, 8, CanByteOrder::Intel, false, 1.0f, -40.0f };
+	static constexpr CanSignal iatSignal = { 24, 8, CanByteOrder::Intel, false, 1.0f, -40.0f };
+	static constexpr CanSignal aux1Signal = { 32, 8, CanByteOrder::Intel, false, 1.0f, -40.0f };
+	static constexpr CanSignal aux2Signal = { 40, 8, CanByteOrder::Intel, false, 1.0f, -40.0f };
+	static constexpr CanSignal mcuTempSignal = { 48, 8, CanByteOrder::Intel, false, 1.0f, 0.0f };
+	static constexpr CanSignal fuelLevelSignal = { 56, 8, CanByteOrder::Intel, false, 0.5f, 0.0f };
+
+	// kPa, 0 to 2184.5
+	float map = 0;
+	// degC, -40 to 215
+	float clt = 0;
+	// degC, -40 to 215
+	float iat = 0;
+	// degC, -40 to 215
+	float aux1 = 0;
+	// degC, -40 to 215
+	float aux2 = 0;
+	// degC, 0 to 255
+	float mcuTemp = 0;
+	// %, 0 to 127.5
+	float fuelLevel = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		mapSignal.encode(data, map);
+		cltSignal.encode(data, clt);
+		iatSignal.encode(data, iat);
+		aux1Signal.encode(data, aux1);
+		aux2Signal.encode(data, aux2);
+		mcuTempSignal.encode(data, mcuTemp);
+		fuelLevelSignal.encode(data, fuelLevel);
+	}
+
+	static constexpr VerboseSensors1 unpack(const uint8_t *data) {
+		VerboseSensors1 m;
+		m.map = mapSignal.decode(data);
+		m.clt = cltSignal.decode(data);
+		m.iat = iatSignal.decode(data);
+		m.aux1 = aux1Signal.decode(data);
+		m.aux2 = aux2Signal.decode(data);
+		m.mcuTemp = mcuTempSignal.decode(data);
+		m.fuelLevel = fuelLevelSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x204 VerboseSensors2, sent by rusEFI
+ */
+struct VerboseSensors2 {
+	static constexpr uint32_t id = 0x204;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal afrSignal = { 0, 16, CanByteOrder::Intel, false, 0.001f, 0.0f };
+	static constexpr CanSignal oilPressureSignal = { 16, 16, CanByteOrder::Intel, false, 0.0333333333f, 0.0f };
+	static constexpr CanSignal vvtPosSignal = { 32, 16, CanByteOrder::Intel, true, 0.02f, 0.0f };
+	static constexpr CanSignal vbattSignal = { 48, 16, CanByteOrder::Intel, false, 0.001f, 0.0f };
+
+	// afr, 0 to 65.535
+	float afr = 0;
+	// kPa, 0 to 2184.5
+	float oilPressure = 0;
+	// deg, -655.36 to 655.34
+	float vvtPos = 0;
+	// V, 0 to 65.535
+	float vbatt = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		afrSignal.encode(data, afr);
+		oilPressureSignal.encode(data, oilPressure);
+		vvtPosSignal.encode(data, vvtPos);
+		vbattSignal.encode(data, vbatt);
+	}
+
+	static constexpr VerboseSensors2 unpack(const uint8_t *data) {
+		VerboseSensors2 m;
+		m.afr = afrSignal.decode(data);
+		m.oilPressure = oilPressureSignal.decode(data);
+		m.vvtPos = vvtPosSignal.decode(data);
+		m.vbatt = vbattSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x205 VerboseFueling, sent by rusEFI
+ */
+struct VerboseFueling {
+	static constexpr uint32_t id = 0x205;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal cylAirmassSignal = { 0, 16, CanByteOrder::Intel, false, 0.001f, 0.0f };
+	static constexpr CanSignal estAirflowSignal = { 16, 16, CanByteOrder::Intel, false, 0.01f, 0.0f };
+	static constexpr CanSignal fuelPulseSignal = { 32, 16, CanByteOrder::Intel, true, 0.0033333333f, 0.0f };
+	static constexpr CanSignal stftSignal = { 48, 16, CanByteOrder::Intel, true, 0.01f, 0.0f };
+
+	// g, 0 to 65.535
+	float cylAirmass = 0;
+	// kg/h, 0 to 655.35
+	float estAirflow = 0;
+	// ms, -109.22 to 109.22
+	float fuelPulse = 0;
+	// %, -327.68 to 327.67
+	float stft = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		cylAirmassSignal.encode(data, cylAirmass);
+		estAirflowSignal.encode(data, estAirflow);
+		fuelPulseSignal.encode(data, fuelPulse);
+		stftSignal.encode(data, stft);
+	}
+
+	static constexpr VerboseFueling unpack(const uint8_t *data) {
+		VerboseFueling m;
+		m.cylAirmass = cylAirmassSignal.decode(data);
+		m.estAirflow = estAirflowSignal.decode(data);
+		m.fuelPulse = fuelPulseSignal.decode(data);
+		m.stft = stftSignal.decode(data);
+		return m;
+	}
+};
+
+// integration/can/vehicle_speed.dbc
+
+/**
+ * 0x1F0 BmwE46Abs, sent by ABS
+ */
+struct BmwE46Abs {
+	static constexpr uint32_t id = 0x1F0;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal leftFrontSpeedSignal = { 0, 12, CanByteOrder::Intel, false, 0.0625f, 0.0f };
+
+	// kph, 0 to 255.9375
+	float leftFrontSpeed = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		leftFrontSpeedSignal.encode(data, leftFrontSpeed);
+	}
+
+	static constexpr BmwE46Abs unpack(const uint8_t *data) {
+		BmwE46Abs m;
+		m.leftFrontSpeed = leftFrontSpeedSignal.decode(data);
+		return m;
+	}
+};
+
+/**
+ * 0x200 W202Abs, sent by ABS
+ */
+struct W202Abs {
+	static constexpr uint32_t id = 0x200;
+	static constexpr uint8_t dlc = 8;
+	static constexpr bool isExtended = false;
+
+	static constexpr CanSignal speedSignal = { 23, 16, CanByteOrder::Motorola, false, 0.0625f, 0.0f };
+
+	// kph, 0 to 4095.9375
+	float speed = 0;
+
+	constexpr void pack(uint8_t *data) const {
+		speedSignal.encode(data, speed);
+	}
+
+	static constexpr W202Abs unpack(const uint8_t *data) {
+		W202Abs m;
+		m.speed = speedSignal.decode(data);
+		return m;
+	}
+};
@@ -1858,7 +1858,7 @@ struct engine_configuration_s {
 	bool tcuEnabled : 1;
 	/**
 	offset 976 bit 29 */
-	bool unusedBit_251_29 : 1;
+	bool enableKnockControl : 1;
 	/**
 	offset 976 bit 30 */
 	bool unusedBit_289_30 : 1;
@@ -2369,9 +2369,14 @@ struct engine_configuration_s {
 	 */
 	float tachPulseDuractionMs;
 	/**
+	 * Below RPM hard limit and launch hard cut, cut a growing share of cylinders over this RPM range instead of all at once. 0 for hard cut only.
 	 * offset 1708
 	 */
-	int unused1708;
+	uint16_t rollingCutRpmWindow;
+	/**
+	 * offset 1710
+	 */
+	uint8_t unused1710[2];
 	/**
 	 * Length of time the deposited wall fuel takes to dissipate after the start of acceleration. 
 	 * offset 1712
@@ -2972,17 +2977,20 @@ struct engine_configuration_s {
 	 */
 	float fuelReferencePressure;
 	/**
+	 * Extrapolate MAP to the intake valve closing of the next cylinder event using its rate of change, so that fuel matches the air actually trapped during transients. 0 to use measured MAP, 1 for full extrapolation.
 	 * offset 2424
 	 */
-	float unused244_2;
+	float mapPredictionGain;
 	/**
+	 * Timing removed from a cylinder every time knock is detected on it, up to 'maximum total number of degrees to subtract' (maxKnockSubDeg).
 	 * offset 2428
 	 */
-	float unused244_3;
+	float knockRetardStep;
 	/**
+	 * Rate at which removed timing is added back while the cylinder is not knocking.
 	 * offset 2432
 	 */
-	float unused2432;
+	float knockRetardRecoveryRate;
 	/**
 	 * Fuel multiplier (enrichment) immediately after engine start
 	 * offset 2436
@@ -3004,9 +3012,35 @@ struct engine_configuration_s {
 	 */
 	ThermistorConf auxTempSensor2;
 	/**
+	 * Engine: RPM, MAP, TPS, lambda/AFR, timing, knock retard, VVT.
 	 * offset 2508
 	 */
-	uint8_t unused2508[6];
+	uint8_t sdLogEngineDivider;
+	/**
+	 * Fuel: targets, pulse widths, VE, load, trims.
+	 * offset 2509
+	 */
+	uint8_t sdLogFuelDivider;
+	/**
+	 * Ignition: dwell, coil duty, ignition load.
+	 * offset 2510
+	 */
+	uint8_t sdLogIgnitionDivider;
+	/**
+	 * Throttle: pedal, second TPS, idle, ETB.
+	 * offset 2511
+	 */
+	uint8_t sdLogThrottleDivider;
+	/**
+	 * Sensors: temperatures, pressures, battery, speed, fuel level.
+	 * offset 2512
+	 */
+	uint8_t sdLogSensorsDivider;
+	/**
+	 * Status: trigger errors, SD logger counters.
+	 * offset 2513
+	 */
+	uint8_t sdLogStatusDivider;
 	/**
 	 * offset 2514
 	 */
@@ -1,6 +1,9 @@
 #include "limp_manager.h"
 #include "engine.h"
 #include "efilib.h"
+#if EFI_LAUNCH_CONTROL
+#include "launch_control.h"
+#endif // EFI_LAUNCH_CONTROL
 
 EXTERN_ENGINE;
 
@@ -8,17 +11,43 @@ void LimpManager::updateState(int rpm) {
 	Clearable allowFuel = CONFIG(isInjectionEnabled);
 	Clearable allowSpark = CONFIG(isIgnitionEnabled);
 
-	// User-configured hard RPM limit
-	if (rpm > engine->getRpmHardLimit(PASS_ENGINE_PARAMETER_SIGNATURE)) {
-		if (CONFIG(cutFuelOnHardLimit)) {
-			allowFuel.clear();
-		}
+	percent_t fuelCut = 0;
+	percent_t sparkCut = 0;
 
-		if (CONFIG(cutSparkOnHardLimit)) {
-			allowSpark.clear();
-		}
+	// User-configured hard RPM limit, optionally with a rolling cut just below it
+	percent_t hardLimitCut = getRollingCutPercent(rpm, engine->getRpmHardLimit(PASS_ENGINE_PARAMETER_SIGNATURE), CONFIG(rollingCutRpmWindow));
+	if (CONFIG(cutFuelOnHardLimit)) {
+		fuelCut = maxF(fuelCut, hardLimitCut);
+	}
+	if (CONFIG(cutSparkOnHardLimit)) {
+		sparkCut = maxF(sparkCut, hardLimitCut);
 	}
 
+#if EFI_LAUNCH_CONTROL
+	percent_t launchCut = getLaunchCutPercent(rpm PASS_ENGINE_PARAMETER_SUFFIX);
+	if (CONFIG(launchFuelCutEnable)) {
+		fuelCut = maxF(fuelCut, launchCut);
+	}
+	if (CONFIG(launchSparkCutEnable)) {
+		sparkCut = maxF(sparkCut, launchCut);
+	}
+#endif // EFI_LAUNCH_CONTROL
+
+	// whoever asked for it went quiet, do not keep cutting on their behalf
+	if (!m_torqueReductionTimer.hasElapsedMs(m_torqueReductionTimeoutMs)) {
+		sparkCut = maxF(sparkCut, m_torqueReductionSparkCut);
+	}
+
+	if (fuelCut >= 100) {
+		allowFuel.clear();
+	}
+	if (sparkCut >= 100) {
+		allowSpark.clear();
+	}
+
+	m_fuelCut.setTargetPercent(fuelCut);
+	m_sparkCut.setTargetPercent(sparkCut);
+
 	// Force fuel limiting on the fault rev limit
 	if (rpm > m_faultRevLimit) {
 		allowFuel.clear();
@@ -26,7 +55,7 @@ void LimpManager::updateState(int rpm) {
 
 	// Limit fuel only on boost pressure (limiting spark bends valves)
 	if (CONFIG(boostCutPressure) != 0) {
-		if (Sensor::get(SensorType::Map).value_or(0) > CONFIG(boostCutPressure)) {
+		if (ENGINE(fastFrame).get(SensorType::Map).value_or(0) > CONFIG(boostCutPressure)) {
 			allowFuel.clear();
 		}
 	}
@@ -49,6 +78,12 @@ void LimpManager::fatalError() {
 	setFaultRevLimit(0);
 }
 
+void LimpManager::requestTorqueReduction(percent_t sparkCutPercent, float timeoutMs) {
+	m_torqueReductionSparkCut = sparkCutPercent;
+	m_torqueReductionTimeoutMs = timeoutMs;
+	m_torqueReductionTimer.reset();
+}
+
 void LimpManager::setFaultRevLimit(int limit) {
 	// Only allow decreasing the limit
 	// aka uses the limit of the worst fault to yet occur
@@ -70,3 +105,34 @@ bool LimpManager::allowInjection() const {
 bool LimpManager::allowIgnition() const {
 	return m_transientAllowIgnition && m_allowIgnition;
 }
+
+void LimpManager::updateEngineCycle(uint32_t engineCycle, int cylinderCount) {
+	if (m_hasEngineCycle && engineCycle == m_engineCycle) {
+		return;
+	}
+
+	m_hasEngineCycle = true;
+	m_engineCycle = engineCycle;
+	onEngineCycle(cylinderCount);
+}
+
+void LimpManager::onEngineCycle(int cylinderCount) {
+	m_fuelCut.onEngineCycle(cylinderCount);
+	m_sparkCut.onEngineCycle(cylinderCount);
+}
+
+bool LimpManager::allowInjection(int eventIndex) const {
+	return allowInjection() && !m_fuelCut.isCut(eventIndex);
+}
+
+bool LimpManager::allowIgnition(int eventIndex) const {
+	return allowIgnition() && !m_sparkCut.isCut(eventIndex);
+}
+
+percent_t LimpManager::getFuelCutRatio() const {
+	return allowInjection() ? m_fuelCut.getActualPercent() : 100;
+}
+
+percent_t LimpManager::getSparkCutRatio() const {
+	return allowIgnition() ? m_sparkCut.getActualPercent() : 100;
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "engine_ptr.h"
+#include "cut_pattern.h"
+#include "timer.h"
 
 #include <cstdint>
 
@@ -35,12 +37,27 @@ public:
 	bool allowInjection() const;
 	bool allowIgnition() const;
 
+	// Partial cuts, called on every trigger event, picks the cylinders to skip once the engine
+	// cycle counter moves on
+	void updateEngineCycle(uint32_t engineCycle, int cylinderCount);
+	void onEngineCycle(int cylinderCount);
+	// Per cylinder decisions for the current engine cycle
+	bool allowInjection(int eventIndex) const;
+	bool allowIgnition(int eventIndex) const;
+
+	percent_t getFuelCutRatio() const;
+	percent_t getSparkCutRatio() const;
+
 	bool allowTriggerInput() const;
 
 	// Other subsystems call these APIs to indicate a problem has occured
 	void etbProblem();
 	void fatalError();
 
+	// Traction or shift torque reduction, a spark cut through the same cut pattern. Has to be
+	// requested again before the timeout runs out to keep it going.
+	void requestTorqueReduction(percent_t sparkCutPercent, float timeoutMs);
+
 private:
 	void setFaultRevLimit(int limit);
 
@@ -54,4 +71,14 @@ private:
 
 	bool m_transientAllowInjection = true;
 	bool m_transientAllowIgnition = true;
+
+	CutPattern m_fuelCut;
+	CutPattern m_sparkCut;
+
+	percent_t m_torqueReductionSparkCut = 0;
+	float m_torqueReductionTimeoutMs = 0;
+	Timer m_torqueReductionTimer;
+
+	bool m_hasEngineCycle = false;
+	uint32_t m_engineCycle = 0;
 };
@@ -69,7 +69,7 @@ static bool shouldCorrect(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	}
 
 	// Check that the engine is hot enough (and clt not failed)
-	auto clt = Sensor::get(SensorType::Clt);
+	auto clt = ENGINE(fastFrame).get(SensorType::Clt);
 	if (!clt.Valid || clt.Value < cfg.minClt) {
 		return false;
 	}
@@ -83,7 +83,7 @@ bool shouldUpdateCorrection(SensorType sensor DECLARE_ENGINE_PARAMETER_SUFFIX) {
 
 	// Pause (but don't reset) correction if the AFR is off scale.
 	// It's probably a transient and poorly tuned transient correction
-	auto afr = Sensor::get(sensor).value_or(0) * 14.7f;
+	auto afr = ENGINE(fastFrame).get(sensor).value_or(0) * 14.7f;
 	if (!afr || afr < (cfg.minAfr * 0.1f) || afr > (cfg.maxAfr * 0.1f)) {
 		return false;
 	}
@@ -36,8 +36,8 @@ baroCorr_Map3D_t baroCorrMap("baro");
 //  http://rusefi.com/math/t_charge.html
 /***panel:Charge Temperature*/
 temperature_t getTCharge(int rpm, float tps DECLARE_ENGINE_PARAMETER_SUFFIX) {
-	const auto clt = Sensor::get(SensorType::Clt);
-	const auto iat = Sensor::get(SensorType::Iat);
+	const auto clt = ENGINE(fastFrame).get(SensorType::Clt);
+	const auto iat = ENGINE(fastFrame).get(SensorType::Iat);
 
 	float airTemp = 0;
 
@@ -15,7 +15,8 @@ AemXSeriesWideband::AemXSeriesWideband(uint8_t sensorIndex, SensorType type)
 	: CanSensorBase(
 		0x180 + sensorIndex,	// 0th sensor is 0x180, others sequential above that
 		type,
-		MS2NT(21)	// sensor transmits at 100hz, allow a frame to be missed
+		MS2NT(21),	// sensor transmits at 100hz, allow a frame to be missed
+		true	// 29 bit IDs
 	)
 {}
 
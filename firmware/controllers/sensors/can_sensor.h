@@ -8,7 +8,7 @@
 #pragma once
 
 #include "stored_value_sensor.h"
-#include "scaled_channel.h"
+#include "can_codec.h"
 #include "hal.h"
 #include "can_msg_tx.h"
 #include "obd2.h"
@@ -19,9 +19,10 @@
  */
 class CanSensorBase : public StoredValueSensor {
 public:
-	CanSensorBase(uint32_t eid, SensorType type, efitick_t timeout)
+	CanSensorBase(uint32_t eid, SensorType type, efitick_t timeout, bool isExtended = false)
 		: StoredValueSensor(type, timeout)
 		, m_eid(eid)
+		, m_isExtended(isExtended)
 	{
 	}
 
@@ -31,10 +32,11 @@ public:
 
 	void showInfo(Logging* logger, const char* sensorName) const override;
 
+	/**
+	 * Only called for frames with our ID, see registerCanSensor
+	 */
 	CanSensorBase* processFrame(const CANRxFrame& frame, efitick_t nowNt) {
-		if (frame.EID == m_eid) {
-			decodeFrame(frame, nowNt);
-		}
+		decodeFrame(frame, nowNt);
 
 		return m_next;
 	}
@@ -43,6 +45,10 @@ public:
 		return m_eid;
 	}
 
+	bool isExtended() const {
+		return m_isExtended;
+	}
+
 	void setNext(CanSensorBase* next) {
 		m_next = next;
 	}
@@ -53,31 +59,26 @@ protected:
 
 private:
 	const uint32_t m_eid;
+	const bool m_isExtended;
 };
 
-template <typename TStorage, int TScale>
+/**
+ * Sensor reading one signal of a frame, see can_codec_generated.h for signal definitions
+ */
 class CanSensor : public CanSensorBase {
 public:
-	CanSensor(uint32_t eid, uint8_t offset, SensorType type, efitick_t timeout)
+	CanSensor(uint32_t eid, const CanSignal& signal, SensorType type, efitick_t timeout)
 		: CanSensorBase(eid, type, timeout)
-		, m_offset(offset)
+		, m_signal(signal)
 	{
 	}
 
 	void decodeFrame(const CANRxFrame& frame, efitick_t nowNt) override {
-		// Compute the location of our data within the frame
-		const uint8_t* dataLocation = &frame.data8[m_offset];
-
-		// Reinterpret as a scaled_channel - it already has the logic for decoding a scaled integer to a float
-		const auto scaler = reinterpret_cast<const scaled_channel<TStorage, TScale>*>(dataLocation);
-
-		// Actually do the conversion
-		float value = *scaler;
-		setValidValue(value, nowNt);
+		setValidValue(m_signal.decode(frame.data8), nowNt);
 	}
 
 private:
-	const uint8_t m_offset;
+	const CanSignal m_signal;
 };
 
 template <int Size, int Offset>
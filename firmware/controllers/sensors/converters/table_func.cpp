@@ -0,0 +1,82 @@
+#include "table_func.h"
+
+#include "efilib.h"
+
+// The table is checked against the exact function at every ADC code
+#define ADC_CODES 4096
+#define CODES_PER_SEGMENT (ADC_CODES / TABLE_FUNC_SEGMENTS)
+
+static_assert(ADC_CODES % TABLE_FUNC_SEGMENTS == 0, "segments must split ADC codes evenly");
+static_assert(TABLE_FUNC_SEGMENTS % 32 == 0, "segment bitmask must fill whole words");
+
+int TableFunc::compile(const SensorConverter& exact, float maxInput, float maxError) {
+	m_exact = &exact;
+	m_maxInput = maxInput;
+	m_segmentsPerInput = TABLE_FUNC_SEGMENTS / maxInput;
+	m_tableSegmentCount = 0;
+
+	for (auto& word : m_isTableSegment) {
+		word = 0;
+	}
+
+	float inputPerCode = maxInput / ADC_CODES;
+
+	// Table points sit on segment boundaries
+	bool pointValid[TABLE_FUNC_SEGMENTS + 1];
+	for (int i = 0; i <= TABLE_FUNC_SEGMENTS; i++) {
+		auto result = exact.convert(i * CODES_PER_SEGMENT * inputPerCode);
+		pointValid[i] = result.Valid;
+		m_values[i] = result.Value;
+	}
+
+	for (int segment = 0; segment < TABLE_FUNC_SEGMENTS; segment++) {
+		if (!pointValid[segment] || !pointValid[segment + 1]) {
+			continue;
+		}
+
+		float from = m_values[segment];
+		float to = m_values[segment + 1];
+
+		bool withinBound = true;
+		for (int code = 1; code < CODES_PER_SEGMENT; code++) {
+			auto result = exact.convert((segment * CODES_PER_SEGMENT + code) * inputPerCode);
+
+			float interpolated = from + (to - from) * code / CODES_PER_SEGMENT;
+
+			if (!result.Valid || absF(result.Value - interpolated) > maxError) {
+				withinBound = false;
+				break;
+			}
+		}
+
+		if (withinBound) {
+			m_isTableSegment[segment / 32] |= 1u << (segment % 32);
+			m_tableSegmentCount++;
+		}
+	}
+
+	return m_tableSegmentCount;
+}
+
+SensorResult TableFunc::convert(float inputValue) const {
+	if (!m_exact) {
+		return unexpected;
+	}
+
+	if (inputValue < 0 || inputValue >= m_maxInput) {
+		return m_exact->convert(inputValue);
+	}
+
+	float position = inputValue * m_segmentsPerInput;
+	int segment = (int)position;
+
+	// rounding can land exactly on the last point
+	if (segment >= TABLE_FUNC_SEGMENTS || !isTableSegment(segment)) {
+		return m_exact->convert(inputValue);
+	}
+
+	float from = m_values[segment];
+	float to = m_values[segment + 1];
+
+	return from + (to - from) * (position - segment);
+}
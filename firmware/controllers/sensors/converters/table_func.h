@@ -0,0 +1,49 @@
+/**
+ * A converter that replaces an expensive conversion (for example resistor divider followed
+ * by Steinhart-Hart) with a uniform lookup table plus linear interpolation.
+ *
+ * The table is built once when configuration is applied by sampling the exact function
+ * at every 12 bit ADC code. Segments where interpolation can't stay within the requested
+ * error, or which touch an input the exact function rejects, keep using the exact function.
+ */
+
+#pragma once
+
+#include "sensor_converter_func.h"
+
+#include <cstdint>
+
+#define TABLE_FUNC_SEGMENTS 128
+
+class TableFunc final : public SensorConverter {
+public:
+	/**
+	 * @param exact function to approximate, must outlive this object
+	 * @param maxInput input value produced by a full scale ADC reading
+	 * @param maxError largest allowed deviation from the exact function, in output units
+	 * @return number of segments served from the table
+	 */
+	int compile(const SensorConverter& exact, float maxInput, float maxError);
+
+	SensorResult convert(float inputValue) const override;
+
+	void showInfo(Logging* logger, float testRawValue) const override;
+
+	int getTableSegmentCount() const {
+		return m_tableSegmentCount;
+	}
+
+private:
+	bool isTableSegment(int segment) const {
+		return m_isTableSegment[segment / 32] & (1u << (segment % 32));
+	}
+
+	const SensorConverter* m_exact = nullptr;
+
+	float m_maxInput = 0;
+	float m_segmentsPerInput = 0;
+
+	float m_values[TABLE_FUNC_SEGMENTS + 1];
+	uint32_t m_isTableSegment[TABLE_FUNC_SEGMENTS / 32];
+	int m_tableSegmentCount = 0;
+};
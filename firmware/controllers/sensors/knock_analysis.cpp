@@ -0,0 +1,146 @@
+#include "knock_analysis.h"
+#include "pid_auto_tune.h"
+
+#include <cmath>
+
+// Roots of the derivative of the Bessel function for the (1,0), (2,0) and (0,1) modes
+static const float besselRoots[KNOCK_BAND_COUNT] = { 1.841f, 3.054f, 3.832f };
+// Speed of sound in the hot cylinder charge, m/s - matches HIP9011's BAND(bore) for the first mode
+#define KNOCK_SPEED_OF_SOUND (1800 / 1.841f)
+
+// How fast the noise floor follows quiet windows, and windows it thinks are knock
+#define NOISE_FLOOR_ALPHA 0.05f
+#define NOISE_FLOOR_ALPHA_KNOCK 0.005f
+
+size_t getKnockResonanceFrequencies(float boreMm, float overrideKhz, float *frequenciesHz) {
+	float firstMode;
+
+	if (overrideKhz > 0) {
+		firstMode = 1000 * overrideKhz;
+	} else if (boreMm > 0) {
+		firstMode = 1000 * KNOCK_SPEED_OF_SOUND * besselRoots[0] / ((float)CONST_PI * boreMm);
+	} else {
+		return 0;
+	}
+
+	// higher modes keep their ratio to the first one
+	for (size_t i = 0; i < KNOCK_BAND_COUNT; i++) {
+		frequenciesHz[i] = firstMode * besselRoots[i] / besselRoots[0];
+	}
+
+	return KNOCK_BAND_COUNT;
+}
+
+void GoertzelBank::configure(float sampleRate, const float *frequenciesHz, size_t count) {
+	m_count = 0;
+
+	for (size_t i = 0; i < count && m_count < KNOCK_BAND_COUNT; i++) {
+		// skip anything we can't resolve at this sample rate
+		if (frequenciesHz[i] <= 0 || frequenciesHz[i] >= sampleRate / 2) {
+			continue;
+		}
+
+		m_coeff[m_count++] = 2 * cosf(2 * (float)CONST_PI * frequenciesHz[i] / sampleRate);
+	}
+}
+
+void GoertzelBank::process(const uint16_t *samples, size_t sampleCount, float voltsPerCount, float *powerOut) const {
+	if (sampleCount == 0) {
+		for (size_t b = 0; b < m_count; b++) {
+			powerOut[b] = 0;
+		}
+		return;
+	}
+
+	uint32_t sum = 0;
+	for (size_t i = 0; i < sampleCount; i++) {
+		sum += samples[i];
+	}
+	float mean = (float)sum / sampleCount;
+
+	float s1[KNOCK_BAND_COUNT] = {};
+	float s2[KNOCK_BAND_COUNT] = {};
+
+	for (size_t i = 0; i < sampleCount; i++) {
+		float x = (samples[i] - mean) * voltsPerCount;
+
+		for (size_t b = 0; b < m_count; b++) {
+			float s = x + m_coeff[b] * s1[b] - s2[b];
+			s2[b] = s1[b];
+			s1[b] = s;
+		}
+	}
+
+	// |X|^2 * 2 / N^2 is the mean square of a sine at the band's frequency
+	float norm = 2.0f / ((float)sampleCount * sampleCount);
+
+	for (size_t b = 0; b < m_count; b++) {
+		float magnitudeSquared = s1[b] * s1[b] + s2[b] * s2[b] - m_coeff[b] * s1[b] * s2[b];
+		powerOut[b] = magnitudeSquared * norm;
+	}
+}
+
+float KnockNoiseFloor::update(size_t cylinderIndex, float levelDb) {
+	if (cylinderIndex >= cylinderCount) {
+		return 0;
+	}
+
+	float &floor = m_floor[cylinderIndex];
+
+	if (!m_hasFloor[cylinderIndex]) {
+		m_hasFloor[cylinderIndex] = true;
+		floor = levelDb;
+		return 0;
+	}
+
+	float intensity = levelDb - floor;
+
+	// Learn mostly from quiet windows, but keep creeping towards loud ones so that a floor
+	// learned at idle still catches up with the mechanical noise at high RPM
+	float alpha = intensity < KNOCK_INTENSITY_THRESHOLD_DB ? NOISE_FLOOR_ALPHA : NOISE_FLOOR_ALPHA_KNOCK;
+	floor += alpha * intensity;
+
+	return intensity;
+}
+
+float KnockNoiseFloor::getFloor(size_t cylinderIndex) const {
+	if (cylinderIndex >= cylinderCount || !m_hasFloor[cylinderIndex]) {
+		return 0;
+	}
+
+	return m_floor[cylinderIndex];
+}
+
+void KnockNoiseFloor::reset() {
+	for (size_t i = 0; i < cylinderCount; i++) {
+		m_hasFloor[i] = false;
+	}
+}
+
+bool KnockAnalyzer::configure(float sampleRate, float boreMm, float overrideKhz) {
+	float frequencies[KNOCK_BAND_COUNT];
+	size_t count = getKnockResonanceFrequencies(boreMm, overrideKhz, frequencies);
+
+	m_bank.configure(sampleRate, frequencies, count);
+	m_noiseFloor.reset();
+
+	return m_bank.getBandCount() > 0;
+}
+
+KnockResult KnockAnalyzer::process(uint8_t cylinderIndex, const uint16_t *samples, size_t sampleCount, float voltsPerCount) {
+	float power[KNOCK_BAND_COUNT];
+	m_bank.process(samples, sampleCount, voltsPerCount, power);
+
+	float total = 0;
+	for (size_t b = 0; b < m_bank.getBandCount(); b++) {
+		total += power[b];
+	}
+
+	// -100dB for a perfectly flat window, same floor as the TS gauge
+	float levelDb = total > 0 ? 10 * log10f(total) : -100;
+	if (levelDb < -100) {
+		levelDb = -100;
+	}
+
+	return { levelDb, m_noiseFloor.update(cylinderIndex, levelDb) };
+}
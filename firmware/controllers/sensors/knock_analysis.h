@@ -0,0 +1,197 @@
+/**
+ * @file knock_analysis.h
+ *
+ * Hardware independent part of software knock: sample window hand-off between the ADC and
+ * the processing thread, per resonance mode signal power, and per cylinder noise floor.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rusefi_generated.h"
+
+// Number of cylinder resonance modes evaluated per window
+#define KNOCK_BAND_COUNT 3
+
+// Windows this far above the cylinder's learned noise floor count as knock, dB
+#define KNOCK_INTENSITY_THRESHOLD_DB 6
+
+/**
+ * Cylinder bore resonance frequencies, lowest mode first (Draper's equation).
+ * @param boreMm cylinder bore
+ * @param overrideKhz if non-zero, used as the first mode instead of the bore based one
+ * @return number of frequencies written, 0 if there is not enough information
+ */
+size_t getKnockResonanceFrequencies(float boreMm, float overrideKhz, float *frequenciesHz);
+
+/**
+ * Signal power at a few fixed frequencies, one Goertzel filter per frequency.
+ * All filters run in a single pass over the window.
+ */
+class GoertzelBank {
+public:
+	void configure(float sampleRate, const float *frequenciesHz, size_t count);
+
+	size_t getBandCount() const {
+		return m_count;
+	}
+
+	/**
+	 * Mean removed, so the ADC bias does not matter.
+	 * @param powerOut per band mean square of the signal component at that frequency, volts^2
+	 */
+	void process(const uint16_t *samples, size_t sampleCount, float voltsPerCount, float *powerOut) const;
+
+private:
+	float m_coeff[KNOCK_BAND_COUNT];
+	size_t m_count = 0;
+};
+
+/**
+ * Knock is judged against what this particular cylinder is normally like, since sensor
+ * placement makes some cylinders much louder than others.
+ */
+class KnockNoiseFloor {
+public:
+	/**
+	 * @return intensity of this window, dB above the cylinder's noise floor
+	 */
+	float update(size_t cylinderIndex, float levelDb);
+	float getFloor(size_t cylinderIndex) const;
+	void reset();
+
+private:
+	static constexpr size_t cylinderCount = IGNITION_PIN_COUNT;
+
+	float m_floor[cylinderCount];
+	bool m_hasFloor[cylinderCount] = {};
+};
+
+struct KnockResult {
+	// total power in all resonance bands, dB
+	float levelDb;
+	// dB above this cylinder's noise floor
+	float intensity;
+};
+
+/**
+ * One sample window in, knock level and intensity out.
+ */
+class KnockAnalyzer {
+public:
+	// @return false if no resonance frequency could be determined
+	bool configure(float sampleRate, float boreMm, float overrideKhz);
+	KnockResult process(uint8_t cylinderIndex, const uint16_t *samples, size_t sampleCount, float voltsPerCount);
+
+	bool isKnock(const KnockResult &result) const {
+		return result.intensity > KNOCK_INTENSITY_THRESHOLD_DB;
+	}
+
+	const KnockNoiseFloor& getNoiseFloor() const {
+		return m_noiseFloor;
+	}
+
+private:
+	GoertzelBank m_bank;
+	KnockNoiseFloor m_noiseFloor;
+};
+
+/**
+ * Double buffered sample windows: the ADC fills one window while the processing thread works
+ * on the other, so a cylinder is only ever missed if processing falls a whole window behind.
+ */
+template <size_t TBuffers, size_t TDepth>
+class KnockSampleBuffers {
+public:
+	struct Window {
+		uint16_t samples[TDepth];
+		volatile size_t sampleCount;
+		volatile uint8_t cylinderIndex;
+		volatile uint8_t state;
+		// order in which windows were completed
+		uint32_t sequence;
+	};
+
+	/**
+	 * Claim a free window for the ADC to fill
+	 * @return nullptr if every window is still waiting to be processed
+	 */
+	Window *startSampling(uint8_t cylinderIndex, size_t sampleCount) {
+		for (size_t i = 0; i < TBuffers; i++) {
+			Window &w = m_windows[i];
+
+			if (w.state == Free) {
+				w.state = Sampling;
+				w.cylinderIndex = cylinderIndex;
+				w.sampleCount = sampleCount;
+				m_sampling = &w;
+				return &w;
+			}
+		}
+
+		m_overruns++;
+		return nullptr;
+	}
+
+	// ADC finished filling the window claimed last
+	void completeSampling() {
+		if (!m_sampling) {
+			return;
+		}
+
+		m_sampling->state = Ready;
+		m_sampling->sequence = m_nextSequence++;
+		m_sampling = nullptr;
+	}
+
+	// ADC failed, the window claimed last is free again
+	void abortSampling() {
+		if (!m_sampling) {
+			return;
+		}
+
+		m_sampling->state = Free;
+		m_sampling = nullptr;
+	}
+
+	/**
+	 * Oldest window the ADC has finished, nullptr if none
+	 */
+	Window *getReady() {
+		Window *oldest = nullptr;
+
+		for (size_t i = 0; i < TBuffers; i++) {
+			Window &w = m_windows[i];
+
+			if (w.state == Ready && (!oldest || (int32_t)(w.sequence - oldest->sequence) < 0)) {
+				oldest = &w;
+			}
+		}
+
+		return oldest;
+	}
+
+	void release(Window *w) {
+		w->state = Free;
+	}
+
+	uint32_t getOverrunCount() const {
+		return m_overruns;
+	}
+
+	static constexpr size_t depth = TDepth;
+
+private:
+	enum : uint8_t {
+		Free = 0,
+		Sampling,
+		Ready,
+	};
+
+	Window m_windows[TBuffers] = {};
+	Window * volatile m_sampling = nullptr;
+	uint32_t m_nextSequence = 0;
+	uint32_t m_overruns = 0;
+};
@@ -185,7 +185,23 @@ bool Sensor::Register() {
 	return entry ? entry->getSensor() : nullptr;
 }
 
+#if EFI_UNIT_TEST
+static size_t s_lookupCount = 0;
+
+/*static*/ size_t Sensor::getLookupCount() {
+	return s_lookupCount;
+}
+
+/*static*/ void Sensor::resetLookupCount() {
+	s_lookupCount = 0;
+}
+#endif // EFI_UNIT_TEST
+
 /*static*/ SensorResult Sensor::get(SensorType type) {
+#if EFI_UNIT_TEST
+	s_lookupCount++;
+#endif // EFI_UNIT_TEST
+
 	const auto entry = getEntryForType(type);
 
 	// Check if this is a valid sensor entry
@@ -87,6 +87,14 @@ public:
 	 */
 	static SensorResult get(SensorType type);
 
+#if EFI_UNIT_TEST
+	/*
+	 * Number of registry lookups get() has done, so tests can see how hard a code path leans on the registry.
+	 */
+	static size_t getLookupCount();
+	static void resetLookupCount();
+#endif // EFI_UNIT_TEST
+
 	/*
 	 * Get a raw (unconverted) value from the sensor, if available.
 	 */
@@ -0,0 +1,153 @@
+#include "global.h"
+#include "sensor_frame.h"
+#include "efilib.h"
+
+#include <atomic>
+
+// Everything the fast callback fuel & ignition math reads
+static constexpr SensorType s_frameSensors[] = {
+	SensorType::Clt,
+	SensorType::Iat,
+	SensorType::Map,
+	SensorType::Tps1,
+	SensorType::DriverThrottleIntent,
+	SensorType::Lambda1,
+	SensorType::FuelEthanolPercent,
+	SensorType::BarometricPressure,
+};
+
+static_assert(efi::size(s_frameSensors) == SENSOR_FRAME_SIZE);
+static_assert(SENSOR_FRAME_SIZE <= 32, "valid bits must fit the mask");
+
+struct SlotTable {
+	int8_t slots[static_cast<size_t>(SensorType::PlaceholderLast)];
+
+	constexpr SlotTable() : slots() {
+		for (auto& slot : slots) {
+			slot = -1;
+		}
+
+		for (size_t i = 0; i < efi::size(s_frameSensors); i++) {
+			slots[static_cast<size_t>(s_frameSensors[i])] = i;
+		}
+	}
+};
+
+static constexpr SlotTable s_slotTable;
+
+/*static*/ int SensorFrame::getSlot(SensorType type) {
+	size_t index = static_cast<size_t>(type);
+
+	if (index >= efi::size(s_slotTable.slots)) {
+		return -1;
+	}
+
+	return s_slotTable.slots[index];
+}
+
+void SensorFrame::capture(efitick_t nowNt) {
+	uint32_t validMask = 0;
+
+	for (size_t i = 0; i < efi::size(s_frameSensors); i++) {
+		auto result = Sensor::get(s_frameSensors[i]);
+
+		m_values[i] = result.Value;
+		if (result.Valid) {
+			validMask |= 1u << i;
+		}
+	}
+
+	m_validMask = validMask;
+	m_timestampNt = nowNt;
+	m_isCaptured = true;
+}
+
+SensorResult SensorFrame::get(SensorType type) const {
+	int slot = getSlot(type);
+
+	if (!m_isCaptured || slot < 0) {
+		return Sensor::get(type);
+	}
+
+	if (m_validMask & (1u << slot)) {
+		return m_values[slot];
+	}
+
+	return unexpected;
+}
+
+void SensorFramePublisher::publish(efitick_t nowNt) {
+	uint32_t sequence = m_sequence;
+
+	// readers are directed at buffer (sequence / 2) % 2, fill the other one
+	SensorFrame& target = m_frames[((sequence >> 1) + 1) & 1];
+
+	m_sequence = sequence + 1;
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+
+	target.capture(nowNt);
+
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+	m_sequence = sequence + 2;
+}
+
+bool SensorFramePublisher::isStillConsistent(uint32_t startSequence) const {
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+
+	// The buffer we read only gets overwritten by the publish after the one
+	// that was possibly in progress when we started. Unsigned math survives wrap around.
+	return m_sequence - (startSequence & ~1u) <= 2;
+}
+
+void SensorFramePublisher::read(SensorFrame& out) const {
+	while (true) {
+		uint32_t sequence = m_sequence;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+
+		const SensorFrame& source = m_frames[(sequence >> 1) & 1];
+		for (size_t i = 0; i < efi::size(source.m_values); i++) {
+			out.m_values[i] = source.m_values[i];
+		}
+		out.m_validMask = source.m_validMask;
+		out.m_timestampNt = source.m_timestampNt;
+		out.m_isCaptured = source.m_isCaptured;
+
+		if (isStillConsistent(sequence)) {
+			return;
+		}
+
+		m_retryCount = m_retryCount + 1;
+	}
+}
+
+SensorResult SensorFramePublisher::get(SensorType type) const {
+	int slot = SensorFrame::getSlot(type);
+	if (slot < 0) {
+		return Sensor::get(type);
+	}
+
+	while (true) {
+		uint32_t sequence = m_sequence;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+
+		const SensorFrame& source = m_frames[(sequence >> 1) & 1];
+		bool isCaptured = source.m_isCaptured;
+		bool valid = source.m_validMask & (1u << slot);
+		float value = source.m_values[slot];
+
+		if (isStillConsistent(sequence)) {
+			if (!isCaptured) {
+				// nothing published yet
+				return Sensor::get(type);
+			}
+
+			if (valid) {
+				return value;
+			}
+
+			return unexpected;
+		}
+
+		m_retryCount = m_retryCount + 1;
+	}
+}
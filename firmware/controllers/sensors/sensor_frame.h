@@ -0,0 +1,92 @@
+/**
+ * @file sensor_frame.h
+ *
+ * A snapshot of the sensors the fuel/ignition math reads, taken once per control loop tick.
+ *
+ * Reading Sensor::get() over and over during one computation costs a registry lookup each time,
+ * and lets values change halfway through: fuel mass could be computed from one MAP reading while
+ * the load axis used another. The fast callback instead publishes one SensorFrame per tick, and
+ * consumers work from that.
+ */
+
+#pragma once
+
+#include "sensor.h"
+#include "rusefi_types.h"
+
+#include <cstdint>
+
+#define SENSOR_FRAME_SIZE 8
+
+class SensorFrame {
+public:
+	// Read every frame sensor from the registry, once
+	void capture(efitick_t nowNt);
+
+	// Mark this frame as no longer current: get() goes to the registry again
+	void release() {
+		m_isCaptured = false;
+	}
+
+	/**
+	 * Value as of the capture. Sensors which are not part of the frame,
+	 * or a frame which has not been captured, read through to the registry.
+	 */
+	SensorResult get(SensorType type) const;
+
+	bool isCaptured() const {
+		return m_isCaptured;
+	}
+
+	efitick_t getTimestamp() const {
+		return m_timestampNt;
+	}
+
+	// Index into the frame for sensor type, -1 if that type is not part of frames
+	static int getSlot(SensorType type);
+
+private:
+	friend class SensorFramePublisher;
+
+	float m_values[SENSOR_FRAME_SIZE];
+	uint32_t m_validMask = 0;
+	efitick_t m_timestampNt = 0;
+	bool m_isCaptured = false;
+};
+
+/**
+ * Publishes frames from one producer to readers in any context, including ISRs which interrupt
+ * the producer halfway through a publish.
+ *
+ * Frames are double buffered: the producer always writes the buffer readers are not directed to,
+ * and a sequence counter tells readers which buffer is current. A reader only has to retry if the
+ * producer managed to publish twice while it was copying, so an ISR never spins waiting for the
+ * thread it interrupted.
+ */
+class SensorFramePublisher {
+public:
+	void publish(efitick_t nowNt);
+
+	// Copy the latest published frame
+	void read(SensorFrame& out) const;
+
+	// Single value from the latest published frame
+	SensorResult get(SensorType type) const;
+
+	uint32_t getPublishCount() const {
+		return m_sequence / 2;
+	}
+
+	uint32_t getRetryCount() const {
+		return m_retryCount;
+	}
+
+private:
+	// Both buffers are readable while the sequence is such that neither is being overwritten
+	bool isStillConsistent(uint32_t startSequence) const;
+
+	SensorFrame m_frames[2];
+	// odd while a publish is in progress, (m_sequence / 2) % 2 is the current buffer
+	volatile uint32_t m_sequence = 0;
+	mutable volatile uint32_t m_retryCount = 0;
+};
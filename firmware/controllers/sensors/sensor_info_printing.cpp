@@ -7,6 +7,7 @@
 #include "linear_func.h"
 #include "resistance_func.h"
 #include "thermistor_func.h"
+#include "table_func.h"
 #include "efilib.h"
 #include "loggingcentral.h"
 
@@ -62,6 +63,15 @@ void ResistanceFunc::showInfo(Logging* logger, float testInputValue) const {
 	scheduleMsg(logger, "    %.2f volts -> %.1f ohms with supply voltage %.2f and pullup %.1f.", testInputValue, result.Value, m_supplyVoltage, m_pullupResistor);
 }
 
+void TableFunc::showInfo(Logging* logger, float testInputValue) const {
+	const auto [valid, value] = convert(testInputValue);
+	scheduleMsg(logger, "    Lookup table: %d of %d segments tabulated, %.2f -> valid: %s. %.2f", m_tableSegmentCount, TABLE_FUNC_SEGMENTS, testInputValue, boolToString(valid), value);
+
+	if (m_exact) {
+		m_exact->showInfo(logger, testInputValue);
+	}
+}
+
 void ThermistorFunc::showInfo(Logging* logger, float testInputValue) const {
 	const auto [valid, value] = convert(testInputValue);
 	scheduleMsg(logger, "    %.1f ohms -> valid: %s. %.1f deg C", testInputValue, boolToString(valid), value);
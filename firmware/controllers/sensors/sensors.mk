@@ -9,13 +9,16 @@ CONTROLLERS_SENSORS_SRC_CPP = 	$(PROJECT_DIR)/controllers/sensors/thermistors.cp
 	$(PROJECT_DIR)/controllers/sensors/ego.cpp \
 	$(PROJECT_DIR)/controllers/sensors/hip9011_lookup.cpp \
 	$(PROJECT_DIR)/controllers/sensors/sensor.cpp \
+	$(PROJECT_DIR)/controllers/sensors/sensor_frame.cpp \
 	$(PROJECT_DIR)/controllers/sensors/sensor_info_printing.cpp \
 	$(PROJECT_DIR)/controllers/sensors/functional_sensor.cpp \
 	$(PROJECT_DIR)/controllers/sensors/redundant_sensor.cpp \
 	$(PROJECT_DIR)/controllers/sensors/AemXSeriesLambda.cpp \
 	$(PROJECT_DIR)/cotnrollers/sensors/flex_sensor.cpp \
 	$(PROJECT_DIR)/controllers/sensors/software_knock.cpp \
+	$(PROJECT_DIR)/controllers/sensors/knock_analysis.cpp \
 	$(PROJECT_DIR)/controllers/sensors/Lps25Sensor.cpp \
 	$(PROJECT_DIR)/controllers/sensors/converters/linear_func.cpp \
 	$(PROJECT_DIR)/controllers/sensors/converters/resistance_func.cpp \
+	$(PROJECT_DIR)/controllers/sensors/converters/table_func.cpp \
 	$(PROJECT_DIR)/controllers/sensors/converters/thermistor_func.cpp
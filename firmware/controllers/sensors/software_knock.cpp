@@ -1,7 +1,7 @@
 
 #include "global.h"
 #include "engine.h"
-#include "biquad.h"
+#include "knock_analysis.h"
 #include "perf_trace.h"
 #include "thread_controller.h"
 #include "software_knock.h"
@@ -13,13 +13,9 @@ EXTERN_ENGINE;
 
 #include "knock_config.h"
 
-NO_CACHE adcsample_t sampleBuffer[2000];
-int8_t currentCylinderIndex = 0;
-Biquad knockFilter;
-
-static volatile bool knockIsSampling = false;
-static volatile bool knockNeedsProcess = false;
-static volatile size_t sampleCount = 0;
+// One window samples while the other is processed
+static NO_CACHE KnockSampleBuffers<2, 2000> knockBuffers;
+static KnockAnalyzer knockAnalyzer;
 
 binary_semaphore_t knockSem;
 
@@ -27,7 +23,7 @@ static void completionCallback(ADCDriver* adcp) {
 	palClearPad(GPIOD, 2);
 
 	if (adcp->state == ADC_COMPLETE) {
-		knockNeedsProcess = true;
+		knockBuffers.completeSampling();
 
 		// Notify the processing thread that it's time to process this sample
 		chSysLockFromISR();
@@ -37,6 +33,7 @@ static void completionCallback(ADCDriver* adcp) {
 }
 
 static void errorCallback(ADCDriver*, adcerror_t) {
+	knockBuffers.abortSampling();
 }
 
 static const uint32_t smpr1 = 
@@ -142,23 +139,21 @@ void startKnockSampling(uint8_t cylinderIndex) {
 		return;
 	}
 
-	// If there's pending processing, skip this event
-	if (knockNeedsProcess) {
-		return;
-	}
-
 	// Sample for 45 degrees
 	float samplingSeconds = ENGINE(rpmCalculator).oneDegreeUs * 45 * 1e-6;
 	constexpr int sampleRate = KNOCK_SAMPLE_RATE;
-	sampleCount = 0xFFFFFFFE & static_cast<size_t>(clampF(100, samplingSeconds * sampleRate, efi::size(sampleBuffer)));
+	size_t sampleCount = 0xFFFFFFFE & static_cast<size_t>(clampF(100, samplingSeconds * sampleRate, knockBuffers.depth));
+
+	// Only fails if the processing thread is a whole window behind
+	auto window = knockBuffers.startSampling(cylinderIndex, sampleCount);
+	if (!window) {
+		return;
+	}
 
 	// Select the appropriate conversion group - it will differ depending on which sensor this cylinder should listen on
 	auto conversionGroup = getConversionGroup(cylinderIndex);
 
-	// Stash the current cylinder's index so we can store the result appropriately
-	currentCylinderIndex = cylinderIndex;
-
-	adcStartConversionI(&KNOCK_ADC, conversionGroup, sampleBuffer, sampleCount);
+	adcStartConversionI(&KNOCK_ADC, conversionGroup, window->samples, sampleCount);
 }
 
 class KnockThread : public ThreadController<256> {
@@ -173,7 +168,11 @@ void initSoftwareKnock() {
 	chBSemObjectInit(&knockSem, TRUE);
 
 	if (CONFIG(enableSoftwareKnock)) {
-		knockFilter.configureBandpass(KNOCK_SAMPLE_RATE, 1000 * CONFIG(knockBandCustom), 3);
+		if (!knockAnalyzer.configure(KNOCK_SAMPLE_RATE, CONFIG(cylinderBore), CONFIG(knockBandCustom))) {
+			warning(CUSTOM_OBD_KNOCK_PROCESSOR, "Software knock needs cylinder bore or knock band");
+			return;
+		}
+
 		adcStart(&KNOCK_ADC, nullptr);
 
 		efiSetPadMode("knock ch1", KNOCK_PIN_CH1, PAL_MODE_INPUT_ANALOG);
@@ -185,41 +184,23 @@ void initSoftwareKnock() {
 }
 
 void processLastKnockEvent() {
-	if (!knockNeedsProcess) {
+	auto window = knockBuffers.getReady();
+	if (!window) {
 		return;
 	}
 
-	float sumSq = 0;
-
 	// todo: reduce magic constants. engineConfiguration->adcVcc?
 	constexpr float ratio = 3.3f / 4095.0f;
 
-	size_t localCount = sampleCount;
-
-	// Prepare the steady state at vcc/2 so that there isn't a step
-	// when samples begin
-	// todo: reduce magic constants. engineConfiguration->adcVcc?
-	knockFilter.cookSteadyState(3.3f / 2);
+	uint8_t cylinderIndex = window->cylinderIndex;
+	KnockResult result = knockAnalyzer.process(cylinderIndex, window->samples, window->sampleCount, ratio);
 
-	// Compute the sum of squares
-	for (size_t i = 0; i < localCount; i++) {
-		float volts = ratio * sampleBuffer[i];
+	knockBuffers.release(window);
 
-		float filtered = knockFilter.filter(volts);
-
-		sumSq += filtered * filtered;
-	}
+	ENGINE(knockController).onKnockSense(cylinderIndex, knockAnalyzer.isKnock(result));
 
-	// mean of squares (not yet root)
-	float meanSquares = sumSq / localCount;
-
-	// RMS
-	float db = 10 * log10(meanSquares);
-
-	tsOutputChannels.knockLevels[currentCylinderIndex] = roundf(clampF(-100, db, 100));
-	tsOutputChannels.knockLevel = db;
-
-	knockNeedsProcess = false;
+	tsOutputChannels.knockLevels[cylinderIndex] = roundf(clampF(-100, result.levelDb, 100));
+	tsOutputChannels.knockLevel = result.levelDb;
 }
 
 void KnockThread::ThreadTask() {
@@ -227,7 +208,11 @@ void KnockThread::ThreadTask() {
 		chBSemWait(&knockSem);
 
 		ScopePerf perf(PE::SoftwareKnockProcess);
-		processLastKnockEvent();
+
+		// The semaphore only remembers one signal, catch up with every finished window
+		while (knockBuffers.getReady()) {
+			processLastKnockEvent();
+		}
 	}
 }
 
@@ -28,6 +28,8 @@
 #define PRIO_CONSOLE (NORMALPRIO + 1)
 
 // Less important things
+// SD log records are sampled at a fixed rate, the card writes whenever it can
+#define PRIO_SD_LOG_SAMPLER NORMALPRIO
 #define PRIO_MMC (NORMALPRIO - 1)
 // USB mass storage
 #define MSD_THD_PRIO LOWPRIO
@@ -36,3 +38,5 @@
 #define PRIO_AUX_SERIAL NORMALPRIO
 #define PRIO_KNOCK_PROCESS (NORMALPRIO - 10)
 #define PRIO_HIP9011 (NORMALPRIO - 10)
+// formats console messages, the ring holds them meanwhile
+#define PRIO_DEFERRED_LOG (NORMALPRIO - 10)
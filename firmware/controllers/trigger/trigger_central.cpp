@@ -359,8 +359,6 @@ void TriggerCentral::resetCounters() {
 	memset(hwEventCounters, 0, sizeof(hwEventCounters));
 }
 
-static char shaft_signal_msg_index[15];
-
 static const bool isUpEvent[6] = { false, true, false, true, false, true };
 static const char *eventId[6] = { PROTOCOL_CRANK1, PROTOCOL_CRANK1, PROTOCOL_CRANK2, PROTOCOL_CRANK2, PROTOCOL_CRANK3, PROTOCOL_CRANK3 };
 
@@ -370,15 +368,12 @@ static void reportEventToWaveChart(trigger_event_e ckpSignalType, int index DECL
 	}
 
 
-	itoa10(&shaft_signal_msg_index[2], index);
 	bool isUp = isUpEvent[(int) ckpSignalType];
-	shaft_signal_msg_index[0] = isUp ? 'u' : 'd';
 
-	addEngineSnifferEvent(eventId[(int )ckpSignalType], (char* ) shaft_signal_msg_index);
+	addEngineSnifferValue(eventId[(int )ckpSignalType], isUp ? PROTOCOL_ES_UP : PROTOCOL_ES_DOWN, index);
 	if (engineConfiguration->useOnlyRisingEdgeForTrigger) {
 		// let's add the opposite event right away
-		shaft_signal_msg_index[0] = isUp ? 'd' : 'u';
-		addEngineSnifferEvent(eventId[(int )ckpSignalType], (char* ) shaft_signal_msg_index);
+		addEngineSnifferValue(eventId[(int )ckpSignalType], isUp ? PROTOCOL_ES_DOWN : PROTOCOL_ES_UP, index);
 	}
 }
 
@@ -446,6 +441,23 @@ bool TriggerNoiseFilter::noiseFilter(efitick_t nowNt,
 	return false;
 }
 
+int getCrankDivider(operation_mode_e operationMode) {
+	switch (operationMode) {
+	case FOUR_STROKE_CAM_SENSOR:
+	case TWO_STROKE:
+		// trigger cycle matches engine cycle
+		return 1;
+	case FOUR_STROKE_CRANK_SENSOR:
+		return 2;
+	default:
+		return SYMMETRICAL_CRANK_SENSOR_DIVIDER;
+	}
+}
+
+uint32_t getEngineCycleCounter(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	return engine->triggerCentral.triggerState.getTotalRevolutionCounter() / getCrankDivider(engine->getOperationMode(PASS_ENGINE_PARAMETER_SIGNATURE));
+}
+
 /**
  * This method is NOT invoked for VR falls.
  */
@@ -496,9 +508,7 @@ void TriggerCentral::handleShaftSignal(trigger_event_e signal, efitick_t timesta
 		// That's easy - trigger cycle matches engine cycle
 		triggerIndexForListeners = triggerState.getCurrentIndex();
 	} else {
-		int crankDivider = operationMode == FOUR_STROKE_CRANK_SENSOR ? 2 : SYMMETRICAL_CRANK_SENSOR_DIVIDER;
-
-		int crankInternalIndex = triggerState.getTotalRevolutionCounter() % crankDivider;
+		int crankInternalIndex = triggerState.getTotalRevolutionCounter() % getCrankDivider(operationMode);
 
 		triggerIndexForListeners = triggerState.getCurrentIndex() + (crankInternalIndex * getTriggerSize());
 	}
@@ -715,7 +725,6 @@ bool isTriggerConfigChanged(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 
 void initTriggerCentral(Logging *sharedLogger) {
 	logger = sharedLogger;
-	strcpy((char*) shaft_signal_msg_index, "x_");
 
 #if EFI_ENGINE_SNIFFER
 	initWaveChart(&waveChart);
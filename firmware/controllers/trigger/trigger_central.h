@@ -97,4 +97,14 @@ bool isTriggerConfigChanged(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 
 bool isTriggerDecoderError(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 
+/**
+ * Trigger cycles per engine cycle: crank-only triggers on a four stroke go around more than once.
+ */
+int getCrankDivider(operation_mode_e operationMode);
+/**
+ * Counts whole engine cycles, moves on exactly where the index given to the trigger listeners
+ * goes back to zero.
+ */
+uint32_t getEngineCycleCounter(DECLARE_ENGINE_PARAMETER_SIGNATURE);
+
 #define SYMMETRICAL_CRANK_SENSOR_DIVIDER 4
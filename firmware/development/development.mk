@@ -8,7 +8,9 @@ DEV_SRC_CPP = $(DEVELOPMENT_DIR)/hw_layer/poten.cpp \
 	$(DEVELOPMENT_DIR)/rfi_perftest.cpp \
 	$(DEVELOPMENT_DIR)/engine_emulator.cpp \
 	$(DEVELOPMENT_DIR)/engine_sniffer.cpp \
+	$(DEVELOPMENT_DIR)/engine_sniffer_events.cpp \
 	$(DEVELOPMENT_DIR)/logic_analyzer.cpp \
 	$(DEVELOPMENT_DIR)/development/perf_trace.cpp
 	
-DEV_SIMULATOR_SRC_CPP = $(DEVELOPMENT_DIR)/engine_sniffer.cpp
\ No newline at end of file
+DEV_SIMULATOR_SRC_CPP = $(DEVELOPMENT_DIR)/engine_sniffer.cpp \
+	$(DEVELOPMENT_DIR)/engine_sniffer_events.cpp
\ No newline at end of file
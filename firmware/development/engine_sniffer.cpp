@@ -37,14 +37,11 @@
 #include "status_loop.h"
 #include "perf_trace.h"
 
-#define CHART_DELIMETER	'!'
-
 EXTERN_ENGINE;
 extern uint32_t maxLockedDuration;
 
 /**
- * This is the number of events in the digital chart which would be displayed
- * on the 'digital sniffer' pane
+ * Text of the chart as it goes to the 'digital sniffer' pane
  */
 #if EFI_PROD_CODE
 #define WAVE_LOGGING_SIZE 5000
@@ -52,9 +49,27 @@ extern uint32_t maxLockedDuration;
 #define WAVE_LOGGING_SIZE 35000
 #endif
 
-static char WAVE_LOGGING_BUFFER[WAVE_LOGGING_SIZE] CCM_OPTIONAL;
+/**
+ * Events of one chart, no more than the text of one chart can take: a typical event like
+ * c1!u!12345! is about this long
+ */
+#define WAVE_CHART_EVENT_TEXT_SIZE 17
+#define WAVE_CHART_MAX_EVENTS (WAVE_LOGGING_SIZE / WAVE_CHART_EVENT_TEXT_SIZE)
+
+/**
+ * Until publish() the text buffer is not used, the binary events of the chart are kept in its
+ * tail. Formatting overwrites them one by one as they turn into text.
+ */
+static union {
+	char text[WAVE_LOGGING_SIZE];
+	SnifferEvent events[WAVE_LOGGING_SIZE / sizeof(SnifferEvent)];
+} waveChartBuffer CCM_OPTIONAL;
+
+static_assert(WAVE_CHART_MAX_EVENTS <= efi::size(waveChartBuffer.events), "sniffer events have to fit the text buffer");
 
 int waveChartUsedSize;
+// events which were recorded but did not fit into the text of their chart
+static uint32_t waveChartCutOffCount = 0;
 
 //#define DEBUG_WAVE 1
 
@@ -77,7 +92,8 @@ static void resetNow(void) {
 }
 #endif
 
-WaveChart::WaveChart() : logging("wave chart", WAVE_LOGGING_BUFFER, sizeof(WAVE_LOGGING_BUFFER)) {
+WaveChart::WaveChart() : logging("wave chart", waveChartBuffer.text, sizeof(waveChartBuffer.text))
+	, events(waveChartBuffer.events + efi::size(waveChartBuffer.events) - WAVE_CHART_MAX_EVENTS, WAVE_CHART_MAX_EVENTS) {
 }
 
 void WaveChart::init() {
@@ -89,11 +105,13 @@ void WaveChart::reset() {
 #if DEBUG_WAVE
 	scheduleSimpleMsg(&debugLogging, "reset while at ", counter);
 #endif /* DEBUG_WAVE */
-	logging.reset();
-	counter = 0;
-	startTimeNt = 0;
+	{
+		chibios_rt::CriticalSectionLocker csl;
+		events.reset();
+		counter = 0;
+		startTimeNt = 0;
+	}
 	collectingData = false;
-	logging.appendPrintf( "%s%s", PROTOCOL_ENGINE_SNIFFER, DELIMETER);
 }
 
 void WaveChart::startDataCollection() {
@@ -112,12 +130,13 @@ bool WaveChart::isStartedTooLongAgo() const {
 }
 
 bool WaveChart::isFull() const {
-	return counter >= CONFIG(engineChartSize);
+	return counter >= CONFIG(engineChartSize) || counter >= WAVE_CHART_MAX_EVENTS;
 }
 
 static void printStatus(void) {
 	scheduleMsg(&logger, "engine chart: %s", boolToString(engineConfiguration->isEngineChartEnabled));
-	scheduleMsg(&logger, "engine chart size=%d", engineConfiguration->engineChartSize);
+	scheduleMsg(&logger, "engine chart size=%d, up to %d events", engineConfiguration->engineChartSize, WAVE_CHART_MAX_EVENTS);
+	scheduleMsg(&logger, "engine chart events cut off: %d", waveChartCutOffCount);
 }
 
 static void setChartActive(int value) {
@@ -144,6 +163,17 @@ void WaveChart::publishIfFull() {
 }
 
 void WaveChart::publish() {
+	size_t eventCount;
+	{
+		// events past this one might be going in while we format
+		chibios_rt::CriticalSectionLocker csl;
+		eventCount = events.getCount();
+	}
+
+	logging.reset();
+	logging.appendPrintf( "%s%s", PROTOCOL_ENGINE_SNIFFER, DELIMETER);
+	size_t formatted = events.format(logging, eventCount, strlen(DELIMETER));
+	waveChartCutOffCount += eventCount - formatted;
 	logging.appendPrintf( DELIMETER);
 	waveChartUsedSize = logging.loggingSize();
 #if DEBUG_WAVE
@@ -158,7 +188,7 @@ void WaveChart::publish() {
 /**
  * @brief	Register an event for digital sniffer
  */
-void WaveChart::addEvent3(const char *name, const char * msg) {
+void WaveChart::addEvent3(const char *name, const char * msg, int value) {
 	ScopePerf perf(PE::EngineSniffer);
 	efitick_t nowNt = getTimeNowNt();
 
@@ -200,33 +230,7 @@ void WaveChart::addEvent3(const char *name, const char * msg) {
 	}
 	counter++;
 
-	/**
-	 * We want smaller times within a chart in order to reduce packet size.
-	 */
-	/**
-	 * todo: migrate to binary fractions in order to eliminate
-	 * this division? I do not like division
-	 *
-	 * at least that's 32 bit division now
-	 */
-	uint32_t diffNt = nowNt - startTimeNt;
-	uint32_t time100 = NT2US(diffNt / ENGINE_SNIFFER_UNIT_US);
-
-	if (logging.remainingSize() > 35) {
-		/**
-		 * printf is a heavy method, append is used here as a performance optimization
-		 */
-		logging.appendFast(name);
-		logging.appendChar(CHART_DELIMETER);
-		logging.appendFast(msg);
-		logging.appendChar(CHART_DELIMETER);
-//		time100 -= startTime100;
-
-		itoa10(timeBuffer, time100);
-		logging.appendFast(timeBuffer);
-		logging.appendChar(CHART_DELIMETER);
-		logging.terminate();
-	}
+	events.add(name, msg, value, nowNt - startTimeNt);
 #endif /* EFI_TEXT_LOGGING */
 }
 
@@ -12,6 +12,7 @@
 
 #if EFI_ENGINE_SNIFFER
 #include "datalogging.h"
+#include "engine_sniffer_events.h"
 
 /**
  * @brief	rusEfi console sniffer data buffer
@@ -20,7 +21,11 @@ class WaveChart {
 public:
 	WaveChart();
 	void init();
-	void addEvent3(const char *name, const char *msg);
+	/**
+	 * @param msg has to stay around until the chart is published, like PROTOCOL_ES_UP
+	 * @param value tooth index or rpm, goes after msg
+	 */
+	void addEvent3(const char *name, const char *msg, int value = SNIFFER_NO_VALUE);
 	void reset();
 	void startDataCollection();
 	void publishIfFull();
@@ -31,8 +36,9 @@ public:
 	efitick_t pauseEngineSnifferUntilNt = 0;
 
 private:
+	// text is only put together in publish()
 	Logging logging;
-	char timeBuffer[_MAX_FILLER + 2];
+	EngineSnifferEvents events;
 	uint32_t counter = 0;
 	/**
 	 * We want to avoid visual jitter thus we want the left edge to be aligned
@@ -0,0 +1,82 @@
+/**
+ * @file	engine_sniffer_events.cpp
+ *
+ * @date Oct 18, 2026
+ */
+
+#include "global.h"
+#include "engine_sniffer_events.h"
+#include "efilib.h"
+
+#define CHART_DELIMETER	'!'
+
+// longest name, message with value and time we expect, with delimiters
+#define MAX_EVENT_TEXT 50
+
+size_t EngineSnifferEvents::format(Logging &logging, size_t count, size_t reserve) const {
+	// one event at a time, it only goes out if it fits as a whole
+	char text[MAX_EVENT_TEXT];
+	size_t length;
+	char number[_MAX_FILLER + 2];
+
+	auto append = [&](const char *part) {
+		while (*part != 0 && length < sizeof(text)) {
+			text[length++] = *part++;
+		}
+	};
+	auto appendChar = [&](char c) {
+		if (length < sizeof(text)) {
+			text[length++] = c;
+		}
+	};
+
+	// events may live in the tail of the text buffer, text only ever covers events formatted already
+	const char *eventsStart = reinterpret_cast<const char*>(m_events);
+	bool isInPlace = eventsStart >= logging.buffer && eventsStart < logging.buffer + logging.bufferSize;
+
+	for (size_t i = 0; i < count; i++) {
+		// a copy, its text might go where it is stored
+		const SnifferEvent event = m_events[i];
+
+		/**
+		 * printf is a heavy method, the text is put together by hand as a performance optimization
+		 */
+		length = 0;
+		append(event.name);
+		appendChar(CHART_DELIMETER);
+
+		if (event.edge != 0) {
+			appendChar(event.edge);
+		}
+		if (event.value != SNIFFER_NO_VALUE) {
+			if (event.edge != 0) {
+				appendChar('_');
+			}
+			itoa10(number, event.value);
+			append(number);
+		}
+		appendChar(CHART_DELIMETER);
+
+		/**
+		 * We want smaller times within a chart in order to reduce packet size.
+		 */
+		itoa10(number, NT2US(event.timeNt / ENGINE_SNIFFER_UNIT_US));
+		append(number);
+		appendChar(CHART_DELIMETER);
+
+		// and the terminating zero
+		if (length + reserve >= logging.remainingSize()) {
+			return i;
+		}
+		if (isInPlace && logging.linePointer + length + 1 > reinterpret_cast<const char*>(&m_events[i + 1])) {
+			return i;
+		}
+
+		for (size_t j = 0; j < length; j++) {
+			logging.appendChar(text[j]);
+		}
+		logging.terminate();
+	}
+
+	return count;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file	engine_sniffer_events.h
+ *
+ * Engine sniffer events as they happen: a few stores per edge from the trigger and scheduler
+ * paths, the text for rusEfi console is only put together when the chart is published.
+ *
+ * @date Oct 18, 2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "datalogging.h"
+
+#define SNIFFER_NO_VALUE -1
+
+struct SnifferEvent {
+	// channel, string constants and pin names which stay around
+	const char *name;
+	// since the start of the chart
+	uint32_t timeNt;
+	// tooth index or rpm, SNIFFER_NO_VALUE for none
+	int16_t value;
+	// first character of PROTOCOL_ES_UP or PROTOCOL_ES_DOWN, 0 for a value only
+	char edge;
+};
+
+class EngineSnifferEvents {
+public:
+	EngineSnifferEvents(SnifferEvent *storage, size_t capacity)
+		: m_events(storage)
+		, m_capacity(capacity)
+	{
+	}
+
+	/**
+	 * Not thread safe, the caller takes care of locking.
+	 * @return false if there is no more room
+	 */
+	bool add(const char *name, const char *msg, int value, uint32_t timeNt) {
+		if (m_count >= m_capacity) {
+			return false;
+		}
+		SnifferEvent &event = m_events[m_count];
+		event.name = name;
+		event.timeNt = timeNt;
+		event.value = value;
+		event.edge = msg[0];
+		m_count++;
+		return true;
+	}
+
+	size_t getCount() const {
+		return m_count;
+	}
+
+	void reset() {
+		m_count = 0;
+	}
+
+	/**
+	 * Appends the first count events the way rusEfi console reads them: name!msg!time! with msg
+	 * followed by _value if there is one, or just the value if msg is empty. Time is in
+	 * ENGINE_SNIFFER_UNIT_US units. The events may be stored in the tail of the logging buffer,
+	 * an event is cut off rather than having its text overwrite events which are not formatted yet.
+	 * @param reserve bytes left free after the last event, for whatever the caller appends
+	 * @return events which fit into logging, an event is either complete or not there at all
+	 */
+	size_t format(Logging &logging, size_t count, size_t reserve = 0) const;
+
+private:
+	SnifferEvent * const m_events;
+	const size_t m_capacity;
+	size_t m_count = 0;
+};
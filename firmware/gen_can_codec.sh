@@ -0,0 +1,11 @@
+#!/bin/bash
+
+echo "This script reads integration/can/*.dbc and produces CAN message pack/unpack header"
+
+python3 ../misc/can_codec/gen_can_codec.py controllers/generated/can_codec_generated.h \
+	integration/can/dashboards.dbc \
+	integration/can/rusefi_verbose.dbc \
+	integration/can/vehicle_speed.dbc
+[ $? -eq 0 ] || { echo "ERROR generating CAN codec"; exit 1; }
+
+exit 0
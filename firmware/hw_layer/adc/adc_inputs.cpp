@@ -37,12 +37,18 @@
 #include "maf.h"
 #include "perf_trace.h"
 #include "thread_priority.h"
+#include "adc_oversampler.h"
 
 /* Depth of the conversion buffer, channels are sampled X times each.*/
 #ifndef ADC_BUF_DEPTH_FAST
 #define ADC_BUF_DEPTH_FAST      4
 #endif
 
+/* Default number of fast samples per value, the board can override per channel, see setFastAdcOversampling */
+#ifndef ADC_FAST_OVERSAMPLING
+#define ADC_FAST_OVERSAMPLING   ADC_BUF_DEPTH_FAST
+#endif
+
 static NO_CACHE adcsample_t slowAdcSamples[ADC_MAX_CHANNELS_COUNT];
 static NO_CACHE adcsample_t fastAdcSampleBuf[ADC_BUF_DEPTH_FAST * ADC_MAX_CHANNELS_COUNT];
 
@@ -103,18 +109,6 @@ static int adcDebugReporting = false;
 
 EXTERN_ENGINE;
 
-static adcsample_t getAvgAdcValue(int index, adcsample_t *samples, int bufDepth, int numChannels) {
-	uint32_t result = 0;
-	for (int i = 0; i < bufDepth; i++) {
-		result += samples[index];
-		index += numChannels;
-	}
-
-	// this truncation is guaranteed to not be lossy - the average can't be larger than adcsample_t
-	return static_cast<adcsample_t>(result / bufDepth);
-}
-
-
 // See https://github.com/rusefi/rusefi/issues/976 for discussion on these values
 #define ADC_SAMPLING_SLOW ADC_SAMPLE_56
 #define ADC_SAMPLING_FAST ADC_SAMPLE_28
@@ -168,6 +162,31 @@ static ADCConversionGroup adcgrpcfgFast = {
 
 AdcDevice fastAdc(&adcgrpcfgFast, fastAdcSampleBuf, ARRAY_SIZE(fastAdcSampleBuf));
 
+// indexed by internal fast ADC index
+static AdcOversampler<ADC_MAX_CHANNELS_COUNT> fastAdcOversampler;
+
+void onFastAdcComplete(adcsample_t *samples) {
+	fastAdcOversampler.onBlock(samples, ADC_BUF_DEPTH_FAST, fastAdc.size());
+}
+
+int getFastAdcValueByIndex(int internalIndex) {
+	return fastAdcOversampler.get(internalIndex);
+}
+
+bool setFastAdcOversampling(adc_channel_e hwChannel, uint32_t ratio, uint8_t order) {
+	if (!fastAdc.isHwUsed(hwChannel)) {
+		return false;
+	}
+
+	int internalIndex = fastAdc.internalAdcIndexByHardwareIndex[hwChannel];
+	if (!fastAdcOversampler.configure(internalIndex, ratio, order)) {
+		firmwareError(CUSTOM_INVALID_ADC, "Unsupported fast ADC oversampling %d order %d", ratio, order);
+		return false;
+	}
+
+	return true;
+}
+
 static void fast_adc_callback(GPTDriver*) {
 #if EFI_INTERNAL_ADC
 	/*
@@ -215,10 +234,7 @@ int getInternalAdcValue(const char *msg, adc_channel_e hwChannel) {
 #if EFI_USE_FAST_ADC
 	if (adcHwChannelEnabled[hwChannel] == ADC_FAST) {
 		int internalIndex = fastAdc.internalAdcIndexByHardwareIndex[hwChannel];
-// todo if ADC_BUF_DEPTH_FAST EQ 1
-//		return fastAdc.samples[internalIndex];
-		int value = getAvgAdcValue(internalIndex, fastAdc.samples, ADC_BUF_DEPTH_FAST, fastAdc.size());
-		return value;
+		return getFastAdcValueByIndex(internalIndex);
 	}
 #endif // EFI_USE_FAST_ADC
 
@@ -337,8 +353,9 @@ static void printFullAdcReport(Logging *logger) {
 			ioportid_t port = getAdcChannelPort("print", hwIndex);
 			int pin = getAdcChannelPin(hwIndex);
 
-			int adcValue = getAvgAdcValue(hwIndex, fastAdc.samples, ADC_BUF_DEPTH_FAST, fastAdc.size());
+			int adcValue = getFastAdcValueByIndex(index);
 			logger->appendPrintf(" F ch%d %s%d", index, portname(port), pin);
+			logger->appendPrintf(" x%d order %d", fastAdcOversampler.getRatio(index), fastAdcOversampler.getOrder(index));
 			logger->appendPrintf(" ADC%d 12bit=%d", hwIndex, adcValue);
 			float volts = adcToVolts(adcValue);
 			logger->appendPrintf(" v=%.2f", volts);
@@ -438,6 +455,7 @@ void addChannel(const char *name, adc_channel_e setting, adc_channel_mode_e mode
 #if EFI_USE_FAST_ADC
 	if (mode == ADC_FAST) {
 		fastAdc.enableChannelAndPin(name, setting);
+		setFastAdcOversampling(setting, ADC_FAST_OVERSAMPLING, 1);
 		return;
 	}
 #endif
@@ -49,6 +49,18 @@ int getSlowAdcCounter();
 
 int getAdcHardwareIndexByInternalIndex(int index);
 
+#if EFI_USE_FAST_ADC
+// fold a completed fast ADC DMA block into the per-channel oversamplers, from the ADC callback
+void onFastAdcComplete(adcsample_t *samples);
+// latest oversampled value, O(1)
+int getFastAdcValueByIndex(int internalIndex);
+/**
+ * Average 'ratio' samples per value, order 1 is a boxcar average, 2 and 3 a CIC decimator.
+ * Boards can call this from setAdcChannelOverrides() for channels already added as ADC_FAST.
+ */
+bool setFastAdcOversampling(adc_channel_e hwChannel, uint32_t ratio, uint8_t order);
+#endif // EFI_USE_FAST_ADC
+
 void printFullAdcReportIfNeeded(Logging *log);
 int getInternalAdcValue(const char *msg, adc_channel_e index);
 float getMCUInternalTemperature(void);
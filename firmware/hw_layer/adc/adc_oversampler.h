@@ -0,0 +1,122 @@
+/**
+ * @file adc_oversampler.h
+ *
+ * Per-channel decimation of fast ADC DMA blocks. Each completed block is folded into running
+ * integrators once, so reading a channel is O(1) no matter how many samples it averages.
+ *
+ * Order 1 is a plain boxcar average over 'ratio' samples, higher orders are a CIC
+ * (cascaded integrator-comb) decimator with better rejection of noise near the output rate.
+ * A ratio above the DMA block depth averages across several blocks.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define ADC_OVERSAMPLER_MAX_ORDER 3
+
+// Filter gain is ratio^order, which times a 16 bit sample has to fit the 32 bit accumulators
+#define ADC_OVERSAMPLER_MAX_GAIN 65536
+
+template <size_t TChannels>
+class AdcOversampler {
+public:
+	AdcOversampler() {
+		for (size_t i = 0; i < TChannels; i++) {
+			configure(i, 1, 1);
+		}
+	}
+
+	/**
+	 * @param ratio number of samples per decimated value
+	 * @param order 1 for boxcar average, 2..ADC_OVERSAMPLER_MAX_ORDER for CIC
+	 * @return false if the combination is not supported, channel is left untouched
+	 */
+	bool configure(size_t channel, uint32_t ratio, uint8_t order) {
+		if (channel >= TChannels || ratio == 0 || order < 1 || order > ADC_OVERSAMPLER_MAX_ORDER) {
+			return false;
+		}
+
+		uint32_t gain = 1;
+		for (int i = 0; i < order; i++) {
+			gain *= ratio;
+			if (gain > ADC_OVERSAMPLER_MAX_GAIN) {
+				return false;
+			}
+		}
+
+		Channel &c = m_channels[channel];
+		c = {};
+		c.ratio = ratio;
+		c.order = order;
+		c.gain = gain;
+
+		return true;
+	}
+
+	/**
+	 * Called once per completed DMA block
+	 * @param samples interleaved, depth rows of channelCount samples each
+	 */
+	template <typename TSample>
+	void onBlock(const TSample *samples, size_t depth, size_t channelCount) {
+		for (size_t ch = 0; ch < channelCount && ch < TChannels; ch++) {
+			Channel &c = m_channels[ch];
+			const TSample *s = samples + ch;
+
+			for (size_t d = 0; d < depth; d++) {
+				c.integrator[0] += s[d * channelCount];
+				for (int k = 1; k < c.order; k++) {
+					c.integrator[k] += c.integrator[k - 1];
+				}
+
+				if (++c.count >= c.ratio) {
+					c.count = 0;
+					decimate(c);
+				}
+			}
+		}
+	}
+
+	// Latest decimated value of the channel, in ADC counts
+	uint16_t get(size_t channel) const {
+		return m_channels[channel].value;
+	}
+
+	uint32_t getRatio(size_t channel) const {
+		return m_channels[channel].ratio;
+	}
+
+	uint8_t getOrder(size_t channel) const {
+		return m_channels[channel].order;
+	}
+
+private:
+	struct Channel {
+		// wrap around is expected, the combs undo it as long as the gain fits 32 bits
+		uint32_t integrator[ADC_OVERSAMPLER_MAX_ORDER];
+		uint32_t combDelay[ADC_OVERSAMPLER_MAX_ORDER];
+
+		uint32_t ratio;
+		uint32_t gain;
+		uint32_t count;
+		uint8_t order;
+
+		uint16_t value;
+	};
+
+	static void decimate(Channel &c) {
+		uint32_t v = c.integrator[c.order - 1];
+
+		for (int k = 0; k < c.order; k++) {
+			uint32_t previous = c.combDelay[k];
+			c.combDelay[k] = v;
+			v -= previous;
+		}
+
+		c.value = v / c.gain;
+	}
+
+	Channel m_channels[TChannels];
+};
@@ -6,9 +6,76 @@
 
 #include "functional_sensor.h"
 #include "global.h"
+#include "biquad_bank.h"
 
 class AdcSubscription {
 public:
 	static void SubscribeSensor(FunctionalSensor &sensor, adc_channel_e channel, float lowpassCutoff, float voltsPerAdcVolt = 0.0f);
 	static void UpdateSubscribers(efitick_t nowNt);
 };
+
+/**
+ * Sensors fed from ADC channels, processed as a batch: fetch every raw sample, scale
+ * all of them to volts, run all low pass filters as one filter bank, then post to sensors.
+ */
+template <size_t TSize>
+class AdcSubscriptionTable {
+public:
+	// Returns false if the table is full
+	bool subscribe(FunctionalSensor &sensor, adc_channel_e channel, float samplingFrequency, float lowpassCutoff, float voltsPerAdcVolt) {
+		if (m_count >= TSize) {
+			return false;
+		}
+
+		m_sensors[m_count] = &sensor;
+		m_channels[m_count] = channel;
+		m_voltsPerAdcVolt[m_count] = voltsPerAdcVolt;
+		m_filters.configureLowpass(m_count, samplingFrequency, lowpassCutoff);
+
+		m_count++;
+		return true;
+	}
+
+	/**
+	 * @param getRaw returns the raw ADC code for a channel
+	 * @param voltsPerAdcCode MCU volts for one ADC code
+	 */
+	template <typename TGetRaw>
+	void update(TGetRaw getRaw, float voltsPerAdcCode, efitick_t nowNt) {
+		for (size_t i = 0; i < m_count; i++) {
+			m_volts[i] = getRaw(m_channels[i]);
+		}
+
+		for (size_t i = 0; i < m_count; i++) {
+			m_volts[i] *= voltsPerAdcCode * m_voltsPerAdcVolt[i];
+		}
+
+		// On the very first update of an entry, preload the filter as if we've been
+		// seeing this value for a long time.  This prevents a slow ramp-up
+		// towards the correct value just after startup
+		for (; m_cookedCount < m_count; m_cookedCount++) {
+			m_filters.cookSteadyState(m_cookedCount, m_volts[m_cookedCount]);
+		}
+
+		m_filters.filter(m_volts, m_count);
+
+		for (size_t i = 0; i < m_count; i++) {
+			m_sensors[i]->postRawValue(m_volts[i], nowNt);
+		}
+	}
+
+	size_t getCount() const {
+		return m_count;
+	}
+
+private:
+	FunctionalSensor *m_sensors[TSize];
+	adc_channel_e m_channels[TSize];
+	float m_voltsPerAdcVolt[TSize];
+	// scratch for the batch in flight: raw, then volts, then filtered volts
+	float m_volts[TSize];
+	BiquadBank<TSize> m_filters;
+
+	size_t m_count = 0;
+	size_t m_cookedCount = 0;
+};
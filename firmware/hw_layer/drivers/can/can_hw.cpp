@@ -31,6 +31,7 @@ EXTERN_ENGINE;
 static int canReadCounter = 0;
 int canWriteOk = 0;
 int canWriteNotOk = 0;
+int canWriteMailboxFull = 0;
 static bool isCanEnabled = false;
 static LoggingWithStorage logger("CAN driver");
 
@@ -130,7 +131,7 @@ static void canInfo(void) {
 			boolToString(engineConfiguration->canReadEnabled), boolToString(engineConfiguration->canWriteEnabled),
 			engineConfiguration->canSleepPeriodMs);
 
-	scheduleMsg(&logger, "CAN rx_cnt=%d/tx_ok=%d/tx_not_ok=%d", canReadCounter, canWriteOk, canWriteNotOk);
+	scheduleMsg(&logger, "CAN rx_cnt=%d/tx_ok=%d/tx_not_ok=%d/tx_mailbox_full=%d", canReadCounter, canWriteOk, canWriteNotOk, canWriteMailboxFull);
 }
 
 void setCanType(int type) {
@@ -174,6 +175,9 @@ void startCanPins(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 void initCan(void) {
 	addConsoleAction("caninfo", canInfo);
 
+	// RX routing has to be in place before the RX thread starts
+	initCanRx();
+
 	isCanEnabled = 
 		(isBrainPinValid(CONFIG_OVERRIDE(canTxPin))) && // both pins are set...
 		(isBrainPinValid(CONFIG_OVERRIDE(canRxPin))) &&
@@ -229,8 +233,7 @@ void initCan(void) {
 
 	// fire up threads, as necessary
 	if (CONFIG(canWriteEnabled)) {
-		canWrite.setPeriod(CONFIG(canSleepPeriodMs));
-		canWrite.Start();
+		canWrite.start();
 	}
 
 	if (CONFIG(canReadEnabled)) {
@@ -19,6 +19,7 @@ extern LoggingWithStorage sharedLogger;
 
 extern int canWriteOk;
 extern int canWriteNotOk;
+extern int canWriteMailboxFull;
 
 /*static*/ CANDriver* CanTxMessage::s_device = nullptr;
 
@@ -56,6 +57,10 @@ CanTxMessage::~CanTxMessage() {
 		canWriteOk++;
 	} else {
 		canWriteNotOk++;
+		if (msg == MSG_TIMEOUT) {
+			// every mailbox stayed busy, the bus is saturated or nobody acks
+			canWriteMailboxFull++;
+		}
 	}
 }
 
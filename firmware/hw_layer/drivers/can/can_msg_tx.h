@@ -98,6 +98,18 @@ public:
 #endif // EFI_CAN_SUPPORT
 };
 
+/**
+ * Packs a message defined in can_codec_generated.h and transmits it.
+ * @param eid overrides the ID from the DBC file, for messages with a configurable base address
+ */
+template <typename TMessage>
+void transmitMessage(const TMessage& message, uint32_t eid = TMessage::id)
+{
+	CanTxMessage frame(eid, TMessage::dlc, TMessage::isExtended);
+	// Destruction of an instance of CanTxMessage will transmit the message over the wire.
+	message.pack(&frame[0]);
+}
+
 template <typename TData>
 void transmitStruct(uint32_t eid)
 {
@@ -172,6 +172,8 @@ void adc_callback_fast(ADCDriver *adcp) {
 			triggerAdcCallback(buffer[triggerSampleIndex]);
 #endif /* HAL_TRIGGER_USE_ADC */
 
+		onFastAdcComplete(buffer);
+
 		// store the values for averaging
 		for (int i = fastAdc.size() - 1; i >= 0; i--) {
 			averagedSamples[i] += fastAdc.samples[i];
@@ -225,6 +227,10 @@ void adc_callback_fast(ADCDriver *adcp) {
 		 */
 		efiAssertVoid(CUSTOM_ERR_6676, getCurrentRemainingStack() > 128, "lowstck#9b");
 
+#if !EFI_FASTER_UNIFORM_ADC
+		onFastAdcComplete(buffer);
+#endif /* EFI_FASTER_UNIFORM_ADC */
+
 #if EFI_SENSOR_CHART && EFI_SHAFT_POSITION_INPUT
 		if (ENGINE(sensorChartMode) == SC_AUX_FAST1) {
 			float voltage = getAdcValue("fAux1", engineConfiguration->auxFastSensor1_adcChannel);
@@ -233,7 +239,7 @@ void adc_callback_fast(ADCDriver *adcp) {
 #endif /* EFI_SENSOR_CHART */
 
 #if EFI_MAP_AVERAGING
-		mapAveragingAdcCallback(buffer[fastMapSampleIndex]);
+		mapAveragingAdcCallback(getFastAdcValueByIndex(fastMapSampleIndex));
 #endif /* EFI_MAP_AVERAGING */
 #if EFI_HIP_9011
 		if (CONFIG(isHip9011Enabled)) {
@@ -18,15 +18,18 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <atomic>
 #include "mmc_card.h"
 #include "pin_repository.h"
 #include "ff.h"
 #include "hardware.h"
 #include "engine_configuration.h"
 #include "status_loop.h"
-#include "buffered_writer.h"
+#include "log_ring_buffer.h"
+#include "binary_logging.h"
 #include "null_device.h"
 #include "thread_priority.h"
+#include "periodic_thread_controller.h"
 
 #include "rtc_helper.h"
 
@@ -46,11 +49,35 @@ EXTERN_ENGINE;
 
 #define F_SYNC_FREQUENCY 100
 
+#ifndef SD_LOG_RING_SIZE
+// over a second of records at the default rate, longer than a card takes for its housekeeping
+#define SD_LOG_RING_SIZE 8192
+#endif
+
+// at most this many sectors per f_write
+#define SD_LOG_MAX_WRITE_SECTORS 4
+// how long the card writer sleeps when there is not a full sector yet
+#define SD_LOG_WRITER_IDLE_MS 10
+// the sector still being filled goes to the card this often, at most this much is lost on power loss
+#define SD_LOG_PARTIAL_SYNC_MS 1000
+// 1kHz is fine with a few groups selected
+#define SD_LOG_MIN_PERIOD_MS 1
+
+// contiguous space asked for up front, the log then grows cluster after cluster without FAT lookups
+#define SD_LOG_PREALLOCATE_SIZE (64 * 1024 * 1024)
+// new log file name attempts if the name is taken
+#define SD_LOG_NAME_ATTEMPTS 10
+
 static int totalLoggedBytes = 0;
 static int fileCreatedCounter = 0;
 static int writeCounter = 0;
 static int totalWritesCounter = 0;
 static int totalSyncCounter = 0;
+// slowest card write since the previous record, and ever
+static std::atomic<uint32_t> maxWriteUs(0);
+static uint32_t maxWriteUsEver = 0;
+// the writer is putting out what is left, no more records
+static volatile bool isLogClosing = false;
 
 /**
  * on't re-read SD card spi device after boot - it could change mid transaction (TS thread could preempt),
@@ -120,6 +147,9 @@ static void printError(const char *str, FRESULT f_error) {
 static FIL FDLogFile NO_CACHE;
 static FIL FDCurrFile NO_CACHE;
 
+// the card is written straight from here, whole sectors at a time
+static NO_CACHE LogRingBuffer<SD_LOG_RING_SIZE, FF_MAX_SS> logRing;
+
 // 10 because we want at least 4 character name
 #define MIN_FILE_INDEX 10
 static int logFileIndex = MIN_FILE_INDEX;
@@ -140,6 +170,8 @@ static void sdStatistics(void) {
 	printSpiConfig(&logger, "SD", mmcSpiDevice);
 	if (isSdCardAlive()) {
 		scheduleMsg(&logger, "filename=%s size=%d", logName, totalLoggedBytes);
+		scheduleMsg(&logger, "ring %d of %d bytes, %d records dropped, slowest write %dus",
+				logRing.getUsed(), SD_LOG_RING_SIZE, logRing.getDroppedCount(), maxWriteUsEver);
 	}
 }
 
@@ -205,22 +237,30 @@ static void prepareLogFileName(void) {
  */
 static void createLogFile(void) {
 	memset(&FDLogFile, 0, sizeof(FIL));						// clear the memory
-	prepareLogFileName();
 
-	FRESULT err = f_open(&FDLogFile, logName, FA_OPEN_ALWAYS | FA_WRITE);				// Create new file
-	if (err != FR_OK && err != FR_EXIST) {
+	// always a new file: the log is written in whole sectors from the start of the file, and appending
+	// would have put a second header in the middle of an older log anyway
+	FRESULT err;
+	for (int attempt = 0;; attempt++) {
+		prepareLogFileName();
+		err = f_open(&FDLogFile, logName, FA_CREATE_NEW | FA_WRITE);
+		if (err != FR_EXIST || attempt == SD_LOG_NAME_ATTEMPTS) {
+			break;
+		}
+		logFileIndex++;
+	}
+
+	if (err != FR_OK) {
 		sdStatus = SD_STATE_OPEN_FAILED;
 		warning(CUSTOM_ERR_SD_MOUNT_FAILED, "SD: mount failed");
 		printError("FS mount failed", err);	// else - show error
 		return;
 	}
 
-	err = f_lseek(&FDLogFile, f_size(&FDLogFile)); // Move to end of the file to append data
-	if (err) {
-		sdStatus = SD_STATE_SEEK_FAILED;
-		warning(CUSTOM_ERR_SD_SEEK_FAILED, "SD: seek failed");
-		printError("Seek error", err);
-		return;
+	err = f_expand(&FDLogFile, SD_LOG_PREALLOCATE_SIZE, 0);
+	if (err != FR_OK) {
+		// still fine, just not one contiguous run
+		printError("no contiguous space", err);
 	}
 	f_sync(&FDLogFile);
 	setSdCardReady(true);						// everything Ok
@@ -454,42 +494,117 @@ static bool mountMmc() {
 	}
 }
 
-struct SdLogBufferWriter final : public BufferedWriter<512> {
-	bool failed = false;
+/**
+ * Takes a record every sdCardPeriodMs no matter how long the card takes to write them
+ */
+class SdLogSampler final : public PeriodicController<UTILITY_THREAD_STACK_SIZE * 2> {
+public:
+	SdLogSampler() : PeriodicController("SD log sampler", PRIO_SD_LOG_SAMPLER, 20) { }
+
+private:
+	void PeriodicTask(efitick_t nowNt) override {
+		UNUSED(nowNt);
+		setPeriod(NOT_TOO_OFTEN(SD_LOG_MIN_PERIOD_MS, CONFIG(sdCardPeriodMs)));
+
+		if (!isSdCardAlive() || isLogClosing) {
+			return;
+		}
 
-	size_t writeInternal(const char* buffer, size_t count) override {
-		size_t bytesWritten;
+		// one exchange, a write finishing in between is not lost
+		setSdLogCounters(logRing.getDroppedCount(), maxWriteUs.exchange(0) / 1000);
+
+		writeLogLine(logRing);
+	}
+};
 
-		totalLoggedBytes += count;
+static SdLogSampler sampler;
 
-		FRESULT err = f_write(&FDLogFile, buffer, count, &bytesWritten);
+static bool writeSectors(const char* buffer, size_t count) {
+	UINT bytesWritten;
+	efitimeus_t start = getTimeNowUs();
 
-		if (bytesWritten != count) {
-			printError("write error or disk full", err); // error or disk full
+	FRESULT err = f_write(&FDLogFile, buffer, count, &bytesWritten);
 
-			// Close file and unmount volume
-			mmcUnMount();
-			failed = true;
-			return 0;
-		} else {
-			writeCounter++;
-			totalWritesCounter++;
-			if (writeCounter >= F_SYNC_FREQUENCY) {
-				/**
-				 * Performance optimization: not f_sync after each line, f_sync is probably a heavy operation
-				 * todo: one day someone should actually measure the relative cost of f_sync
-				 */
-				f_sync(&FDLogFile);
-				totalSyncCounter++;
-				writeCounter = 0;
-			}
-		}
+	if (bytesWritten != count) {
+		printError("write error or disk full", err); // error or disk full
 
-		return bytesWritten;
+		// Close file and unmount volume
+		mmcUnMount();
+		return false;
+	}
+
+	totalLoggedBytes += count;
+	writeCounter++;
+	totalWritesCounter++;
+	if (writeCounter >= F_SYNC_FREQUENCY) {
+		/**
+		 * Performance optimization: not f_sync after each line, f_sync is probably a heavy operation
+		 * todo: one day someone should actually measure the relative cost of f_sync
+		 */
+		f_sync(&FDLogFile);
+		totalSyncCounter++;
+		writeCounter = 0;
 	}
-};
 
-static NO_CACHE SdLogBufferWriter logBuffer;
+	uint32_t elapsedUs = getTimeNowUs() - start;
+	uint32_t previousMax = maxWriteUs;
+	while (elapsedUs > previousMax && !maxWriteUs.compare_exchange_weak(previousMax, elapsedUs)) {
+		// the sampler took it in between, try again against what is there now
+	}
+	maxWriteUsEver = maxI(maxWriteUsEver, elapsedUs);
+
+	return true;
+}
+
+/**
+ * Puts the sector still being filled on the card as it is. Unless this is the last write the
+ * file position goes back to the start of that sector: once full it is written over the same
+ * place and writes stay sector aligned.
+ */
+static bool writePartialSector(bool isLast) {
+	size_t size = logRing.getPartialSize();
+	if (size == 0) {
+		return true;
+	}
+
+	FSIZE_t sectorStart = f_tell(&FDLogFile);
+	UINT bytesWritten;
+	FRESULT err = f_write(&FDLogFile, logRing.getReadPointer(), size, &bytesWritten);
+	if (bytesWritten != size) {
+		printError("write error or disk full", err);
+		mmcUnMount();
+		return false;
+	}
+
+	f_sync(&FDLogFile);
+	totalSyncCounter++;
+	writeCounter = 0;
+
+	if (!isLast) {
+		f_lseek(&FDLogFile, sectorStart);
+	}
+	return true;
+}
+
+/**
+ * Everything in the ring goes to the card before the file is closed.
+ */
+static void closeLog() {
+	isLogClosing = true;
+
+	while (size_t sectors = logRing.getReadableBlocks()) {
+		sectors = minI(sectors, SD_LOG_MAX_WRITE_SECTORS);
+		if (!writeSectors(logRing.getReadPointer(), sectors * FF_MAX_SS)) {
+			// already unmounted
+			return;
+		}
+		logRing.release(sectors);
+	}
+
+	if (writePartialSector(true)) {
+		mmcUnMount();
+	}
+}
 
 static THD_FUNCTION(MMCmonThread, arg) {
 	(void)arg;
@@ -500,9 +615,14 @@ static THD_FUNCTION(MMCmonThread, arg) {
 		return;
 	}
 
+	sampler.Start();
+
+	efitick_t partialSyncNt = getTimeNowNt();
+
 	while (true) {
 		// if the SPI device got un-picked somehow, cancel SD card
 		if (CONFIG(sdCardSpiDevice) == SPI_NONE) {
+			closeLog();
 			return;
 		}
 
@@ -511,19 +631,30 @@ static THD_FUNCTION(MMCmonThread, arg) {
 			tsOutputChannels.debugIntField2 = totalWritesCounter;
 			tsOutputChannels.debugIntField3 = totalSyncCounter;
 			tsOutputChannels.debugIntField4 = fileCreatedCounter;
+			tsOutputChannels.debugIntField5 = logRing.getDroppedCount();
 		}
 
-		writeLogLine(logBuffer);
+		size_t sectors = logRing.getReadableBlocks();
+		if (sectors == 0) {
+			// at a slow log rate a sector takes a while to fill, do not keep it only in RAM
+			efitick_t nowNt = getTimeNowNt();
+			if (nowNt - partialSyncNt >= MS2NT(SD_LOG_PARTIAL_SYNC_MS)) {
+				partialSyncNt = nowNt;
+				if (!writePartialSector(false)) {
+					return;
+				}
+			}
 
-		// Something went wrong (already handled), so cancel further writes
-		if (logBuffer.failed) {
-			return;
+			chThdSleepMilliseconds(SD_LOG_WRITER_IDLE_MS);
+			continue;
 		}
 
-		auto period = CONFIG(sdCardPeriodMs);
-		if (period > 0) {
-			chThdSleepMilliseconds(period);
+		sectors = minI(sectors, SD_LOG_MAX_WRITE_SECTORS);
+		if (!writeSectors(logRing.getReadPointer(), sectors * FF_MAX_SS)) {
+			// Something went wrong (already handled), so cancel further writes
+			return;
 		}
+		logRing.release(sectors);
 	}
 }
 
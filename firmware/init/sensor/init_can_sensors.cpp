@@ -11,12 +11,13 @@
 #if EFI_CAN_SUPPORT
 #include "can_sensor.h"
 #include "can.h"
+#include "can_codec_generated.h"
 
 EXTERN_CONFIG
 ;
 
-CanSensor<int16_t, PACK_MULT_PERCENT> canPedalSensor(
-	CAN_DEFAULT_BASE + CAN_PEDAL_TPS_OFFSET, /*offset =*/ 0,
+CanSensor canPedalSensor(
+	VerbosePedalAndTps::id, VerbosePedalAndTps::pedalSignal,
 	SensorType::AcceleratorPedal, CAN_TIMEOUT
 );
 
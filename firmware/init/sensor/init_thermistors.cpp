@@ -8,16 +8,22 @@
 #include "linear_func.h"
 #include "resistance_func.h"
 #include "thermistor_func.h"
+#include "table_func.h"
 
 EXTERN_ENGINE;
 
 using resist = ResistanceFunc;
 using therm = ThermistorFunc;
 
+// Lookup table may differ from the exact thermistor math by this much, deg C
+#define THERMISTOR_TABLE_MAX_ERROR 0.1f
+
 // Each one could be either linear or thermistor
 struct FuncPair {
 	LinearFunc linear;
 	FuncChain<resist, therm> thermistor;
+	// thermistor math is log() heavy, so it is served from a table built from the chain above
+	TableFunc thermistorTable;
 };
 
 static CCM_OPTIONAL FunctionalSensor clt(SensorType::Clt, MS2NT(10));
@@ -38,7 +44,7 @@ void validateThermistorConfig(thermistor_conf_s& cfg) {
 	}
 }
 
-static SensorConverter& configureTempSensorFunction(thermistor_conf_s& cfg, FuncPair& p, bool isLinear) {
+static SensorConverter& configureTempSensorFunction(thermistor_conf_s& cfg, FuncPair& p, bool isLinear, float maxInput) {
 	if (isLinear) {
 		p.linear.configure(cfg.resistance_1, cfg.tempC_1, cfg.resistance_2, cfg.tempC_2, -50, 250);
 
@@ -49,27 +55,31 @@ static SensorConverter& configureTempSensorFunction(thermistor_conf_s& cfg, Func
 		p.thermistor.get<resist>().configure(5.0f, cfg.bias_resistor);
 		p.thermistor.get<therm>().configure(cfg);
 
-		return p.thermistor;
+		p.thermistorTable.compile(p.thermistor, maxInput, THERMISTOR_TABLE_MAX_ERROR);
+
+		return p.thermistorTable;
 	}
 }
 
 void configTherm(FunctionalSensor &sensor,
 					FuncPair &p,
 					ThermistorConf &config,
-					bool isLinear) {
+					bool isLinear,
+					float maxInput) {
 	// nothing to do if no channel
 	if (!isAdcChannelValid(config.adcChannel)) {
 		return;
 	}
 
 	// Configure the conversion function for this sensor
-	sensor.setFunction(configureTempSensorFunction(config.config, p, isLinear));
+	sensor.setFunction(configureTempSensorFunction(config.config, p, isLinear, maxInput));
 }
 
 static void configureTempSensor(FunctionalSensor &sensor,
 								FuncPair &p,
 								ThermistorConf &config,
-								bool isLinear) {
+								bool isLinear,
+								float maxInput) {
 	auto channel = config.adcChannel;
 
 	// Only register if we have a sensor
@@ -77,55 +87,72 @@ static void configureTempSensor(FunctionalSensor &sensor,
 		return;
 	}
 
-	configTherm(sensor, p, config, isLinear);
+	configTherm(sensor, p, config, isLinear, maxInput);
 
 	// Register & subscribe
 	AdcSubscription::SubscribeSensor(sensor, channel, 2);
 	sensor.Register();
 }
 
+// Sensor voltage AdcSubscription reports for a full scale ADC reading
+static float getMaxInput(DECLARE_CONFIG_PARAMETER_SIGNATURE) {
+	return CONFIG(adcVcc) * CONFIG(analogInputDividerCoefficient);
+}
+
 void initThermistors(DECLARE_CONFIG_PARAMETER_SIGNATURE) {
+	float maxInput = getMaxInput(PASS_CONFIG_PARAMETER_SIGNATURE);
+
 	if (!CONFIG(consumeObdSensors)) {
 		configureTempSensor(clt,
 						fclt,
 						CONFIG(clt),
-						CONFIG(useLinearCltSensor));
+						CONFIG(useLinearCltSensor),
+						maxInput);
 
 		configureTempSensor(iat,
 						fiat,
 						CONFIG(iat),
-						CONFIG(useLinearIatSensor));
+						CONFIG(useLinearIatSensor),
+						maxInput);
 	}
 
 	configureTempSensor(aux1,
 						faux1,
 						CONFIG(auxTempSensor1),
-						false);
+						false,
+						maxInput);
 
 	configureTempSensor(aux2,
 						faux2,
 						CONFIG(auxTempSensor2),
-						false);
+						false,
+						maxInput);
 }
 
 void reconfigureThermistors(DECLARE_CONFIG_PARAMETER_SIGNATURE) {
+	float maxInput = getMaxInput(PASS_CONFIG_PARAMETER_SIGNATURE);
+
 	configTherm(clt,
 				fclt,
 				CONFIG(clt),
-				CONFIG(useLinearCltSensor));
+				CONFIG(useLinearCltSensor),
+				maxInput);
 
 	configTherm(iat,
 				fiat,
 				CONFIG(iat),
-				CONFIG(useLinearIatSensor));
+				CONFIG(useLinearIatSensor),
+				maxInput);
 
 	configTherm(aux1,
 				faux1,
 				CONFIG(auxTempSensor1),
-				false);
+				false,
+				maxInput);
 
 	configTherm(aux2,
 				faux2,
 				CONFIG(auxTempSensor2),
-				false);
+				false,
+				maxInput);
 }
@@ -0,0 +1,344 @@
+/**
+ * @file	deferred_log.cpp
+ *
+ * @date Oct 18, 2026
+ */
+
+#include "global.h"
+#include "deferred_log.h"
+
+#include <cstdio>
+#include <cstring>
+
+#if ! EFI_UNIT_TEST
+#include "chprintf.h"
+#define formatArgument chsnprintf
+#else
+#define formatArgument snprintf
+#endif
+
+static_assert((DEFERRED_LOG_SLOTS & (DEFERRED_LOG_SLOTS - 1)) == 0, "deferred log slots have to be a power of two");
+static_assert(DEFERRED_LOG_ARGS_SIZE <= UINT8_MAX, "deferred log argument size");
+
+enum class ArgKind : uint8_t {
+	Int,
+	Long,
+	LongLong,
+	Double,
+	String,
+	Pointer,
+	Unsupported,
+};
+
+/**
+ * Producer and consumer have to agree on this, it decides what was captured.
+ * @return the '%' of the next conversion at or after p, nullptr if there is none
+ * @param end set to just past the conversion character
+ */
+static const char *findConversion(const char *p, const char *&end, ArgKind &kind) {
+	while (*p != 0) {
+		if (*p != '%') {
+			p++;
+			continue;
+		}
+
+		const char *start = p++;
+		if (*p == '%') {
+			p++;
+			continue;
+		}
+
+		// flags, width and precision, '*' is not supported
+		while (*p != 0 && strchr("-+ #0123456789.", *p) != nullptr) {
+			p++;
+		}
+
+		int longCount = 0;
+		while (*p == 'l') {
+			longCount++;
+			p++;
+		}
+
+		switch (*p) {
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+		case 'c':
+			kind = longCount == 0 ? ArgKind::Int : longCount == 1 ? ArgKind::Long : ArgKind::LongLong;
+			break;
+		case 'f':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+			kind = ArgKind::Double;
+			break;
+		case 's':
+			kind = ArgKind::String;
+			break;
+		case 'p':
+			kind = ArgKind::Pointer;
+			break;
+		default:
+			kind = ArgKind::Unsupported;
+			break;
+		}
+
+		end = *p != 0 ? p + 1 : p;
+		return start;
+	}
+	return nullptr;
+}
+
+template <typename T>
+static bool capture(char *&at, const char *end, T value) {
+	if (at + sizeof(value) > end) {
+		return false;
+	}
+	memcpy(at, &value, sizeof(value));
+	at += sizeof(value);
+	return true;
+}
+
+template <typename T>
+static bool take(const char *&at, const char *end, T &value) {
+	if (at + sizeof(value) > end) {
+		return false;
+	}
+	memcpy(&value, at, sizeof(value));
+	at += sizeof(value);
+	return true;
+}
+
+DeferredLog::DeferredLog()
+	: m_enqueuePosition(0)
+	, m_droppedCount(0)
+{
+	for (uint32_t i = 0; i < DEFERRED_LOG_SLOTS; i++) {
+		m_slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+bool DeferredLog::add(const char *format, ...) {
+	va_list ap;
+	va_start(ap, format);
+	bool result = vadd(format, ap);
+	va_end(ap);
+	return result;
+}
+
+bool DeferredLog::vadd(const char *format, va_list ap) {
+	uint32_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+	Slot *slot;
+	while (true) {
+		slot = &m_slots[position % DEFERRED_LOG_SLOTS];
+		int32_t diff = static_cast<int32_t>(slot->sequence.load(std::memory_order_acquire) - position);
+
+		if (diff == 0) {
+			// ours if nobody else got there first, otherwise position now says where they got to
+			if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if (diff < 0) {
+			// the consumer has not got to this slot since the last time around
+			m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		} else {
+			position = m_enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	char *at = slot->args;
+	const char *end = slot->args + sizeof(slot->args);
+	bool isTruncated = false;
+
+	const char *p = format;
+	const char *conversionEnd;
+	ArgKind kind;
+	while (!isTruncated && (p = findConversion(p, conversionEnd, kind)) != nullptr) {
+		p = conversionEnd;
+
+		switch (kind) {
+		case ArgKind::Int:
+			isTruncated = !capture(at, end, va_arg(ap, int));
+			break;
+		case ArgKind::Long:
+			isTruncated = !capture(at, end, va_arg(ap, long));
+			break;
+		case ArgKind::LongLong:
+			isTruncated = !capture(at, end, va_arg(ap, long long));
+			break;
+		case ArgKind::Double:
+			isTruncated = !capture(at, end, va_arg(ap, double));
+			break;
+		case ArgKind::Pointer:
+			isTruncated = !capture(at, end, va_arg(ap, void*));
+			break;
+		case ArgKind::String: {
+			const char *text = va_arg(ap, const char*);
+			if (text == nullptr) {
+				text = "(null)";
+			}
+			if (at >= end) {
+				isTruncated = true;
+				break;
+			}
+			// as much as fits, then nothing after it
+			size_t length = strlen(text);
+			size_t room = end - at - 1;
+			if (length > room) {
+				length = room;
+				isTruncated = true;
+			}
+			memcpy(at, text, length);
+			at[length] = 0;
+			at += length + 1;
+			break;
+		}
+		default:
+			isTruncated = true;
+			break;
+		}
+	}
+
+	slot->format = format;
+	slot->argsSize = at - slot->args;
+	slot->isTruncated = isTruncated;
+
+	// publish, the consumer may take it from here
+	slot->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+int DeferredLog::formatNext(char *buffer, size_t size) {
+	if (m_isConsuming.test_and_set(std::memory_order_acquire)) {
+		// somebody else is taking messages right now
+		return -1;
+	}
+	int result = formatNextLocked(buffer, size);
+	m_isConsuming.clear(std::memory_order_release);
+	return result;
+}
+
+int DeferredLog::formatNextLocked(char *buffer, size_t size) {
+	Slot &slot = m_slots[m_dequeuePosition % DEFERRED_LOG_SLOTS];
+	if (slot.sequence.load(std::memory_order_acquire) != m_dequeuePosition + 1) {
+		// empty, or the next one in line is still being written
+		return -1;
+	}
+
+	size_t length = 0;
+	auto append = [&](char c) {
+		if (length + 1 < size) {
+			buffer[length++] = c;
+		}
+	};
+
+	const char *args = slot.args;
+	const char *argsEnd = slot.args + slot.argsSize;
+	bool isComplete = true;
+
+	const char *p = slot.format;
+	while (true) {
+		const char *conversionEnd;
+		ArgKind kind;
+		const char *conversion = findConversion(p, conversionEnd, kind);
+
+		// literal text up to the conversion, %% is a percent sign
+		for (const char *c = p; *c != 0 && c != conversion; c++) {
+			append(*c);
+			if (c[0] == '%' && c[1] == '%') {
+				c++;
+			}
+		}
+		if (conversion == nullptr) {
+			break;
+		}
+		p = conversionEnd;
+
+		char spec[16];
+		size_t specLength = conversionEnd - conversion;
+		if (specLength >= sizeof(spec)) {
+			isComplete = false;
+			break;
+		}
+		memcpy(spec, conversion, specLength);
+		spec[specLength] = 0;
+
+		char *out = buffer + length;
+		size_t room = size - length;
+		int written = -1;
+		switch (kind) {
+		case ArgKind::Int: {
+			int value;
+			if (take(args, argsEnd, value)) {
+				written = formatArgument(out, room, spec, value);
+			}
+			break;
+		}
+		case ArgKind::Long: {
+			long value;
+			if (take(args, argsEnd, value)) {
+				written = formatArgument(out, room, spec, value);
+			}
+			break;
+		}
+		case ArgKind::LongLong: {
+			long long value;
+			if (take(args, argsEnd, value)) {
+				written = formatArgument(out, room, spec, value);
+			}
+			break;
+		}
+		case ArgKind::Double: {
+			double value;
+			if (take(args, argsEnd, value)) {
+				written = formatArgument(out, room, spec, value);
+			}
+			break;
+		}
+		case ArgKind::Pointer: {
+			void *value;
+			if (take(args, argsEnd, value)) {
+				written = formatArgument(out, room, spec, value);
+			}
+			break;
+		}
+		case ArgKind::String:
+			if (args < argsEnd) {
+				written = formatArgument(out, room, spec, args);
+				args += strlen(args) + 1;
+			}
+			break;
+		default:
+			break;
+		}
+
+		if (written < 0) {
+			isComplete = false;
+			break;
+		}
+		// what would have been written if there was room
+		length += (size_t)written < room ? written : room - 1;
+	}
+
+	if (!isComplete || slot.isTruncated) {
+		if (slot.isTruncated) {
+			m_truncatedCount++;
+		}
+		append('.');
+		append('.');
+		append('.');
+	}
+	if (size > 0) {
+		buffer[length] = 0;
+	}
+
+	// the slot is free for the producers' next time around the ring
+	slot.sequence.store(m_dequeuePosition + DEFERRED_LOG_SLOTS, std::memory_order_release);
+	m_dequeuePosition++;
+	return length;
+}
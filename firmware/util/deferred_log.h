@@ -0,0 +1,82 @@
+/**
+ * @file	deferred_log.h
+ *
+ * Console messages without formatting on the caller's time: the format string pointer and the
+ * raw arguments go into a ring, the text is made later by a low priority thread.
+ *
+ * Any thread or interrupt can add, there are no locks. Each slot has a sequence number, a
+ * producer claims the next position with a compare-and-swap and publishes the slot by
+ * bumping its sequence once the arguments are in. The consumer takes positions in the order
+ * they were claimed and waits on a slot which is claimed but not yet published, so messages
+ * come out in the order they were started even if one producer interrupts another.
+ *
+ * Format strings have to stay around, they are string constants everywhere. String arguments
+ * are copied. If the arguments do not fit a slot the text is cut off after the last one which
+ * did, with "..." at the end.
+ *
+ * @date Oct 18, 2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef DEFERRED_LOG_SLOTS
+// has to be a power of two. Console commands like 'help' print a couple hundred lines in one go,
+// about what used to fit the text buffer, and the thread which formats them has a lower priority
+#define DEFERRED_LOG_SLOTS 256
+#endif
+
+// captured arguments per message, copies of string arguments included
+#define DEFERRED_LOG_ARGS_SIZE 40
+
+class DeferredLog {
+public:
+	DeferredLog();
+
+	/**
+	 * Producer side, any context.
+	 * @return false if the ring was full and the message was dropped
+	 */
+	bool add(const char *format, ...);
+	bool vadd(const char *format, va_list ap);
+
+	/**
+	 * Consumer side, any thread. Formats the oldest message. Only one consumer formats at a
+	 * time, a second one gets -1 and the first takes the message.
+	 * @return length of the text in buffer, -1 if there is nothing to take yet
+	 */
+	int formatNext(char *buffer, size_t size);
+
+	uint32_t getDroppedCount() const {
+		return m_droppedCount;
+	}
+
+	// messages which did not have room for all of their arguments
+	uint32_t getTruncatedCount() const {
+		return m_truncatedCount;
+	}
+
+private:
+	int formatNextLocked(char *buffer, size_t size);
+
+	struct Slot {
+		std::atomic<uint32_t> sequence;
+		const char *format;
+		uint8_t argsSize;
+		bool isTruncated;
+		char args[DEFERRED_LOG_ARGS_SIZE];
+	};
+
+	Slot m_slots[DEFERRED_LOG_SLOTS];
+	std::atomic<uint32_t> m_enqueuePosition;
+	uint32_t m_dequeuePosition = 0;
+	// held by the consumer which is formatting, m_dequeuePosition belongs to it
+	std::atomic_flag m_isConsuming = ATOMIC_FLAG_INIT;
+
+	std::atomic<uint32_t> m_droppedCount;
+	uint32_t m_truncatedCount = 0;
+};
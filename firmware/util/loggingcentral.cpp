@@ -12,6 +12,7 @@
 #include "global.h"
 #include "os_access.h"
 #include "efilib.h"
+#include "deferred_log.h"
 
 #if EFI_UNIT_TEST || EFI_SIMULATOR
 extern bool verboseMode;
@@ -56,10 +57,29 @@ public:
 	 * amount of data accumulated so far
 	 */
 	uint32_t accumulatedSize;
+
+	/**
+	 * messages which did not fit while nobody was reading
+	 */
+	uint32_t droppedCount = 0;
 };
 
 static LoggingCentral loggingCentral;
 
+#if EFI_TEXT_LOGGING && ! EFI_UNIT_TEST && ! EFI_SIMULATOR
+#include "thread_priority.h"
+#include "periodic_thread_controller.h"
+
+/**
+ * scheduleMsg arguments waiting to be formatted by DeferredLogFormatter
+ */
+static DeferredLog deferredLog;
+static LoggingWithStorage deferredLogging("deferred");
+
+static uint32_t reportedDroppedCount = 0;
+#define DEFERRED_LOG_TEXT_SIZE 160
+#endif
+
 
 /**
  * This method appends the content of specified thread-local logger into the global buffer
@@ -80,6 +100,7 @@ static void scheduleLoggingInternal(Logging *logging) {
 		 * if no one is consuming the data we have to drop it
 		 * this happens in case of serial-over-USB, todo: find a better solution?
 		 */
+		loggingCentral.droppedCount++;
 		return;
 	}
 	// memcpy is faster then strcpy because it is not looking for line terminator
@@ -93,10 +114,55 @@ void scheduleLogging(Logging* logging) {
 	logging->reset();
 }
 
+#if EFI_TEXT_LOGGING && ! EFI_UNIT_TEST && ! EFI_SIMULATOR
+static void formatDeferredMessages() {
+	char text[DEFERRED_LOG_TEXT_SIZE];
+	while (deferredLog.formatNext(text, sizeof(text)) >= 0) {
+		deferredLogging.reset();
+		appendMsgPrefix(&deferredLogging);
+		deferredLogging.append(text);
+		appendMsgPostfix(&deferredLogging);
+		scheduleLoggingInternal(&deferredLogging);
+	}
+
+	uint32_t droppedCount = deferredLog.getDroppedCount() + loggingCentral.droppedCount;
+	if (droppedCount != reportedDroppedCount) {
+		deferredLogging.reset();
+		appendMsgPrefix(&deferredLogging);
+		deferredLogging.appendPrintf("%d console messages dropped so far, %d truncated",
+				droppedCount, deferredLog.getTruncatedCount());
+		appendMsgPostfix(&deferredLogging);
+		scheduleLoggingInternal(&deferredLogging);
+		reportedDroppedCount = droppedCount;
+	}
+}
+
+/**
+ * Formats off the TunerStudio and console threads. Below both of them, a burst of messages waits
+ * in the ring until the command which printed it is done.
+ */
+class DeferredLogFormatter final : public PeriodicController<UTILITY_THREAD_STACK_SIZE * 2> {
+public:
+	DeferredLogFormatter() : PeriodicController("DeferredLog", PRIO_DEFERRED_LOG, 100) { }
+private:
+	void PeriodicTask(efitick_t nowNt) override {
+		UNUSED(nowNt);
+		formatDeferredMessages();
+	}
+};
+
+static DeferredLogFormatter deferredLogFormatter;
+#endif
+
+void startDeferredLogging() {
+#if EFI_TEXT_LOGGING && ! EFI_UNIT_TEST && ! EFI_SIMULATOR
+	deferredLogFormatter.Start();
+#endif
+}
+
 /**
  * Actual communication layer invokes this method when it's ready to send some data out
  *
- * this method should always be invoked from the same thread!
  * @return pointer to the buffer which should be print to console
  */
 char * swapOutputBuffers(int *actualOutputBufferSize) {
@@ -136,10 +202,9 @@ char * swapOutputBuffers(int *actualOutputBufferSize) {
 /**
  * rusEfi business logic invokes this method in order to eventually print stuff to rusEfi console
  *
- * this whole method is executed under syslock so that we can have multiple threads use the same shared buffer
- * in order to reduce memory usage
- *
- * this is really 'global lock + printf + scheduleLogging + unlock' a bit more clear
+ * Only the format pointer and the arguments are recorded here, without locks, the text is made
+ * by DeferredLogFormatter. That means the format has to be a string constant, string arguments are
+ * copied. 'logging' is not used anymore.
  */
 void scheduleMsg(Logging *logging, const char *format, ...) {
 #if EFI_UNIT_TEST || EFI_SIMULATOR
@@ -161,17 +226,10 @@ void scheduleMsg(Logging *logging, const char *format, ...) {
 		return;
 	}
 
-	chibios_rt::CriticalSectionLocker csl;
-	logging->reset(); // todo: is 'reset' really needed here?
-	appendMsgPrefix(logging);
-
 	va_list ap;
 	va_start(ap, format);
-	logging->vappendPrintf(format, ap);
+	deferredLog.vadd(format, ap);
 	va_end(ap);
-
-	appendMsgPostfix(logging);
-	scheduleLogging(logging);
 #endif /* EFI_TEXT_LOGGING */
 #endif /* EFI_UNIT_TEST */
 }
@@ -8,5 +8,6 @@
 
 class Logging;
 
+void startDeferredLogging();
 char * swapOutputBuffers(int *actualOutputBufferSize);
 void scheduleMsg(Logging *logging, const char *fmt, ...);
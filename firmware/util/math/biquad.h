@@ -7,6 +7,11 @@
 
 #pragma once
 
+#include <cstddef>
+
+template <size_t TSize>
+class BiquadBank;
+
 class Biquad {
 public:
 	Biquad();
@@ -22,6 +27,10 @@ public:
 	void configureLowpass(float samplingFrequency, float cutoffFrequency, float Q = 0.54f);
 
 private:
+	// the bank borrows our coefficient math
+	template <size_t TSize>
+	friend class BiquadBank;
+
 	float a0, a1, a2, b1, b2;
 	float z1, z2;
 };
@@ -0,0 +1,59 @@
+/**
+ * @file biquad_bank.h
+ *
+ * Many independent biquad filters stored as structure-of-arrays, so that filtering
+ * every channel is one tight loop over contiguous coefficient and state arrays
+ * instead of a call per Biquad object.
+ */
+
+#pragma once
+
+#include "biquad.h"
+
+template <size_t TSize>
+class BiquadBank {
+public:
+	BiquadBank() {
+		for (size_t i = 0; i < TSize; i++) {
+			// Default to passthru
+			a0[i] = 1;
+			a1[i] = a2[i] = b1[i] = b2[i] = 0;
+			z1[i] = z2[i] = 0;
+		}
+	}
+
+	void configureLowpass(size_t index, float samplingFrequency, float cutoffFrequency, float Q = 0.54f) {
+		Biquad f;
+		f.configureLowpass(samplingFrequency, cutoffFrequency, Q);
+
+		a0[index] = f.a0;
+		a1[index] = f.a1;
+		a2[index] = f.a2;
+		b1[index] = f.b1;
+		b2[index] = f.b2;
+		z1[index] = z2[index] = 0;
+	}
+
+	// Preload filter state as if this input has been seen for a long time
+	void cookSteadyState(size_t index, float steadyStateInput) {
+		float y = steadyStateInput * (a0[index] + a1[index] + a2[index]) / (1 + b1[index] + b2[index]);
+
+		z2[index] = steadyStateInput * a2[index] - y * b2[index];
+		z1[index] = z2[index] + steadyStateInput * a1[index] - y * b1[index];
+	}
+
+	// Filter values[i] through filter i in place, for the first count filters
+	void filter(float* values, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			float input = values[i];
+			float result = input * a0[i] + z1[i];
+			z1[i] = input * a1[i] + z2[i] - b1[i] * result;
+			z2[i] = input * a2[i] - b2[i] * result;
+			values[i] = result;
+		}
+	}
+
+private:
+	float a0[TSize], a1[TSize], a2[TSize], b1[TSize], b2[TSize];
+	float z1[TSize], z2[TSize];
+};
@@ -19,6 +19,14 @@ crc_t calc_crc(const crc_t message[], int nBytes);
 uint32_t crc32(const void *buf, uint32_t size);
 uint32_t crc32inc(const void *buf, uint32_t crc, uint32_t size);
 
+#ifdef EFI_CRC32_HARDWARE
+/**
+ * Provided by the port when the MCU CRC unit can do reflected CRC-32 (0xEDB88320) starting from
+ * any value, crc32inc() then goes straight to it. Same arguments and result as crc32inc().
+ */
+uint32_t crc32incHardware(const void *buf, uint32_t crc, uint32_t size);
+#endif /* EFI_CRC32_HARDWARE */
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
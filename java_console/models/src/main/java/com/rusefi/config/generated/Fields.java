@@ -354,6 +354,7 @@ public class Fields {
 	public static final int enableCanVss_offset = 976;
 	public static final int enabledStep1Limiter_offset = 744;
 	public static final int enableInnovateLC2_offset = 976;
+	public static final int enableKnockControl_offset = 976;
 	public static final int enableLaunchBoost_offset = 976;
 	public static final int enableLaunchRetard_offset = 976;
 	public static final int enableMapEstimationTableFallback_offset = 76;
@@ -972,6 +973,8 @@ public class Fields {
 	public static final int knockDetectionWindowStart_offset = 1500;
 	public static final int knockNoise_offset = 1820;
 	public static final int knockNoiseRpmBins_offset = 1852;
+	public static final int knockRetardRecoveryRate_offset = 2432;
+	public static final int knockRetardStep_offset = 2428;
 	public static final int knockVThreshold_offset = 1512;
 	public static final int lambdaLoadBins_offset = 18848;
 	public static final int lambdaRpmBins_offset = 18912;
@@ -1037,6 +1040,7 @@ public class Fields {
 	public static final int MAP_ACCEL_TAPER = 8;
 	public static final int MAP_ANGLE_SIZE = 8;
 	public static final int map_offset = 108;
+	public static final int mapPredictionGain_offset = 2424;
 	public static final int map_samplingAngle_offset = 140;
 	public static final int map_samplingAngleBins_offset = 108;
 	public static final int map_samplingWindow_offset = 204;
@@ -1171,6 +1175,7 @@ public class Fields {
 	public static final String PROTOCOL_WA_CHANNEL_2 = "input2";
 	public static final String PROTOCOL_WA_CHANNEL_3 = "input3";
 	public static final String PROTOCOL_WA_CHANNEL_4 = "input4";
+	public static final int rollingCutRpmWindow_offset = 1708;
 	public static final int rollingLaunchEnabled_offset = 76;
 	public static final int RPM_1_BYTE_PACKING_MULT = 50;
 	public static final int rpmHardLimit_offset = 416;
@@ -1179,6 +1184,12 @@ public class Fields {
 	public static final int sdCardCsPinMode_offset = 2226;
 	public static final int sdCardPeriodMs_offset = 804;
 	public static final int sdCardSpiDevice_offset = 2592;
+	public static final int sdLogEngineDivider_offset = 2508;
+	public static final int sdLogFuelDivider_offset = 2509;
+	public static final int sdLogIgnitionDivider_offset = 2510;
+	public static final int sdLogSensorsDivider_offset = 2512;
+	public static final int sdLogStatusDivider_offset = 2513;
+	public static final int sdLogThrottleDivider_offset = 2511;
 	public static final int secondSolenoidPin_offset = 810;
 	public static final int sensorChartFrequency_offset = 520;
 	public static final int sensorChartMode_offset = 944;
@@ -1454,6 +1465,8 @@ public class Fields {
 	public static final char TS_IO_TEST_COMMAND = 'Z';
 	public static final char TS_ONLINE_PROTOCOL = 'z';
 	public static final char TS_OUTPUT_COMMAND = 'O';
+	public static final char TS_OUTPUT_DELTA_COMMAND = 'd';
+	public static final char TS_OUTPUT_STREAM_COMMAND = 'u';
 	public static final int TS_OUTPUT_SIZE = 340;
 	public static final char TS_PAGE_COMMAND = 'P';
 	public static final char TS_PERF_TRACE_BEGIN = '_';
@@ -1465,6 +1478,7 @@ public class Fields {
 	public static final int TS_RESPONSE_CRC_FAILURE = 0x82;
 	public static final int TS_RESPONSE_FRAMING_ERROR = 0x8D;
 	public static final int TS_RESPONSE_OK = 0;
+	public static final int TS_RESPONSE_OUTPUT_STREAM = 8;
 	public static final int TS_RESPONSE_OUT_OF_RANGE = 0x84;
 	public static final int TS_RESPONSE_UNDERRUN = 0x80;
 	public static final int TS_RESPONSE_UNRECOGNIZED_COMMAND = 0x83;
@@ -1539,13 +1553,9 @@ public class Fields {
 	public static final int unused1476b3_offset = 1476;
 	public static final int unused1476b8_offset = 1476;
 	public static final int unused15136_offset = 16032;
-	public static final int unused1708_offset = 1708;
+	public static final int unused1710_offset = 1710;
 	public static final int unused2260_offset = 2260;
 	public static final int unused2419_offset = 2419;
-	public static final int unused2432_offset = 2432;
-	public static final int unused244_2_offset = 2424;
-	public static final int unused244_3_offset = 2428;
-	public static final int unused2508_offset = 2508;
 	public static final int unused2536_offset = 2536;
 	public static final int unused3328_offset = 3340;
 	public static final int unused3942_offset = 3992;
@@ -1574,7 +1584,6 @@ public class Fields {
 	public static final int unusedAuxVoltage1_TODO_332_offset = 2713;
 	public static final int unusedAuxVoltage2_TODO_332_offset = 2714;
 	public static final int unusedBit4_1476_offset = 1476;
-	public static final int unusedBit_251_29_offset = 976;
 	public static final int unusedBit_289_30_offset = 976;
 	public static final int unusedBit_289_31_offset = 976;
 	public static final int unusedBit_34_31_offset = 76;
@@ -2164,7 +2173,7 @@ public class Fields {
 	public static final Field KNOCKBANKCYL11 = Field.create("KNOCKBANKCYL11", 976, FieldType.BIT, 26);
 	public static final Field KNOCKBANKCYL12 = Field.create("KNOCKBANKCYL12", 976, FieldType.BIT, 27);
 	public static final Field TCUENABLED = Field.create("TCUENABLED", 976, FieldType.BIT, 28);
-	public static final Field UNUSEDBIT_251_29 = Field.create("UNUSEDBIT_251_29", 976, FieldType.BIT, 29);
+	public static final Field ENABLEKNOCKCONTROL = Field.create("ENABLEKNOCKCONTROL", 976, FieldType.BIT, 29);
 	public static final Field UNUSEDBIT_289_30 = Field.create("UNUSEDBIT_289_30", 976, FieldType.BIT, 30);
 	public static final Field UNUSEDBIT_289_31 = Field.create("UNUSEDBIT_289_31", 976, FieldType.BIT, 31);
 	public static final Field ETBIO1_DIRECTIONPIN1 = Field.create("ETBIO1_DIRECTIONPIN1", 980, FieldType.INT8, brain_pin_e);
@@ -2351,7 +2360,7 @@ public class Fields {
 	public static final Field MAPAVERAGINGSCHEDULINGATINDEX = Field.create("MAPAVERAGINGSCHEDULINGATINDEX", 1540, FieldType.INT);
 	public static final Field BAROCORRTABLE = Field.create("BAROCORRTABLE", 1576, FieldType.INT);
 	public static final Field TACHPULSEDURACTIONMS = Field.create("TACHPULSEDURACTIONMS", 1704, FieldType.FLOAT);
-	public static final Field UNUSED1708 = Field.create("UNUSED1708", 1708, FieldType.INT);
+	public static final Field ROLLINGCUTRPMWINDOW = Field.create("ROLLINGCUTRPMWINDOW", 1708, FieldType.INT16);
 	public static final Field WWAETAU = Field.create("WWAETAU", 1712, FieldType.FLOAT);
 	public static final Field ALTERNATORCONTROL_PFACTOR = Field.create("ALTERNATORCONTROL_PFACTOR", 1716, FieldType.FLOAT);
 	public static final Field ALTERNATORCONTROL_IFACTOR = Field.create("ALTERNATORCONTROL_IFACTOR", 1720, FieldType.FLOAT);
@@ -2510,9 +2519,9 @@ public class Fields {
 	public static final Field INJECTORCOMPENSATIONMODE = Field.create("INJECTORCOMPENSATIONMODE", 2418, FieldType.INT8);
 	public static final Field UNUSED2419 = Field.create("UNUSED2419", 2419, FieldType.INT8);
 	public static final Field FUELREFERENCEPRESSURE = Field.create("FUELREFERENCEPRESSURE", 2420, FieldType.FLOAT);
-	public static final Field UNUSED244_2 = Field.create("UNUSED244_2", 2424, FieldType.FLOAT);
-	public static final Field UNUSED244_3 = Field.create("UNUSED244_3", 2428, FieldType.FLOAT);
-	public static final Field UNUSED2432 = Field.create("UNUSED2432", 2432, FieldType.FLOAT);
+	public static final Field MAPPREDICTIONGAIN = Field.create("MAPPREDICTIONGAIN", 2424, FieldType.FLOAT);
+	public static final Field KNOCKRETARDSTEP = Field.create("KNOCKRETARDSTEP", 2428, FieldType.FLOAT);
+	public static final Field KNOCKRETARDRECOVERYRATE = Field.create("KNOCKRETARDRECOVERYRATE", 2432, FieldType.FLOAT);
 	public static final Field POSTCRANKINGFACTOR = Field.create("POSTCRANKINGFACTOR", 2436, FieldType.FLOAT);
 	public static final Field POSTCRANKINGDURATIONSEC = Field.create("POSTCRANKINGDURATIONSEC", 2440, FieldType.FLOAT);
 	public static final Field AUXTEMPSENSOR1_TEMPC_1 = Field.create("AUXTEMPSENSOR1_TEMPC_1", 2444, FieldType.FLOAT);
@@ -2531,6 +2540,12 @@ public class Fields {
 	public static final Field AUXTEMPSENSOR2_RESISTANCE_3 = Field.create("AUXTEMPSENSOR2_RESISTANCE_3", 2496, FieldType.FLOAT);
 	public static final Field AUXTEMPSENSOR2_BIAS_RESISTOR = Field.create("AUXTEMPSENSOR2_BIAS_RESISTOR", 2500, FieldType.FLOAT);
 	public static final Field AUXTEMPSENSOR2_ADCCHANNEL = Field.create("AUXTEMPSENSOR2_ADCCHANNEL", 2504, FieldType.INT8, adc_channel_e);
+	public static final Field SDLOGENGINEDIVIDER = Field.create("SDLOGENGINEDIVIDER", 2508, FieldType.INT8);
+	public static final Field SDLOGFUELDIVIDER = Field.create("SDLOGFUELDIVIDER", 2509, FieldType.INT8);
+	public static final Field SDLOGIGNITIONDIVIDER = Field.create("SDLOGIGNITIONDIVIDER", 2510, FieldType.INT8);
+	public static final Field SDLOGTHROTTLEDIVIDER = Field.create("SDLOGTHROTTLEDIVIDER", 2511, FieldType.INT8);
+	public static final Field SDLOGSENSORSDIVIDER = Field.create("SDLOGSENSORSDIVIDER", 2512, FieldType.INT8);
+	public static final Field SDLOGSTATUSDIVIDER = Field.create("SDLOGSTATUSDIVIDER", 2513, FieldType.INT8);
 	public static final Field ETBFREQ = Field.create("ETBFREQ", 2514, FieldType.INT16);
 	public static final Field ETBWASTEGATEPID_PFACTOR = Field.create("ETBWASTEGATEPID_PFACTOR", 2516, FieldType.FLOAT);
 	public static final Field ETBWASTEGATEPID_IFACTOR = Field.create("ETBWASTEGATEPID_IFACTOR", 2520, FieldType.FLOAT);
@@ -3239,7 +3254,7 @@ public class Fields {
 	KNOCKBANKCYL11,
 	KNOCKBANKCYL12,
 	TCUENABLED,
-	UNUSEDBIT_251_29,
+	ENABLEKNOCKCONTROL,
 	UNUSEDBIT_289_30,
 	UNUSEDBIT_289_31,
 	ETBIO1_DIRECTIONPIN1,
@@ -3424,7 +3439,7 @@ public class Fields {
 	MAPAVERAGINGSCHEDULINGATINDEX,
 	BAROCORRTABLE,
 	TACHPULSEDURACTIONMS,
-	UNUSED1708,
+	ROLLINGCUTRPMWINDOW,
 	WWAETAU,
 	ALTERNATORCONTROL_PFACTOR,
 	ALTERNATORCONTROL_IFACTOR,
@@ -3578,9 +3593,9 @@ public class Fields {
 	INJECTORCOMPENSATIONMODE,
 	UNUSED2419,
 	FUELREFERENCEPRESSURE,
-	UNUSED244_2,
-	UNUSED244_3,
-	UNUSED2432,
+	MAPPREDICTIONGAIN,
+	KNOCKRETARDSTEP,
+	KNOCKRETARDRECOVERYRATE,
 	POSTCRANKINGFACTOR,
 	POSTCRANKINGDURATIONSEC,
 	AUXTEMPSENSOR1_TEMPC_1,
@@ -3599,6 +3614,12 @@ public class Fields {
 	AUXTEMPSENSOR2_RESISTANCE_3,
 	AUXTEMPSENSOR2_BIAS_RESISTOR,
 	AUXTEMPSENSOR2_ADCCHANNEL,
+	SDLOGENGINEDIVIDER,
+	SDLOGFUELDIVIDER,
+	SDLOGIGNITIONDIVIDER,
+	SDLOGTHROTTLEDIVIDER,
+	SDLOGSENSORSDIVIDER,
+	SDLOGSTATUSDIVIDER,
 	ETBFREQ,
 	ETBWASTEGATEPID_PFACTOR,
 	ETBWASTEGATEPID_IFACTOR,
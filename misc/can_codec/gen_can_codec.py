@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+
+# Reads the message (BO_) and signal (SG_) definitions of one or more DBC files and writes a C++
+# header with one struct per message: frame ID, DLC, a CanSignal descriptor per signal and
+# constexpr pack/unpack. Everything else in the DBC is ignored.
+#
+# usage: gen_can_codec.py output.h input.dbc [input.dbc ...]
+# see firmware/gen_can_codec.sh
+
+import re
+import sys
+
+MESSAGE = re.compile(r'^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)\s+(\w+)')
+SIGNAL = re.compile(r'^SG_\s+(\w+)\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*\(([^,]+),([^)]+)\)\s*\[([^|]+)\|([^\]]+)\]\s*"([^"]*)"')
+
+EXTENDED_FLAG = 0x80000000
+
+
+class Signal:
+    def __init__(self, match, location):
+        self.name = match.group(1)
+        self.start = int(match.group(2))
+        self.length = int(match.group(3))
+        self.motorola = match.group(4) == '0'
+        self.signed = match.group(5) == '-'
+        self.factor = float(match.group(6))
+        self.offset = float(match.group(7))
+        self.min = match.group(8).strip()
+        self.max = match.group(9).strip()
+        self.unit = match.group(10)
+
+        if not 1 <= self.length <= 32:
+            raise ValueError(f'{location}: {self.name} is {self.length} bits, 1 to 32 supported')
+        if self.factor == 0:
+            raise ValueError(f'{location}: {self.name} has zero factor')
+
+        if self.motorola:
+            # walk from the most significant bit to the least significant one
+            position = self.start
+            for _ in range(self.length - 1):
+                position = position + 15 if position % 8 == 0 else position - 1
+            last = position
+        else:
+            last = self.start + self.length - 1
+        if last > 63 or self.start > 63:
+            raise ValueError(f'{location}: {self.name} does not fit 8 bytes')
+
+
+class Message:
+    def __init__(self, match, source):
+        raw_id = int(match.group(1))
+        self.extended = bool(raw_id & EXTENDED_FLAG)
+        self.id = raw_id & ~EXTENDED_FLAG
+        self.name = match.group(2)
+        self.dlc = int(match.group(3))
+        self.sender = match.group(4)
+        self.source = source
+        self.signals = []
+
+
+def read_dbc(file_name):
+    messages = []
+    current = None
+
+    with open(file_name) as f:
+        for line_number, line in enumerate(f, 1):
+            line = line.strip()
+            location = f'{file_name}:{line_number}'
+
+            m = MESSAGE.match(line)
+            if m:
+                current = Message(m, file_name)
+                messages.append(current)
+                continue
+
+            if line.startswith('SG_'):
+                m = SIGNAL.match(line)
+                if not m:
+                    raise ValueError(f'{location}: unsupported signal definition: {line}')
+                if current is None:
+                    raise ValueError(f'{location}: signal outside of a message')
+                current.signals.append(Signal(m, location))
+                continue
+
+            if not line:
+                current = None
+
+    return messages
+
+
+def float_literal(value):
+    text = repr(value)
+    if 'e' not in text and '.' not in text:
+        text += '.0'
+    return text + 'f'
+
+
+def write_message(out, message):
+    out.append('/**')
+    out.append(f' * 0x{message.id:X} {message.name}, sent by {message.sender}')
+    out.append(' */')
+    out.append(f'struct {message.name} {{')
+    out.append(f'\tstatic constexpr uint32_t id = 0x{message.id:X};')
+    out.append(f'\tstatic constexpr uint8_t dlc = {message.dlc};')
+    out.append(f'\tstatic constexpr bool isExtended = {"true" if message.extended else "false"};')
+    out.append('')
+
+    for s in message.signals:
+        order = 'Motorola' if s.motorola else 'Intel'
+        out.append(f'\tstatic constexpr CanSignal {s.name}Signal = {{ {s.start}, {s.length}, CanByteOrder::{order}, '
+                   f'{"true" if s.signed else "false"}, {float_literal(s.factor)}, {float_literal(s.offset)} }};')
+    out.append('')
+
+    for s in message.signals:
+        unit = f'{s.unit}, ' if s.unit else ''
+        out.append(f'\t// {unit}{s.min} to {s.max}')
+        out.append(f'\tfloat {s.name} = 0;')
+    out.append('')
+
+    out.append('\tconstexpr void pack(uint8_t *data) const {')
+    for s in message.signals:
+        out.append(f'\t\t{s.name}Signal.encode(data, {s.name});')
+    out.append('\t}')
+    out.append('')
+
+    out.append(f'\tstatic constexpr {message.name} unpack(const uint8_t *data) {{')
+    out.append(f'\t\t{message.name} m;')
+    for s in message.signals:
+        out.append(f'\t\tm.{s.name} = {s.name}Signal.decode(data);')
+    out.append('\t\treturn m;')
+    out.append('\t}')
+    out.append('};')
+    out.append('')
+
+
+def main():
+    if len(sys.argv) < 3:
+        print('usage: gen_can_codec.py output.h input.dbc [input.dbc ...]')
+        sys.exit(1)
+
+    output = sys.argv[1]
+    inputs = sys.argv[2:]
+
+    out = []
+    out.append('//')
+    out.append(f'// was generated automatically by gen_can_codec.py based on gen_can_codec.sh {" ".join(inputs)}')
+    out.append('// do not edit, change the DBC files and generate again')
+    out.append('//')
+    out.append('')
+    out.append('#pragma once')
+    out.append('')
+    out.append('#include "can_codec.h"')
+    out.append('')
+
+    names = set()
+    for file_name in inputs:
+        out.append(f'// {file_name}')
+        out.append('')
+        for message in read_dbc(file_name):
+            if message.name in names:
+                raise ValueError(f'{file_name}: duplicate message {message.name}')
+            names.add(message.name)
+            write_message(out, message)
+
+    with open(output, 'w', newline='\n') as f:
+        f.write('\n'.join(out))
+
+
+if __name__ == '__main__':
+    main()
@@ -7,6 +7,10 @@
 
 #include "boards.h"
 #include "engine.h"
+#include "tunerstudio_outputs.h"
+
+// what the SD log reads from, tunerstudio.cpp has it only with EFI_TUNER_STUDIO
+TunerStudioOutputChannels tsOutputChannels;
 
 // see setMockVoltage
 float getVoltageDivided(const char *msg, adc_channel_e hwChannel DECLARE_ENGINE_PARAMETER_SUFFIX) {
@@ -7,6 +7,8 @@
 
 #include "engine_test_helper.h"
 #include "advance_map.h"
+#include "spark_logic.h"
+#include "global_execution_queue.h"
 
 TEST(Multispark, DefaultConfiguration) {
 	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
@@ -72,3 +74,98 @@ TEST(Multispark, RpmLimit) {
 	EXPECT_EQ(3, getMultiSparkCount(795 PASS_ENGINE_PARAMETER_SUFFIX));
 	EXPECT_EQ(0, getMultiSparkCount(805 PASS_ENGINE_PARAMETER_SUFFIX));
 }
+
+class CountingExecutor : public ExecutorInterface {
+public:
+	void scheduleByTimestamp(scheduling_s *scheduling, efitimeus_t timeUs, action_s action) override {
+		insertCount++;
+		queue.scheduleByTimestamp(scheduling, timeUs, action);
+	}
+
+	void scheduleByTimestampNt(scheduling_s *scheduling, efitime_t timeNt, action_s action) override {
+		insertCount++;
+		queue.scheduleByTimestampNt(scheduling, timeNt, action);
+	}
+
+	void scheduleForLater(scheduling_s *scheduling, int delayUs, action_s action) override {
+		insertCount++;
+		queue.scheduleForLater(scheduling, delayUs, action);
+	}
+
+	TestExecutor queue;
+	int insertCount = 0;
+};
+
+extern int timeNowUs;
+
+TEST(Multispark, BurstTiming) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	CountingExecutor counter;
+	engine->executor.setMockExecutor(&counter);
+
+	ENGINE(engineState.dwellAngle) = 20;
+	ENGINE(engineState.sparkDwell) = 3;
+	// 1ms spark + 2ms dwell
+	ENGINE(engineState.multispark.delay) = US2NT(1000);
+	ENGINE(engineState.multispark.dwell) = US2NT(2000);
+
+	IgnitionEvent event;
+	INJECT_ENGINE_REFERENCE(&event);
+	event.outputs[0] = &enginePins.coils[0];
+
+	prepareMultisparkBurst(&event, 3 PASS_ENGINE_PARAMETER_SUFFIX);
+	ASSERT_EQ(6, event.multispark.edgeCount);
+
+	int mainSparkUs = 10000;
+	timeNowUs = mainSparkUs;
+	fireSparkAndPrepareNextSchedule(&event);
+
+	// the burst occupies exactly one queue slot at a time
+	ASSERT_EQ(1, counter.queue.size());
+	EXPECT_EQ(mainSparkUs + 1000, counter.queue.getHead()->momentX);
+
+	int expectedEdgeUs[] = { 1000, 3000, 4000, 6000, 7000, 9000 };
+	for (size_t i = 0; i < efi::size(expectedEdgeUs); i++) {
+		scheduling_s *head = counter.queue.getHead();
+		ASSERT_NE(nullptr, head) << "edge " << i;
+		// edges are placed relative to the main spark, no matter how late the previous edge ran
+		EXPECT_EQ(mainSparkUs + expectedEdgeUs[i], head->momentX) << "edge " << i;
+
+		// pretend each edge interrupt runs 50us late
+		timeNowUs = head->momentX + 50;
+		counter.queue.executeAll(timeNowUs);
+
+		// even edges start dwell, odd edges fire
+		EXPECT_EQ(i % 2 == 0, (bool)enginePins.coils[0].currentLogicValue) << "edge " << i;
+	}
+
+	// burst is complete
+	EXPECT_EQ(0, counter.queue.size());
+	// one insert per edge, nothing else
+	EXPECT_EQ(6, counter.insertCount);
+
+	engine->executor.setMockExecutor(nullptr);
+}
+
+TEST(Multispark, NoBurstWhenSparkLimited) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	CountingExecutor counter;
+	engine->executor.setMockExecutor(&counter);
+
+	ENGINE(engineState.dwellAngle) = 20;
+	ENGINE(engineState.sparkDwell) = 3;
+
+	IgnitionEvent event;
+	INJECT_ENGINE_REFERENCE(&event);
+	event.outputs[0] = &enginePins.coils[0];
+
+	prepareMultisparkBurst(&event, 0 PASS_ENGINE_PARAMETER_SUFFIX);
+	fireSparkAndPrepareNextSchedule(&event);
+
+	EXPECT_EQ(0, counter.insertCount);
+	EXPECT_EQ(0, counter.queue.size());
+
+	engine->executor.setMockExecutor(nullptr);
+}
@@ -0,0 +1,141 @@
+#include "adc_subscription.h"
+#include "biquad_bank.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+
+struct IdentityFunc final : public SensorConverter {
+	SensorResult convert(float input) const override {
+		return input;
+	}
+};
+
+TEST(BiquadBank, matchesScalarBiquad) {
+	BiquadBank<4> bank;
+	Biquad scalar[4];
+
+	for (size_t i = 0; i < 4; i++) {
+		float cutoff = 5 + 10 * i;
+		bank.configureLowpass(i, 500, cutoff);
+		scalar[i].configureLowpass(500, cutoff);
+	}
+
+	bank.cookSteadyState(2, 3);
+	scalar[2].cookSteadyState(3);
+
+	for (int step = 0; step < 200; step++) {
+		float values[4];
+		float expected[4];
+
+		for (size_t i = 0; i < 4; i++) {
+			// a different square wave on each channel
+			values[i] = ((step / (5 + i)) % 2) ? 4.5f : 0.5f;
+			expected[i] = scalar[i].filter(values[i]);
+		}
+
+		bank.filter(values, 4);
+
+		for (size_t i = 0; i < 4; i++) {
+			EXPECT_NEAR(expected[i], values[i], 1e-5f);
+		}
+	}
+}
+
+TEST(BiquadBank, unconfiguredIsPassthru) {
+	BiquadBank<2> bank;
+
+	float values[] = { 1.5f, -3 };
+	bank.filter(values, 2);
+
+	EXPECT_FLOAT_EQ(1.5f, values[0]);
+	EXPECT_FLOAT_EQ(-3, values[1]);
+}
+
+TEST(AdcSubscriptionTable, publishesFilteredVolts) {
+	Sensor::resetRegistry();
+
+	IdentityFunc func;
+	FunctionalSensor clt(SensorType::Clt, MS2NT(50));
+	FunctionalSensor iat(SensorType::Iat, MS2NT(50));
+	clt.setFunction(func);
+	iat.setFunction(func);
+	ASSERT_TRUE(clt.Register());
+	ASSERT_TRUE(iat.Register());
+
+	AdcSubscriptionTable<2> table;
+	EXPECT_TRUE(table.subscribe(clt, EFI_ADC_0, 500, 10, 2));
+	EXPECT_TRUE(table.subscribe(iat, EFI_ADC_1, 500, 10, 1));
+	// Full
+	EXPECT_FALSE(table.subscribe(iat, EFI_ADC_2, 500, 10, 1));
+	EXPECT_EQ(2u, table.getCount());
+
+	auto getRaw = [](adc_channel_e channel) {
+		return channel == EFI_ADC_0 ? 1000 : 3000;
+	};
+
+	// First update is preloaded to steady state, no ramp from zero
+	table.update(getRaw, 0.001f, getTimeNowNt());
+	EXPECT_NEAR(2, clt.getRaw(), 1e-4f);
+	EXPECT_NEAR(3, iat.getRaw(), 1e-4f);
+	EXPECT_NEAR(2, Sensor::get(SensorType::Clt).Value, 1e-4f);
+
+	// A step is filtered, not passed straight through
+	auto getStepped = [](adc_channel_e channel) {
+		return channel == EFI_ADC_0 ? 2000 : 3000;
+	};
+	table.update(getStepped, 0.001f, getTimeNowNt());
+	EXPECT_GT(clt.getRaw(), 2);
+	EXPECT_LT(clt.getRaw(), 4);
+	EXPECT_NEAR(3, iat.getRaw(), 1e-4f);
+
+	for (int i = 0; i < 500; i++) {
+		table.update(getStepped, 0.001f, getTimeNowNt());
+	}
+	EXPECT_NEAR(4, clt.getRaw(), 1e-3f);
+
+	Sensor::resetRegistry();
+}
+
+template <size_t TSize>
+static void benchmarkBank() {
+	constexpr int updates = 20000;
+
+	BiquadBank<TSize> bank;
+	Biquad scalar[TSize];
+	float values[TSize];
+
+	for (size_t i = 0; i < TSize; i++) {
+		bank.configureLowpass(i, 500, 20);
+		scalar[i].configureLowpass(500, 20);
+	}
+
+	float sink = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int u = 0; u < updates; u++) {
+		for (size_t i = 0; i < TSize; i++) {
+			values[i] = u & i;
+		}
+		bank.filter(values, TSize);
+		sink += values[u % TSize];
+	}
+	auto bankNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	for (int u = 0; u < updates; u++) {
+		for (size_t i = 0; i < TSize; i++) {
+			values[i] = scalar[i].filter(u & i);
+		}
+		sink += values[u % TSize];
+	}
+	auto scalarNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	printf("Biquad %d channels: bank %.1f ns/update, scalar %.1f ns/update (%f)\n",
+		(int)TSize, (float)bankNs / updates, (float)scalarNs / updates, sink);
+}
+
+TEST(BiquadBank, benchmark) {
+	benchmarkBank<8>();
+	benchmarkBank<16>();
+	benchmarkBank<32>();
+}
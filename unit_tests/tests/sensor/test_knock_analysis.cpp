@@ -0,0 +1,303 @@
+#include "knock_analysis.h"
+#include "pid_auto_tune.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// 84MHz PCLK2, 84 + 12 cycles per sample, prescaler 4 - see knock_config.h
+#define TEST_SAMPLE_RATE (84000000 / (4 * (84 + 12)))
+#define TEST_VOLTS_PER_COUNT (3.3f / 4095)
+
+TEST(SoftwareKnock, resonanceFrequencies) {
+	float f[KNOCK_BAND_COUNT];
+
+	// 87.5mm bore, same first mode as HIP9011 BAND()
+	ASSERT_EQ(KNOCK_BAND_COUNT, getKnockResonanceFrequencies(87.5, 0, f));
+	EXPECT_NEAR(6548, f[0], 5);
+	EXPECT_NEAR(6548 * 3.054 / 1.841, f[1], 10);
+	EXPECT_NEAR(6548 * 3.832 / 1.841, f[2], 10);
+
+	// override moves every mode
+	ASSERT_EQ(KNOCK_BAND_COUNT, getKnockResonanceFrequencies(87.5, 7, f));
+	EXPECT_FLOAT_EQ(7000, f[0]);
+	EXPECT_NEAR(7000 * 3.054 / 1.841, f[1], 1);
+
+	// nothing to go on
+	EXPECT_EQ(0u, getKnockResonanceFrequencies(0, 0, f));
+}
+
+TEST(SoftwareKnock, goertzelMeasuresSinePower) {
+	float frequencies[] = { 5000, 9000 };
+	GoertzelBank bank;
+	bank.configure(TEST_SAMPLE_RATE, frequencies, 2);
+	ASSERT_EQ(2u, bank.getBandCount());
+
+	// 0.5V amplitude at 5kHz on top of the 1.65V bias, exactly 20 periods
+	std::vector<uint16_t> samples(TEST_SAMPLE_RATE / 5000 * 20);
+	for (size_t i = 0; i < samples.size(); i++) {
+		float volts = 1.65f + 0.5f * sinf(2 * (float)CONST_PI * 5000 * i / TEST_SAMPLE_RATE);
+		samples[i] = volts / TEST_VOLTS_PER_COUNT;
+	}
+
+	float power[2];
+	bank.process(samples.data(), samples.size(), TEST_VOLTS_PER_COUNT, power);
+
+	// mean square of a sine is amplitude^2 / 2
+	EXPECT_NEAR(0.125f, power[0], 0.01f);
+	EXPECT_LT(power[1], 0.001f);
+}
+
+TEST(SoftwareKnock, goertzelSkipsUnresolvableBands) {
+	float frequencies[] = { 0, 1000, TEST_SAMPLE_RATE };
+	GoertzelBank bank;
+	bank.configure(TEST_SAMPLE_RATE, frequencies, 3);
+	EXPECT_EQ(1u, bank.getBandCount());
+}
+
+TEST(SoftwareKnock, noiseFloorIsPerCylinder) {
+	KnockNoiseFloor floor;
+
+	// first window only sets the floor
+	EXPECT_EQ(0, floor.update(0, -40));
+	EXPECT_EQ(0, floor.update(1, -20));
+
+	// cylinder 2 being louder than cylinder 1 is not knock
+	EXPECT_NEAR(1, floor.update(0, -39), 1e-3);
+	EXPECT_NEAR(1, floor.update(1, -19), 1e-3);
+
+	// floor follows quiet windows
+	for (int i = 0; i < 200; i++) {
+		floor.update(0, -35);
+	}
+	EXPECT_NEAR(-35, floor.getFloor(0), 0.1);
+
+	// a single loud window barely moves it
+	EXPECT_NEAR(20, floor.update(0, -15), 0.1);
+	EXPECT_NEAR(-34.9, floor.getFloor(0), 0.1);
+
+	floor.reset();
+	EXPECT_EQ(0, floor.getFloor(0));
+}
+
+TEST(SoftwareKnock, doubleBufferedWindows) {
+	KnockSampleBuffers<2, 16> buffers;
+	EXPECT_EQ(nullptr, buffers.getReady());
+
+	// cylinder 1 sampled, not processed yet
+	auto w1 = buffers.startSampling(0, 10);
+	ASSERT_NE(nullptr, w1);
+	buffers.completeSampling();
+
+	// cylinder 2 still gets a window
+	auto w2 = buffers.startSampling(1, 12);
+	ASSERT_NE(nullptr, w2);
+	EXPECT_NE(w1, w2);
+	// still sampling, not ready
+	EXPECT_EQ(w1, buffers.getReady());
+	buffers.completeSampling();
+
+	// both waiting for processing: third cylinder is the first one to be skipped
+	EXPECT_EQ(nullptr, buffers.startSampling(2, 10));
+	EXPECT_EQ(1u, buffers.getOverrunCount());
+
+	// processed oldest first
+	auto ready = buffers.getReady();
+	ASSERT_EQ(w1, ready);
+	EXPECT_EQ(0, ready->cylinderIndex);
+	EXPECT_EQ(10u, ready->sampleCount);
+	buffers.release(ready);
+
+	// freed window is reused while the second one still waits
+	auto w3 = buffers.startSampling(3, 10);
+	EXPECT_EQ(w1, w3);
+	buffers.completeSampling();
+
+	EXPECT_EQ(w2, buffers.getReady());
+	buffers.release(w2);
+	EXPECT_EQ(w3, buffers.getReady());
+	buffers.release(w3);
+	EXPECT_EQ(nullptr, buffers.getReady());
+
+	// ADC error gives the window back
+	ASSERT_NE(nullptr, buffers.startSampling(4, 10));
+	buffers.abortSampling();
+	EXPECT_EQ(nullptr, buffers.getReady());
+	EXPECT_NE(nullptr, buffers.startSampling(5, 10));
+	EXPECT_NE(nullptr, buffers.startSampling(6, 10));
+}
+
+/**
+ * Offline replay: captured (or synthesized) knock ADC windows with a known knock flag go through
+ * the same analysis as the firmware, reporting detection quality and processing time.
+ */
+struct CapturedWindow {
+	uint8_t cylinderIndex;
+	bool knock;
+	std::vector<uint16_t> samples;
+};
+
+struct ReplayStats {
+	int windows = 0;
+	int knockWindows = 0;
+	int detected = 0;
+	int falseAlarms = 0;
+	float nsPerWindow = 0;
+};
+
+static ReplayStats replayKnockWindows(KnockAnalyzer &analyzer, const std::vector<CapturedWindow> &windows) {
+	ReplayStats stats;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (auto &w : windows) {
+		auto result = analyzer.process(w.cylinderIndex, w.samples.data(), w.samples.size(), TEST_VOLTS_PER_COUNT);
+		bool detected = analyzer.isKnock(result);
+
+		stats.windows++;
+		if (w.knock) {
+			stats.knockWindows++;
+			stats.detected += detected;
+		} else {
+			stats.falseAlarms += detected;
+		}
+	}
+
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	stats.nsPerWindow = stats.windows ? (float)ns / stats.windows : 0;
+
+	return stats;
+}
+
+static void printReplayStats(const char *name, const ReplayStats &stats) {
+	printf("Knock replay %s: %d windows, detected %d/%d knock, %d false alarms, %.0f ns per window\n",
+		name, stats.windows, stats.detected, stats.knockWindows, stats.falseAlarms, stats.nsPerWindow);
+}
+
+/**
+ * Deterministic synthetic engine: broadband sensor noise and valve train clatter, with
+ * cylinder 3 louder than the others because it sits next to the sensor. Knock is a decaying
+ * ring at the bore resonance.
+ */
+static std::vector<CapturedWindow> synthesizeWindows(float knockHz, int cycles) {
+	std::vector<CapturedWindow> windows;
+	uint32_t lcg = 12345;
+
+	auto noise = [&lcg]() {
+		lcg = lcg * 1664525 + 1013904223;
+		return ((lcg >> 16) & 0xFFFF) / 32768.0f - 1;
+	};
+
+	// 45 degrees at 3000 rpm
+	size_t sampleCount = TEST_SAMPLE_RATE * 0.0025;
+
+	for (int cycle = 0; cycle < cycles; cycle++) {
+		for (uint8_t cyl = 0; cyl < 4; cyl++) {
+			// every 7th window on cylinder 2 knocks, after the floor had time to learn
+			bool knock = cyl == 1 && cycle > 20 && (cycle % 7) == 0;
+			float loudness = cyl == 2 ? 3 : 1;
+
+			CapturedWindow w;
+			w.cylinderIndex = cyl;
+			w.knock = knock;
+
+			for (size_t i = 0; i < sampleCount; i++) {
+				float t = (float)i / TEST_SAMPLE_RATE;
+				float volts = 1.65f
+					+ 0.02f * loudness * noise()
+					+ 0.05f * loudness * sinf(2 * (float)CONST_PI * 2300 * t + cycle);
+
+				if (knock && i > sampleCount / 4) {
+					float tk = t - 0.25f * sampleCount / TEST_SAMPLE_RATE;
+					volts += 0.05f * expf(-tk / 0.0008f) * sinf(2 * (float)CONST_PI * knockHz * tk);
+				}
+
+				w.samples.push_back(volts / TEST_VOLTS_PER_COUNT);
+			}
+
+			windows.push_back(w);
+		}
+	}
+
+	return windows;
+}
+
+TEST(SoftwareKnock, replaySynthetic) {
+	KnockAnalyzer analyzer;
+	ASSERT_TRUE(analyzer.configure(TEST_SAMPLE_RATE, 83, 0));
+
+	float f[KNOCK_BAND_COUNT];
+	getKnockResonanceFrequencies(83, 0, f);
+
+	auto windows = synthesizeWindows(f[0], 200);
+	auto stats = replayKnockWindows(analyzer, windows);
+	printReplayStats("synthetic", stats);
+
+	EXPECT_EQ(800, stats.windows);
+	EXPECT_EQ(stats.knockWindows, stats.detected);
+	EXPECT_EQ(0, stats.falseAlarms);
+
+	// the loud cylinder learned its own floor
+	EXPECT_GT(analyzer.getNoiseFloor().getFloor(2), analyzer.getNoiseFloor().getFloor(0) + 5);
+}
+
+/**
+ * Text file of captured windows, one per line: cylinder index, knock flag, then raw ADC samples.
+ * Pass the file in KNOCK_REPLAY_FILE, with KNOCK_REPLAY_BORE in mm.
+ */
+static std::vector<CapturedWindow> loadCapturedWindows(const char *fileName) {
+	std::vector<CapturedWindow> windows;
+
+	FILE *f = fopen(fileName, "r");
+	if (!f) {
+		return windows;
+	}
+
+	char line[65536];
+	while (fgets(line, sizeof(line), f)) {
+		char *p = line;
+		char *end;
+
+		CapturedWindow w;
+		w.cylinderIndex = strtol(p, &end, 10);
+		if (end == p) {
+			continue;
+		}
+		p = end;
+		w.knock = strtol(p, &p, 10) != 0;
+
+		while (true) {
+			long sample = strtol(p, &end, 10);
+			if (end == p) {
+				break;
+			}
+			w.samples.push_back(sample);
+			p = end;
+		}
+
+		windows.push_back(w);
+	}
+
+	fclose(f);
+	return windows;
+}
+
+TEST(SoftwareKnock, replayCaptured) {
+	const char *fileName = getenv("KNOCK_REPLAY_FILE");
+	if (!fileName) {
+		return;
+	}
+
+	const char *bore = getenv("KNOCK_REPLAY_BORE");
+
+	KnockAnalyzer analyzer;
+	ASSERT_TRUE(analyzer.configure(TEST_SAMPLE_RATE, bore ? atof(bore) : 87.5, 0));
+
+	auto windows = loadCapturedWindows(fileName);
+	ASSERT_FALSE(windows.empty()) << fileName;
+
+	printReplayStats(fileName, replayKnockWindows(analyzer, windows));
+}
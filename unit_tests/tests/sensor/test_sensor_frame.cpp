@@ -0,0 +1,107 @@
+#include "engine_test_helper.h"
+#include "sensor_frame.h"
+
+#include <gtest/gtest.h>
+
+class SensorFrameTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		Sensor::resetRegistry();
+	}
+
+	void TearDown() override {
+		Sensor::resetRegistry();
+	}
+};
+
+TEST_F(SensorFrameTest, notCapturedReadsRegistry) {
+	SensorFrame frame;
+
+	Sensor::setMockValue(SensorType::Clt, 85);
+	EXPECT_FALSE(frame.isCaptured());
+	EXPECT_FLOAT_EQ(85, frame.get(SensorType::Clt).Value);
+	EXPECT_FALSE(frame.get(SensorType::Map).Valid);
+}
+
+TEST_F(SensorFrameTest, captureFreezesValues) {
+	SensorFrame frame;
+
+	Sensor::setMockValue(SensorType::Clt, 85);
+	Sensor::setMockValue(SensorType::Map, 40);
+
+	frame.capture(1234);
+	EXPECT_TRUE(frame.isCaptured());
+	EXPECT_EQ(1234, frame.getTimestamp());
+
+	// values move on, the frame does not
+	Sensor::setMockValue(SensorType::Clt, 90);
+	Sensor::setMockValue(SensorType::Map, 100);
+	Sensor::resetLookupCount();
+
+	EXPECT_FLOAT_EQ(85, frame.get(SensorType::Clt).Value);
+	EXPECT_FLOAT_EQ(40, frame.get(SensorType::Map).Value);
+	// validity is captured too
+	EXPECT_FALSE(frame.get(SensorType::Iat).Valid);
+	EXPECT_EQ(0u, Sensor::getLookupCount());
+
+	// sensors which are not part of the frame still work
+	Sensor::setMockValue(SensorType::OilPressure, 300);
+	EXPECT_FLOAT_EQ(300, frame.get(SensorType::OilPressure).Value);
+	EXPECT_EQ(1u, Sensor::getLookupCount());
+
+	frame.release();
+	EXPECT_FLOAT_EQ(90, frame.get(SensorType::Clt).Value);
+}
+
+TEST_F(SensorFrameTest, publishAndRead) {
+	SensorFramePublisher publisher;
+
+	Sensor::setMockValue(SensorType::Tps1, 20);
+
+	// nothing published yet, read through
+	EXPECT_FLOAT_EQ(20, publisher.get(SensorType::Tps1).Value);
+
+	publisher.publish(100);
+	Sensor::setMockValue(SensorType::Tps1, 30);
+	publisher.publish(200);
+	Sensor::setMockValue(SensorType::Tps1, 40);
+
+	EXPECT_EQ(2u, publisher.getPublishCount());
+	EXPECT_FLOAT_EQ(30, publisher.get(SensorType::Tps1).Value);
+
+	SensorFrame frame;
+	publisher.read(frame);
+	EXPECT_TRUE(frame.isCaptured());
+	EXPECT_EQ(200, frame.getTimestamp());
+	EXPECT_FLOAT_EQ(30, frame.get(SensorType::Tps1).Value);
+
+	EXPECT_EQ(0u, publisher.getRetryCount());
+}
+
+TEST(SensorFrame, lookupsPerFastTick) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+	setupSimpleTestEngineWithMafAndTT_ONE_trigger(&eth);
+	engineConfiguration->fuelAlgorithm = LM_SPEED_DENSITY;
+	engineConfiguration->coastingFuelCutEnabled = true;
+
+	Sensor::setMockValue(SensorType::Clt, 70);
+	Sensor::setMockValue(SensorType::Iat, 30);
+	Sensor::setMockValue(SensorType::Map, 60);
+	Sensor::setMockValue(SensorType::Tps1, 20);
+	Sensor::setMockValue(SensorType::DriverThrottleIntent, 20);
+	Sensor::setMockValue(SensorType::BarometricPressure, 100);
+
+	ENGINE(rpmCalculator.mockRpm) = 2000;
+	engine->periodicFastCallback(PASS_ENGINE_PARAMETER_SIGNATURE);
+
+	Sensor::resetLookupCount();
+	engine->periodicFastCallback(PASS_ENGINE_PARAMETER_SIGNATURE);
+	size_t lookups = Sensor::getLookupCount();
+
+	printf("Sensor registry lookups per fast tick: %d\n", (int)lookups);
+	// was 14 when every consumer went to the registry; now the frame capture is the only lookup
+	EXPECT_EQ(SENSOR_FRAME_SIZE, lookups);
+
+	// outside of the tick consumers see the registry again
+	EXPECT_FALSE(ENGINE(fastFrame).isCaptured());
+}
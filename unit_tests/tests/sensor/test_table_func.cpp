@@ -0,0 +1,83 @@
+#include "table_func.h"
+#include "func_chain.h"
+#include "resistance_func.h"
+#include "thermistor_func.h"
+
+#include <gtest/gtest.h>
+
+using ThermChain = FuncChain<ResistanceFunc, ThermistorFunc>;
+
+// 3.3v ADC behind a 2:1 divider, like most boards
+#define MAX_INPUT 6.6f
+
+static void configureNeon(ThermChain& chain) {
+	chain.get<ResistanceFunc>().configure(5.0f, 2700);
+	thermistor_conf_s tc = {0, 30, 100, 32500, 7550, 700, 2700};
+	chain.get<ThermistorFunc>().configure(tc);
+}
+
+TEST(TableFunc, NotCompiled) {
+	TableFunc dut;
+
+	EXPECT_FALSE(dut.convert(2.5f).Valid);
+}
+
+TEST(TableFunc, ThermistorWithinBound) {
+	ThermChain exact;
+	configureNeon(exact);
+
+	TableFunc dut;
+	int segments = dut.compile(exact, MAX_INPUT, 0.1f);
+
+	// most of the usable range is served from the table
+	EXPECT_GT(segments, 60);
+	EXPECT_EQ(segments, dut.getTableSegmentCount());
+
+	// every ADC code converts to within the bound, and validity matches exactly
+	for (int code = 0; code < 4096; code++) {
+		float volts = code * MAX_INPUT / 4096;
+		auto expected = exact.convert(volts);
+		auto actual = dut.convert(volts);
+
+		ASSERT_EQ(expected.Valid, actual.Valid) << volts;
+		if (expected.Valid) {
+			ASSERT_NEAR(expected.Value, actual.Value, 0.1f) << volts;
+		}
+	}
+
+	// in between codes, too
+	EXPECT_NEAR(exact.convert(3.6829f).Value, dut.convert(3.6829f).Value, 0.1f);
+
+	// out of range inputs are handled by the exact function
+	EXPECT_FALSE(dut.convert(0).Valid);
+	EXPECT_FALSE(dut.convert(MAX_INPUT).Valid);
+	EXPECT_FALSE(dut.convert(-1).Valid);
+}
+
+TEST(TableFunc, BoundNotMetFallsBackToExact) {
+	ThermChain exact;
+	configureNeon(exact);
+
+	TableFunc dut;
+	// no curved segment can be interpolated exactly
+	EXPECT_EQ(0, dut.compile(exact, MAX_INPUT, 0));
+
+	for (float volts = 0.5f; volts < 4.8f; volts += 0.37f) {
+		EXPECT_EQ(exact.convert(volts).Value, dut.convert(volts).Value);
+	}
+}
+
+struct Straight final : public SensorConverter {
+	SensorResult convert(float input) const override {
+		return 3 * input - 1;
+	}
+};
+
+TEST(TableFunc, LinearFullyTabulated) {
+	Straight exact;
+
+	TableFunc dut;
+	EXPECT_EQ(TABLE_FUNC_SEGMENTS, dut.compile(exact, MAX_INPUT, 1e-4f));
+
+	EXPECT_NEAR(3 * 1.234f - 1, dut.convert(1.234f).Value, 1e-4f);
+}
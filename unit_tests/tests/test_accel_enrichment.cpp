@@ -55,6 +55,8 @@ TEST(fuel, testTpsAccelEnrichmentScheduling) {
 	ASSERT_EQ(expectedInvocationCounter, ENGINE(tpsAccelEnrichment).onUpdateInvocationCounter);
 
 	Sensor::setMockValue(SensorType::Tps1, 70);
+	// trigger callback sees sensors as of the last fast callback
+	eth.engine.periodicFastCallback(PASS_ENGINE_PARAMETER_SIGNATURE);
 	eth.fireTriggerEvents2(/* count */ 1, 25 /* ms */);
 
 	float expectedAEValue = 29.2;
@@ -0,0 +1,121 @@
+#include "adc_oversampler.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdlib>
+
+// 3 channels, 4 samples deep, the way the fast ADC DMA fills its buffer
+static void fillBlock(uint16_t *block, uint16_t ch0, uint16_t ch1, uint16_t ch2) {
+	for (int d = 0; d < 4; d++) {
+		block[d * 3 + 0] = ch0 + d;
+		block[d * 3 + 1] = ch1;
+		block[d * 3 + 2] = ch2 - d;
+	}
+}
+
+TEST(AdcOversampler, boxcarOfOneBlock) {
+	AdcOversampler<4> dut;
+	for (int i = 0; i < 3; i++) {
+		ASSERT_TRUE(dut.configure(i, 4, 1));
+	}
+
+	uint16_t block[12];
+	fillBlock(block, 100, 2000, 4000);
+	dut.onBlock(block, 4, 3);
+
+	// (100 + 101 + 102 + 103) / 4, truncated like the old per-read average
+	EXPECT_EQ(101, dut.get(0));
+	EXPECT_EQ(2000, dut.get(1));
+	EXPECT_EQ(3998, dut.get(2));
+
+	// next block replaces the value, no history from the previous one
+	fillBlock(block, 200, 1000, 3000);
+	dut.onBlock(block, 4, 3);
+	EXPECT_EQ(201, dut.get(0));
+	EXPECT_EQ(1000, dut.get(1));
+	EXPECT_EQ(2998, dut.get(2));
+}
+
+TEST(AdcOversampler, ratioSpansBlocks) {
+	AdcOversampler<3> dut;
+	ASSERT_TRUE(dut.configure(0, 8, 1));
+	ASSERT_TRUE(dut.configure(1, 2, 1));
+
+	uint16_t block[12];
+	fillBlock(block, 100, 2000, 4000);
+	dut.onBlock(block, 4, 3);
+
+	// channel 0 needs a second block before it has a value
+	EXPECT_EQ(0, dut.get(0));
+	EXPECT_EQ(2000, dut.get(1));
+
+	fillBlock(block, 300, 2000, 4000);
+	dut.onBlock(block, 4, 3);
+	// (100 + 101 + 102 + 103 + 300 + 301 + 302 + 303) / 8
+	EXPECT_EQ(201, dut.get(0));
+
+	// unconfigured channel passes every sample through, last one wins
+	EXPECT_EQ(3997, dut.get(2));
+}
+
+TEST(AdcOversampler, cicSettlesOnDc) {
+	AdcOversampler<1> dut;
+	ASSERT_TRUE(dut.configure(0, 4, 3));
+
+	uint16_t block[4] = { 1234, 1234, 1234, 1234 };
+
+	// integrator/comb pipeline fills after 'order' outputs
+	for (int i = 0; i < 3; i++) {
+		dut.onBlock(block, 4, 1);
+	}
+	EXPECT_EQ(1234, dut.get(0));
+
+	// many more blocks, integrators wrap around without disturbing the output
+	for (int i = 0; i < 100000; i++) {
+		dut.onBlock(block, 4, 1);
+	}
+	EXPECT_EQ(1234, dut.get(0));
+}
+
+TEST(AdcOversampler, cicRejectsAlternatingNoise) {
+	AdcOversampler<2> dut;
+	ASSERT_TRUE(dut.configure(0, 3, 1));
+	ASSERT_TRUE(dut.configure(1, 3, 2));
+
+	// +-300 counts of noise alternating every sample around 2000
+	uint16_t block[2];
+	int maxError[2] = { 0, 0 };
+
+	for (int i = 0; i < 300; i++) {
+		uint16_t sample = (i % 2) ? 2300 : 1700;
+		block[0] = block[1] = sample;
+		dut.onBlock(block, 1, 2);
+
+		if (i > 30) {
+			for (int ch = 0; ch < 2; ch++) {
+				int error = abs(dut.get(ch) - 2000);
+				maxError[ch] = std::max(maxError[ch], error);
+			}
+		}
+	}
+
+	// odd boxcar keeps one sample of noise, second order CIC keeps much less
+	EXPECT_EQ(100, maxError[0]);
+	EXPECT_LT(maxError[1], 50);
+}
+
+TEST(AdcOversampler, rejectsUnsupportedConfiguration) {
+	AdcOversampler<2> dut;
+
+	EXPECT_FALSE(dut.configure(0, 0, 1));
+	EXPECT_FALSE(dut.configure(0, 4, 0));
+	EXPECT_FALSE(dut.configure(0, 4, ADC_OVERSAMPLER_MAX_ORDER + 1));
+	EXPECT_FALSE(dut.configure(2, 4, 1));
+	// 64^3 does not fit the accumulators
+	EXPECT_FALSE(dut.configure(0, 64, 3));
+	EXPECT_TRUE(dut.configure(0, 40, 3));
+	EXPECT_TRUE(dut.configure(1, 256, 2));
+
+	EXPECT_EQ(40u, dut.getRatio(0));
+	EXPECT_EQ(3, dut.getOrder(0));
+}
@@ -1,7 +1,17 @@
+#include "engine_test_helper.h"
+#include "binary_logging.h"
 #include "log_field.h"
+#include "tunerstudio_outputs.h"
 #include "buffered_writer.h"
+#include "log_ring_buffer.h"
+#include "log_delta_encoder.h"
+#include "output_channel_registry.h"
 
 #include <gmock/gmock.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
 
 using ::testing::_;
 using ::testing::ElementsAre;
@@ -59,3 +69,442 @@ TEST(BinaryLogField, Value) {
 	// Check that big endian data was written, and bytes after weren't touched
 	EXPECT_THAT(buffer, ElementsAre(0x00, 0xbc, 0x61, 0x4e, 0xAA, 0xAA));
 }
+
+TEST(LogRingBuffer, wholeRecordsWholeBlocks) {
+	LogRingBuffer<1024, 256> ring;
+
+	char record[100];
+	for (int i = 0; i < 10; i++) {
+		memset(record, i, sizeof(record));
+		EXPECT_TRUE(ring.push(record, sizeof(record)));
+	}
+	EXPECT_EQ(3u, ring.getReadableBlocks());
+
+	// no room for another whole record
+	memset(record, 10, sizeof(record));
+	EXPECT_FALSE(ring.push(record, 25));
+	EXPECT_EQ(1u, ring.getDroppedCount());
+
+	std::vector<char> out;
+	auto drain = [&]() {
+		size_t blocks = ring.getReadableBlocks();
+		out.insert(out.end(), ring.getReadPointer(), ring.getReadPointer() + blocks * 256);
+		ring.release(blocks);
+	};
+	drain();
+	EXPECT_EQ(1000u - 768, ring.getUsed());
+
+	// these wrap around the end of the buffer
+	for (int i = 10; i < 17; i++) {
+		memset(record, i, sizeof(record));
+		ASSERT_TRUE(ring.push(record, sizeof(record)));
+	}
+	// the block up to the end of the buffer first, then the rest
+	EXPECT_EQ(1u, ring.getReadableBlocks());
+	drain();
+	EXPECT_EQ(2u, ring.getReadableBlocks());
+	drain();
+
+	ASSERT_EQ(6u * 256, out.size());
+	for (size_t i = 0; i < out.size(); i++) {
+		ASSERT_EQ((char)(i / 100), out[i]) << i;
+	}
+}
+
+TEST(LogRingBuffer, partialBlock) {
+	LogRingBuffer<1024, 256> ring;
+
+	char record[100];
+	memset(record, 1, sizeof(record));
+	ASSERT_TRUE(ring.push(record, sizeof(record)));
+
+	// not a whole block yet, but it can be looked at
+	EXPECT_EQ(0u, ring.getReadableBlocks());
+	EXPECT_EQ(100u, ring.getPartialSize());
+	EXPECT_EQ(0, memcmp(record, ring.getReadPointer(), sizeof(record)));
+
+	memset(record, 2, sizeof(record));
+	ASSERT_TRUE(ring.push(record, sizeof(record)));
+	ASSERT_TRUE(ring.push(record, sizeof(record)));
+	EXPECT_EQ(1u, ring.getReadableBlocks());
+	// full blocks go first
+	EXPECT_EQ(0u, ring.getPartialSize());
+
+	ring.release(1);
+	EXPECT_EQ(44u, ring.getPartialSize());
+	EXPECT_EQ(2, ring.getReadPointer()[0]);
+	EXPECT_EQ(2, ring.getReadPointer()[43]);
+}
+
+/**
+ * Records every 20ms, the card takes 2ms per write and every couple of seconds stops for its
+ * housekeeping.
+ */
+static std::vector<uint8_t> simulateSdLog(int stallMs, int &accepted, uint32_t &dropped) {
+	auto ringStorage = std::make_unique<LogRingBuffer<8192>>();
+	auto &ring = *ringStorage;
+
+	const size_t recordSize = 98;
+	std::vector<uint8_t> card;
+	int cardBusyUntil = 0;
+	size_t pendingRelease = 0;
+	int nextPoll = 0;
+	int nextStall = 1000;
+
+	uint8_t record[recordSize];
+	int sequence = 0;
+
+	for (int nowMs = 0; nowMs < 10000; nowMs++) {
+		if (nowMs % 20 == 0) {
+			memset(record, sequence, sizeof(record));
+			if (ring.push(reinterpret_cast<char*>(record), sizeof(record))) {
+				sequence++;
+			}
+		}
+
+		if (nowMs < cardBusyUntil) {
+			continue;
+		}
+		ring.release(pendingRelease);
+		pendingRelease = 0;
+
+		if (nowMs < nextPoll) {
+			continue;
+		}
+
+		size_t sectors = std::min<size_t>(ring.getReadableBlocks(), 4);
+		if (sectors == 0) {
+			nextPoll = nowMs + 10;
+			continue;
+		}
+
+		const uint8_t *data = reinterpret_cast<const uint8_t*>(ring.getReadPointer());
+		card.insert(card.end(), data, data + sectors * 512);
+		pendingRelease = sectors;
+		cardBusyUntil = nowMs + 2;
+		if (nowMs >= nextStall) {
+			cardBusyUntil += stallMs;
+			nextStall += 2000;
+		}
+	}
+
+	accepted = sequence;
+	dropped = ring.getDroppedCount();
+	return card;
+}
+
+TEST(LogRingBuffer, cardStall) {
+	int accepted;
+	uint32_t dropped;
+	std::vector<uint8_t> card = simulateSdLog(250, accepted, dropped);
+
+	// a quarter of a second is nothing, every record made it and in order
+	EXPECT_EQ(500, accepted);
+	EXPECT_EQ(0u, dropped);
+	EXPECT_GT(card.size(), 500u * 98 - 8192);
+	for (size_t i = 0; i < card.size(); i++) {
+		ASSERT_EQ((uint8_t)(i / 98), card[i]) << i;
+	}
+
+	// two seconds is more than the ring holds: whole records are dropped and counted
+	card = simulateSdLog(2000, accepted, dropped);
+	EXPECT_GT(dropped, 0u);
+	EXPECT_EQ(500u, accepted + dropped);
+	for (size_t i = 0; i < card.size(); i++) {
+		ASSERT_EQ((uint8_t)(i / 98), card[i]) << i;
+	}
+}
+
+class VectorWriter : public Writer {
+public:
+	size_t write(const char* buffer, size_t count) override {
+		data.insert(data.end(), buffer, buffer + count);
+		return count;
+	}
+
+	size_t flush() override {
+		return 0;
+	}
+
+	std::vector<uint8_t> data;
+};
+
+static std::vector<std::pair<uint16_t, uint16_t>> refreshed;
+
+static void recordRefresh(uint16_t offset, uint16_t count) {
+	refreshed.emplace_back(offset, count);
+}
+
+TEST(BinaryLogGroups, everythingByDefault) {
+	const uint8_t dividers[LOG_GROUP_COUNT] = {};
+	selectLogFields(dividers);
+
+	VectorWriter header;
+	writeHeader(header);
+	// time and all 47 fields
+	EXPECT_EQ(48, header.data[21]);
+	EXPECT_EQ(MLQ_HEADER_SIZE + 48 * 55, header.data.size());
+	uint16_t recordLength = header.data[18] << 8 | header.data[19];
+
+	// the one record buffer in status_loop.cpp
+	char record[128];
+	refreshed.clear();
+	EXPECT_EQ(recordLength + 5u, writeBlock(record, recordRefresh));
+	// neighbouring fields share a range, and no range is refreshed twice
+	EXPECT_GE(refreshed.size(), (size_t)LOG_GROUP_COUNT);
+	EXPECT_LT(refreshed.size(), 47u);
+	std::sort(refreshed.begin(), refreshed.end());
+	for (size_t i = 1; i < refreshed.size(); i++) {
+		EXPECT_LE(refreshed[i - 1].first + refreshed[i - 1].second, refreshed[i].first);
+	}
+}
+
+TEST(BinaryLogGroups, selection) {
+	const uint8_t dividers[LOG_GROUP_COUNT] = { 1, 0, 0, 0, 0, 0 };
+	selectLogFields(dividers);
+
+	VectorWriter header;
+	writeHeader(header);
+	// time and the engine group
+	EXPECT_EQ(11, header.data[21]);
+	EXPECT_EQ(MLQ_HEADER_SIZE + 11 * 55, header.data.size());
+	uint16_t recordLength = header.data[18] << 8 | header.data[19];
+
+	char record[128];
+	EXPECT_EQ(recordLength + 5u, writeBlock(record));
+	EXPECT_LT(recordLength, 40);
+}
+
+TEST(BinaryLogGroups, dividers) {
+	const uint8_t dividers[LOG_GROUP_COUNT] = { 1, 4, 0, 0, 2, 0 };
+	selectLogFields(dividers);
+
+	char record[128];
+	std::vector<size_t> perRecord;
+	refreshed.clear();
+	for (int i = 0; i < 8; i++) {
+		size_t before = refreshed.size();
+		writeBlock(record, recordRefresh);
+		perRecord.push_back(refreshed.size() - before);
+	}
+
+	// engine every record, fuel every 4th, sensors every other
+	size_t engineRanges = perRecord[1];
+	size_t sensorRanges = perRecord[2] - engineRanges;
+	size_t fuelRanges = perRecord[0] - engineRanges - sensorRanges;
+	EXPECT_GT(engineRanges, 0u);
+	EXPECT_GT(sensorRanges, 0u);
+	EXPECT_GT(fuelRanges, 0u);
+	EXPECT_EQ(8 * engineRanges + 2 * fuelRanges + 4 * sensorRanges, refreshed.size());
+	for (auto& range : refreshed) {
+		EXPECT_LE(range.first + range.second, sizeof(TunerStudioOutputChannels));
+	}
+}
+
+static int registryUpdates;
+
+static void countUpdate(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	registryUpdates++;
+}
+
+// a few updaters spread over the output channels, fields of different groups in between
+static const OutputChannelEntry logTestEntries[] = {
+	{ OUTPUT_RANGE(rpm, rpm), OutputRefresh::EveryRequest, countUpdate },
+	{ OUTPUT_RANGE(coolantTemperature, coolantTemperature), OutputRefresh::EveryRequest, countUpdate },
+	{ OUTPUT_RANGE(pedalPosition, pedalPosition), OutputRefresh::EveryRequest, countUpdate },
+	{ OUTPUT_RANGE(massAirFlow, massAirFlow), OutputRefresh::EveryRequest, countUpdate },
+	{ OUTPUT_RANGE(vBatt, vBatt), OutputRefresh::EveryRequest, countUpdate },
+	{ OUTPUT_RANGE(idlePosition, etb1Error), OutputRefresh::EveryRequest, countUpdate },
+	{ OUTPUT_RANGE(throttle2Position, throttle2Position), OutputRefresh::EveryRequest, countUpdate },
+};
+
+TEST(BinaryLogGroups, registryUpdatesForOneGroup) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	// throttle fields are spread from pedal position to the second TPS, across most of the channels
+	const uint8_t dividers[LOG_GROUP_COUNT] = { 0, 0, 0, 1, 0, 0 };
+	selectLogFields(dividers);
+
+	char record[128];
+	refreshed.clear();
+	writeBlock(record, recordRefresh);
+
+	OutputChannelRegistry<efi::size(logTestEntries)> registry(logTestEntries);
+	registryUpdates = 0;
+	for (auto& range : refreshed) {
+		registry.refresh(&tsOutputChannels, range.first, range.second, 0 PASS_ENGINE_PARAMETER_SUFFIX);
+	}
+
+	// pedal, the ETB block and the second TPS, nothing which just sits in between
+	EXPECT_EQ(3, registryUpdates);
+	EXPECT_EQ(3u, registry.getUpdateCount());
+}
+
+// field sizes the way a reader of the file finds them, from the field headers
+static std::vector<uint8_t> readFieldSizes(const std::vector<uint8_t>& header) {
+	std::vector<uint8_t> sizes;
+	for (int i = 0; i < header[21]; i++) {
+		uint8_t type = header[MLQ_HEADER_SIZE + i * MLQ_FIELD_HEADER_SIZE];
+		sizes.push_back(type <= 1 ? 1 : type <= 3 ? 2 : 4);
+	}
+	return sizes;
+}
+
+static uint32_t nextRandom() {
+	static uint32_t seed = 12345;
+	seed = seed * 1103515245 + 12345;
+	return seed >> 16;
+}
+
+// a drive: warm up at idle, pulls through the rev range, cruise
+static void simulateEngine(int i) {
+	float rpm = i < 500 ? 850 : 2000 + 1500 * sinf(i / 150.0f) + (i % 400) * 5;
+	tsOutputChannels.rpm = rpm + nextRandom() % 20;
+	tsOutputChannels.manifoldAirPressure = 30 + rpm / 100 + (nextRandom() % 50) / 10.0f;
+	tsOutputChannels.throttlePosition = i < 500 ? 0 : rpm / 100;
+	tsOutputChannels.coolantTemperature = 20 + i / 50.0f;
+	tsOutputChannels.intakeAirTemperature = 25;
+	tsOutputChannels.vBatt = 13.8f + (nextRandom() % 10) / 100.0f;
+	tsOutputChannels.lambda = 1 + ((int)(nextRandom() % 21) - 10) / 1000.0f;
+	tsOutputChannels.airFuelRatio = 14.7f * tsOutputChannels.lambda;
+	tsOutputChannels.ignitionAdvance = 10 + rpm / 200;
+	tsOutputChannels.fuelRunning = tsOutputChannels.manifoldAirPressure / 10;
+	tsOutputChannels.veValue = 60 + rpm / 200;
+	tsOutputChannels.sparkDwell = 3;
+	tsOutputChannels.vehicleSpeedKph = i < 500 ? 0 : rpm / 50;
+	tsOutputChannels.knockRetard = (i % 1000) > 990 ? 2 : 0;
+}
+
+TEST(BinaryLogDelta, roundTrip) {
+	const uint8_t everything[LOG_GROUP_COUNT] = {};
+	selectLogFields(everything);
+
+	VectorWriter header;
+	writeHeader(header, true);
+	EXPECT_EQ('Z', header.data[4]);
+	std::vector<uint8_t> sizes = readFieldSizes(header.data);
+
+	LogDeltaEncoder encoder;
+	encoder.setFields(sizes.data(), sizes.size());
+
+	std::vector<std::vector<char>> records;
+	std::vector<char> file;
+	size_t plainSize = 0;
+	int64_t encodeNs = 0;
+#if defined(__x86_64__)
+	uint64_t encodeCycles = 0;
+#endif
+	const int recordCount = 5000;
+	for (int i = 0; i < recordCount; i++) {
+		simulateEngine(i);
+
+		char record[128];
+		size_t size = writeBlock(record);
+		records.emplace_back(record, record + size);
+		plainSize += size;
+
+		char out[128];
+		auto start = std::chrono::high_resolution_clock::now();
+#if defined(__x86_64__)
+		uint64_t startCycles = __builtin_ia32_rdtsc();
+#endif
+		size_t encoded = encoder.encode(record, size, out);
+#if defined(__x86_64__)
+		encodeCycles += __builtin_ia32_rdtsc() - startCycles;
+#endif
+		encodeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+		ASSERT_LE(encoded, size);
+		file.insert(file.end(), out, out + encoded);
+	}
+
+	LogDeltaDecoder decoder;
+	decoder.setFields(sizes.data(), sizes.size());
+	ASSERT_EQ(records[0].size(), decoder.getRecordSize());
+
+	size_t at = 0;
+	for (int i = 0; i < recordCount; i++) {
+		char record[128];
+		bool isRecord;
+		size_t used = decoder.decode(file.data() + at, file.size() - at, record, isRecord);
+		ASSERT_NE(0u, used) << "record " << i;
+		ASSERT_TRUE(isRecord);
+		ASSERT_EQ(records[i], std::vector<char>(record, record + decoder.getRecordSize())) << "record " << i;
+		at += used;
+	}
+	EXPECT_EQ(file.size(), at);
+
+	double ratio = (double)plainSize / file.size();
+	printf("Compressed MLG: %d records of %d bytes, %.1f bytes average, ratio %.2f, %d keyframes, encode %dns",
+			recordCount, (int)records[0].size(), (double)file.size() / recordCount, ratio,
+			(int)encoder.getKeyframeCount(), (int)(encodeNs / recordCount));
+#if defined(__x86_64__)
+	printf(" %d cycles", (int)(encodeCycles / recordCount));
+#endif
+	printf(" per record on this host\n");
+	EXPECT_GT(ratio, 3);
+}
+
+TEST(BinaryLogDelta, lostRecord) {
+	const uint8_t sizes[] = { 4, 2, 1 };
+	LogDeltaEncoder encoder;
+	encoder.setFields(sizes, sizeof(sizes));
+	LogDeltaDecoder decoder;
+	decoder.setFields(sizes, sizeof(sizes));
+
+	auto makeRecord = [](uint8_t counter, int value) {
+		std::vector<char> record = { 0, (char)counter, 0, 0,
+				0, 0, (char)(value >> 8), (char)value,
+				(char)(value >> 8), (char)value,
+				(char)value,
+				0 };
+		uint8_t sum = 0;
+		for (size_t i = 4; i < record.size() - 1; i++) {
+			sum += record[i];
+		}
+		record.back() = sum;
+		return record;
+	};
+
+	char out[16];
+	char decoded[16];
+	bool isRecord;
+
+	std::vector<char> record = makeRecord(0, 1000);
+	EXPECT_EQ(record.size(), encoder.encode(record.data(), record.size(), out));
+	EXPECT_EQ(record.size(), decoder.decode(out, sizeof(out), decoded, isRecord));
+	EXPECT_TRUE(isRecord);
+
+	// small step down: bitmap and one byte per field
+	record = makeRecord(1, 999);
+	size_t size = encoder.encode(record.data(), record.size(), out);
+	EXPECT_EQ(MLG_BLOCK_DELTA, out[0]);
+	EXPECT_EQ(4u + 1 + 3 + 1, size);
+	EXPECT_EQ(size, decoder.decode(out, size, decoded, isRecord));
+	ASSERT_TRUE(isRecord);
+	EXPECT_EQ(record, std::vector<char>(decoded, decoded + record.size()));
+
+	// this one never makes it to the file
+	record = makeRecord(2, 998);
+	encoder.encode(record.data(), record.size(), out);
+
+	// the decoder notices the gap and waits for a keyframe
+	record = makeRecord(3, 997);
+	size = encoder.encode(record.data(), record.size(), out);
+	EXPECT_EQ(size, decoder.decode(out, size, decoded, isRecord));
+	EXPECT_FALSE(isRecord);
+
+	// the logger asks for a keyframe after a lost record
+	encoder.requestKeyframe();
+	record = makeRecord(4, 996);
+	EXPECT_EQ(record.size(), encoder.encode(record.data(), record.size(), out));
+	EXPECT_EQ(record.size(), decoder.decode(out, sizeof(out), decoded, isRecord));
+	EXPECT_TRUE(isRecord);
+	EXPECT_EQ(2u, encoder.getKeyframeCount());
+
+	// a corrupt block is rejected
+	record = makeRecord(5, 5000);
+	size = encoder.encode(record.data(), record.size(), out);
+	out[4] ^= 1;
+	EXPECT_EQ(0u, decoder.decode(out, size, decoded, isRecord));
+}
@@ -0,0 +1,215 @@
+#include "can_codec_generated.h"
+#include "scaled_channel.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+
+// packing happens at compile time just as well
+static constexpr float packAndUnpackRpm(float rpm) {
+	uint8_t data[8] = {};
+	BmwE46Rpm msg;
+	msg.rpm = rpm;
+	msg.pack(data);
+	return BmwE46Rpm::unpack(data).rpm;
+}
+static_assert(packAndUnpackRpm(3000) == 3000);
+
+TEST(CanCodec, intelUnaligned) {
+	// 12 bits starting in the middle of a byte
+	constexpr CanSignal s = { 4, 12, CanByteOrder::Intel, false, 1, 0 };
+	uint8_t data[8];
+	memset(data, 0xFF, sizeof(data));
+
+	s.setRaw(data, 0xABC);
+	EXPECT_EQ(0xCF, data[0]);
+	EXPECT_EQ(0xAB, data[1]);
+	// neighbours untouched
+	EXPECT_EQ(0xFF, data[2]);
+	EXPECT_EQ(0xABCu, s.getRaw(data));
+}
+
+TEST(CanCodec, motorolaAcrossBytes) {
+	// big endian 16 bits in bytes 1 and 2
+	constexpr CanSignal s = { 15, 16, CanByteOrder::Motorola, false, 1, 0 };
+	uint8_t data[8] = {};
+
+	s.setRaw(data, 0x1234);
+	EXPECT_EQ(0, data[0]);
+	EXPECT_EQ(0x12, data[1]);
+	EXPECT_EQ(0x34, data[2]);
+	EXPECT_EQ(0x1234u, s.getRaw(data));
+
+	// 10 bits starting at bit 3 of byte 0: 4 bits there, 6 in the top of byte 1
+	constexpr CanSignal odd = { 3, 10, CanByteOrder::Motorola, false, 1, 0 };
+	memset(data, 0, sizeof(data));
+	odd.setRaw(data, 0x3FF);
+	EXPECT_EQ(0x0F, data[0]);
+	EXPECT_EQ(0xFC, data[1]);
+	EXPECT_EQ(0x3FFu, odd.getRaw(data));
+}
+
+TEST(CanCodec, signedAndScaled) {
+	constexpr CanSignal s = { 16, 16, CanByteOrder::Intel, true, 0.02f, 0 };
+	uint8_t data[8] = {};
+
+	s.encode(data, -10);
+	// -500 little endian
+	EXPECT_EQ(0x0C, data[2]);
+	EXPECT_EQ(0xFE, data[3]);
+	EXPECT_NEAR(-10, s.decode(data), 1e-4);
+
+	// rounds to the nearest step
+	s.encode(data, 0.029f);
+	EXPECT_EQ(1u, s.getRaw(data));
+	s.encode(data, -0.031f);
+	EXPECT_NEAR(-0.04f, s.decode(data), 1e-6);
+}
+
+TEST(CanCodec, saturates) {
+	constexpr CanSignal u8 = { 0, 8, CanByteOrder::Intel, false, 1, -40 };
+	constexpr CanSignal s8 = { 8, 8, CanByteOrder::Intel, true, 1, 0 };
+	uint8_t data[8] = {};
+
+	u8.encode(data, 500);
+	EXPECT_EQ(255, data[0]);
+	u8.encode(data, -100);
+	EXPECT_EQ(0, data[0]);
+	u8.encode(data, NAN);
+	EXPECT_EQ(0, data[0]);
+
+	s8.encode(data, 1000);
+	EXPECT_EQ(127, s8.decode(data));
+	s8.encode(data, -1000);
+	EXPECT_EQ(-128, s8.decode(data));
+	// the other signal is left alone
+	EXPECT_EQ(0, data[0]);
+
+	constexpr CanSignal u32 = { 0, 32, CanByteOrder::Intel, false, 1, 0 };
+	u32.encode(data, 1e12);
+	EXPECT_EQ(0xFFFFFFFFu, u32.getRaw(data));
+}
+
+// Frames used to be packed by hand, the wire format has to stay the same
+TEST(CanCodec, dashboardsMatchHandPacking) {
+	uint8_t data[8] = {};
+
+	BmwE46Rpm rpm;
+	rpm.rpm = 3000;
+	rpm.pack(data);
+	// old code: setShortValue(rpm * 6.4, 2), little endian
+	EXPECT_EQ((19200 & 0xFF), data[2]);
+	EXPECT_EQ((19200 >> 8), data[3]);
+
+	memset(data, 0, sizeof(data));
+	MazdaRx8RpmSpeed rx8;
+	rx8.rpm = 3000;
+	rx8.unknown = 0xFFFF;
+	rx8.speed = 50;
+	rx8.pack(data);
+	// old code: SWAP_UINT16(rpm * 4), 0xFFFF, SWAP_UINT16(100 * kph + 10000)
+	uint8_t expected[8] = { 12000 >> 8, 12000 & 0xFF, 0xFF, 0xFF, 15000 >> 8, 15000 & 0xFF, 0, 0 };
+	EXPECT_EQ(0, memcmp(expected, data, 8));
+
+	memset(data, 0, sizeof(data));
+	MazdaRx8Status2 status;
+	status.clt = 90;
+	status.batteryLight = 1;
+	status.coolantLight = 1;
+	status.pack(data);
+	EXPECT_EQ(159, data[0]);
+	// old code: setBit(6, 6) and setBit(6, 1)
+	EXPECT_EQ((1 << 6) | (1 << 1), data[6]);
+
+	memset(data, 0, sizeof(data));
+	FiatMotorInfo fiat;
+	fiat.clt = 20;
+	fiat.rpm = 3200;
+	fiat.pack(data);
+	// old code: setShortValue(clt - 40, 3) and setShortValue(rpm / 32, 6)
+	EXPECT_EQ(0xEC, data[3]);
+	EXPECT_EQ(0xFF, data[4]);
+	EXPECT_EQ(100, data[6]);
+}
+
+TEST(CanCodec, vehicleSpeedMatchesHandDecoding) {
+	uint8_t e46[8] = { 0x40, 0x36, 0, 0, 0, 0, 0, 0 };
+	// old code: ((data[1] & 0x0f) << 8 | data[0]) / 16, upper nibble of data[1] is something else
+	EXPECT_FLOAT_EQ(0x640 / 16.0f, BmwE46Abs::unpack(e46).leftFrontSpeed);
+
+	uint8_t w202[8] = { 0, 0, 0x03, 0x20, 0, 0, 0, 0 };
+	// old code: (data[2] << 8 | data[3]) * 0.0625
+	EXPECT_FLOAT_EQ(0x320 * 0.0625f, W202Abs::unpack(w202).speed);
+}
+
+// Layout of the hand written struct the verbose Speeds frame used to be
+struct OldSpeeds {
+	uint16_t rpm;
+	scaled_angle timing;
+	scaled_channel<uint8_t, 2> injDuty;
+	scaled_channel<uint8_t, 2> coilDuty;
+	scaled_channel<uint8_t> vssKph;
+	uint8_t pad[1];
+};
+
+TEST(CanCodec, verboseMatchesOldStructs) {
+	// every member zero, pad included
+	OldSpeeds old{};
+	old.rpm = 4321;
+	old.timing = -12.5f;
+	old.injDuty = 45.5f;
+	old.coilDuty = 20;
+	old.vssKph = 88;
+
+	VerboseSpeeds msg;
+	msg.rpm = 4321;
+	msg.timing = -12.5f;
+	msg.injDuty = 45.5f;
+	msg.coilDuty = 20;
+	msg.vssKph = 88;
+
+	uint8_t data[8] = {};
+	msg.pack(data);
+	EXPECT_EQ(0, memcmp(&old, data, sizeof(old)));
+
+	// and the receiving side of the CAN pedal
+	uint8_t pedal[8] = {};
+	VerbosePedalAndTps p;
+	p.pedal = 37.25f;
+	p.pack(pedal);
+	EXPECT_EQ(3725, *reinterpret_cast<int16_t*>(pedal));
+	EXPECT_FLOAT_EQ(37.25f, VerbosePedalAndTps::pedalSignal.decode(pedal));
+}
+
+template <typename TMessage>
+static float maxRoundTripError(TMessage& in, const CanSignal &signal, float TMessage::*field, float min, float max) {
+	float worst = 0;
+
+	for (int i = 0; i <= 1000; i++) {
+		float value = min + (max - min) * i / 1000;
+		in.*field = value;
+
+		uint8_t data[8] = {};
+		in.pack(data);
+		TMessage out = TMessage::unpack(data);
+
+		worst = std::max(worst, std::abs(out.*field - value) / signal.factor);
+	}
+
+	return worst;
+}
+
+TEST(CanCodec, roundTripWithinHalfStep) {
+	VerboseSensors1 s1;
+	EXPECT_LE(maxRoundTripError(s1, VerboseSensors1::mapSignal, &VerboseSensors1::map, 0, 2000), 0.5f + 1e-3f);
+	EXPECT_LE(maxRoundTripError(s1, VerboseSensors1::cltSignal, &VerboseSensors1::clt, -40, 215), 0.5f);
+
+	VerboseFueling fueling;
+	EXPECT_LE(maxRoundTripError(fueling, VerboseFueling::fuelPulseSignal, &VerboseFueling::fuelPulse, -100, 100), 0.5f + 1e-3f);
+
+	MazdaRx8RpmSpeed rx8;
+	EXPECT_LE(maxRoundTripError(rx8, MazdaRx8RpmSpeed::speedSignal, &MazdaRx8RpmSpeed::speed, -100, 500), 0.5f + 1e-3f);
+
+	BmwE46Dme2 dme2;
+	EXPECT_LE(maxRoundTripError(dme2, BmwE46Dme2::cltSignal, &BmwE46Dme2::clt, -48, 140), 0.5f + 1e-3f);
+}
@@ -0,0 +1,221 @@
+#include "can_rx_dispatch.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <vector>
+
+// same layout as the STM32 CANRxFrame: SID and EID share storage
+struct TestFrame {
+	uint8_t IDE;
+	union {
+		struct {
+			uint32_t SID : 11;
+		};
+		struct {
+			uint32_t EID : 29;
+		};
+	};
+	uint8_t data8[8];
+};
+
+static TestFrame makeFrame(uint32_t id, bool isExtended = false) {
+	TestFrame f = {};
+	f.IDE = isExtended;
+	if (isExtended) {
+		f.EID = id;
+	} else {
+		f.SID = id;
+	}
+	return f;
+}
+
+struct Recorder {
+	std::vector<uint32_t> ids;
+	int tag = 0;
+
+	static void onFrame(void *owner, const TestFrame &frame, efitick_t) {
+		static_cast<Recorder*>(owner)->ids.push_back(frame.IDE ? frame.EID : frame.SID);
+	}
+};
+
+TEST(CanRxDispatch, routesById) {
+	CanRxDispatchTable<TestFrame, 8> dut;
+	Recorder a, b;
+
+	ASSERT_TRUE(dut.add(0x7E8, false, Recorder::onFrame, &a, "a"));
+	ASSERT_TRUE(dut.add(0x1F0, false, Recorder::onFrame, &b, "b"));
+	ASSERT_TRUE(dut.add(0x727573, true, Recorder::onFrame, &b, "b ext"));
+
+	EXPECT_EQ(1u, dut.dispatch(makeFrame(0x1F0), 0));
+	EXPECT_EQ(1u, dut.dispatch(makeFrame(0x7E8), 0));
+	EXPECT_EQ(1u, dut.dispatch(makeFrame(0x727573, true), 0));
+
+	EXPECT_EQ(std::vector<uint32_t>({ 0x7E8 }), a.ids);
+	EXPECT_EQ(std::vector<uint32_t>({ 0x1F0, 0x727573 }), b.ids);
+
+	// sorted by ID, each with its own hit count
+	ASSERT_EQ(3u, dut.getCount());
+	EXPECT_EQ(0x1F0u, dut.get(0).id);
+	EXPECT_EQ(0x7E8u, dut.get(1).id);
+	EXPECT_EQ(0x727573u, dut.get(2).id);
+	EXPECT_TRUE(dut.get(2).isExtended);
+	EXPECT_EQ(1u, dut.get(0).hits);
+	EXPECT_EQ(0u, dut.getUnknownCount());
+}
+
+TEST(CanRxDispatch, standardAndExtendedAreDifferent) {
+	CanRxDispatchTable<TestFrame, 8> dut;
+	Recorder standard, extended;
+
+	dut.add(0x100, false, Recorder::onFrame, &standard, "standard");
+	dut.add(0x100, true, Recorder::onFrame, &extended, "extended");
+
+	EXPECT_EQ(1u, dut.dispatch(makeFrame(0x100), 0));
+	EXPECT_EQ(1u, dut.dispatch(makeFrame(0x100, true), 0));
+	EXPECT_EQ(1u, dut.dispatch(makeFrame(0x100), 0));
+
+	EXPECT_EQ(std::vector<uint32_t>({ 0x100, 0x100 }), standard.ids);
+	EXPECT_EQ(std::vector<uint32_t>({ 0x100 }), extended.ids);
+	EXPECT_EQ(0u, dut.getUnknownCount());
+}
+
+/**
+ * The driver keeps receiving into the same frame and a standard frame only writes the SID
+ * bits, the upper EID bits stay from the last extended frame.
+ */
+TEST(CanRxDispatch, reusedFrameBuffer) {
+	CanRxDispatchTable<TestFrame, 8> dut;
+	Recorder obd, bootloader;
+
+	dut.add(0x7DF, false, Recorder::onFrame, &obd, "OBD");
+	dut.add(0x7E0, false, Recorder::onFrame, &obd, "OBD physical");
+	dut.add(0x727573, true, Recorder::onFrame, &bootloader, "wideband bootloader");
+
+	TestFrame buffer = {};
+
+	buffer.IDE = 1;
+	buffer.EID = 0x727573;
+	EXPECT_EQ(1u, dut.dispatch(buffer, 0));
+
+	buffer.IDE = 0;
+	buffer.SID = 0x7DF;
+	// stale bits above the SID
+	ASSERT_NE(0x7DFu, (uint32_t)buffer.EID);
+	EXPECT_EQ(1u, dut.dispatch(buffer, 0));
+
+	buffer.SID = 0x7E0;
+	EXPECT_EQ(1u, dut.dispatch(buffer, 0));
+
+	EXPECT_EQ(std::vector<uint32_t>({ 0x7DF, 0x7E0 }), obd.ids);
+	EXPECT_EQ(std::vector<uint32_t>({ 0x727573 }), bootloader.ids);
+	EXPECT_EQ(0u, dut.getUnknownCount());
+}
+
+TEST(CanRxDispatch, sharedIdInRegistrationOrder) {
+	CanRxDispatchTable<TestFrame, 8> dut;
+
+	// several OBD sensors all listen to the same response ID
+	static std::vector<int> order;
+	order.clear();
+	Recorder first, second, other;
+	first.tag = 1;
+	second.tag = 2;
+	other.tag = 3;
+
+	auto handler = [](void *owner, const TestFrame &, efitick_t) {
+		order.push_back(static_cast<Recorder*>(owner)->tag);
+	};
+
+	dut.add(0x7E8, false, handler, &first, "first");
+	dut.add(0x100, false, handler, &other, "other");
+	dut.add(0x7E8, false, handler, &second, "second");
+
+	EXPECT_EQ(2u, dut.dispatch(makeFrame(0x7E8), 0));
+	EXPECT_EQ(std::vector<int>({ 1, 2 }), order);
+}
+
+TEST(CanRxDispatch, unknownIdsAreCounted) {
+	CanRxDispatchTable<TestFrame, 4> dut;
+	Recorder r;
+	dut.add(0x200, false, Recorder::onFrame, &r, "r");
+
+	for (uint32_t id = 0; id < 0x800; id++) {
+		dut.dispatch(makeFrame(id), 0);
+	}
+
+	// filter collisions are counted the same as frames the filter rejects
+	EXPECT_EQ(0x7FFu, dut.getUnknownCount());
+	EXPECT_EQ(std::vector<uint32_t>({ 0x200 }), r.ids);
+	EXPECT_EQ(1u, dut.get(0).hits);
+
+	dut.clear();
+	EXPECT_EQ(0u, dut.getCount());
+	EXPECT_EQ(0u, dut.getUnknownCount());
+	EXPECT_EQ(0u, dut.dispatch(makeFrame(0x200), 0));
+}
+
+TEST(CanRxDispatch, full) {
+	CanRxDispatchTable<TestFrame, 2> dut;
+	Recorder r;
+
+	EXPECT_TRUE(dut.add(1, false, Recorder::onFrame, &r, "1"));
+	EXPECT_TRUE(dut.add(2, false, Recorder::onFrame, &r, "2"));
+	EXPECT_FALSE(dut.add(3, false, Recorder::onFrame, &r, "3"));
+	EXPECT_EQ(2u, dut.getCount());
+}
+
+/**
+ * Busy vehicle bus: a couple hundred distinct IDs, of which only a handful are ours.
+ * Compare against walking a list of every consumer for every frame.
+ */
+TEST(CanRxDispatch, busyBusCost) {
+	constexpr int consumers = 12;
+	constexpr int frames = 2000000;
+
+	CanRxDispatchTable<TestFrame, consumers> dut;
+	static uint32_t delivered;
+	delivered = 0;
+	auto handler = [](void *, const TestFrame &, efitick_t) {
+		delivered++;
+	};
+
+	uint32_t ids[consumers];
+	for (int i = 0; i < consumers; i++) {
+		ids[i] = 0x600 + 7 * i;
+		dut.add(ids[i], false, handler, nullptr, "consumer");
+	}
+
+	TestFrame f = {};
+	uint32_t lcg = 1;
+	auto nextId = [&lcg]() {
+		lcg = lcg * 1664525 + 1013904223;
+		return 0x100 + ((lcg >> 16) % 0x600);
+	};
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < frames; i++) {
+		f.SID = nextId();
+		dut.dispatch(f, 0);
+	}
+	auto tableNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	uint32_t tableDelivered = delivered;
+
+	delivered = 0;
+	lcg = 1;
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < frames; i++) {
+		f.SID = nextId();
+		for (int c = 0; c < consumers; c++) {
+			if (f.SID == ids[c]) {
+				handler(nullptr, f, 0);
+			}
+		}
+	}
+	auto listNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	EXPECT_EQ(delivered, tableDelivered);
+	EXPECT_EQ(frames - tableDelivered, dut.getUnknownCount());
+
+	printf("CAN RX dispatch: %.1f ns per frame table, %.1f ns per frame linear, %d of %d frames consumed\n",
+		(float)tableNs / frames, (float)listNs / frames, tableDelivered, frames);
+}
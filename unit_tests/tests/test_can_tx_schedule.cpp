@@ -0,0 +1,102 @@
+#include "can_tx_schedule.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+
+static int fastCount;
+static int slowCount;
+static int otherCount;
+
+static void fast() {
+	fastCount++;
+}
+
+static void slow() {
+	slowCount++;
+}
+
+static void other() {
+	otherCount++;
+}
+
+TEST(CanTxSchedule, periodAndPhase) {
+	fastCount = slowCount = otherCount = 0;
+	CanTxSchedule<4> dut;
+
+	ASSERT_TRUE(dut.add(fast, CAN_TX_SLOT_MS, 0, "fast"));
+	ASSERT_TRUE(dut.add(slow, 1000, 250, "slow"));
+	// shorter than a slot still goes out every slot
+	ASSERT_TRUE(dut.add(other, 1, 0, "other"));
+
+	EXPECT_EQ(1, dut.get(0).period);
+	EXPECT_EQ(100, dut.get(1).period);
+	EXPECT_EQ(25, dut.get(1).phase);
+	EXPECT_EQ(1, dut.get(2).period);
+
+	// first 25 slots: nothing slow yet
+	for (int i = 0; i < 25; i++) {
+		dut.onSlot();
+	}
+	EXPECT_EQ(25, fastCount);
+	EXPECT_EQ(0, slowCount);
+
+	// slot 25 is the slow one
+	EXPECT_EQ(3u, dut.onSlot());
+	EXPECT_EQ(1, slowCount);
+
+	// one simulated second later
+	for (int i = 0; i < 100; i++) {
+		dut.onSlot();
+	}
+	EXPECT_EQ(126, fastCount);
+	EXPECT_EQ(2, slowCount);
+	EXPECT_EQ(126, otherCount);
+	EXPECT_EQ(2u, dut.get(1).runs);
+}
+
+TEST(CanTxSchedule, autoPhaseSpreadsLoad) {
+	CanTxSchedule<16> dut;
+
+	// sent together like before, 50ms frames would pile up in one slot out of five
+	for (int i = 0; i < 5; i++) {
+		ASSERT_TRUE(dut.add(fast, 50, CAN_TX_AUTO_PHASE, "50ms"));
+	}
+	// 100Hz critical frame next to them
+	ASSERT_TRUE(dut.add(fast, 10, CAN_TX_AUTO_PHASE, "10ms"));
+	// a 1Hz status frame, then a 20Hz one
+	ASSERT_TRUE(dut.add(slow, 1000, CAN_TX_AUTO_PHASE, "1s"));
+	ASSERT_TRUE(dut.add(slow, 50, CAN_TX_AUTO_PHASE, "50ms again"));
+
+	// each of the five 50ms frames got its own slot
+	for (int i = 0; i < 5; i++) {
+		EXPECT_EQ(i, dut.get(i).phase);
+	}
+
+	size_t maxLoad = 0;
+	size_t total = 0;
+	for (uint32_t slot = 0; slot < 100; slot++) {
+		maxLoad = std::max(maxLoad, dut.getLoad(slot));
+		total += dut.getLoad(slot);
+	}
+
+	// 100 + 5 * 20 + 1 + 20 frames per second
+	EXPECT_EQ(221u, total);
+	// every slot has the 10ms frame plus one 50ms frame, the two extra frames share with
+	// nothing else
+	EXPECT_EQ(3u, maxLoad);
+
+	// all at phase 0 would put seven frames in one slot
+	CanTxSchedule<16> naive;
+	for (int i = 0; i < 6; i++) {
+		naive.add(fast, 50, 0, "50ms");
+	}
+	naive.add(fast, 10, 0, "10ms");
+	EXPECT_EQ(7u, naive.getLoad(0));
+}
+
+TEST(CanTxSchedule, full) {
+	CanTxSchedule<1> dut;
+	EXPECT_TRUE(dut.add(fast, 10, 0, "a"));
+	EXPECT_FALSE(dut.add(fast, 10, 0, "b"));
+	EXPECT_EQ(1u, dut.getCount());
+}
@@ -0,0 +1,302 @@
+#include "config_journal.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// stm32f4 datasheet, x32 parallelism: 128K sector erase and 32 bit word program, typical
+#define SECTOR_ERASE_US 1000000
+#define WORD_PROGRAM_US 16
+
+/**
+ * Flash in RAM: erase sets bits, programming can only clear them and a word can only be programmed
+ * once between erases. Keeps track of how long the real thing would have been busy.
+ */
+class RamFlashRegion final : public FlashRegion {
+public:
+	RamFlashRegion()
+		: image(CONFIG_JOURNAL_REGION_SIZE, 0xFF)
+		, isProgrammed(CONFIG_JOURNAL_REGION_SIZE / CONFIG_JOURNAL_WRITE_ALIGN)
+	{
+	}
+
+	size_t getSize() const override {
+		return image.size();
+	}
+
+	bool read(size_t offset, void *buffer, size_t size) override {
+		EXPECT_LE(offset + size, image.size());
+		memcpy(buffer, &image[offset], size);
+		return true;
+	}
+
+	bool write(size_t offset, const void *buffer, size_t size) override {
+		EXPECT_LE(offset + size, image.size());
+		EXPECT_EQ(0u, offset % CONFIG_JOURNAL_WRITE_ALIGN);
+		// the whole last word is programmed whatever the size, on stm32h7 from past the buffer
+		EXPECT_EQ(0u, size % CONFIG_JOURNAL_WRITE_ALIGN);
+
+		for (size_t word = offset / CONFIG_JOURNAL_WRITE_ALIGN; word * CONFIG_JOURNAL_WRITE_ALIGN < offset + size; word++) {
+			if (isProgrammed[word]) {
+				ADD_FAILURE() << "programming word at " << word * CONFIG_JOURNAL_WRITE_ALIGN << " again";
+				return false;
+			}
+		}
+
+		const uint8_t *data = reinterpret_cast<const uint8_t*>(buffer);
+		for (size_t i = 0; i < size; i++) {
+			if (powerLossAfterBytes == 0) {
+				return false;
+			}
+			if (powerLossAfterBytes > 0) {
+				powerLossAfterBytes--;
+			}
+
+			// a word is spoiled as soon as programming it starts
+			isProgrammed[(offset + i) / CONFIG_JOURNAL_WRITE_ALIGN] = true;
+			image[offset + i] &= data[i];
+		}
+
+		busyUs += (size + 3) / 4 * WORD_PROGRAM_US;
+		return true;
+	}
+
+	bool erase() override {
+		memset(image.data(), 0xFF, image.size());
+		std::fill(isProgrammed.begin(), isProgrammed.end(), false);
+		eraseCount++;
+		busyUs += SECTOR_ERASE_US;
+		return true;
+	}
+
+	std::vector<uint8_t> image;
+	std::vector<bool> isProgrammed;
+	int eraseCount = 0;
+	int64_t busyUs = 0;
+	// -1 for never
+	int powerLossAfterBytes = -1;
+};
+
+static std::vector<uint8_t> makeTune() {
+	std::vector<uint8_t> tune(sizeof(persistent_config_s));
+	for (size_t i = 0; i < tune.size(); i++) {
+		tune[i] = i * 7 + (i >> 8);
+	}
+	return tune;
+}
+
+static std::vector<uint8_t> replay(RamFlashRegion &first, RamFlashRegion &second, persisted_configuration_state_e expected = PC_OK) {
+	ConfigJournal journal(first, second);
+	std::vector<uint8_t> image(sizeof(persistent_config_s));
+	EXPECT_EQ(expected, journal.replay(image.data(), image.size(), FLASH_DATA_VERSION));
+	return image;
+}
+
+TEST(ConfigJournal, burnAndReplay) {
+	RamFlashRegion first;
+	RamFlashRegion second;
+	ConfigJournal journal(first, second);
+
+	std::vector<uint8_t> tune = makeTune();
+	std::vector<uint8_t> image(tune.size());
+	EXPECT_EQ(CRC_FAILED, journal.replay(image.data(), image.size(), FLASH_DATA_VERSION));
+
+	// the first burn writes the snapshot
+	ASSERT_TRUE(journal.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+	EXPECT_EQ(0, journal.getActiveRegion());
+	EXPECT_EQ(1u, journal.getRecordCount());
+	EXPECT_EQ(tune, replay(first, second));
+
+	// one cell, one chunk
+	size_t usedBefore = journal.getUsedBytes();
+	tune[5000] ^= 0x55;
+	ASSERT_TRUE(journal.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+	EXPECT_EQ(2u, journal.getRecordCount());
+	// 20 byte record header padded to a flash word
+	size_t headerSize = (20 + CONFIG_JOURNAL_WRITE_ALIGN - 1) / CONFIG_JOURNAL_WRITE_ALIGN * CONFIG_JOURNAL_WRITE_ALIGN;
+	EXPECT_EQ(headerSize + CONFIG_JOURNAL_CHUNK_SIZE, journal.getUsedBytes() - usedBefore);
+
+	// two cells in neighbouring chunks make one record, the last partial chunk another
+	tune[5120] ^= 0x55;
+	tune[5376] ^= 0x55;
+	tune[tune.size() - 1] ^= 0x55;
+	ASSERT_TRUE(journal.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+	EXPECT_EQ(4u, journal.getRecordCount());
+
+	// nothing changed, nothing written
+	usedBefore = journal.getUsedBytes();
+	ASSERT_TRUE(journal.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+	EXPECT_EQ(usedBefore, journal.getUsedBytes());
+
+	EXPECT_EQ(tune, replay(first, second));
+	EXPECT_EQ(1, first.eraseCount);
+	EXPECT_EQ(0, second.eraseCount);
+}
+
+TEST(ConfigJournal, compactsIntoTheOtherRegion) {
+	RamFlashRegion first;
+	RamFlashRegion second;
+	ConfigJournal journal(first, second);
+
+	std::vector<uint8_t> tune = makeTune();
+	ASSERT_TRUE(journal.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+
+	int burnsPerErase = 0;
+	for (int i = 0; i < 2000; i++) {
+		tune[(i * 997) % tune.size()]++;
+		ASSERT_TRUE(journal.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+
+		if (burnsPerErase == 0 && journal.getCompactionCount() == 2) {
+			burnsPerErase = i + 1;
+		}
+
+		// whatever happens to power after this burn, this is what we boot with
+		if (i % 97 == 0) {
+			ASSERT_EQ(tune, replay(first, second));
+		}
+	}
+	EXPECT_EQ(tune, replay(first, second));
+
+	// regions take turns
+	EXPECT_LE(abs(first.eraseCount - second.eraseCount), 1);
+	int erases = first.eraseCount + second.eraseCount;
+	printf("Config journal: %d burns per erase, %d erases for 2000 burns (4000 before)\n", burnsPerErase, erases);
+	EXPECT_GT(burnsPerErase, 300);
+	EXPECT_LT(erases, 20);
+}
+
+TEST(ConfigJournal, interruptedBurn) {
+	RamFlashRegion first;
+	RamFlashRegion second;
+	ConfigJournal journal(first, second);
+
+	std::vector<uint8_t> tune = makeTune();
+	ASSERT_TRUE(journal.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+	tune[100]++;
+	ASSERT_TRUE(journal.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+	std::vector<uint8_t> good = tune;
+
+	// power goes away half way through the next record
+	tune[3000]++;
+	first.powerLossAfterBytes = 100;
+	second.powerLossAfterBytes = 0;
+	EXPECT_FALSE(journal.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+	first.powerLossAfterBytes = -1;
+	second.powerLossAfterBytes = -1;
+
+	// back on: the torn record is ignored, the next burn starts over in the other region
+	{
+		ConfigJournal rebooted(first, second);
+		std::vector<uint8_t> image(tune.size());
+		ASSERT_EQ(PC_OK, rebooted.replay(image.data(), image.size(), FLASH_DATA_VERSION));
+		EXPECT_EQ(good, image);
+
+		ASSERT_TRUE(rebooted.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+		EXPECT_EQ(1, rebooted.getActiveRegion());
+		EXPECT_EQ(tune, replay(first, second));
+	}
+
+	// power goes away while writing the snapshot: the first region still has the old journal
+	ConfigJournal journal2(first, second);
+	std::vector<uint8_t> image(tune.size());
+	ASSERT_EQ(PC_OK, journal2.replay(image.data(), image.size(), FLASH_DATA_VERSION));
+	good = tune;
+	for (int i = 0; journal2.getActiveRegion() == 1; i++) {
+		tune[i * 300 % tune.size()]++;
+		first.powerLossAfterBytes = 5000;
+		bool isOk = journal2.burn(tune.data(), tune.size(), FLASH_DATA_VERSION);
+		first.powerLossAfterBytes = -1;
+		if (!isOk) {
+			break;
+		}
+		good = tune;
+	}
+	EXPECT_EQ(good, replay(first, second));
+}
+
+TEST(ConfigJournal, interruptedBurnBetweenRecords) {
+	RamFlashRegion first;
+	RamFlashRegion second;
+	ConfigJournal journal(first, second);
+
+	std::vector<uint8_t> tune = makeTune();
+	ASSERT_TRUE(journal.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+	std::vector<uint8_t> good = tune;
+
+	// two chunks far apart, two records. Power goes away right after the first one is complete
+	tune[100]++;
+	tune[3000]++;
+	size_t headerSize = (20 + CONFIG_JOURNAL_WRITE_ALIGN - 1) / CONFIG_JOURNAL_WRITE_ALIGN * CONFIG_JOURNAL_WRITE_ALIGN;
+	first.powerLossAfterBytes = headerSize + CONFIG_JOURNAL_CHUNK_SIZE;
+	second.powerLossAfterBytes = 0;
+	EXPECT_FALSE(journal.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+	first.powerLossAfterBytes = -1;
+	second.powerLossAfterBytes = -1;
+
+	// the record made it with a good CRC but the burn has no commit: none of it is applied
+	ConfigJournal rebooted(first, second);
+	std::vector<uint8_t> image(tune.size());
+	ASSERT_EQ(PC_OK, rebooted.replay(image.data(), image.size(), FLASH_DATA_VERSION));
+	EXPECT_EQ(good, image);
+	EXPECT_EQ(1u, rebooted.getRecordCount());
+
+	// the region holds the records of the dropped burn, the next burn starts over in the other one
+	ASSERT_TRUE(rebooted.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+	EXPECT_EQ(1, rebooted.getActiveRegion());
+	EXPECT_EQ(tune, replay(first, second));
+}
+
+TEST(ConfigJournal, versionChange) {
+	RamFlashRegion first;
+	RamFlashRegion second;
+	ConfigJournal journal(first, second);
+
+	std::vector<uint8_t> tune = makeTune();
+	ASSERT_TRUE(journal.burn(tune.data(), tune.size(), FLASH_DATA_VERSION - 1));
+
+	ConfigJournal upgraded(first, second);
+	std::vector<uint8_t> image(tune.size());
+	EXPECT_EQ(INCOMPATIBLE_VERSION, upgraded.replay(image.data(), image.size(), FLASH_DATA_VERSION));
+
+	// a fresh snapshot in the other region, the old one is left alone
+	ASSERT_TRUE(upgraded.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+	EXPECT_EQ(1, upgraded.getActiveRegion());
+	EXPECT_EQ(1, first.eraseCount);
+	EXPECT_EQ(tune, replay(first, second));
+}
+
+TEST(ConfigJournal, burnLatency) {
+	RamFlashRegion first;
+	RamFlashRegion second;
+	ConfigJournal journal(first, second);
+
+	std::vector<uint8_t> tune = makeTune();
+	ASSERT_TRUE(journal.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+
+	// fill the region with one cell burns
+	int64_t busyUs = 0;
+	int burns = 0;
+	while (journal.getCompactionCount() == 1) {
+		tune[(burns * 331) % tune.size()]++;
+		int64_t before = first.busyUs + second.busyUs;
+		ASSERT_TRUE(journal.burn(tune.data(), tune.size(), FLASH_DATA_VERSION));
+		busyUs += first.busyUs + second.busyUs - before;
+		burns++;
+	}
+
+	// what writeToFlashNow used to do every time: erase and program both copies
+	int64_t legacyUs = 2 * (SECTOR_ERASE_US + (sizeof(persistent_config_container_s) + 3) / 4 * WORD_PROGRAM_US);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	const int replays = 20;
+	for (int i = 0; i < replays; i++) {
+		replay(first, second);
+	}
+	auto replayUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count() / replays;
+
+	int64_t averageUs = busyUs / burns;
+	printf("Config burn: %.1fms average over %d burns including compaction, %.1fms before. Full region replay %dus on this host\n",
+			averageUs / 1000.0, burns, legacyUs / 1000.0, (int)replayUs);
+	EXPECT_LT(averageUs * 50, legacyUs);
+}
@@ -0,0 +1,218 @@
+#include "global.h"
+#include "deferred_log.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(DeferredLog, formatLater) {
+	DeferredLog log;
+	char text[100];
+
+	EXPECT_EQ(-1, log.formatNext(text, sizeof(text)));
+
+	char name[] = "tps";
+	ASSERT_TRUE(log.add("%s=%d %.2f%% 0x%x", name, -12, 45.678, 255));
+	ASSERT_TRUE(log.add("no arguments"));
+	// string arguments are copied, the caller's buffer can go away
+	strcpy(name, "map");
+
+	EXPECT_EQ(19, log.formatNext(text, sizeof(text)));
+	EXPECT_STREQ("tps=-12 45.68% 0xff", text);
+	EXPECT_EQ(12, log.formatNext(text, sizeof(text)));
+	EXPECT_STREQ("no arguments", text);
+	EXPECT_EQ(-1, log.formatNext(text, sizeof(text)));
+
+	// the text is cut to the output buffer
+	ASSERT_TRUE(log.add("rpm %d", 6000));
+	char small[6];
+	EXPECT_EQ(5, log.formatNext(small, sizeof(small)));
+	EXPECT_STREQ("rpm 6", small);
+}
+
+TEST(DeferredLog, argumentsDoNotFit) {
+	DeferredLog log;
+	char text[200];
+
+	char longName[DEFERRED_LOG_ARGS_SIZE + 20];
+	memset(longName, 'a', sizeof(longName) - 1);
+	longName[sizeof(longName) - 1] = 0;
+
+	ASSERT_TRUE(log.add("%d %s %d", 1, longName, 2));
+	ASSERT_TRUE(log.formatNext(text, sizeof(text)) > 0);
+
+	// the first argument and as much of the string as fit, then nothing after it
+	EXPECT_EQ(0, strncmp("1 aaaa", text, 6));
+	EXPECT_EQ(0, strcmp("...", text + strlen(text) - 3));
+	EXPECT_EQ(nullptr, strstr(text, " 2"));
+	EXPECT_EQ(1u, log.getTruncatedCount());
+}
+
+TEST(DeferredLog, dropWhenFull) {
+	DeferredLog log;
+	char text[50];
+
+	for (int i = 0; i < DEFERRED_LOG_SLOTS; i++) {
+		ASSERT_TRUE(log.add("m%d", i));
+	}
+	EXPECT_FALSE(log.add("m%d", 1000));
+	EXPECT_FALSE(log.add("m%d", 1001));
+	EXPECT_EQ(2u, log.getDroppedCount());
+
+	// what made it in comes out, the dropped ones do not
+	ASSERT_TRUE(log.formatNext(text, sizeof(text)) > 0);
+	EXPECT_STREQ("m0", text);
+	ASSERT_TRUE(log.add("m%d", 1002));
+
+	for (int i = 1; i < DEFERRED_LOG_SLOTS; i++) {
+		ASSERT_TRUE(log.formatNext(text, sizeof(text)) > 0);
+		char expected[10];
+		sprintf(expected, "m%d", i);
+		EXPECT_STREQ(expected, text);
+	}
+	ASSERT_TRUE(log.formatNext(text, sizeof(text)) > 0);
+	EXPECT_STREQ("m1002", text);
+	EXPECT_EQ(-1, log.formatNext(text, sizeof(text)));
+	EXPECT_EQ(2u, log.getDroppedCount());
+}
+
+TEST(DeferredLog, interleavedProducersKeepOrder) {
+	DeferredLog log;
+
+	// one context after the other, several times around the ring
+	char text[50];
+	for (int i = 0; i < 5 * DEFERRED_LOG_SLOTS; i++) {
+		ASSERT_TRUE(log.add("p%d %d", i % 3, i));
+		ASSERT_TRUE(log.add("p%d %d", 3, i));
+		ASSERT_TRUE(log.formatNext(text, sizeof(text)) > 0);
+		int producer, sequence;
+		ASSERT_EQ(2, sscanf(text, "p%d %d", &producer, &sequence));
+		EXPECT_EQ(i % 3, producer);
+		EXPECT_EQ(i, sequence);
+		ASSERT_TRUE(log.formatNext(text, sizeof(text)) > 0);
+		ASSERT_EQ(2, sscanf(text, "p%d %d", &producer, &sequence));
+		EXPECT_EQ(3, producer);
+		EXPECT_EQ(i, sequence);
+	}
+}
+
+TEST(DeferredLog, concurrentProducers) {
+	DeferredLog log;
+
+	constexpr int producerCount = 4;
+	constexpr int messageCount = 20000;
+
+	std::atomic<int> running(producerCount);
+	std::thread producers[producerCount];
+	for (int p = 0; p < producerCount; p++) {
+		producers[p] = std::thread([&log, &running, p]() {
+			for (int i = 0; i < messageCount; i++) {
+				log.add("p%d %d", p, i);
+			}
+			running--;
+		});
+	}
+
+	// consumer on this thread while they go
+	int next[producerCount] = {};
+	int received = 0;
+	char text[50];
+	while (true) {
+		bool isDone = running == 0;
+		int length = log.formatNext(text, sizeof(text));
+		if (length < 0) {
+			if (isDone) {
+				break;
+			}
+			std::this_thread::yield();
+			continue;
+		}
+
+		int producer, sequence;
+		ASSERT_EQ(2, sscanf(text, "p%d %d", &producer, &sequence)) << text;
+		ASSERT_TRUE(producer >= 0 && producer < producerCount);
+		// a producer's messages come out in the order it added them, some may be dropped
+		ASSERT_TRUE(sequence >= next[producer]) << text;
+		next[producer] = sequence + 1;
+		received++;
+	}
+
+	for (auto& producer : producers) {
+		producer.join();
+	}
+
+	// nothing goes missing without being counted
+	EXPECT_EQ(producerCount * messageCount, received + (int)log.getDroppedCount());
+}
+
+TEST(DeferredLog, concurrentConsumers) {
+	DeferredLog log;
+
+	constexpr int producerCount = 2;
+	constexpr int consumerCount = 2;
+	constexpr int messageCount = 20000;
+
+	std::atomic<int> running(producerCount);
+	std::thread producers[producerCount];
+	for (int p = 0; p < producerCount; p++) {
+		producers[p] = std::thread([&log, &running, p]() {
+			for (int i = 0; i < messageCount; i++) {
+				log.add("p%d %d", p, i);
+			}
+			running--;
+		});
+	}
+
+	// like the TunerStudio and the console thread both sending text out
+	std::vector<int> received[consumerCount][producerCount];
+	std::thread consumers[consumerCount];
+	for (int c = 0; c < consumerCount; c++) {
+		consumers[c] = std::thread([&log, &running, &received, c]() {
+			char text[50];
+			while (true) {
+				bool isDone = running == 0;
+				if (log.formatNext(text, sizeof(text)) < 0) {
+					if (isDone) {
+						break;
+					}
+					std::this_thread::yield();
+					continue;
+				}
+				int producer, sequence;
+				if (sscanf(text, "p%d %d", &producer, &sequence) == 2 && producer >= 0 && producer < producerCount) {
+					received[c][producer].push_back(sequence);
+				}
+			}
+		});
+	}
+
+	for (auto& producer : producers) {
+		producer.join();
+	}
+	for (auto& consumer : consumers) {
+		consumer.join();
+	}
+
+	// whatever is left after both consumers gave up
+	char text[50];
+	EXPECT_EQ(-1, log.formatNext(text, sizeof(text)));
+
+	// every message came out once, none twice and none lost without being counted
+	int receivedCount = 0;
+	for (int p = 0; p < producerCount; p++) {
+		std::vector<bool> isSeen(messageCount);
+		for (int c = 0; c < consumerCount; c++) {
+			int previous = -1;
+			for (int sequence : received[c][p]) {
+				ASSERT_TRUE(sequence >= 0 && sequence < messageCount);
+				EXPECT_FALSE(isSeen[sequence]) << "p" << p << " " << sequence;
+				isSeen[sequence] = true;
+				// in order as seen by either consumer
+				EXPECT_TRUE(sequence > previous);
+				previous = sequence;
+				receivedCount++;
+			}
+		}
+	}
+	EXPECT_EQ(producerCount * messageCount, receivedCount + (int)log.getDroppedCount());
+}
@@ -0,0 +1,84 @@
+#include "global.h"
+#include "engine_sniffer_events.h"
+
+#include <gtest/gtest.h>
+
+TEST(EngineSniffer, formatAtPublish) {
+	SnifferEvent storage[10];
+	EngineSnifferEvents events(storage, efi::size(storage));
+
+	// engine sniffer time units
+	auto at = [](int units) {
+		return (uint32_t)US2NT(units * ENGINE_SNIFFER_UNIT_US);
+	};
+
+	ASSERT_TRUE(events.add("r", "", 3000, at(0)));
+	ASSERT_TRUE(events.add(PROTOCOL_CRANK1, PROTOCOL_ES_UP, 12, at(15)));
+	ASSERT_TRUE(events.add("c1", PROTOCOL_ES_UP, SNIFFER_NO_VALUE, at(120)));
+	ASSERT_TRUE(events.add("c1", PROTOCOL_ES_DOWN, SNIFFER_NO_VALUE, at(420)));
+	EXPECT_EQ(4u, events.getCount());
+
+	char buffer[200];
+	Logging logging("test", buffer, sizeof(buffer));
+	EXPECT_EQ(4u, events.format(logging, events.getCount()));
+	EXPECT_STREQ("r!3000!0!t1!u_12!15!c1!u!120!c1!d!420!", buffer);
+
+	// a short buffer takes the events which fit as a whole
+	char small[21];
+	Logging shortLogging("test", small, sizeof(small));
+	EXPECT_EQ(2u, events.format(shortLogging, events.getCount()));
+	EXPECT_STREQ("r!3000!0!t1!u_12!15!", small);
+
+	// room kept for what goes after the events
+	Logging reservedLogging("test", small, sizeof(small));
+	EXPECT_EQ(1u, events.format(reservedLogging, events.getCount(), 1));
+	EXPECT_STREQ("r!3000!0!", small);
+
+	events.reset();
+	EXPECT_EQ(0u, events.getCount());
+}
+
+TEST(EngineSniffer, formatInPlace) {
+	// like the chart buffer: binary events in the tail of the text
+	union {
+		char text[100];
+		SnifferEvent events[100 / sizeof(SnifferEvent)];
+	} buffer;
+	const size_t count = 4;
+	EngineSnifferEvents events(buffer.events + efi::size(buffer.events) - count, count);
+
+	auto at = [](int units) {
+		return (uint32_t)US2NT(units * ENGINE_SNIFFER_UNIT_US);
+	};
+	ASSERT_TRUE(events.add("r", "", 3000, at(0)));
+	ASSERT_TRUE(events.add(PROTOCOL_CRANK1, PROTOCOL_ES_UP, 12, at(15)));
+	ASSERT_TRUE(events.add("c1", PROTOCOL_ES_UP, SNIFFER_NO_VALUE, at(120)));
+	ASSERT_TRUE(events.add("c1", PROTOCOL_ES_DOWN, SNIFFER_NO_VALUE, at(420)));
+
+	Logging logging("test", buffer.text, sizeof(buffer.text));
+	logging.append(PROTOCOL_ENGINE_SNIFFER DELIMETER);
+	EXPECT_EQ(4u, events.format(logging, events.getCount(), 1));
+	EXPECT_STREQ("wave_chart,r!3000!0!t1!u_12!15!c1!u!120!c1!d!420!", buffer.text);
+
+	// with long names the text catches up with the events which are still binary
+	events.reset();
+	for (size_t i = 0; i < count; i++) {
+		ASSERT_TRUE(events.add("a_long_channel_name", PROTOCOL_ES_UP, 12345, at(1000 + i)));
+	}
+	logging.reset();
+	size_t formatted = events.format(logging, events.getCount());
+	EXPECT_LT(formatted, count);
+	EXPECT_GT(formatted, 0u);
+	// what made it is intact
+	EXPECT_EQ(0, strncmp("a_long_channel_name!u_12345!1000!", buffer.text, 33));
+}
+
+TEST(EngineSniffer, capacity) {
+	SnifferEvent storage[100];
+	EngineSnifferEvents events(storage, efi::size(storage));
+	for (int i = 0; i < 100; i++) {
+		ASSERT_TRUE(events.add("c1", PROTOCOL_ES_UP, SNIFFER_NO_VALUE, i));
+	}
+	EXPECT_FALSE(events.add("c1", PROTOCOL_ES_DOWN, SNIFFER_NO_VALUE, 0));
+	EXPECT_EQ(100u, events.getCount());
+}
@@ -0,0 +1,244 @@
+#include "engine_test_helper.h"
+#include "knock_controller.h"
+#include "spark_logic.h"
+
+#include <chrono>
+
+TEST(KnockController, retardStepAndLimit) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	engineConfiguration->knockRetardStep = 3;
+	engineConfiguration->enableKnockControl = true;
+	engineConfiguration->maxKnockSubDeg = 8;
+
+	KnockController dut;
+	INJECT_ENGINE_REFERENCE(&dut);
+
+	dut.onKnockSense(1, false);
+	EXPECT_EQ(0, dut.getRetard(1));
+
+	dut.onKnockSense(1, true);
+	EXPECT_FLOAT_EQ(3, dut.getRetard(1));
+	dut.onKnockSense(1, true);
+	EXPECT_FLOAT_EQ(6, dut.getRetard(1));
+	// limited to max
+	dut.onKnockSense(1, true);
+	EXPECT_FLOAT_EQ(8, dut.getRetard(1));
+
+	// other cylinders untouched
+	EXPECT_EQ(0, dut.getRetard(0));
+	EXPECT_EQ(0, dut.getRetard(2));
+	EXPECT_FLOAT_EQ(8, dut.getMaxRetard());
+
+	// out of range is ignored
+	dut.onKnockSense(IGNITION_PIN_COUNT, true);
+	EXPECT_EQ(0, dut.getRetard(IGNITION_PIN_COUNT));
+
+	// without a max there is no knock control
+	engineConfiguration->maxKnockSubDeg = 0;
+	dut.reset();
+	dut.onKnockSense(0, true);
+	EXPECT_EQ(0, dut.getRetard(0));
+}
+
+TEST(KnockController, offUnlessEnabled) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	// off by default, even with a retard limit like HIP9011 boards have
+	EXPECT_FALSE(engineConfiguration->enableKnockControl);
+	engineConfiguration->knockRetardStep = 3;
+	engineConfiguration->maxKnockSubDeg = 20;
+
+	KnockController dut;
+	INJECT_ENGINE_REFERENCE(&dut);
+
+	dut.onKnockSense(1, true);
+	dut.onKnockSenseAllCylinders(true);
+	EXPECT_EQ(0, dut.getRetard(1));
+	EXPECT_EQ(0, dut.getMaxRetard());
+
+	engineConfiguration->enableKnockControl = true;
+	dut.onKnockSense(1, true);
+	EXPECT_FLOAT_EQ(3, dut.getRetard(1));
+
+	// switching it off gives the timing back right away
+	engineConfiguration->enableKnockControl = false;
+	EXPECT_EQ(0, dut.getRetard(1));
+	EXPECT_EQ(0, dut.getMaxRetard());
+}
+
+TEST(KnockController, recovery) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	engineConfiguration->knockRetardStep = 4;
+	engineConfiguration->knockRetardRecoveryRate = 2;
+	engineConfiguration->enableKnockControl = true;
+	engineConfiguration->maxKnockSubDeg = 10;
+
+	KnockController dut;
+	INJECT_ENGINE_REFERENCE(&dut);
+
+	efitick_t nowNt = 0;
+	dut.update(nowNt);
+
+	dut.onKnockSense(0, true);
+
+	// 5ms fast callback for one second adds back 2 degrees
+	for (int i = 0; i < 200; i++) {
+		nowNt += MS2NT(5);
+		dut.update(nowNt);
+	}
+	EXPECT_NEAR(2, dut.getRetard(0), 1e-3);
+
+	// a long stall of the fast callback does not restore everything at once
+	nowNt += MS2NT(5000);
+	dut.update(nowNt);
+	EXPECT_NEAR(1.8, dut.getRetard(0), 1e-3);
+
+	// never below zero
+	for (int i = 0; i < 1000; i++) {
+		nowNt += MS2NT(5);
+		dut.update(nowNt);
+	}
+	EXPECT_EQ(0, dut.getRetard(0));
+
+	// lowering the limit applies right away
+	dut.onKnockSense(0, true);
+	dut.onKnockSense(0, true);
+	engineConfiguration->maxKnockSubDeg = 5;
+	dut.update(nowNt);
+	EXPECT_FLOAT_EQ(5, dut.getRetard(0));
+}
+
+TEST(KnockController, hipAndCdmRetardAllCylinders) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	engineConfiguration->knockRetardStep = 2;
+	engineConfiguration->enableKnockControl = true;
+	engineConfiguration->maxKnockSubDeg = 10;
+	engineConfiguration->knockVThreshold = 3;
+
+	// below threshold
+	engine->knockLogic(2.5 PASS_ENGINE_PARAMETER_SUFFIX);
+	EXPECT_EQ(0, engine->knockController.getMaxRetard());
+
+	// HIP9011, CDM and external knock inputs don't know the cylinder
+	engine->knockLogic(3.5 PASS_ENGINE_PARAMETER_SUFFIX);
+	for (int i = 0; i < engineConfiguration->specs.cylindersCount; i++) {
+		EXPECT_FLOAT_EQ(2, engine->knockController.getRetard(i));
+	}
+}
+
+TEST(KnockController, appliedToSparkAngle) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	engineConfiguration->knockRetardStep = 3;
+	engineConfiguration->enableKnockControl = true;
+	engineConfiguration->maxKnockSubDeg = 10;
+
+	engine->engineState.timingAdvance = 10;
+	initializeIgnitionActions(PASS_ENGINE_PARAMETER_SIGNATURE);
+
+	IgnitionEvent &knocking = engine->ignitionEvents.elements[1];
+	// wasted spark shares a coil between two events, look for one on another coil
+	int quietIndex = 0;
+	while (engine->ignitionEvents.elements[quietIndex].cylinderNumber == knocking.cylinderNumber) {
+		quietIndex++;
+	}
+	IgnitionEvent &quiet = engine->ignitionEvents.elements[quietIndex];
+	float knockingBefore = knocking.sparkAngle;
+	float quietBefore = quiet.sparkAngle;
+
+	// knock is reported for the physical cylinder the event fired
+	engine->knockController.onKnockSense(knocking.cylinderNumber, true);
+	initializeIgnitionActions(PASS_ENGINE_PARAMETER_SIGNATURE);
+
+	// retard moves the spark later
+	EXPECT_FLOAT_EQ(knockingBefore + 3, knocking.sparkAngle);
+	EXPECT_FLOAT_EQ(quietBefore, quiet.sparkAngle);
+}
+
+/**
+ * Simulated engine at 3000 rpm where cylinder 3 starts knocking above 20 degrees of advance
+ * while the map asks for 26. The loop should settle a step wide band around 6 degrees of retard
+ * for that cylinder only.
+ */
+TEST(KnockController, convergesOnKnockLimit) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	engineConfiguration->knockRetardStep = 2;
+	engineConfiguration->knockRetardRecoveryRate = 1;
+	engineConfiguration->enableKnockControl = true;
+	engineConfiguration->maxKnockSubDeg = 15;
+
+	KnockController dut;
+	INJECT_ENGINE_REFERENCE(&dut);
+
+	constexpr float baseAdvance = 26;
+	constexpr float knockLimit = 20;
+	constexpr int cylinders = 4;
+	constexpr int knockingCylinder = 2;
+
+	// 3000 rpm 4 cylinder: one combustion every 10ms, fast callback every 5ms
+	efitick_t nowNt = 0;
+	float minRetard = 100;
+	float maxRetard = 0;
+	int events = 0;
+	int knocks = 0;
+
+	for (int ms = 0; ms < 30000; ms += 5) {
+		nowNt = MS2NT(ms);
+		dut.update(nowNt);
+
+		if (ms % 10 == 0) {
+			int cylinder = (ms / 10) % cylinders;
+			bool knock = cylinder == knockingCylinder && baseAdvance - dut.getRetard(cylinder) > knockLimit;
+			dut.onKnockSense(cylinder, knock);
+
+			events++;
+			knocks += knock;
+		}
+
+		// after settling
+		if (ms > 10000) {
+			minRetard = minF(minRetard, dut.getRetard(knockingCylinder));
+			maxRetard = maxF(maxRetard, dut.getRetard(knockingCylinder));
+		}
+	}
+
+	EXPECT_GT(minRetard, baseAdvance - knockLimit - 0.1f);
+	EXPECT_LT(maxRetard, baseAdvance - knockLimit + engineConfiguration->knockRetardStep + 0.1f);
+
+	// at 1 deg/s recovery and 2 deg steps, settled it knocks about every 2 seconds
+	EXPECT_NEAR(15, knocks, 4);
+
+	for (int i = 0; i < cylinders; i++) {
+		if (i != knockingCylinder) {
+			EXPECT_EQ(0, dut.getRetard(i));
+		}
+	}
+
+	printf("Knock control: %d events, %d knocks, settled retard %.2f..%.2f\n", events, knocks, minRetard, maxRetard);
+}
+
+TEST(KnockController, costPerEvent) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	engineConfiguration->knockRetardStep = 2;
+	engineConfiguration->enableKnockControl = true;
+	engineConfiguration->maxKnockSubDeg = 15;
+
+	KnockController dut;
+	INJECT_ENGINE_REFERENCE(&dut);
+
+	constexpr int count = 1000000;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < count; i++) {
+		dut.onKnockSense(i % 8, (i & 0x30) == 0);
+	}
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	printf("Knock control: %.1f ns per knock event\n", (float)ns / count);
+	EXPECT_FLOAT_EQ(15, dut.getMaxRetard());
+}
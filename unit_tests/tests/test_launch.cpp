@@ -125,7 +125,6 @@ TEST(LaunchControl, CombinedCondition) {
 }
 
 TEST(LaunchControl, CompleteRun) {
-	bool spark, fuel;
 	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
 
 	LoggingWithStorage logger("test");
@@ -152,11 +151,7 @@ TEST(LaunchControl, CompleteRun) {
     updateLaunchConditions(PASS_ENGINE_PARAMETER_SIGNATURE);
 
 	//check if we have some sort of cut? we should not have at this point
-	spark = false;
-	fuel = false;
-	applyLaunchControlLimiting(&spark, &fuel PASS_ENGINE_PARAMETER_SUFFIX);
-	EXPECT_FALSE(spark);
-	EXPECT_FALSE(fuel);
+	EXPECT_EQ(0, getLaunchCutPercent(GET_RPM() PASS_ENGINE_PARAMETER_SUFFIX));
 
 
 	engine->rpmCalculator.mockRpm = 3510;
@@ -167,28 +162,19 @@ TEST(LaunchControl, CompleteRun) {
 	//we have a 3 seconds delay to actually enable it!
 	eth.smartMoveTimeForwardSeconds(1);
 	updateLaunchConditions(PASS_ENGINE_PARAMETER_SIGNATURE);
-	spark = false;
-	fuel = false;
-	applyLaunchControlLimiting(&spark, &fuel PASS_ENGINE_PARAMETER_SUFFIX);
-	
-	EXPECT_FALSE(spark);
-	EXPECT_FALSE(fuel);
+	EXPECT_EQ(0, getLaunchCutPercent(GET_RPM() PASS_ENGINE_PARAMETER_SUFFIX));
 
 	eth.smartMoveTimeForwardSeconds(3);
 	updateLaunchConditions(PASS_ENGINE_PARAMETER_SIGNATURE);
-	spark = false;
-	fuel = false;
-	applyLaunchControlLimiting(&spark, &fuel PASS_ENGINE_PARAMETER_SUFFIX);
+	EXPECT_EQ(100, getLaunchCutPercent(GET_RPM() PASS_ENGINE_PARAMETER_SUFFIX));
 
-	EXPECT_TRUE(spark);
-	EXPECT_FALSE(fuel);
+	// default configuration cuts spark only
+	engine->limpManager.updateState(GET_RPM());
+	EXPECT_FALSE(engine->limpManager.allowIgnition());
+	EXPECT_TRUE(engine->limpManager.allowInjection());
 
 	setMockVehicleSpeed(40);
 	updateLaunchConditions(PASS_ENGINE_PARAMETER_SIGNATURE);
-	spark = false;
-	fuel = false;
-	applyLaunchControlLimiting(&spark, &fuel PASS_ENGINE_PARAMETER_SUFFIX);
-	EXPECT_FALSE(spark);
-	EXPECT_FALSE(fuel);
+	EXPECT_EQ(0, getLaunchCutPercent(GET_RPM() PASS_ENGINE_PARAMETER_SUFFIX));
 
 }
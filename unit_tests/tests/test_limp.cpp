@@ -74,3 +74,201 @@ TEST(limp, boostCut) {
 	dut.updateState(1000);
 	EXPECT_TRUE(dut.allowInjection());
 }
+
+TEST(limp, rollingCutPercent) {
+	// No window means hard cut
+	EXPECT_EQ(0, getRollingCutPercent(2500, 2500, 0));
+	EXPECT_EQ(100, getRollingCutPercent(2501, 2500, 0));
+
+	// 500 rpm window below the limit
+	EXPECT_EQ(0, getRollingCutPercent(1900, 2500, 500));
+	EXPECT_EQ(0, getRollingCutPercent(2000, 2500, 500));
+	EXPECT_FLOAT_EQ(50, getRollingCutPercent(2250, 2500, 500));
+	EXPECT_EQ(100, getRollingCutPercent(2500, 2500, 500));
+	EXPECT_EQ(100, getRollingCutPercent(3000, 2500, 500));
+}
+
+static int countCuts(const CutPattern& pattern, int cylinderCount) {
+	int result = 0;
+	for (int i = 0; i < cylinderCount; i++) {
+		result += pattern.isCut(i);
+	}
+	return result;
+}
+
+TEST(limp, cutPatternSpreadsAcrossCylinders) {
+	CutPattern dut;
+	dut.setTargetPercent(25);
+
+	int cutsPerCylinder[4] = {};
+
+	for (int cycle = 0; cycle < 40; cycle++) {
+		dut.onEngineCycle(4);
+
+		// one of four cylinders every cycle
+		EXPECT_EQ(1, countCuts(dut, 4));
+		EXPECT_EQ(25, dut.getActualPercent());
+
+		for (int i = 0; i < 4; i++) {
+			cutsPerCylinder[i] += dut.isCut(i);
+		}
+	}
+
+	// no cylinder gets all the cuts
+	for (int i = 0; i < 4; i++) {
+		EXPECT_EQ(10, cutsPerCylinder[i]);
+	}
+}
+
+TEST(limp, cutPatternFractionalRatio) {
+	CutPattern dut;
+	dut.setTargetPercent(30);
+
+	int totalCuts = 0;
+	for (int cycle = 0; cycle < 100; cycle++) {
+		dut.onEngineCycle(6);
+		int cuts = countCuts(dut, 6);
+
+		// error is carried over, so each cycle is within one event of the target
+		EXPECT_TRUE(cuts == 1 || cuts == 2);
+		totalCuts += cuts;
+	}
+
+	EXPECT_EQ(180, totalCuts);
+
+	dut.setTargetPercent(0);
+	dut.onEngineCycle(6);
+	EXPECT_EQ(0, countCuts(dut, 6));
+
+	dut.setTargetPercent(100);
+	dut.onEngineCycle(6);
+	EXPECT_EQ(6, countCuts(dut, 6));
+}
+
+TEST(limp, rollingRevLimit) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	engineConfiguration->rpmHardLimit = 2500;
+	engineConfiguration->rollingCutRpmWindow = 500;
+	engineConfiguration->cutFuelOnHardLimit = false;
+	engineConfiguration->cutSparkOnHardLimit = true;
+
+	LimpManager dut;
+	INJECT_ENGINE_REFERENCE(&dut);
+
+	// Half way into the window, half of the cylinders lose spark
+	dut.updateState(2250);
+	dut.onEngineCycle(4);
+	EXPECT_TRUE(dut.allowIgnition());
+	EXPECT_EQ(50, dut.getSparkCutRatio());
+	EXPECT_EQ(0, dut.getFuelCutRatio());
+
+	int sparkCuts = 0;
+	for (int i = 0; i < 4; i++) {
+		sparkCuts += !dut.allowIgnition(i);
+		EXPECT_TRUE(dut.allowInjection(i));
+	}
+	EXPECT_EQ(2, sparkCuts);
+
+	// Over the limit everything is cut
+	dut.updateState(2600);
+	dut.onEngineCycle(4);
+	EXPECT_FALSE(dut.allowIgnition());
+	EXPECT_EQ(100, dut.getSparkCutRatio());
+
+	// Below the window nothing is cut
+	dut.updateState(1900);
+	dut.onEngineCycle(4);
+	EXPECT_EQ(0, dut.getSparkCutRatio());
+	for (int i = 0; i < 4; i++) {
+		EXPECT_TRUE(dut.allowIgnition(i));
+	}
+}
+
+TEST(limp, cutPatternOncePerEngineCycle) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	engineConfiguration->rpmHardLimit = 2500;
+	engineConfiguration->rollingCutRpmWindow = 500;
+	engineConfiguration->cutSparkOnHardLimit = true;
+
+	LimpManager dut;
+	INJECT_ENGINE_REFERENCE(&dut);
+
+	// a quarter of the cylinders, the cut one moves on each engine cycle
+	dut.updateState(2125);
+
+	dut.updateEngineCycle(10, 4);
+	int cut = -1;
+	for (int i = 0; i < 4; i++) {
+		if (!dut.allowIgnition(i)) {
+			cut = i;
+		}
+	}
+	ASSERT_NE(-1, cut);
+
+	// every other trigger event of the same engine cycle keeps the pattern
+	for (int event = 0; event < 20; event++) {
+		dut.updateEngineCycle(10, 4);
+		EXPECT_FALSE(dut.allowIgnition(cut));
+	}
+
+	dut.updateEngineCycle(11, 4);
+	EXPECT_TRUE(dut.allowIgnition(cut));
+	EXPECT_EQ(25, dut.getSparkCutRatio());
+}
+
+TEST(limp, engineCycleCounterWithCrankTrigger) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	setOperationMode(engineConfiguration, FOUR_STROKE_CRANK_SENSOR);
+	engineConfiguration->useOnlyRisingEdgeForTrigger = true;
+	eth.setTriggerType(TT_ONE PASS_ENGINE_PARAMETER_SUFFIX);
+
+	eth.fireTriggerEvents2(/* count */ 4, 50 /* ms */);
+	uint32_t revolutions = engine->triggerCentral.triggerState.getTotalRevolutionCounter();
+	uint32_t cycles = getEngineCycleCounter(PASS_ENGINE_PARAMETER_SIGNATURE);
+
+	// two crank revolutions per engine cycle
+	eth.fireTriggerEvents2(/* count */ 6, 50 /* ms */);
+	EXPECT_EQ(revolutions + 6, (uint32_t)engine->triggerCentral.triggerState.getTotalRevolutionCounter());
+	EXPECT_EQ(cycles + 3, getEngineCycleCounter(PASS_ENGINE_PARAMETER_SIGNATURE));
+}
+
+TEST(limp, torqueReduction) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	LimpManager dut;
+	INJECT_ENGINE_REFERENCE(&dut);
+
+	dut.requestTorqueReduction(25, 100);
+	dut.updateState(1000);
+	dut.updateEngineCycle(1, 8);
+
+	// two of eight cylinders, through the same pattern as the rev limiter
+	int cutCount = 0;
+	for (int i = 0; i < 8; i++) {
+		cutCount += dut.allowIgnition(i) ? 0 : 1;
+	}
+	EXPECT_EQ(2, cutCount);
+	EXPECT_TRUE(dut.allowIgnition());
+	EXPECT_EQ(25, dut.getSparkCutRatio());
+	EXPECT_EQ(0, dut.getFuelCutRatio());
+
+	// requested again in time, keeps going
+	eth.moveTimeForwardMs(80);
+	dut.requestTorqueReduction(50, 100);
+	eth.moveTimeForwardMs(80);
+	dut.updateState(1000);
+	dut.updateEngineCycle(2, 8);
+	EXPECT_EQ(50, dut.getSparkCutRatio());
+
+	// nobody asked for a while, the cut stops
+	eth.moveTimeForwardMs(30);
+	dut.updateState(1000);
+	dut.updateEngineCycle(3, 8);
+	EXPECT_EQ(0, dut.getSparkCutRatio());
+	for (int i = 0; i < 8; i++) {
+		EXPECT_TRUE(dut.allowIgnition(i));
+	}
+}
@@ -0,0 +1,87 @@
+#include "load_predictor.h"
+#include "global.h"
+#include <gtest/gtest.h>
+
+// fast callback runs every 5ms
+#define TICK_US 5000
+
+static void feedRamp(LoadPredictor& dut, float mapFrom, float mapRatePerSec, float tps, int count, float horizonUs, float gain) {
+	for (int i = 0; i < count; i++) {
+		float map = mapFrom + mapRatePerSec * i * TICK_US / 1e6f;
+		dut.update(US2NT(i * TICK_US), map, tps, horizonUs, gain);
+	}
+}
+
+TEST(LoadPredictor, steadyStateNoDelta) {
+	LoadPredictor dut;
+
+	feedRamp(dut, 50, 0, 20, 20, 10000, 1);
+
+	EXPECT_FLOAT_EQ(0, dut.getPredictedDelta());
+	EXPECT_FLOAT_EQ(50, dut.getPredictedMap(50));
+	EXPECT_FLOAT_EQ(0, dut.getPredictionError());
+}
+
+TEST(LoadPredictor, extrapolatesRamp) {
+	LoadPredictor dut;
+
+	// 200 kPa/s while the throttle opens, predict 10ms ahead
+	feedRamp(dut, 30, 200, 50, 40, 10000, 1);
+
+	// once the rate filter settles we lead by rate * horizon
+	EXPECT_NEAR(2, dut.getPredictedDelta(), 0.01);
+	EXPECT_NEAR(52, dut.getPredictedMap(50), 0.01);
+
+	// a linear ramp is predicted exactly
+	EXPECT_NEAR(0, dut.getPredictionError(), 0.01);
+}
+
+TEST(LoadPredictor, gainScalesAndZeroDisables) {
+	LoadPredictor half;
+	feedRamp(half, 30, 200, 50, 40, 10000, 0.5);
+	EXPECT_NEAR(1, half.getPredictedDelta(), 0.01);
+
+	LoadPredictor off;
+	feedRamp(off, 30, 200, 50, 40, 10000, 0);
+	EXPECT_FLOAT_EQ(0, off.getPredictedDelta());
+	EXPECT_FLOAT_EQ(50, off.getPredictedMap(50));
+}
+
+TEST(LoadPredictor, deltaIsClamped) {
+	LoadPredictor dut;
+
+	// absurd rate and a long horizon
+	feedRamp(dut, 30, 10000, 50, 40, 100000, 1);
+	EXPECT_FLOAT_EQ(MAX_PREDICTED_MAP_DELTA, dut.getPredictedDelta());
+
+	// never predict below vacuum
+	EXPECT_FLOAT_EQ(0, dut.getPredictedMap(-100));
+}
+
+TEST(LoadPredictor, throttleReversalStopsExtrapolation) {
+	LoadPredictor dut;
+
+	// MAP still rising but throttle snapping shut
+	for (int i = 0; i < 40; i++) {
+		dut.update(US2NT(i * TICK_US), 30 + i, 80 - 2 * i, 10000, 1);
+	}
+
+	EXPECT_FLOAT_EQ(0, dut.getPredictedDelta());
+}
+
+TEST(LoadPredictor, errorTracksMissedPrediction) {
+	LoadPredictor dut;
+
+	// ramp up, then MAP stops rising abruptly
+	feedRamp(dut, 30, 200, 50, 40, 10000, 1);
+	float lastMap = 30 + 200 * 39 * TICK_US / 1e6f;
+	for (int i = 40; i < 44; i++) {
+		dut.update(US2NT(i * TICK_US), lastMap, 50, 10000, 1);
+	}
+
+	// we predicted about 2kPa more than what arrived
+	EXPECT_LT(dut.getPredictionError(), -1);
+
+	dut.reset();
+	EXPECT_FLOAT_EQ(0, dut.getPredictedDelta());
+}
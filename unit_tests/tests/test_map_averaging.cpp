@@ -0,0 +1,86 @@
+#include "global.h"
+#include "map_averaging.h"
+#include <gtest/gtest.h>
+
+TEST(MapAveraging, windowOpenClose) {
+	MapSampler dut;
+	EXPECT_FALSE(dut.isSampling());
+
+	uint32_t start = dut.open();
+	EXPECT_TRUE(dut.isSampling());
+
+	dut.add(1000);
+	dut.add(900);
+	dut.add(1100);
+
+	MapSamples samples;
+	dut.close(start, samples);
+	EXPECT_FALSE(dut.isSampling());
+	EXPECT_EQ(3000u, samples.adcSum);
+	EXPECT_EQ(3, samples.count);
+	EXPECT_EQ(900, samples.adcMin);
+
+	// samples taken between windows do not leak into the next one
+	dut.add(50);
+
+	start = dut.open();
+	dut.add(2000);
+	dut.close(start, samples);
+	EXPECT_EQ(2000u, samples.adcSum);
+	EXPECT_EQ(1, samples.count);
+	EXPECT_EQ(2000, samples.adcMin);
+
+	// a window without samples
+	start = dut.open();
+	dut.close(start, samples);
+	EXPECT_EQ(0, samples.count);
+}
+
+TEST(MapAveraging, overlappingWindows) {
+	MapSampler dut;
+
+	uint32_t first = dut.open();
+	dut.add(100);
+	dut.add(200);
+
+	// the next cylinder starts before the previous one is done, both keep sampling
+	uint32_t second = dut.open();
+	dut.add(300);
+
+	MapSamples samples;
+	dut.close(first, samples);
+	EXPECT_EQ(600u, samples.adcSum);
+	EXPECT_EQ(3, samples.count);
+	EXPECT_EQ(100, samples.adcMin);
+	EXPECT_TRUE(dut.isSampling());
+
+	dut.add(400);
+	dut.close(second, samples);
+	EXPECT_EQ(700u, samples.adcSum);
+	EXPECT_EQ(2, samples.count);
+	EXPECT_EQ(300, samples.adcMin);
+	EXPECT_FALSE(dut.isSampling());
+	EXPECT_EQ(0u, dut.getOverflowCount());
+}
+
+TEST(MapAveraging, windowLongerThanRing) {
+	MapSampler dut;
+
+	// not a multiple of the ring size so that the ring wraps in the middle
+	for (int i = 0; i < 100; i++) {
+		dut.add(5);
+	}
+
+	uint32_t start = dut.open();
+	// the oldest samples are the lowest, they fall out of the window
+	for (int i = 0; i < MAP_SAMPLE_RING_SIZE; i++) {
+		dut.add(i < MAP_SAMPLE_RING_SIZE / 2 ? 1 : 10);
+	}
+
+	MapSamples samples;
+	dut.close(start, samples);
+	EXPECT_EQ(MAP_SAMPLE_RING_SIZE / 2, samples.count);
+	EXPECT_EQ(10u * MAP_SAMPLE_RING_SIZE / 2, samples.adcSum);
+	EXPECT_EQ(10, samples.adcMin);
+	EXPECT_EQ(1u, dut.getOverflowCount());
+}
@@ -0,0 +1,272 @@
+#include "global.h"
+#include "engine_test_helper.h"
+#include "obd2.h"
+#include "iso_tp.h"
+#include "sensor.h"
+#include "can_rx_dispatch.h"
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+static const uint8_t flowControl[] = { 0x30, 0, 0 };
+
+TEST(IsoTp, singleFrame) {
+	IsoTpTransmitter dut;
+	uint8_t payload[] = { 0x41, 0x0C, 0x1A, 0xF8 };
+	uint8_t frame[ISO_TP_FRAME_SIZE];
+
+	ASSERT_TRUE(dut.start(payload, sizeof(payload), 0));
+	ASSERT_TRUE(dut.getNextFrame(frame, 0));
+
+	uint8_t expected[] = { 4, 0x41, 0x0C, 0x1A, 0xF8, 0, 0, 0 };
+	EXPECT_EQ(0, memcmp(expected, frame, sizeof(expected)));
+	EXPECT_FALSE(dut.isBusy());
+	EXPECT_FALSE(dut.getNextFrame(frame, 0));
+}
+
+TEST(IsoTp, blockSizeAndSeparationTime) {
+	IsoTpTransmitter dut;
+	uint8_t payload[30];
+	for (size_t i = 0; i < sizeof(payload); i++) {
+		payload[i] = i;
+	}
+	uint8_t frame[ISO_TP_FRAME_SIZE];
+
+	ASSERT_TRUE(dut.start(payload, sizeof(payload), 0));
+	// one at a time
+	EXPECT_FALSE(dut.start(payload, sizeof(payload), 0));
+
+	ASSERT_TRUE(dut.getNextFrame(frame, 0));
+	EXPECT_EQ(0x10, frame[0]);
+	EXPECT_EQ(30, frame[1]);
+	EXPECT_EQ(5, frame[7]);
+
+	// nothing until the receiver says so
+	EXPECT_FALSE(dut.getNextFrame(frame, MS2NT(10)));
+
+	// two frames per block, 5ms apart
+	uint8_t fc[] = { 0x30, 2, 5 };
+	dut.onFlowControl(fc, sizeof(fc), MS2NT(10));
+
+	ASSERT_TRUE(dut.getNextFrame(frame, MS2NT(10)));
+	EXPECT_EQ(0x21, frame[0]);
+	EXPECT_EQ(6, frame[1]);
+	EXPECT_EQ(12, frame[7]);
+
+	EXPECT_FALSE(dut.getNextFrame(frame, MS2NT(14)));
+	ASSERT_TRUE(dut.getNextFrame(frame, MS2NT(15)));
+	EXPECT_EQ(0x22, frame[0]);
+
+	// block is over, wait for the next Flow Control
+	EXPECT_FALSE(dut.getNextFrame(frame, MS2NT(100)));
+	dut.onFlowControl(flowControl, sizeof(flowControl), MS2NT(100));
+
+	ASSERT_TRUE(dut.getNextFrame(frame, MS2NT(100)));
+	EXPECT_EQ(0x23, frame[0]);
+	EXPECT_EQ(20, frame[1]);
+
+	// no block limit and no separation this time
+	ASSERT_TRUE(dut.getNextFrame(frame, MS2NT(100)));
+	EXPECT_EQ(0x24, frame[0]);
+	// the last three bytes, zero padded
+	EXPECT_EQ(27, frame[1]);
+	EXPECT_EQ(29, frame[3]);
+	EXPECT_EQ(0, frame[4]);
+
+	EXPECT_FALSE(dut.isBusy());
+	EXPECT_EQ(5u, dut.getFrameCount());
+	EXPECT_EQ(0u, dut.getAbortCount());
+}
+
+TEST(IsoTp, flowControlTimeoutAndOverflow) {
+	IsoTpTransmitter dut;
+	uint8_t payload[10] = {};
+	uint8_t frame[ISO_TP_FRAME_SIZE];
+
+	dut.start(payload, sizeof(payload), 0);
+	dut.getNextFrame(frame, 0);
+
+	// Wait pushes the timeout out
+	uint8_t wait[] = { 0x31, 0, 0 };
+	dut.onFlowControl(wait, sizeof(wait), MS2NT(900));
+	EXPECT_FALSE(dut.getNextFrame(frame, MS2NT(1500)));
+	EXPECT_TRUE(dut.isBusy());
+
+	EXPECT_FALSE(dut.getNextFrame(frame, MS2NT(1900)));
+	EXPECT_FALSE(dut.isBusy());
+	EXPECT_EQ(1u, dut.getAbortCount());
+
+	dut.start(payload, sizeof(payload), 0);
+	dut.getNextFrame(frame, 0);
+	uint8_t overflow[] = { 0x32, 0, 0 };
+	dut.onFlowControl(overflow, sizeof(overflow), 0);
+	EXPECT_FALSE(dut.isBusy());
+	EXPECT_EQ(2u, dut.getAbortCount());
+}
+
+TEST(IsoTp, separationTimeEncoding) {
+	EXPECT_EQ(0, isoTpDecodeSeparationTime(0));
+	EXPECT_EQ(MS2NT(127), isoTpDecodeSeparationTime(0x7F));
+	EXPECT_EQ(US2NT(100), isoTpDecodeSeparationTime(0xF1));
+	EXPECT_EQ(US2NT(900), isoTpDecodeSeparationTime(0xF9));
+	// reserved
+	EXPECT_EQ(MS2NT(127), isoTpDecodeSeparationTime(0x80));
+}
+
+TEST(Obd2, multiPidResponse) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	Sensor::setMockValue(SensorType::Clt, 90);
+	Sensor::setMockValue(SensorType::Iat, 20);
+	Sensor::setMockValue(SensorType::Tps1, 50);
+	obdRefreshPidCache(PASS_ENGINE_PARAMETER_SIGNATURE);
+
+	uint8_t pids[] = { PID_COOLANT_TEMP, PID_INTAKE_TEMP, 0x5F, PID_THROTTLE };
+	uint8_t out[OBD_MAX_RESPONSE_SIZE];
+
+	// 0x5F is not supported and left out
+	ASSERT_EQ(7u, obdBuildCurrentDataResponse(pids, efi::size(pids), out, sizeof(out)));
+	uint8_t expected[] = { 0x41, PID_COOLANT_TEMP, 130, PID_INTAKE_TEMP, 60, PID_THROTTLE, 128 };
+	EXPECT_EQ(0, memcmp(expected, out, sizeof(expected)));
+
+	// nothing supported, no response at all
+	uint8_t unknown[] = { 0x5F };
+	EXPECT_EQ(0u, obdBuildCurrentDataResponse(unknown, 1, out, sizeof(out)));
+}
+
+TEST(Obd2, supportedPidBitmaps) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+	obdRefreshPidCache(PASS_ENGINE_PARAMETER_SIGNATURE);
+
+	uint8_t ranges[] = { PID_SUPPORTED_PIDS_REQUEST_01_20, PID_SUPPORTED_PIDS_REQUEST_21_40, PID_SUPPORTED_PIDS_REQUEST_41_60 };
+	uint8_t out[OBD_MAX_RESPONSE_SIZE];
+	ASSERT_EQ(16u, obdBuildCurrentDataResponse(ranges, efi::size(ranges), out, sizeof(out)));
+
+	// PID 0x01 is the top bit, next range is supported
+	EXPECT_EQ(0x80, out[2] & 0x80);
+	EXPECT_EQ(0x01, out[5] & 0x01);
+	// only 0x24 in the second range, plus the next range bit
+	uint8_t range2[] = { PID_SUPPORTED_PIDS_REQUEST_21_40, 0x10, 0, 0, 0x01 };
+	EXPECT_EQ(0, memcmp(range2, out + 6, sizeof(range2)));
+	// 0x5E is bit 2 of the last range, which is the last one
+	EXPECT_EQ(PID_SUPPORTED_PIDS_REQUEST_41_60, out[11]);
+	EXPECT_EQ(0x04, out[15]);
+}
+
+/**
+ * Replays what a dashboard app asks for once per refresh and counts every frame on the bus,
+ * requests and Flow Control included, when asking for pidsPerRequest PIDs at a time.
+ */
+static int replayScanToolTrace(const std::vector<uint8_t> &trace, size_t pidsPerRequest) {
+	IsoTpTransmitter ecu;
+	uint8_t response[OBD_MAX_RESPONSE_SIZE];
+	int frames = 0;
+	efitick_t nowNt = 0;
+
+	for (size_t first = 0; first < trace.size(); first += pidsPerRequest) {
+		size_t count = std::min(pidsPerRequest, trace.size() - first);
+
+		// request: Single Frame with mode and PIDs
+		frames++;
+		size_t length = obdBuildCurrentDataResponse(&trace[first], count, response, sizeof(response));
+		EXPECT_TRUE(ecu.start(response, length, nowNt));
+
+		uint8_t frame[ISO_TP_FRAME_SIZE];
+		while (ecu.isBusy()) {
+			if (ecu.getNextFrame(frame, nowNt)) {
+				frames++;
+
+				if (frame[0] >> 4 == (int)IsoTpFrameType::First) {
+					// the tool is happy with everything at once
+					frames++;
+					ecu.onFlowControl(flowControl, sizeof(flowControl), nowNt);
+				}
+			}
+			nowNt += MS2NT(1);
+		}
+	}
+
+	EXPECT_EQ(0u, ecu.getAbortCount());
+	return frames;
+}
+
+TEST(Obd2, replayFramesPerPid) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+	obdRefreshPidCache(PASS_ENGINE_PARAMETER_SIGNATURE);
+
+	std::vector<uint8_t> trace = {
+		PID_RPM, PID_SPEED, PID_COOLANT_TEMP, PID_INTAKE_TEMP,
+		PID_INTAKE_MAP, PID_THROTTLE, PID_ENGINE_LOAD, PID_TIMING_ADVANCE,
+	};
+
+	int single = replayScanToolTrace(trace, 1);
+	int multi = replayScanToolTrace(trace, OBD_MAX_PIDS_PER_REQUEST);
+
+	printf("OBD2 replay: %.2f frames per PID one at a time, %.2f with %d PIDs per request\n",
+			(float)single / trace.size(), (float)multi / trace.size(), OBD_MAX_PIDS_PER_REQUEST);
+
+	// request and response for each PID
+	EXPECT_EQ(16, single);
+	// six PIDs in a 14 byte response: request, First, Flow Control, two Consecutive; then the
+	// remaining two fit a Single Frame
+	EXPECT_EQ(7, multi);
+}
+
+// same layout as the STM32 CANRxFrame: SID and EID share storage
+struct ObdTestFrame {
+	uint8_t IDE;
+	union {
+		struct {
+			uint32_t SID : 11;
+		};
+		struct {
+			uint32_t EID : 29;
+		};
+	};
+	uint8_t data8[8];
+};
+
+/**
+ * Flow Control for a multi frame response comes to 0x7E0, through the same lookup as every
+ * other frame and into a receive buffer which just had an extended frame in it.
+ */
+TEST(Obd2, physicalRequestAfterExtendedFrame) {
+	CanRxDispatchTable<ObdTestFrame, 4> dispatch;
+	static std::vector<ObdRequest> requests;
+	requests.clear();
+
+	auto onObd = [](void *, const ObdTestFrame &frame, efitick_t) {
+		requests.push_back(obdGetRequest(frame));
+	};
+	dispatch.add(OBD_TEST_REQUEST, false, onObd, nullptr, "OBD");
+	dispatch.add(OBD_PHYSICAL_REQUEST, false, onObd, nullptr, "OBD physical");
+	dispatch.add(0x727573, true, [](void *, const ObdTestFrame &, efitick_t) {}, nullptr, "wideband bootloader");
+
+	ObdTestFrame buffer = {};
+	buffer.IDE = 1;
+	buffer.EID = 0x727573;
+	EXPECT_EQ(1u, dispatch.dispatch(buffer, 0));
+
+	// functional request for RPM
+	buffer.IDE = 0;
+	buffer.SID = OBD_TEST_REQUEST;
+	uint8_t request[] = { 2, OBD_CURRENT_DATA, PID_RPM, 0, 0, 0, 0, 0 };
+	memcpy(buffer.data8, request, sizeof(request));
+	ASSERT_NE((uint32_t)OBD_TEST_REQUEST, (uint32_t)buffer.EID);
+	EXPECT_EQ(1u, dispatch.dispatch(buffer, 0));
+
+	// Flow Control to the physical ID
+	buffer.SID = OBD_PHYSICAL_REQUEST;
+	memcpy(buffer.data8, flowControl, sizeof(flowControl));
+	ASSERT_NE((uint32_t)OBD_PHYSICAL_REQUEST, (uint32_t)buffer.EID);
+	EXPECT_EQ(1u, dispatch.dispatch(buffer, 0));
+
+	EXPECT_EQ(std::vector<ObdRequest>({ ObdRequest::CurrentData, ObdRequest::FlowControl }), requests);
+	EXPECT_EQ(0u, dispatch.getUnknownCount());
+
+	// an extended frame whose low bits happen to look like 0x7E0 is not ours
+	buffer.IDE = 1;
+	buffer.EID = 0x1000000 | OBD_PHYSICAL_REQUEST;
+	EXPECT_EQ(ObdRequest::None, obdGetRequest(buffer));
+}
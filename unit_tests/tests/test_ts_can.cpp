@@ -0,0 +1,209 @@
+#include "global.h"
+#include "serial_can.h"
+#include "crc.h"
+
+#include <gtest/gtest.h>
+#include <array>
+#include <deque>
+#include <vector>
+
+extern int timeNowUs;
+
+// 8 data bytes with an 11 bit ID is about 130 bits with stuffing, at 500 kbit/s
+#define FRAME_US 260
+
+/**
+ * The ECU side of TS over CAN talking to a PC side made of a plain ISO-TP receiver. Every frame
+ * in either direction takes its time on a simulated 500 kbit/s bus.
+ */
+class LoopbackTsChannel final : public CanTsChannel {
+public:
+	LoopbackTsChannel(uint8_t pcBlockSize, uint8_t pcSeparationTime)
+		: CanTsChannel(1)
+		, pc(pcBlockSize, pcSeparationTime)
+	{
+	}
+
+	// the PC sends a message to us, the PC side honors no pacing since we ask for none
+	void sendFromPc(const uint8_t *data, size_t size) {
+		IsoTpTransmitter tx;
+		tx.start(data, size, 0);
+
+		std::array<uint8_t, ISO_TP_FRAME_SIZE> frame;
+		tx.getNextFrame(frame.data(), 0);
+		toEcu.push_back(frame);
+
+		if (tx.isBusy()) {
+			// our Flow Control is not looked at, it is checked separately
+			uint8_t flowControl[] = { 0x30, 0, 0 };
+			tx.onFlowControl(flowControl, sizeof(flowControl), 0);
+			while (tx.getNextFrame(frame.data(), 0)) {
+				toEcu.push_back(frame);
+			}
+		}
+	}
+
+	IsoTpReceiver pc;
+	std::vector<uint8_t> atPc;
+	std::deque<std::array<uint8_t, ISO_TP_FRAME_SIZE>> toEcu;
+	std::vector<std::array<uint8_t, ISO_TP_FRAME_SIZE>> flowControlFromEcu;
+	int frames = 0;
+
+protected:
+	bool transmitFrame(const uint8_t *frame) override {
+		frames++;
+		timeNowUs += FRAME_US;
+
+		if ((IsoTpFrameType)(frame[0] >> 4) == IsoTpFrameType::FlowControl) {
+			std::array<uint8_t, ISO_TP_FRAME_SIZE> copy;
+			memcpy(copy.data(), frame, ISO_TP_FRAME_SIZE);
+			flowControlFromEcu.push_back(copy);
+			return true;
+		}
+
+		uint8_t payload[ISO_TP_FRAME_SIZE];
+		size_t count = pc.onFrame(frame, ISO_TP_FRAME_SIZE, payload);
+		atPc.insert(atPc.end(), payload, payload + count);
+
+		std::array<uint8_t, ISO_TP_FRAME_SIZE> flowControl;
+		if (pc.getFlowControl(flowControl.data())) {
+			toEcu.push_back(flowControl);
+		}
+		return true;
+	}
+
+	bool receiveFrame(uint8_t *frame, int timeout) override {
+		if (toEcu.empty()) {
+			// timeout is in milliseconds here
+			timeNowUs += 1000 * timeout;
+			return false;
+		}
+
+		memcpy(frame, toEcu.front().data(), ISO_TP_FRAME_SIZE);
+		toEcu.pop_front();
+		frames++;
+		timeNowUs += FRAME_US;
+		return true;
+	}
+};
+
+static void expectCrcPacket(const std::vector<uint8_t> &packet, const uint8_t *data, size_t size) {
+	ASSERT_EQ(size + 7, packet.size());
+	EXPECT_EQ((size + 1) >> 8, packet[0]);
+	EXPECT_EQ((size + 1) & 0xFF, packet[1]);
+	EXPECT_EQ(TS_RESPONSE_OK, packet[2]);
+	EXPECT_EQ(0, memcmp(data, &packet[3], size));
+
+	uint32_t crc = crc32(&packet[2], size + 1);
+	EXPECT_EQ(crc >> 24, packet[size + 3]);
+	EXPECT_EQ(crc & 0xFF, packet[size + 6]);
+}
+
+struct TransferResult {
+	float bytesPerSecond;
+	int frames;
+};
+
+static TransferResult transfer(LoopbackTsChannel &dut, const uint8_t *data, size_t size) {
+	timeNowUs = 0;
+	dut.atPc.clear();
+	dut.frames = 0;
+
+	dut.writeCrcPacket(TS_RESPONSE_OK, data, size);
+
+	expectCrcPacket(dut.atPc, data, size);
+	EXPECT_EQ(0u, dut.getTxAbortCount());
+
+	return { 1e6f * size / timeNowUs, dut.frames };
+}
+
+TEST(TsCan, pageReadAndToothLog) {
+	// one page read and one full composite tooth log
+	static uint8_t page[BLOCKING_FACTOR];
+	static uint8_t toothLog[COMPOSITE_PACKET_SIZE * COMPOSITE_PACKET_COUNT];
+	for (size_t i = 0; i < sizeof(toothLog); i++) {
+		toothLog[i] = i * 7;
+		if (i < sizeof(page)) {
+			page[i] = i;
+		}
+	}
+
+	// the bus can not go faster than 7 bytes per frame
+	float busLimit = 7 * 1e6f / FRAME_US;
+
+	// PC takes everything at once
+	LoopbackTsChannel open(0, 0);
+	TransferResult pageOpen = transfer(open, page, sizeof(page));
+	TransferResult logOpen = transfer(open, toothLog, sizeof(toothLog));
+
+	// PC wants a Flow Control every 8 frames
+	LoopbackTsChannel blocks(8, 0);
+	TransferResult logBlocks = transfer(blocks, toothLog, sizeof(toothLog));
+
+	// PC wants 1ms between frames
+	LoopbackTsChannel slow(0, 1);
+	TransferResult logSlow = transfer(slow, toothLog, sizeof(toothLog));
+
+	printf("TS over CAN: page read %.0f B/s in %d frames, tooth log %.0f B/s in %d frames, "
+			"%.0f B/s with block size 8, %.0f B/s with STmin 1ms, bus limit %.0f B/s\n",
+			pageOpen.bytesPerSecond, pageOpen.frames, logOpen.bytesPerSecond, logOpen.frames,
+			logBlocks.bytesPerSecond, logSlow.bytesPerSecond, busLimit);
+
+	// page goes as one message straight out of the scratch buffer: First Frame, Flow Control
+	// and Consecutive Frames for the other 257 bytes
+	EXPECT_EQ(2 + 37, pageOpen.frames);
+	EXPECT_GT(pageOpen.bytesPerSecond, 0.9f * busLimit);
+
+	// header and CRC of the large packet go in Single Frames around the zero copy body
+	EXPECT_EQ(1 + 2 + 357 + 1, logOpen.frames);
+	EXPECT_GT(logOpen.bytesPerSecond, 0.95f * busLimit);
+
+	// one more Flow Control per block
+	EXPECT_EQ(logOpen.frames + (357 + 7) / 8 - 1, logBlocks.frames);
+	EXPECT_GT(logBlocks.bytesPerSecond, 0.85f * busLimit);
+
+	// paced by the PC
+	EXPECT_LT(logSlow.bytesPerSecond, 7000);
+}
+
+TEST(TsCan, receiveMultiFrameCommand) {
+	LoopbackTsChannel dut(0, 0);
+
+	// a write chunk command does not fit one frame
+	uint8_t command[40];
+	for (size_t i = 0; i < sizeof(command); i++) {
+		command[i] = 100 + i;
+	}
+	dut.sendFromPc(command, sizeof(command));
+
+	uint8_t received[sizeof(command)];
+	// read in odd pieces like the TS protocol code does
+	ASSERT_EQ(3u, dut.readTimeout(received, 3, 10));
+	ASSERT_EQ(sizeof(command) - 3, dut.readTimeout(received + 3, sizeof(command) - 3, 10));
+	EXPECT_EQ(0, memcmp(command, received, sizeof(command)));
+
+	// we acknowledged the First Frame with our block size and STmin
+	ASSERT_EQ(1u, dut.flowControlFromEcu.size());
+	EXPECT_EQ(0x30, dut.flowControlFromEcu[0][0]);
+	EXPECT_EQ(TS_CAN_BLOCK_SIZE, dut.flowControlFromEcu[0][1]);
+	EXPECT_EQ(TS_CAN_SEPARATION_TIME, dut.flowControlFromEcu[0][2]);
+
+	// nothing more to read
+	EXPECT_EQ(0u, dut.readTimeout(received, 1, 10));
+	EXPECT_EQ(0u, dut.getRxErrorCount());
+}
+
+TEST(TsCan, shortWritesShareOneFrame) {
+	LoopbackTsChannel dut(0, 0);
+
+	uint8_t a[] = { 1, 2, 3 };
+	uint8_t b[] = { 4, 5 };
+	dut.write(a, sizeof(a));
+	dut.write(b, sizeof(b));
+	EXPECT_EQ(0, dut.frames);
+
+	dut.flush();
+	EXPECT_EQ(1, dut.frames);
+	std::vector<uint8_t> expected = { 1, 2, 3, 4, 5 };
+	EXPECT_EQ(expected, dut.atPc);
+}
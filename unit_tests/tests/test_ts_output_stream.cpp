@@ -0,0 +1,224 @@
+#include "global.h"
+#include "ts_output_stream.h"
+#include "crc.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+extern int timeNowUs;
+
+// HC-05 style Bluetooth SPP: 115200 baud and a long way between the ECU and the laptop
+#define SPP_US_PER_BYTE 87
+#define SPP_LATENCY_US 15000
+// what the serial driver queue takes before write() has to wait
+#define SPP_TX_QUEUE 64
+
+struct ReceivedFrame {
+	int arrivalUs;
+	uint16_t frameNumber;
+	std::vector<uint8_t> data;
+};
+
+/**
+ * Bytes go out on the wire one after the other, write() returns once all but the queue size
+ * are on the wire.
+ */
+class SppTsChannel final : public TsChannelBase {
+public:
+	void write(const uint8_t* buffer, size_t size) override {
+		int start = wireFreeUs > timeNowUs ? wireFreeUs : timeNowUs;
+		wireFreeUs = start + size * SPP_US_PER_BYTE;
+		int returnUs = wireFreeUs - SPP_TX_QUEUE * SPP_US_PER_BYTE;
+		if (returnUs > timeNowUs) {
+			timeNowUs = returnUs;
+		}
+
+		packet.insert(packet.end(), buffer, buffer + size);
+	}
+
+	size_t readTimeout(uint8_t*, size_t, int) override {
+		return 0;
+	}
+
+	void flush() override {
+		// one CRC packet per flush
+		ASSERT_GE(packet.size(), 7u);
+		size_t size = packet[0] << 8 | packet[1];
+		ASSERT_EQ(size + 6, packet.size());
+		EXPECT_EQ(TS_RESPONSE_OUTPUT_STREAM, packet[2]);
+
+		uint32_t crc = crc32(&packet[2], size);
+		EXPECT_EQ(crc >> 24, packet[size + 2]);
+
+		frames.push_back({ wireFreeUs + SPP_LATENCY_US, (uint16_t)(packet[3] | packet[4] << 8),
+				std::vector<uint8_t>(packet.begin() + 5, packet.end() - 4) });
+		packet.clear();
+	}
+
+	bool isReady() override {
+		return true;
+	}
+
+	bool wouldWriteBlock() override {
+		return wireFreeUs > timeNowUs;
+	}
+
+	int wireFreeUs = 0;
+	std::vector<uint8_t> packet;
+	std::vector<ReceivedFrame> frames;
+};
+
+static void put16(std::vector<uint8_t> &request, uint16_t value) {
+	request.push_back(value & 0xFF);
+	request.push_back(value >> 8);
+}
+
+/**
+ * The TS thread: wait for a command until the next frame is due, there never is one
+ */
+static void runFor(TsOutputStream &stream, SppTsChannel &channel, const uint8_t *outputs, int durationUs) {
+	int endUs = timeNowUs + durationUs;
+	while (true) {
+		int nextUs = timeNowUs + NT2US(stream.getTimeToNextFrame(getTimeNowNt()));
+		if (nextUs >= endUs) {
+			timeNowUs = endUs;
+			return;
+		}
+		timeNowUs = nextUs;
+		stream.update(&channel, outputs, getTimeNowNt());
+	}
+}
+
+TEST(TsOutputStream, fieldSubset) {
+	timeNowUs = 0;
+	static uint8_t outputs[sizeof(TunerStudioOutputChannels)];
+	for (size_t i = 0; i < sizeof(outputs); i++) {
+		outputs[i] = i;
+	}
+
+	SppTsChannel channel;
+	TsOutputStream stream;
+
+	// rpm and coolant, then knock retard, every 50ms
+	std::vector<uint8_t> request;
+	put16(request, 50);
+	put16(request, 4);
+	put16(request, 2);
+	put16(request, 12);
+	put16(request, 2);
+	put16(request, 302);
+	put16(request, 1);
+	ASSERT_TRUE(stream.subscribe(&channel, request.data(), request.size(), getTimeNowNt()));
+	EXPECT_TRUE(stream.isActive(&channel));
+
+	runFor(stream, channel, outputs, 1000 * 1000);
+
+	ASSERT_EQ(20u, channel.frames.size());
+	std::vector<uint8_t> expected = { 4, 5, 12, 13, (uint8_t)302 };
+	for (size_t i = 0; i < channel.frames.size(); i++) {
+		EXPECT_EQ(i, channel.frames[i].frameNumber);
+		EXPECT_EQ(expected, channel.frames[i].data);
+	}
+	EXPECT_EQ(0u, stream.getDroppedCount());
+
+	// another channel never gets these
+	SppTsChannel other;
+	stream.update(&other, outputs, getTimeNowNt() + MS2NT(100));
+	EXPECT_EQ(0u, other.frames.size());
+
+	// period 0 stops it
+	std::vector<uint8_t> stop;
+	put16(stop, 0);
+	ASSERT_TRUE(stream.subscribe(&channel, stop.data(), stop.size(), getTimeNowNt()));
+	EXPECT_FALSE(stream.isActive(&channel));
+}
+
+TEST(TsOutputStream, badRequest) {
+	SppTsChannel channel;
+	TsOutputStream stream;
+
+	std::vector<uint8_t> request;
+	put16(request, 10);
+	put16(request, 300);
+	put16(request, 100);
+	EXPECT_FALSE(stream.subscribe(&channel, request.data(), request.size(), 0)) << "past the end";
+
+	request.pop_back();
+	EXPECT_FALSE(stream.subscribe(&channel, request.data(), request.size(), 0)) << "half a pair";
+
+	request.clear();
+	put16(request, 10);
+	for (int i = 0; i <= TS_STREAM_MAX_RANGES; i++) {
+		put16(request, i);
+		put16(request, 1);
+	}
+	EXPECT_FALSE(stream.subscribe(&channel, request.data(), request.size(), 0)) << "too many ranges";
+	EXPECT_FALSE(stream.isActive(&channel));
+}
+
+TEST(TsOutputStream, lateFramesAreDropped) {
+	timeNowUs = 0;
+	static uint8_t outputs[sizeof(TunerStudioOutputChannels)];
+
+	SppTsChannel channel;
+	TsOutputStream stream;
+
+	std::vector<uint8_t> request;
+	put16(request, 10);
+	put16(request, 0);
+	put16(request, 8);
+	ASSERT_TRUE(stream.subscribe(&channel, request.data(), request.size(), getTimeNowNt()));
+
+	runFor(stream, channel, outputs, 25 * 1000);
+	ASSERT_EQ(3u, channel.frames.size());
+
+	// a burn keeps the TS thread away, the 30, 40, 50 and 60ms frames are gone
+	timeNowUs += 45 * 1000;
+	stream.update(&channel, outputs, getTimeNowNt());
+
+	ASSERT_EQ(4u, channel.frames.size());
+	EXPECT_EQ(4u, stream.getDroppedCount());
+	EXPECT_EQ(7, channel.frames.back().frameNumber);
+
+	// and back on the 10ms grid
+	EXPECT_EQ(MS2NT(10), stream.getTimeToNextFrame(getTimeNowNt()));
+}
+
+TEST(TsOutputStream, sampleRateOverBluetooth) {
+	timeNowUs = 0;
+	static uint8_t outputs[sizeof(TunerStudioOutputChannels)];
+
+	SppTsChannel channel;
+	TsOutputStream stream;
+
+	// the whole block as fast as it goes
+	std::vector<uint8_t> request;
+	put16(request, 20);
+	ASSERT_TRUE(stream.subscribe(&channel, request.data(), request.size(), getTimeNowNt()));
+
+	const int durationUs = 10 * 1000 * 1000;
+	runFor(stream, channel, outputs, durationUs);
+
+	int lastArrivalUs = channel.frames.back().arrivalUs;
+	float streamRate = 1e6f * channel.frames.size() / durationUs;
+
+	// one 'O' poll: request goes out, response comes back, each after the link latency
+	int pollRequestBytes = 2 + 5 + 4;
+	int pollResponseBytes = 2 + 1 + sizeof(TunerStudioOutputChannels) + 4;
+	int pollUs = 2 * SPP_LATENCY_US + (pollRequestBytes + pollResponseBytes) * SPP_US_PER_BYTE;
+	float pollRate = 1e6f / pollUs;
+
+	printf("Output channels over Bluetooth SPP: %.1f frames/s streamed (%d dropped), %.1f frames/s polled\n",
+			streamRate, stream.getDroppedCount(), pollRate);
+
+	// the link can not take a frame every 20ms, the rest is dropped instead of piling up
+	EXPECT_GT(stream.getDroppedCount(), 0u);
+	EXPECT_LT(lastArrivalUs - durationUs, 2 * SPP_LATENCY_US);
+
+	EXPECT_GT(streamRate, 1.8f * pollRate);
+
+	// every frame number up to the last one received is accounted for
+	uint32_t accounted = stream.getFrameCount() + stream.getDroppedCount();
+	EXPECT_LE(channel.frames.back().frameNumber + 1u, accounted);
+	EXPECT_GE(channel.frames.back().frameNumber + 3u, accounted);
+}
@@ -1,5 +1,10 @@
 #include "engine_test_helper.h"
 #include "tunerstudio_io.h"
+#include "ts_delta_encoder.h"
+#include "output_channel_registry.h"
+
+#include <cmath>
+#include <vector>
 
 extern int sr5TestWriteDataIndex;
 extern uint8_t st5TestBuffer[16000];
@@ -45,3 +50,198 @@ TEST(binary, testWriteCrc) {
 	test.writeCrcPacket(CODE, (const uint8_t*)PAYLOAD, SIZE);
 	assertCrcPacket();
 }
+
+/**
+ * What a client does with TS_OUTPUT_DELTA_COMMAND responses
+ */
+static uint8_t applyDelta(uint8_t *image, const uint8_t *response, size_t size, uint16_t count) {
+	if (response[0] & TS_DELTA_KEYFRAME) {
+		EXPECT_EQ(TS_DELTA_HEADER_SIZE + count, size);
+		memcpy(image, response + TS_DELTA_HEADER_SIZE, count);
+		return response[1];
+	}
+
+	size_t words = (count + TS_DELTA_WORD_SIZE - 1) / TS_DELTA_WORD_SIZE;
+	const uint8_t *bitmap = response + TS_DELTA_HEADER_SIZE;
+	size_t position = TS_DELTA_HEADER_SIZE + (words + 7) / 8;
+
+	for (size_t word = 0; word < words; word++) {
+		if (bitmap[word / 8] & (1 << (word % 8))) {
+			size_t length = count - word * TS_DELTA_WORD_SIZE < TS_DELTA_WORD_SIZE ? 1 : TS_DELTA_WORD_SIZE;
+			memcpy(image + word * TS_DELTA_WORD_SIZE, response + position, length);
+			position += length;
+		}
+	}
+
+	EXPECT_EQ(position, size);
+	return response[1];
+}
+
+/**
+ * Half a minute of gauges at 20Hz: idle, a pull through the gears, cruise
+ */
+static void recordedEngineData(TunerStudioOutputChannels &och, int poll) {
+	float t = poll / 20.0f;
+	bool pull = t > 10 && t < 20;
+	float rpm = pull ? 2000 + 450 * fmodf(t - 10, 3.3f) * 3 : (t < 10 ? 850 + 10 * sinf(t * 7) : 2600 + 30 * sinf(t));
+
+	och.rpm = rpm;
+	och.vehicleSpeedKph = t < 10 ? 0 : (pull ? (t - 10) * 9 : 90);
+	och.coolantTemperature = 70 + t * 0.3f;
+	och.intakeAirTemperature = 25 + (poll % 40 == 0 ? 0.5f : 0);
+	och.throttlePosition = pull ? 95 : (t < 10 ? 0 : 18 + 0.5f * sinf(t * 3));
+	och.manifoldAirPressure = pull ? 98 : 35 + 3 * sinf(t * 5);
+	och.lambda = pull ? 0.86f : 1 + 0.02f * sinf(t * 11);
+	och.engineLoad = pull ? 95 : 30 + 2 * sinf(t * 5);
+	och.vBatt = 14.1f + 0.01f * (poll % 3);
+	och.ignitionAdvance = pull ? 24 : 12 + sinf(t * 5);
+	och.actualLastInjection = pull ? 9.5f : 2.5f + 0.1f * sinf(t * 5);
+	och.knockLevel = 0.2f + 0.01f * (poll % 7);
+	och.timeSeconds = t;
+}
+
+TEST(binary, outputChannelsDelta) {
+	const uint16_t count = sizeof(TunerStudioOutputChannels);
+	static TunerStudioOutputChannels och;
+	static TsDeltaEncoder encoder;
+	static uint8_t response[TS_DELTA_HEADER_SIZE + sizeof(TunerStudioOutputChannels)];
+	static uint8_t image[sizeof(TunerStudioOutputChannels)];
+
+	const int polls = 600;
+	uint8_t acknowledged = 0;
+	size_t total = 0;
+
+	for (int poll = 0; poll < polls; poll++) {
+		recordedEngineData(och, poll);
+
+		size_t size = encoder.encode(reinterpret_cast<const uint8_t*>(&och), 0, count, acknowledged, response);
+		total += size;
+
+		acknowledged = applyDelta(image, response, size, count);
+		ASSERT_EQ(0, memcmp(image, &och, count)) << "poll " << poll;
+	}
+
+	float bytesPerPoll = 1.0f * total / polls;
+	printf("Delta output channels: %.1f bytes per poll vs %d full, %d keyframes in %d polls\n",
+			bytesPerPoll, count, encoder.getKeyframeCount(), polls);
+
+	// the first response and then one every TS_DELTA_KEYFRAME_PERIOD
+	EXPECT_EQ(1 + (polls - 1) / TS_DELTA_KEYFRAME_PERIOD, encoder.getKeyframeCount());
+	EXPECT_LT(bytesPerPoll, count / 4);
+}
+
+TEST(binary, outputChannelsDeltaLostResponse) {
+	static TunerStudioOutputChannels och;
+	static TsDeltaEncoder encoder;
+	static uint8_t response[TS_DELTA_HEADER_SIZE + sizeof(TunerStudioOutputChannels)];
+	const uint16_t offset = 4;
+	const uint16_t count = 33;
+	const uint8_t *current = reinterpret_cast<const uint8_t*>(&och) + offset;
+
+	// no snapshot yet
+	EXPECT_EQ(TS_DELTA_HEADER_SIZE + count, encoder.encode(current, offset, count, 0, response));
+	EXPECT_EQ(TS_DELTA_KEYFRAME, response[0]);
+	uint8_t first = response[1];
+	EXPECT_NE(0, first);
+
+	// nothing changed: just the bitmap, 17 words
+	EXPECT_EQ(TS_DELTA_HEADER_SIZE + 3u, encoder.encode(current, offset, count, first, response));
+	EXPECT_EQ(0, response[0]);
+	uint8_t second = response[1];
+
+	// that response never made it, the client still has the first one
+	och.rpm = 3000;
+	EXPECT_EQ(TS_DELTA_HEADER_SIZE + count, encoder.encode(current, offset, count, first, response));
+	EXPECT_EQ(TS_DELTA_KEYFRAME, response[0]);
+	EXPECT_NE(second, response[1]);
+	uint8_t third = response[1];
+
+	// the odd last byte goes alone
+	och.knockRetard = 5;
+	size_t size = encoder.encode(reinterpret_cast<const uint8_t*>(&och) + 270, 270, count, third, response);
+	EXPECT_EQ(TS_DELTA_KEYFRAME, response[0]) << "different range";
+	size = encoder.encode(reinterpret_cast<const uint8_t*>(&och) + 270, 270, count, response[1], response);
+	EXPECT_EQ(TS_DELTA_HEADER_SIZE + 3u, size);
+	och.knockRetard = 6;
+	size = encoder.encode(reinterpret_cast<const uint8_t*>(&och) + 270, 270, count, response[1], response);
+	EXPECT_EQ(TS_DELTA_HEADER_SIZE + 3u + 1, size);
+	EXPECT_EQ(1 << 0, response[TS_DELTA_HEADER_SIZE + 2]);
+	EXPECT_EQ(60, response[size - 1]);
+}
+
+static int rpmUpdates = 0;
+static int versionUpdates = 0;
+static int debugUpdates = 0;
+
+static void updateRpm(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	rpmUpdates++;
+	tsOutputChannels->rpm = 3000;
+}
+
+static void updateVersion(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	versionUpdates++;
+	tsOutputChannels->firmwareVersion = 20211018;
+}
+
+static void updateDebug(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	debugUpdates++;
+	tsOutputChannels->debugIntField1 = debugUpdates;
+}
+
+static const OutputChannelEntry testEntries[] = {
+	{ OUTPUT_RANGE(rpm, vehicleSpeedKph), OutputRefresh::EveryRequest, updateRpm },
+	{ OUTPUT_RANGE(engineMode, tsConfigVersion), OutputRefresh::Slow, updateVersion },
+	{ OUTPUT_RANGE(debugFloatField1, debugIntField5), OutputRefresh::EveryRequest, updateDebug },
+};
+
+TEST(binary, outputChannelsDeltaRequest) {
+	TsDeltaRequest request;
+
+	// offset and count, but no sequence number
+	const char data[] = { 4, 0, 10, 0, 0x5A };
+	EXPECT_FALSE(tsParseDeltaRequest(data, 4, request));
+	EXPECT_FALSE(tsParseDeltaRequest(data, 0, request));
+
+	ASSERT_TRUE(tsParseDeltaRequest(data, sizeof(data), request));
+	EXPECT_EQ(4, request.offset);
+	EXPECT_EQ(10, request.count);
+	EXPECT_EQ(0x5A, request.acknowledged);
+}
+
+TEST(binary, outputChannelRegistry) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	// rpm is at 4, vehicle speed is the single byte at 10
+	EXPECT_EQ(4, testEntries[0].offset);
+	EXPECT_EQ(7, testEntries[0].size);
+	EXPECT_EQ(116, testEntries[1].offset);
+	EXPECT_EQ(12, testEntries[1].size);
+
+	static TunerStudioOutputChannels och;
+	OutputChannelRegistry<efi::size(testEntries)> registry(testEntries);
+	rpmUpdates = versionUpdates = debugUpdates = 0;
+
+	// a gauge client which only reads rpm
+	for (int i = 0; i < 10; i++) {
+		registry.refresh(&och, 4, 2, MS2NT(100 * i) PASS_ENGINE_PARAMETER_SUFFIX);
+	}
+	EXPECT_EQ(10, rpmUpdates);
+	EXPECT_EQ(0, versionUpdates);
+	EXPECT_EQ(0, debugUpdates);
+	EXPECT_EQ(3000, och.rpm);
+
+	// the whole block at 10Hz: slow channels twice a second
+	for (int i = 0; i < 10; i++) {
+		registry.refresh(&och, 0, sizeof(och), MS2NT(1000 + 100 * i) PASS_ENGINE_PARAMETER_SUFFIX);
+	}
+	EXPECT_EQ(20, rpmUpdates);
+	EXPECT_EQ(2, versionUpdates);
+	EXPECT_EQ(10, debugUpdates);
+	EXPECT_EQ(20211018u, och.firmwareVersion);
+	EXPECT_EQ(32u, registry.getUpdateCount());
+
+	// touching the last byte of a range is enough, the byte right after it is not
+	registry.refresh(&och, 10, 1, MS2NT(3000) PASS_ENGINE_PARAMETER_SUFFIX);
+	registry.refresh(&och, 11, 1, MS2NT(3000) PASS_ENGINE_PARAMETER_SUFFIX);
+	EXPECT_EQ(21, rpmUpdates);
+}
@@ -26,6 +26,7 @@
 #include "efilib.h"
 
 #include "gtest/gtest.h"
+#include <chrono>
 
 TEST(util, isLogFileName) {
 	ASSERT_FALSE(isLogFile("aaaa"));
@@ -65,6 +66,76 @@ TEST(util, crc) {
 	assertEqualsM("crc32 line inc", 0x4775a7b1, c);
 }
 
+/**
+ * The classic byte at a time loop crc32inc() used to be
+ */
+static uint32_t crc32Bytewise(const uint8_t *p, uint32_t crc, uint32_t size) {
+	static uint32_t table[256];
+	if (table[1] == 0) {
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t c = i;
+			for (int bit = 0; bit < 8; bit++) {
+				c = (c >> 1) ^ (c & 1 ? 0xEDB88320 : 0);
+			}
+			table[i] = c;
+		}
+	}
+
+	crc = ~crc;
+	while (size--) {
+		crc = table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+TEST(util, crc32Slicing) {
+	static uint8_t buffer[20000 + 8];
+	uint32_t lcg = 1;
+	for (size_t i = 0; i < sizeof(buffer); i++) {
+		lcg = lcg * 1664525 + 1013904223;
+		buffer[i] = lcg >> 24;
+	}
+
+	// every alignment and every tail length around the word loops
+	for (int start = 0; start < 8; start++) {
+		for (uint32_t size = 0; size < 70; size++) {
+			ASSERT_EQ(crc32Bytewise(buffer + start, 0, size), crc32(buffer + start, size)) << start << "/" << size;
+		}
+	}
+
+	// incremental in odd pieces matches one go
+	uint32_t whole = crc32(buffer, sizeof(buffer));
+	EXPECT_EQ(crc32Bytewise(buffer, 0, sizeof(buffer)), whole);
+	uint32_t crc = 0;
+	uint32_t offset = 0;
+	for (uint32_t piece = 1; offset < sizeof(buffer); piece = piece * 3 + 1) {
+		uint32_t size = piece < sizeof(buffer) - offset ? piece : sizeof(buffer) - offset;
+		crc = crc32inc(buffer + offset, crc, size);
+		offset += size;
+	}
+	EXPECT_EQ(whole, crc);
+
+	// about the size of the whole persistent config
+	const int rounds = 200;
+	const uint32_t size = 20000;
+	volatile uint32_t sink = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		sink = sink + crc32Bytewise(buffer + (i & 1), 0, size);
+	}
+	auto bytewiseNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		sink = sink + crc32(buffer + (i & 1), size);
+	}
+	auto slicedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	printf("crc32 of %d bytes: %.1f us byte at a time, %.1f us sliced\n",
+		size, bytewiseNs / 1000.0f / rounds, slicedNs / 1000.0f / rounds);
+}
+
 TEST(util, cyclicBufferContains) {
 	cyclic_buffer<int> sb;
 	sb.add(10);
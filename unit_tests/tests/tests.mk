@@ -18,6 +18,7 @@ TESTS_SRC_CPP = \
 	tests/sensor/test_cj125.cpp \
 	tests/util/test_buffered_writer.cpp \
 	tests/util/test_error_accumulator.cpp \
+	tests/util/test_crc32_slices8.cpp \
 	tests/test_util.cpp \
 	tests/test_start_stop.cpp \
 	tests/test_hardware_reinit.cpp \
@@ -44,6 +45,19 @@ TESTS_SRC_CPP = \
 	tests/test_pid_auto.cpp \
 	tests/test_pid.cpp \
 	tests/test_accel_enrichment.cpp \
+	tests/test_load_predictor.cpp \
+	tests/test_map_averaging.cpp \
+	tests/test_adc_oversampler.cpp \
+	tests/test_knock_controller.cpp \
+	tests/test_can_rx_dispatch.cpp \
+	tests/test_can_tx_schedule.cpp \
+	tests/test_can_codec.cpp \
+	tests/test_obd2.cpp \
+	tests/test_ts_can.cpp \
+	tests/test_ts_output_stream.cpp \
+	tests/test_config_journal.cpp \
+	tests/test_engine_sniffer.cpp \
+	tests/test_deferred_log.cpp \
 	tests/test_tacho.cpp \
 	tests/test_gpiochip.cpp \
 	tests/test_deadband.cpp \
@@ -56,6 +70,10 @@ TESTS_SRC_CPP = \
 	tests/sensor/resist_func.cpp \
 	tests/sensor/therm_func.cpp \
 	tests/sensor/func_chain.cpp \
+	tests/sensor/test_table_func.cpp \
+	tests/sensor/test_sensor_frame.cpp \
+	tests/sensor/test_adc_subscription.cpp \
+	tests/sensor/test_knock_analysis.cpp \
 	tests/sensor/redundant.cpp \
 	tests/sensor/test_sensor_init.cpp \
 	tests/util/test_closed_loop_controller.cpp \
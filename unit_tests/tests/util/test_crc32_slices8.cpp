@@ -0,0 +1,55 @@
+/**
+ * The firmware is built with four CRC32 slices, this builds crc.c once more with eight under
+ * other names so that path is checked as well.
+ */
+
+#define CRC32_SLICES 8
+#define calc_crc calc_crcSlices8
+#define crc32 crc32Slices8
+#define crc32inc crc32incSlices8
+#include "crc.c"
+#undef calc_crc
+#undef crc32
+#undef crc32inc
+
+#include <gtest/gtest.h>
+
+// one bit at a time, straight from the reflected polynomial
+static uint32_t crc32Bitwise(const uint8_t *p, uint32_t size) {
+	uint32_t crc = 0xFFFFFFFF;
+	while (size--) {
+		crc ^= *p++;
+		for (int bit = 0; bit < 8; bit++) {
+			crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320 : 0);
+		}
+	}
+	return ~crc;
+}
+
+TEST(util, crc32EightSlices) {
+	static uint8_t buffer[4096 + 16];
+	uint32_t lcg = 7;
+	for (size_t i = 0; i < sizeof(buffer); i++) {
+		lcg = lcg * 1664525 + 1013904223;
+		buffer[i] = lcg >> 24;
+	}
+
+	// every alignment and every tail length around the eight and four byte loops
+	for (int start = 0; start < 16; start++) {
+		for (uint32_t size = 0; size < 80; size++) {
+			ASSERT_EQ(crc32Bitwise(buffer + start, size), crc32Slices8(buffer + start, size)) << start << "/" << size;
+		}
+	}
+
+	EXPECT_EQ(crc32Bitwise(buffer + 3, 4096), crc32Slices8(buffer + 3, 4096));
+
+	// incremental in odd pieces matches one go
+	uint32_t crc = 0;
+	uint32_t offset = 0;
+	for (uint32_t piece = 1; offset < sizeof(buffer); piece = piece * 3 + 1) {
+		uint32_t size = piece < sizeof(buffer) - offset ? piece : sizeof(buffer) - offset;
+		crc = crc32incSlices8(buffer + offset, crc, size);
+		offset += size;
+	}
+	EXPECT_EQ(crc32Bitwise(buffer, sizeof(buffer)), crc);
+}